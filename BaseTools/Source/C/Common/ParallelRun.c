@@ -0,0 +1,222 @@
+/** @file
+Helper functions to run independent tasks on multiple host threads.
+
+Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "ParallelRun.h"
+
+#define MAX_PARALLEL_THREADS  64
+
+typedef struct {
+  PARALLEL_TASK_FUNC   TaskFunc;
+  VOID                *Context;
+  UINT32               TaskCount;
+  UINT32               ThreadCount;
+  UINT32               ThreadIndex;
+  INT32                Result;
+} PARALLEL_THREAD_DATA;
+
+/**
+  Get the number of logical processors available on the host.
+
+  @return The number of logical processors, at least 1.
+**/
+UINT32
+GetHostProcessorCount (
+  VOID
+  )
+{
+#ifdef _WIN32
+  SYSTEM_INFO  SystemInfo;
+
+  GetSystemInfo (&SystemInfo);
+  if (SystemInfo.dwNumberOfProcessors > 0) {
+    return (UINT32) SystemInfo.dwNumberOfProcessors;
+  }
+#else
+  long         Count;
+
+  Count = sysconf (_SC_NPROCESSORS_ONLN);
+  if (Count > 0) {
+    return (UINT32) Count;
+  }
+#endif
+  return 1;
+}
+
+/**
+  Run every task assigned to one thread.
+
+  @param[in] Data   Thread data describing the tasks to run.
+
+  @return The first non-zero task result, or 0.
+**/
+STATIC
+INT32
+RunThreadTasks (
+  IN PARALLEL_THREAD_DATA  *Data
+  )
+{
+  UINT32   Index;
+  INT32    Result;
+
+  for (Index = Data->ThreadIndex; Index < Data->TaskCount; Index += Data->ThreadCount) {
+    Result = Data->TaskFunc (Data->Context, Index);
+    if (Result != 0) {
+      Data->Result = Result;
+      break;
+    }
+  }
+  return Data->Result;
+}
+
+#ifdef _WIN32
+STATIC
+DWORD
+WINAPI
+ParallelThreadEntry (
+  IN LPVOID  Param
+  )
+{
+  RunThreadTasks ((PARALLEL_THREAD_DATA *) Param);
+  return 0;
+}
+#else
+STATIC
+VOID *
+ParallelThreadEntry (
+  IN VOID  *Param
+  )
+{
+  RunThreadTasks ((PARALLEL_THREAD_DATA *) Param);
+  return NULL;
+}
+#endif
+
+/**
+  Run TaskCount independent tasks on up to ThreadCount host threads.
+
+  Task N is run by thread (N % ThreadCount), so tasks of similar cost are
+  spread evenly without any locking between the threads. If threads cannot
+  be created, the remaining tasks are run on the calling thread.
+
+  @param[in] TaskFunc      Routine to run for every task.
+  @param[in] Context       Caller context passed to TaskFunc.
+  @param[in] TaskCount     Number of tasks to run.
+  @param[in] ThreadCount   Maximum number of threads. 0 means one per host
+                           logical processor.
+
+  @retval 0                All tasks completed successfully.
+  @retval others           The first non-zero value returned by a task.
+**/
+INT32
+RunParallelTasks (
+  IN PARALLEL_TASK_FUNC   TaskFunc,
+  IN VOID                *Context,
+  IN UINT32               TaskCount,
+  IN UINT32               ThreadCount
+  )
+{
+  PARALLEL_THREAD_DATA  *Data;
+  UINT32                 Index;
+  UINT32                 Started;
+  INT32                  Result;
+#ifdef _WIN32
+  HANDLE                 Threads[MAX_PARALLEL_THREADS];
+#else
+  pthread_t              Threads[MAX_PARALLEL_THREADS];
+#endif
+
+  if (ThreadCount == 0) {
+    ThreadCount = GetHostProcessorCount ();
+  }
+  if (ThreadCount > TaskCount) {
+    ThreadCount = TaskCount;
+  }
+  if (ThreadCount > MAX_PARALLEL_THREADS) {
+    ThreadCount = MAX_PARALLEL_THREADS;
+  }
+  if (ThreadCount == 0) {
+    return 0;
+  }
+
+  Data = (PARALLEL_THREAD_DATA *) calloc (ThreadCount, sizeof (PARALLEL_THREAD_DATA));
+  if (Data == NULL) {
+    ThreadCount = 1;
+  }
+
+  if (ThreadCount == 1) {
+    for (Index = 0; Index < TaskCount; Index++) {
+      Result = TaskFunc (Context, Index);
+      if (Result != 0) {
+        break;
+      }
+    }
+    free (Data);
+    return (Index < TaskCount) ? Result : 0;
+  }
+
+  for (Index = 0; Index < ThreadCount; Index++) {
+    Data[Index].TaskFunc    = TaskFunc;
+    Data[Index].Context     = Context;
+    Data[Index].TaskCount   = TaskCount;
+    Data[Index].ThreadCount = ThreadCount;
+    Data[Index].ThreadIndex = Index;
+  }
+
+  //
+  // Thread 0 work is done on the calling thread. Any thread that fails to
+  // start has its share of the tasks run on the calling thread as well.
+  //
+  Started = 0;
+  for (Index = 1; Index < ThreadCount; Index++) {
+#ifdef _WIN32
+    Threads[Index] = CreateThread (NULL, 0, ParallelThreadEntry, &Data[Index], 0, NULL);
+    if (Threads[Index] == NULL) {
+      break;
+    }
+#else
+    if (pthread_create (&Threads[Index], NULL, ParallelThreadEntry, &Data[Index]) != 0) {
+      break;
+    }
+#endif
+    Started = Index;
+  }
+
+  RunThreadTasks (&Data[0]);
+  for (Index = Started + 1; Index < ThreadCount; Index++) {
+    RunThreadTasks (&Data[Index]);
+  }
+
+  for (Index = 1; Index <= Started; Index++) {
+#ifdef _WIN32
+    WaitForSingleObject (Threads[Index], INFINITE);
+    CloseHandle (Threads[Index]);
+#else
+    pthread_join (Threads[Index], NULL);
+#endif
+  }
+
+  Result = 0;
+  for (Index = 0; Index < ThreadCount; Index++) {
+    if (Data[Index].Result != 0) {
+      Result = Data[Index].Result;
+      break;
+    }
+  }
+
+  free (Data);
+  return Result;
+}
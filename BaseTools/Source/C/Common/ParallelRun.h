@@ -0,0 +1,72 @@
+/** @file
+Helper functions to run independent tasks on multiple host threads.
+
+Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _EFI_PARALLEL_RUN_H
+#define _EFI_PARALLEL_RUN_H
+
+#include <Common/UefiBaseTypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  Task routine run by RunParallelTasks ().
+
+  @param[in] Context     Caller context passed to RunParallelTasks ().
+  @param[in] TaskIndex   Index of the task to run, 0 based.
+
+  @retval 0              The task completed successfully.
+  @retval others         The task failed.
+**/
+typedef
+INT32
+(*PARALLEL_TASK_FUNC) (
+  IN VOID    *Context,
+  IN UINT32   TaskIndex
+  );
+
+/**
+  Get the number of logical processors available on the host.
+
+  @return The number of logical processors, at least 1.
+**/
+UINT32
+GetHostProcessorCount (
+  VOID
+  );
+
+/**
+  Run TaskCount independent tasks on up to ThreadCount host threads.
+
+  Task N is run by thread (N % ThreadCount), so tasks of similar cost are
+  spread evenly without any locking between the threads. If threads cannot
+  be created, the remaining tasks are run on the calling thread.
+
+  @param[in] TaskFunc      Routine to run for every task.
+  @param[in] Context       Caller context passed to TaskFunc.
+  @param[in] TaskCount     Number of tasks to run.
+  @param[in] ThreadCount   Maximum number of threads. 0 means one per host
+                           logical processor.
+
+  @retval 0                All tasks completed successfully.
+  @retval others           The first non-zero value returned by a task.
+**/
+INT32
+RunParallelTasks (
+  IN PARALLEL_TASK_FUNC   TaskFunc,
+  IN VOID                *Context,
+  IN UINT32               TaskCount,
+  IN UINT32               ThreadCount
+  );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -19,11 +19,33 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <string.h>
 
 #include "CommonLib.h"
+#include "ParallelRun.h"
 #include "Sdk/lz4.h"
 #include "Sdk/lz4hc.h"
 
 #define UTILITY_NAME "Lz4Compress"
 
+//
+// Block stream layout, produced only when block mode is requested:
+//   UINT32  Marker (BLOCK_STREAM_MARKER)
+//   UINT32  DecompressedSize
+//   UINT32  BlockSize
+//   UINT32  BlockCount
+//   UINT32  CompressedSize[BlockCount]
+//   Block[BlockCount], each one a regular single stream (UINT32 size + LZ4 block)
+//
+#define BLOCK_STREAM_MARKER     0xFFFFFFFF
+#define BLOCK_STREAM_HDR_SIZE   (4 * sizeof (UINT32))
+
+typedef struct {
+  const char  *Input;
+  UINT32       InputSize;
+  UINT32       BlockSize;
+  int          Level;
+  char       **Output;
+  UINT32      *OutputSize;
+} BLOCK_JOB;
+
 #define INTEL_COPYRIGHT \
   "Copyright (c) 2017, Intel Corporation. All rights reserved."
 
@@ -34,9 +56,214 @@ void PrintHelp (void)
              "  -e: encode file\n"
              "  -d: decode file\n"
              "  -o FileName, --output FileName: specify the output filename\n"
+             "  -l Level: LZ4-HC compression level [1, %d], default: %d\n"
+             "  -b Size: split input into independent blocks of Size KB\n"
+             "  -t Count: number of threads used in block mode, default: all host CPUs\n",
+             LZ4HC_MAX_CLEVEL, LZ4HC_DEFAULT_CLEVEL
              );
 }
 
+/**
+  Compress one block of a block stream.
+
+  @param[in] Context     Pointer to the BLOCK_JOB.
+  @param[in] TaskIndex   Index of the block to compress.
+
+  @retval 0              The block is compressed.
+  @retval -1             The block could not be compressed.
+**/
+INT32
+CompressBlock (
+  IN VOID    *Context,
+  IN UINT32   TaskIndex
+  )
+{
+  BLOCK_JOB  *Job;
+  UINT32      Offset;
+  UINT32      Size;
+  int         Bound;
+  int         Res;
+  char       *Buf;
+
+  Job    = (BLOCK_JOB *)Context;
+  Offset = TaskIndex * Job->BlockSize;
+  Size   = Job->InputSize - Offset;
+  if (Size > Job->BlockSize) {
+    Size = Job->BlockSize;
+  }
+
+  Bound = LZ4_compressBound ((int)Size);
+  Buf   = (char *)malloc (sizeof (UINT32) + Bound);
+  if (Buf == NULL) {
+    return -1;
+  }
+
+  Res = LZ4_compress_HC (Job->Input + Offset, Buf + sizeof (UINT32), (int)Size, Bound, Job->Level);
+  if (Res <= 0) {
+    free (Buf);
+    return -1;
+  }
+
+  *(UINT32 *)Buf = Size;
+  Job->Output[TaskIndex]     = Buf;
+  Job->OutputSize[TaskIndex] = (UINT32)(sizeof (UINT32) + Res);
+  return 0;
+}
+
+/**
+  Compress a buffer into a block stream using multiple threads.
+
+  @param[in]  Input        Input buffer.
+  @param[in]  InputSize    Size of the input buffer.
+  @param[in]  BlockSize    Size of each uncompressed block.
+  @param[in]  Level        LZ4-HC compression level.
+  @param[in]  Threads      Number of threads, 0 for all host CPUs.
+  @param[out] Output       Allocated block stream.
+
+  @return Size of the block stream, or -1 on failure.
+**/
+int
+CompressBlockStream (
+  IN  const char  *Input,
+  IN  UINT32       InputSize,
+  IN  UINT32       BlockSize,
+  IN  int          Level,
+  IN  UINT32       Threads,
+  OUT char       **Output
+  )
+{
+  BLOCK_JOB   Job;
+  UINT32      BlockCount;
+  UINT32      Index;
+  UINT32      Total;
+  UINT32     *Hdr;
+  char       *Ptr;
+  int         Res;
+
+  BlockCount = (InputSize + BlockSize - 1) / BlockSize;
+  Job.Input      = Input;
+  Job.InputSize  = InputSize;
+  Job.BlockSize  = BlockSize;
+  Job.Level      = Level;
+  Job.Output     = (char **)calloc (BlockCount, sizeof (char *));
+  Job.OutputSize = (UINT32 *)calloc (BlockCount, sizeof (UINT32));
+  *Output = NULL;
+  Res     = -1;
+
+  if ((Job.Output == NULL) || (Job.OutputSize == NULL)) {
+    goto Done;
+  }
+
+  if (RunParallelTasks (CompressBlock, &Job, BlockCount, Threads) != 0) {
+    goto Done;
+  }
+
+  Total = BLOCK_STREAM_HDR_SIZE + BlockCount * sizeof (UINT32);
+  for (Index = 0; Index < BlockCount; Index++) {
+    Total += Job.OutputSize[Index];
+  }
+
+  *Output = (char *)malloc (Total);
+  if (*Output == NULL) {
+    goto Done;
+  }
+
+  Hdr    = (UINT32 *)*Output;
+  Hdr[0] = BLOCK_STREAM_MARKER;
+  Hdr[1] = InputSize;
+  Hdr[2] = BlockSize;
+  Hdr[3] = BlockCount;
+  Ptr    = *Output + BLOCK_STREAM_HDR_SIZE + BlockCount * sizeof (UINT32);
+  for (Index = 0; Index < BlockCount; Index++) {
+    Hdr[4 + Index] = Job.OutputSize[Index];
+    memcpy (Ptr, Job.Output[Index], Job.OutputSize[Index]);
+    Ptr += Job.OutputSize[Index];
+  }
+  Res = (int)Total;
+
+Done:
+  if (Job.Output != NULL) {
+    for (Index = 0; Index < BlockCount; Index++) {
+      free (Job.Output[Index]);
+    }
+    free (Job.Output);
+  }
+  free (Job.OutputSize);
+  return Res;
+}
+
+/**
+  Decompress a block stream.
+
+  @param[in]  Input        Block stream buffer.
+  @param[in]  InputSize    Size of the block stream buffer.
+  @param[out] Output       Allocated decompressed buffer.
+
+  @return Decompressed size, or -1 on failure.
+**/
+int
+DecompressBlockStream (
+  IN  const char  *Input,
+  IN  UINT32       InputSize,
+  OUT char       **Output
+  )
+{
+  const UINT32  *Hdr;
+  const char    *Ptr;
+  UINT32         BlockCount;
+  UINT32         BlockSize;
+  UINT32         Remaining;
+  UINT32         Offset;
+  UINT32         Size;
+  UINT32         Index;
+
+  *Output = NULL;
+  if (InputSize < BLOCK_STREAM_HDR_SIZE) {
+    return -1;
+  }
+
+  Hdr        = (const UINT32 *)Input;
+  BlockSize  = Hdr[2];
+  BlockCount = Hdr[3];
+  if ((BlockSize == 0) || ((UINT64)BlockCount * BlockSize < Hdr[1]) ||
+      (BLOCK_STREAM_HDR_SIZE + (UINT64)BlockCount * sizeof (UINT32) > InputSize)) {
+    return -1;
+  }
+
+  *Output = (char *)malloc (Hdr[1] > 0 ? Hdr[1] : 1);
+  if (*Output == NULL) {
+    return -1;
+  }
+
+  Ptr       = Input + BLOCK_STREAM_HDR_SIZE + BlockCount * sizeof (UINT32);
+  Remaining = (UINT32)(Input + InputSize - Ptr);
+  Offset    = 0;
+  for (Index = 0; Index < BlockCount; Index++) {
+    Size = Hdr[4 + Index];
+    if ((Size < sizeof (UINT32)) || (Size > Remaining)) {
+      break;
+    }
+    if ((*(UINT32 *)Ptr > BlockSize) || (*(UINT32 *)Ptr > Hdr[1] - Offset)) {
+      break;
+    }
+    if (LZ4_decompress_safe (Ptr + sizeof (UINT32), *Output + Offset,
+          (int)(Size - sizeof (UINT32)), (int)*(UINT32 *)Ptr) != (int)*(UINT32 *)Ptr) {
+      break;
+    }
+    Offset    += *(UINT32 *)Ptr;
+    Ptr       += Size;
+    Remaining -= Size;
+  }
+
+  if ((Index < BlockCount) || (Offset != Hdr[1])) {
+    free (*Output);
+    *Output = NULL;
+    return -1;
+  }
+
+  return (int)Offset;
+}
+
 
 int
 main (
@@ -69,6 +296,9 @@ Returns:
   int    res;
   int    decompress;
   int    inpsz;
+  int    level;
+  int    blocksz;
+  int    threads;
   char   *bufi;
   char   *bufo;
   char   *input;
@@ -81,6 +311,9 @@ Returns:
   output = NULL;
   input  = NULL;
   decompress = -1;
+  level   = 0;
+  blocksz = 0;
+  threads = 0;
 
   if (argc < 5) {
     PrintHelp ();
@@ -98,6 +331,19 @@ Returns:
           output =  argv[i+1];
           i++;
         }
+      } else if (!strcmp(argv[i], "-l") || !strcmp(argv[i], "-b") || !strcmp(argv[i], "-t")) {
+        if ((i+1 >= argc) || (atoi(argv[i+1]) < 0)) {
+          printf("Invalid value for option '%s' !\n", argv[i]);
+          return -1;
+        }
+        if (argv[i][1] == 'l') {
+          level = atoi(argv[i+1]);
+        } else if (argv[i][1] == 'b') {
+          blocksz = atoi(argv[i+1]);
+        } else {
+          threads = atoi(argv[i+1]);
+        }
+        i++;
       } else {
         printf("Unknown option '%s' !\n", argv[i]);
         return -1;
@@ -140,19 +386,29 @@ Returns:
   }
   fclose(fp);
 
+  if ((level > LZ4HC_MAX_CLEVEL) || (blocksz > 0x100000)) {
+    printf("Invalid compression level or block size!\n");
+    free(bufi);
+    return -1;
+  }
+
   if (decompress == 1) {
     sz = *(int *)bufi;
-    if ((sz < 0) || (inpsz < sizeof(int))) {
+    if ((inpsz >= sizeof(int)) && ((UINT32)sz == BLOCK_STREAM_MARKER)) {
+      res = DecompressBlockStream ((const char *)bufi, (UINT32)inpsz, &bufo);
+    } else if ((sz < 0) || (inpsz < sizeof(int))) {
       res = -1;
     } else {
       bufo = (char *)malloc(sz);
       res = LZ4_decompress_safe((const char *)bufi + sizeof(int), (char *)bufo, inpsz - sizeof(int), sz);
     }
+  } else if ((blocksz > 0) && (inpsz > 0)) {
+    res = CompressBlockStream ((const char *)bufi, (UINT32)inpsz, (UINT32)blocksz * 1024, level, (UINT32)threads, &bufo);
   } else {
     bufsz = LZ4_compressBound(inpsz);
     bufo = (char *)malloc(bufsz);
     if (bufo) {
-      res = LZ4_compress_HC((const char *)bufi, (char *)bufo, inpsz, bufsz, 0);
+      res = LZ4_compress_HC((const char *)bufi, (char *)bufo, inpsz, bufsz, level);
     } else {
       res = -1;
     }
@@ -163,7 +419,10 @@ Returns:
     if (!fp) {
       printf("Cannot create file '%s' !\n", output);
     } else {
-      if (!decompress) {
+      //
+      // The block stream carries its own header
+      //
+      if (!decompress && ((blocksz == 0) || (inpsz == 0))) {
         fwrite(&inpsz, sizeof(int), 1, fp);
       }
       fwrite(bufo, res, 1, fp);
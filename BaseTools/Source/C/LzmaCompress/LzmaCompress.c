@@ -24,9 +24,31 @@
 #include "Sdk/C/Bra.h"
 #include "CommonLib.h"
 #include "ParseInf.h"
+#include "ParallelRun.h"
 
 #define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
 
+//
+// Block stream layout, produced only when block mode is requested:
+//   UInt32  Marker (BLOCK_STREAM_MARKER, an invalid LZMA properties byte)
+//   UInt32  DecompressedSize
+//   UInt32  BlockSize
+//   UInt32  BlockCount
+//   UInt32  CompressedSize[BlockCount]
+//   Block[BlockCount], each one a regular LZMA stream with its own header
+//
+#define BLOCK_STREAM_MARKER     0xFFFFFFFF
+#define BLOCK_STREAM_HDR_SIZE   (4 * sizeof (UInt32))
+
+typedef struct {
+  const Byte           *Input;
+  size_t                InputSize;
+  UInt32                BlockSize;
+  const CLzmaEncProps  *Props;
+  Byte                **Output;
+  UInt32               *OutputSize;
+} BLOCK_JOB;
+
 typedef enum {
   NoConverter,
   X86Converter,
@@ -44,6 +66,8 @@ static CONVERTER_TYPE mConType = NoConverter;
 
 UINT64 mDictionarySize = 28;
 UINT64 mCompressionMode = 2;
+UINT64 mBlockSize = 0;
+UINT64 mThreadCount = 0;
 
 #define UTILITY_NAME "LzmaCompress"
 #define UTILITY_MAJOR_VERSION 0
@@ -65,6 +89,8 @@ void PrintHelp(char *buffer)
              "  --debug [0-9]: set debug level\n"
              "  -a: set compression mode 0 = fast, 1 = normal, default: 1 (normal)\n"
              "  d: sets Dictionary size - [0, 27], default: 24 (16MB)\n"
+             "  -b Size: split input into independent blocks of Size KB\n"
+             "  -t Count: number of threads used in block mode, default: all host CPUs\n"
              "  --version: display the program version and exit\n"
              "  -h, --help: display this help text\n"
              );
@@ -94,6 +120,162 @@ void PrintVersion(char *buffer)
   sprintf (buffer, "%s Version %d.%d %s ", UTILITY_NAME, UTILITY_MAJOR_VERSION, UTILITY_MINOR_VERSION, __BUILD_VERSION);
 }
 
+static void SetUi32(Byte *p, UInt32 v)
+{
+  p[0] = (Byte)v;
+  p[1] = (Byte)(v >> 8);
+  p[2] = (Byte)(v >> 16);
+  p[3] = (Byte)(v >> 24);
+}
+
+static UInt32 GetUi32(const Byte *p)
+{
+  return (UInt32)p[0] | ((UInt32)p[1] << 8) | ((UInt32)p[2] << 16) | ((UInt32)p[3] << 24);
+}
+
+static INT32 EncodeBlock(VOID *context, UINT32 index)
+{
+  BLOCK_JOB *job = (BLOCK_JOB *)context;
+  size_t offset = (size_t)index * job->BlockSize;
+  size_t inSize = job->InputSize - offset;
+  size_t outSize;
+  size_t outSizeProcessed;
+  size_t outPropsSize = LZMA_PROPS_SIZE;
+  Byte *outBuffer;
+  CLzmaEncProps props;
+  int i;
+
+  if (inSize > job->BlockSize)
+    inSize = job->BlockSize;
+
+  outSize = inSize / 20 * 21 + (1 << 16);
+  outBuffer = (Byte *)MyAlloc(outSize);
+  if (outBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  for (i = 0; i < 8; i++)
+    outBuffer[i + LZMA_PROPS_SIZE] = (Byte)((UInt64)inSize >> (8 * i));
+
+  //
+  // Every block is encoded single threaded, the parallelism is across blocks
+  //
+  props = *job->Props;
+  props.numThreads = 1;
+  outSizeProcessed = outSize - LZMA_HEADER_SIZE;
+  if (LzmaEncode(outBuffer + LZMA_HEADER_SIZE, &outSizeProcessed,
+        job->Input + offset, inSize, &props, outBuffer, &outPropsSize, 0,
+        NULL, &g_Alloc, &g_Alloc) != SZ_OK) {
+    MyFree(outBuffer);
+    return SZ_ERROR_DATA;
+  }
+
+  job->Output[index] = outBuffer;
+  job->OutputSize[index] = (UInt32)(LZMA_HEADER_SIZE + outSizeProcessed);
+  return SZ_OK;
+}
+
+static SRes EncodeBlockStream(ISeqOutStream *outStream, const Byte *inBuffer, size_t inSize, CLzmaEncProps *props)
+{
+  SRes res;
+  BLOCK_JOB job;
+  UInt32 blockCount;
+  UInt32 i;
+  Byte *header = 0;
+  size_t headerSize;
+
+  job.Input = inBuffer;
+  job.InputSize = inSize;
+  job.BlockSize = (UInt32)mBlockSize * 1024;
+  job.Props = props;
+  blockCount = (UInt32)((inSize + job.BlockSize - 1) / job.BlockSize);
+  job.Output = (Byte **)calloc(blockCount, sizeof(Byte *));
+  job.OutputSize = (UInt32 *)calloc(blockCount, sizeof(UInt32));
+  headerSize = BLOCK_STREAM_HDR_SIZE + blockCount * sizeof(UInt32);
+  header = (Byte *)MyAlloc(headerSize);
+  if (job.Output == 0 || job.OutputSize == 0 || header == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  res = (SRes)RunParallelTasks(EncodeBlock, &job, blockCount, (UINT32)mThreadCount);
+  if (res != SZ_OK)
+    goto Done;
+
+  SetUi32(header, BLOCK_STREAM_MARKER);
+  SetUi32(header + 4, (UInt32)inSize);
+  SetUi32(header + 8, job.BlockSize);
+  SetUi32(header + 12, blockCount);
+  for (i = 0; i < blockCount; i++)
+    SetUi32(header + BLOCK_STREAM_HDR_SIZE + i * sizeof(UInt32), job.OutputSize[i]);
+
+  if (outStream->Write(outStream, header, headerSize) != headerSize) {
+    res = SZ_ERROR_WRITE;
+    goto Done;
+  }
+  for (i = 0; i < blockCount; i++) {
+    if (outStream->Write(outStream, job.Output[i], job.OutputSize[i]) != job.OutputSize[i]) {
+      res = SZ_ERROR_WRITE;
+      goto Done;
+    }
+  }
+
+Done:
+  if (job.Output != 0) {
+    for (i = 0; i < blockCount; i++)
+      MyFree(job.Output[i]);
+  }
+  free(job.Output);
+  free(job.OutputSize);
+  MyFree(header);
+  return res;
+}
+
+static SRes DecodeBlockStream(Byte *outBuffer, size_t outSize, const Byte *inBuffer, size_t inSize)
+{
+  UInt32 blockSize = GetUi32(inBuffer + 8);
+  UInt32 blockCount = GetUi32(inBuffer + 12);
+  const Byte *block;
+  size_t offset = 0;
+  size_t remaining;
+  size_t blockOutSize;
+  size_t inSizePure;
+  ELzmaStatus status;
+  UInt32 compSize;
+  UInt32 i;
+  int j;
+  SRes res;
+
+  if (blockSize == 0 || (UInt64)blockCount * blockSize < outSize ||
+      BLOCK_STREAM_HDR_SIZE + (UInt64)blockCount * sizeof(UInt32) > inSize)
+    return SZ_ERROR_DATA;
+
+  block = inBuffer + BLOCK_STREAM_HDR_SIZE + blockCount * sizeof(UInt32);
+  remaining = inSize - (block - inBuffer);
+  for (i = 0; i < blockCount; i++) {
+    compSize = GetUi32(inBuffer + BLOCK_STREAM_HDR_SIZE + i * sizeof(UInt32));
+    if (compSize < LZMA_HEADER_SIZE || compSize > remaining)
+      return SZ_ERROR_DATA;
+
+    blockOutSize = 0;
+    for (j = 0; j < 4; j++)
+      blockOutSize += ((size_t)block[LZMA_PROPS_SIZE + j]) << (j * 8);
+    if (blockOutSize > blockSize || blockOutSize > outSize - offset)
+      return SZ_ERROR_DATA;
+
+    inSizePure = compSize - LZMA_HEADER_SIZE;
+    res = LzmaDecode(outBuffer + offset, &blockOutSize, block + LZMA_HEADER_SIZE, &inSizePure,
+        block, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+    if (res != SZ_OK)
+      return res;
+
+    offset += blockOutSize;
+    block += compSize;
+    remaining -= compSize;
+  }
+
+  return (offset == outSize) ? SZ_OK : SZ_ERROR_DATA;
+}
+
 static SRes Encode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize, CLzmaEncProps *props)
 {
   SRes res;
@@ -148,6 +330,11 @@ static SRes Encode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 file
     }
   }
 
+  if (mBlockSize != 0) {
+    res = EncodeBlockStream(outStream, mConType != NoConverter ? filteredStream : inBuffer, inSize, props);
+    goto Done;
+  }
+
   {
     size_t outSizeProcessed = outSize - LZMA_HEADER_SIZE;
     size_t outPropsSize = LZMA_PROPS_SIZE;
@@ -199,8 +386,16 @@ static SRes Decode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 file
     goto Done;
   }
 
-  for (i = 0; i < 8; i++)
-    outSize64 += ((UInt64)inBuffer[LZMA_PROPS_SIZE + i]) << (i * 8);
+  if (GetUi32(inBuffer) == BLOCK_STREAM_MARKER) {
+    if (inSize < BLOCK_STREAM_HDR_SIZE) {
+      res = SZ_ERROR_INPUT_EOF;
+      goto Done;
+    }
+    outSize64 = GetUi32(inBuffer + 4);
+  } else {
+    for (i = 0; i < 8; i++)
+      outSize64 += ((UInt64)inBuffer[LZMA_PROPS_SIZE + i]) << (i * 8);
+  }
 
   outSize = (size_t)outSize64;
   if (outSize != 0) {
@@ -214,9 +409,13 @@ static SRes Decode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 file
     goto Done;
   }
 
-  inSizePure = inSize - LZMA_HEADER_SIZE;
-  res = LzmaDecode(outBuffer, &outSize, inBuffer + LZMA_HEADER_SIZE, &inSizePure,
-      inBuffer, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+  if (GetUi32(inBuffer) == BLOCK_STREAM_MARKER) {
+    res = DecodeBlockStream(outBuffer, outSize, inBuffer, inSize);
+  } else {
+    inSizePure = inSize - LZMA_HEADER_SIZE;
+    res = LzmaDecode(outBuffer, &outSize, inBuffer + LZMA_HEADER_SIZE, &inSizePure,
+        inBuffer, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+  }
 
   if (res != SZ_OK)
     goto Done;
@@ -309,6 +508,19 @@ int main2(int numArgs, const char *args[], char *rs)
       } else {
         return PrintError(rs, kInvalidParamValMessage);
       }
+    } else if (strcmp(args[param], "-b") == 0 || strcmp(args[param], "-t") == 0) {
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      if (args[param][1] == 'b') {
+        AsciiStringToUint64(args[param + 1],FALSE,&mBlockSize);
+        if (mBlockSize > 0x100000) {
+          return PrintError(rs, kInvalidParamValMessage);
+        }
+      } else {
+        AsciiStringToUint64(args[param + 1],FALSE,&mThreadCount);
+      }
+      param++;
     } else if (
                 strcmp(args[param], "-h") == 0 ||
                 strcmp(args[param], "--help") == 0
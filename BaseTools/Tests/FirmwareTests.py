@@ -0,0 +1,30 @@
+## @file
+# Unit tests for firmware sources built on the host
+#
+# Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+#
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import unittest
+
+import GpioInitTest
+import HeciAsyncTest
+import SmbiosInitTest
+import PoolTraceTest
+import LiteVariableTest
+
+def TheTestSuite():
+    suites = []
+    suites.append(GpioInitTest.TheTestSuite())
+    suites.append(HeciAsyncTest.TheTestSuite())
+    suites.append(SmbiosInitTest.TheTestSuite())
+    suites.append(PoolTraceTest.TheTestSuite())
+    suites.append(LiteVariableTest.TheTestSuite())
+    return unittest.TestSuite(suites)
+
+if __name__ == '__main__':
+    unittest.TextTestRunner(verbosity=2).run(TheTestSuite())
@@ -0,0 +1,70 @@
+## @file
+# Sideband write count test for the CommonSocPkg GPIO pad programming
+#
+# Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+#
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import unittest
+import TestTools
+
+class GpioInitTests(TestTools.HostHarnessTestCase):
+    """Run GpioConfigurePads () on a modeled GPIO community.
+
+    The model has one group of output pads, one of which is left unlocked,
+    and one group of input and disabled pads. It is programmed once from
+    reset (cold), again with all lock bits set and the same table (warm),
+    and again with one output pad changed (delta).
+    """
+    Harness  = 'GpioInitHarness.c'
+    Sources  = [
+      'Silicon/CommonSocPkg/Library/GpioLib/GpioInit.c',
+      'Silicon/CommonSocPkg/Library/GpioLib/GpioLib.c',
+      ]
+    Includes = [
+      'Silicon/CommonSocPkg/Include',
+      'Silicon/CommonSocPkg/Library/GpioLib',
+      ]
+
+    def setUp(self):
+        super().setUp()
+        self.Values = self.RunHarness(self.BuildHarness())
+
+    def GetCount(self, Key):
+        return int(self.Values[Key])
+
+    def testFinalStateMatchesTable(self):
+        for Phase in ('cold', 'warm', 'delta'):
+            self.assertEqual(self.GetCount('%s.status' % Phase), 0)
+            self.assertEqual(self.GetCount('%s.mismatches' % Phase), 0, Phase)
+            self.assertEqual(self.GetCount('%s.dropped_writes' % Phase), 0, Phase)
+
+    def testColdBootProgramsEveryPad(self):
+        self.assertEqual(self.GetCount('cold.padcfg_writes'), 3 * self.GetCount('pads'))
+        self.assertEqual(self.GetCount('cold.sbi_writes'), 4)
+
+    def testWarmBootSkipsUnchangedPads(self):
+        self.assertEqual(self.GetCount('warm.padcfg_writes'), 0)
+        #
+        # Only the TX unlock of the output group is left
+        #
+        self.assertEqual(self.GetCount('warm.sbi_writes'), 2)
+        self.assertLess(self.GetCount('warm.sbi_writes'), self.GetCount('cold.sbi_writes'))
+
+    def testWarmBootUnlocksOutputsAndUnlockedPads(self):
+        for Phase in ('warm', 'delta'):
+            self.assertEqual(self.GetCount('%s.tx_locked_outputs' % Phase), 0, Phase)
+            self.assertEqual(self.GetCount('%s.cfg_locked_unlock_pad' % Phase), 0, Phase)
+
+    def testDeltaProgramsOnlyChangedPad(self):
+        self.assertEqual(self.GetCount('delta.padcfg_writes'), 3)
+
+def TheTestSuite():
+    return unittest.TestLoader().loadTestsFromTestCase(GpioInitTests)
+
+if __name__ == '__main__':
+    unittest.TextTestRunner(verbosity=2).run(TheTestSuite())
@@ -0,0 +1,472 @@
+/** @file
+  Host harness for the CommonSocPkg GPIO pad programming.
+
+  Links Silicon/CommonSocPkg/Library/GpioLib/GpioInit.c and GpioLib.c against
+  a model of one GPIO community. The model keeps the PCR register space in
+  memory, counts PADCFG MMIO writes and sideband lock register writes, and
+  drops PADCFG writes to pads whose PADCFGLOCK/PADCFGLOCKTX bit is set like
+  the hardware does.
+
+  Results are printed as "key=value" lines for GpioInitTest.py.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi/UefiBaseType.h>
+#include <Library/DebugLib.h>
+#include <Library/IoLib.h>
+#include <Library/GpioLib.h>
+#include <Library/GpioSiLib.h>
+#include <Library/PchSbiAccessLib.h>
+#include <Library/ConfigDataLib.h>
+#include <Library/BlMemoryAllocationLib.h>
+#include "GpioLibInternal.h"
+
+int printf (const char *Format, ...);
+void abort (void);
+
+#define MODEL_PID              0x6E
+#define MODEL_PCR_SIZE         0x1000
+#define MODEL_PADCFG_SIZE      0x10
+#define MODEL_GROUP_COUNT      2
+#define MODEL_PADS_PER_GROUP   24
+
+STATIC CONST GPIO_GROUP_INFO  mModelGroupInfo[MODEL_GROUP_COUNT] = {
+  // Community  PadOwn HostOwn GpiIs GpiIe  GpeSts GpeEn  SmiSts/SmiEn                                        NmiSts/NmiEn                                        Lock  LockTx PadCfg PadPerGroup
+  { MODEL_PID,  0x020, 0x140,  0x100, 0x120, 0x160, 0x180, NO_REGISTER_FOR_PROPERTY, NO_REGISTER_FOR_PROPERTY, NO_REGISTER_FOR_PROPERTY, NO_REGISTER_FOR_PROPERTY, 0x080, 0x084, 0x600, MODEL_PADS_PER_GROUP },
+  { MODEL_PID,  0x030, 0x144,  0x104, 0x124, 0x164, 0x184, NO_REGISTER_FOR_PROPERTY, NO_REGISTER_FOR_PROPERTY, NO_REGISTER_FOR_PROPERTY, NO_REGISTER_FOR_PROPERTY, 0x088, 0x08C, 0x780, MODEL_PADS_PER_GROUP }
+};
+
+STATIC UINT32  mPcr[MODEL_PCR_SIZE / sizeof (UINT32)];
+STATIC UINT32  mPadCfgWrites;
+STATIC UINT32  mSbiWrites;
+STATIC UINT32  mDroppedWrites;
+
+#define MODEL_PAD(GroupIndex, PadNumber)  (((GroupIndex) << 16) | (PadNumber))
+
+//
+// DebugLib, BaseMemoryLib and allocation stubs
+//
+VOID
+EFIAPI
+DebugPrint (
+  IN  UINTN        ErrorLevel,
+  IN  CONST CHAR8  *Format,
+  ...
+  )
+{
+}
+
+VOID
+EFIAPI
+DebugAssert (
+  IN CONST CHAR8  *FileName,
+  IN UINTN        LineNumber,
+  IN CONST CHAR8  *Description
+  )
+{
+  printf ("ASSERT %s(%d): %s\n", FileName, (int)LineNumber, Description);
+  abort ();
+}
+
+BOOLEAN EFIAPI DebugAssertEnabled (VOID) { return TRUE; }
+BOOLEAN EFIAPI DebugPrintEnabled (VOID) { return FALSE; }
+BOOLEAN EFIAPI DebugPrintLevelEnabled (IN CONST UINTN ErrorLevel) { return FALSE; }
+BOOLEAN EFIAPI DebugCodeEnabled (VOID) { return TRUE; }
+BOOLEAN EFIAPI DebugClearMemoryEnabled (VOID) { return FALSE; }
+VOID * EFIAPI DebugClearMemory (OUT VOID *Buffer, IN UINTN Length) { return Buffer; }
+
+VOID *
+EFIAPI
+ZeroMem (
+  OUT VOID  *Buffer,
+  IN UINTN  Length
+  )
+{
+  UINT8  *Ptr;
+
+  for (Ptr = Buffer; Length > 0; Length--) {
+    *Ptr++ = 0;
+  }
+  return Buffer;
+}
+
+VOID *
+EFIAPI
+CopyMem (
+  OUT VOID       *DestinationBuffer,
+  IN CONST VOID  *SourceBuffer,
+  IN UINTN       Length
+  )
+{
+  UINT8        *Dst;
+  CONST UINT8  *Src;
+
+  for (Dst = DestinationBuffer, Src = SourceBuffer; Length > 0; Length--) {
+    *Dst++ = *Src++;
+  }
+  return DestinationBuffer;
+}
+
+VOID * EFIAPI AllocateTemporaryMemory (IN UINTN AllocationSize) { return NULL; }
+VOID * EFIAPI FindConfigDataByTag (UINT32 Tag) { return NULL; }
+VOID * EFIAPI FindConfigDataByPidTag (UINT16 PlatformId, UINT32 Tag) { return NULL; }
+
+//
+// GPIO community model
+//
+STATIC
+UINT32 *
+ModelReg (
+  IN UINTN  Address
+  )
+{
+  if (((Address >> 16) != MODEL_PID) || ((Address & 0xFFFF) >= MODEL_PCR_SIZE)) {
+    printf ("ASSERT bad PCR address 0x%x\n", (UINT32)Address);
+    abort ();
+  }
+  return &mPcr[(Address & 0xFFFF) / sizeof (UINT32)];
+}
+
+STATIC
+UINT32
+ModelLockBit (
+  IN UINTN    Offset,
+  IN BOOLEAN  Tx
+  )
+{
+  UINT32  GroupIndex;
+  UINT32  PadNumber;
+
+  for (GroupIndex = 0; GroupIndex < MODEL_GROUP_COUNT; GroupIndex++) {
+    if ((Offset >= mModelGroupInfo[GroupIndex].PadCfgOffset) &&
+        (Offset < mModelGroupInfo[GroupIndex].PadCfgOffset + MODEL_PADS_PER_GROUP * MODEL_PADCFG_SIZE)) {
+      PadNumber = (UINT32)(Offset - mModelGroupInfo[GroupIndex].PadCfgOffset) / MODEL_PADCFG_SIZE;
+      Offset    = Tx ? mModelGroupInfo[GroupIndex].PadCfgLockTxOffset : mModelGroupInfo[GroupIndex].PadCfgLockOffset;
+      return (mPcr[Offset / sizeof (UINT32)] >> PadNumber) & 1;
+    }
+  }
+  return MAX_UINT32;
+}
+
+UINT32
+EFIAPI
+MmioRead32 (
+  IN UINTN  Address
+  )
+{
+  return *ModelReg (Address);
+}
+
+UINT32
+EFIAPI
+MmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  UINT32  *Reg;
+  UINTN   Offset;
+  UINT32  CfgLock;
+  UINT32  KeepMask;
+
+  Reg     = ModelReg (Address);
+  Offset  = Address & 0xFFFF;
+  CfgLock = ModelLockBit (Offset, FALSE);
+  if (CfgLock == MAX_UINT32) {
+    *Reg = Value;
+    return Value;
+  }
+
+  //
+  // PADCFG register: GPIOTXSTATE (DW0 bit 0) is covered by PADCFGLOCKTX,
+  // everything else by PADCFGLOCK.
+  //
+  mPadCfgWrites++;
+  KeepMask = 0;
+  if (CfgLock != 0) {
+    KeepMask = ((Offset % MODEL_PADCFG_SIZE) == 0) ? ~BIT0 : MAX_UINT32;
+  }
+  if (((Offset % MODEL_PADCFG_SIZE) == 0) && (ModelLockBit (Offset, TRUE) != 0)) {
+    KeepMask |= BIT0;
+  }
+  if (((*Reg ^ Value) & KeepMask) != 0) {
+    mDroppedWrites++;
+  }
+  *Reg = (*Reg & KeepMask) | (Value & ~KeepMask);
+  return Value;
+}
+
+UINT32
+EFIAPI
+MmioAndThenOr32 (
+  IN UINTN   Address,
+  IN UINT32  AndData,
+  IN UINT32  OrData
+  )
+{
+  return MmioWrite32 (Address, (MmioRead32 (Address) & AndData) | OrData);
+}
+
+EFI_STATUS
+EFIAPI
+PchSbiExecutionEx (
+  IN     PCH_SBI_PID                    Pid,
+  IN     UINT64                         Offset,
+  IN     PCH_SBI_OPCODE                 Opcode,
+  IN     BOOLEAN                        Posted,
+  IN     UINT16                         Fbe,
+  IN     UINT16                         Bar,
+  IN     UINT16                         Fid,
+  IN OUT UINT32                         *Data32,
+  OUT    UINT8                          *Response
+  )
+{
+  mSbiWrites++;
+  *ModelReg (((UINTN)Pid << 16) | (UINTN)Offset) = *Data32;
+  *Response = 0;
+  return EFI_SUCCESS;
+}
+
+//
+// GpioSiLib for the model community
+//
+CONST GPIO_GROUP_INFO *
+EFIAPI
+GpioGetGroupInfoTable (
+  OUT UINT32              *GpioGroupInfoTableLength
+  )
+{
+  *GpioGroupInfoTableLength = MODEL_GROUP_COUNT;
+  return mModelGroupInfo;
+}
+
+UINT32
+EFIAPI
+GetPchPcrAddress (
+  IN     GPIO_PCH_SBI_PID               Pid,
+  IN     UINT32                         Offset
+  )
+{
+  return ((UINT32)Pid << 16) | Offset;
+}
+
+UINT8 EFIAPI GpioGetPcrPadCfgOffset (VOID) { return MODEL_PADCFG_SIZE; }
+UINT8 EFIAPI GpioGetLockOpcode (VOID) { return GpioLibGpioLockUnlock; }
+BOOLEAN EFIAPI GpioIsDswGroup (IN GPIO_GROUP Group) { return FALSE; }
+BOOLEAN EFIAPI GpioIsCorrectPadForThisChipset (IN GPIO_PAD GpioPad) { return TRUE; }
+GPIO_GROUP EFIAPI GpioGetLowestGroup (VOID) { return 0; }
+GPIO_GROUP EFIAPI GpioGetHighestGroup (VOID) { return MODEL_GROUP_COUNT - 1; }
+GPIO_GROUP EFIAPI GpioGetGroupFromGroupIndex (IN UINT32 GroupIndex) { return GroupIndex; }
+UINT32 EFIAPI GpioGetGroupIndexFromGroup (IN GPIO_GROUP Group) { return Group; }
+GPIO_GROUP EFIAPI GpioGetGroupFromGpioPad (IN GPIO_PAD GpioPad) { return GpioPad >> 16; }
+UINT32 EFIAPI GpioGetGroupIndexFromGpioPad (IN GPIO_PAD GpioPad) { return GpioPad >> 16; }
+UINT32 EFIAPI GpioGetPadNumberFromGpioPad (IN GPIO_PAD GpioPad) { return GpioPad & 0xFFFF; }
+
+UINT32
+EFIAPI
+GpioGetPadPerGroup (
+  IN GPIO_GROUP        Group
+  )
+{
+  return (Group < MODEL_GROUP_COUNT) ? MODEL_PADS_PER_GROUP : 0;
+}
+
+VOID EFIAPI GpioGetGpioPadFromCfgDw (IN UINT32 *GpioItem, OUT GPIO_PAD *GpioPad) { *GpioPad = 0; }
+VOID EFIAPI PmcGetGpioGpe (OUT UINT32 *GpeDw0Value, OUT UINT32 *GpeDw1Value, OUT UINT32 *GpeDw2Value) { *GpeDw0Value = 0; *GpeDw1Value = 1; *GpeDw2Value = 2; }
+
+VOID
+EFIAPI
+GpioGetGroupToGpeMapping (
+  OUT GPIO_GROUP_TO_GPE_MAPPING  **GpioGroupToGpeMapping,
+  OUT UINT32                     *GpioGroupToGpeMappingLength
+  )
+{
+  *GpioGroupToGpeMapping       = NULL;
+  *GpioGroupToGpeMappingLength = 0;
+}
+
+UINT32 EFIAPI GpioGetGroupDwUnlockPadConfigMask (IN UINT32 GroupIndex, IN UINT32 DwNum) { return 0; }
+UINT32 EFIAPI GpioGetGroupDwUnlockOutputMask (IN UINT32 GroupIndex, IN UINT32 DwNum) { return 0; }
+EFI_STATUS EFIAPI GpioStoreGroupDwUnlockPadConfigData (IN UINT32 GroupIndex, IN UINT32 DwNum, IN UINT32 UnlockedPads) { return EFI_SUCCESS; }
+EFI_STATUS EFIAPI GpioStoreGroupDwUnlockOutputData (IN UINT32 GroupIndex, IN UINT32 DwNum, IN UINT32 UnlockedPads) { return EFI_SUCCESS; }
+
+EFI_STATUS
+EFIAPI
+GpioUnlockOverride (
+  IN  GPIO_GROUP  Group,
+  IN  UINT32      DwNum,
+  OUT UINT32      *UnlockCfgPad,
+  OUT UINT32      *UnlockTxPad
+  )
+{
+  *UnlockCfgPad = 0;
+  *UnlockTxPad  = 0;
+  return EFI_SUCCESS;
+}
+
+//
+// Test scenarios
+//
+STATIC GPIO_INIT_CONFIG  mTable[2 * MODEL_PADS_PER_GROUP];
+STATIC UINT32            mTableCount;
+STATIC UINT32            mImage[MODEL_PCR_SIZE / sizeof (UINT32)];
+
+STATIC
+VOID
+BuildTable (
+  VOID
+  )
+{
+  UINT32            PadNumber;
+  GPIO_INIT_CONFIG  *Entry;
+
+  ZeroMem (mTable, sizeof (mTable));
+  mTableCount = 0;
+
+  //
+  // Group 0: GPIO outputs, one of them left unlocked for the OS
+  //
+  for (PadNumber = 0; PadNumber < 20; PadNumber++) {
+    Entry = &mTable[mTableCount++];
+    Entry->GpioPad                     = MODEL_PAD (0, PadNumber);
+    Entry->GpioConfig.PadMode          = GpioPadModeGpio;
+    Entry->GpioConfig.HostSoftPadOwn   = GpioHostOwnGpio;
+    Entry->GpioConfig.Direction        = GpioDirOut;
+    Entry->GpioConfig.OutputState      = (PadNumber & 1) ? GpioOutHigh : GpioOutLow;
+    Entry->GpioConfig.InterruptConfig  = GpioIntDis;
+    Entry->GpioConfig.PowerConfig      = GpioPlatformReset;
+    Entry->GpioConfig.ElectricalConfig = GpioTermNone;
+    Entry->GpioConfig.LockConfig       = (PadNumber == 3) ? GpioPadUnlock : GpioPadLock;
+  }
+
+  //
+  // Group 1: inputs and disabled pads
+  //
+  for (PadNumber = 0; PadNumber < 16; PadNumber++) {
+    Entry = &mTable[mTableCount++];
+    Entry->GpioPad                     = MODEL_PAD (1, PadNumber);
+    Entry->GpioConfig.PadMode          = GpioPadModeGpio;
+    Entry->GpioConfig.HostSoftPadOwn   = GpioHostOwnAcpi;
+    Entry->GpioConfig.Direction        = (PadNumber < 12) ? GpioDirIn : GpioDirNone;
+    Entry->GpioConfig.InterruptConfig  = GpioIntDis;
+    Entry->GpioConfig.PowerConfig      = GpioPlatformReset;
+    Entry->GpioConfig.ElectricalConfig = GpioTermNone;
+    Entry->GpioConfig.LockConfig       = GpioPadLock;
+  }
+}
+
+STATIC
+VOID
+ResetCounters (
+  VOID
+  )
+{
+  mPadCfgWrites  = 0;
+  mSbiWrites     = 0;
+  mDroppedWrites = 0;
+}
+
+STATIC
+VOID
+LockAllPads (
+  VOID
+  )
+{
+  UINT32  GroupIndex;
+
+  for (GroupIndex = 0; GroupIndex < MODEL_GROUP_COUNT; GroupIndex++) {
+    mPcr[mModelGroupInfo[GroupIndex].PadCfgLockOffset / sizeof (UINT32)]   = MAX_UINT32;
+    mPcr[mModelGroupInfo[GroupIndex].PadCfgLockTxOffset / sizeof (UINT32)] = MAX_UINT32;
+  }
+}
+
+STATIC
+UINT32
+PadCfgMismatches (
+  VOID
+  )
+{
+  UINT32  GroupIndex;
+  UINT32  Offset;
+  UINT32  Count;
+
+  Count = 0;
+  for (GroupIndex = 0; GroupIndex < MODEL_GROUP_COUNT; GroupIndex++) {
+    for (Offset = mModelGroupInfo[GroupIndex].PadCfgOffset;
+         Offset < mModelGroupInfo[GroupIndex].PadCfgOffset + MODEL_PADS_PER_GROUP * MODEL_PADCFG_SIZE;
+         Offset += sizeof (UINT32)) {
+      if (mPcr[Offset / sizeof (UINT32)] != mImage[Offset / sizeof (UINT32)]) {
+        Count++;
+      }
+    }
+  }
+  return Count;
+}
+
+STATIC
+VOID
+Report (
+  IN CONST CHAR8  *Name
+  )
+{
+  printf ("%s.padcfg_writes=%u\n", Name, mPadCfgWrites);
+  printf ("%s.sbi_writes=%u\n", Name, mSbiWrites);
+  printf ("%s.dropped_writes=%u\n", Name, mDroppedWrites);
+  printf ("%s.mismatches=%u\n", Name, PadCfgMismatches ());
+  printf ("%s.tx_locked_outputs=%u\n", Name,
+    (UINT32)__builtin_popcount (mPcr[mModelGroupInfo[0].PadCfgLockTxOffset / sizeof (UINT32)] & 0xFFFFF));
+  printf ("%s.cfg_locked_unlock_pad=%u\n", Name,
+    (mPcr[mModelGroupInfo[0].PadCfgLockOffset / sizeof (UINT32)] >> 3) & 1);
+}
+
+int
+main (
+  void
+  )
+{
+  EFI_STATUS  Status;
+
+  BuildTable ();
+  printf ("pads=%u\n", mTableCount);
+
+  //
+  // Cold boot: registers and locks at their reset value
+  //
+  ZeroMem (mPcr, sizeof (mPcr));
+  ResetCounters ();
+  Status = GpioConfigurePads (mTableCount, mTable);
+  CopyMem (mImage, mPcr, sizeof (mImage));
+  printf ("cold.status=%u\n", (UINT32)Status);
+  Report ("cold");
+
+  //
+  // Warm boot: PADCFG and locks survive, the table is unchanged
+  //
+  LockAllPads ();
+  ResetCounters ();
+  Status = GpioConfigurePads (mTableCount, mTable);
+  printf ("warm.status=%u\n", (UINT32)Status);
+  Report ("warm");
+
+  //
+  // Warm boot with one output pad changed by a config delta
+  //
+  mTable[4].GpioConfig.OutputState = GpioOutHigh;
+  ZeroMem (mPcr, sizeof (mPcr));
+  Status = GpioConfigurePads (mTableCount, mTable);
+  CopyMem (mImage, mPcr, sizeof (mImage));
+  mTable[4].GpioConfig.OutputState = GpioOutLow;
+  ZeroMem (mPcr, sizeof (mPcr));
+  GpioConfigurePads (mTableCount, mTable);
+  mTable[4].GpioConfig.OutputState = GpioOutHigh;
+  LockAllPads ();
+  ResetCounters ();
+  Status = GpioConfigurePads (mTableCount, mTable);
+  printf ("delta.status=%u\n", (UINT32)Status);
+  Report ("delta");
+
+  return 0;
+}
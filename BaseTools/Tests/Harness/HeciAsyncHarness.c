@@ -0,0 +1,644 @@
+/** @file
+  Host harness for the asynchronous HECI requests.
+
+  Links Silicon/CommonSocPkg/Library/HeciLib/HeciCore.c and HeciLib.c against
+  a model of the HECI1 host and ME circular buffers. The modeled ME answers
+  every complete host message after a fixed latency, splitting responses that
+  do not fit its circular buffer into several packets. Time only advances in
+  MicroSecondDelay (), so a non-blocking read never sees a response early.
+
+  Results are printed as "key=value" lines for HeciAsyncTest.py.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi/UefiBaseType.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/IoLib.h>
+#include <Library/HeciLib.h>
+#include <Library/BootloaderCommonLib.h>
+#include <MkhiMsgs.h>
+#include <IndustryStandard/Pci.h>
+#include "HeciRegs.h"
+
+int printf (const char *Format, ...);
+void abort (void);
+
+#define MODEL_PCI_BASE         0xE00B0000
+#define MODEL_MBAR             0xFED1A000
+#define MODEL_HOST_CB_DEPTH    32
+#define MODEL_ME_CB_DEPTH      32
+#define MODEL_ME_LATENCY       20000
+#define MODEL_TEST_GROUP_ID    0x77
+#define MODEL_OUT_DWORDS       4096
+
+STATIC UINT32  mNow;
+STATIC UINT32  mHostCsr;
+STATIC UINT32  mHostCb[MODEL_HOST_CB_DEPTH];
+STATIC UINT8   mHostRd;
+STATIC UINT8   mHostWr;
+STATIC UINT32  mMeCb[MODEL_ME_CB_DEPTH];
+STATIC UINT8   mMeRd;
+STATIC UINT8   mMeWr;
+STATIC UINT32  mResets;
+STATIC UINT32  mHostDwords;
+STATIC UINT32  mMeDwords;
+
+//
+// Host message being assembled by the modeled ME
+//
+STATIC UINT32  mInMsg[128];
+STATIC UINT32  mInLength;
+
+//
+// Response packets queued by the modeled ME. Each packet starts with a HECI
+// header and becomes visible once mNow reaches its due time.
+//
+STATIC UINT32  mOut[MODEL_OUT_DWORDS];
+STATIC UINT32  mOutDue[MODEL_OUT_DWORDS];
+STATIC UINT32  mOutHead;
+STATIC UINT32  mOutTail;
+STATIC UINT32  mMessagesAnswered;
+
+//
+// DebugLib, BaseLib, BaseMemoryLib, TimerLib and allocation stubs
+//
+VOID EFIAPI DebugPrint (IN UINTN ErrorLevel, IN CONST CHAR8 *Format, ...) { }
+BOOLEAN EFIAPI DebugAssertEnabled (VOID) { return TRUE; }
+BOOLEAN EFIAPI DebugPrintEnabled (VOID) { return FALSE; }
+BOOLEAN EFIAPI DebugPrintLevelEnabled (IN CONST UINTN ErrorLevel) { return FALSE; }
+BOOLEAN EFIAPI DebugCodeEnabled (VOID) { return TRUE; }
+
+VOID
+EFIAPI
+DebugAssert (
+  IN CONST CHAR8  *FileName,
+  IN UINTN        LineNumber,
+  IN CONST CHAR8  *Description
+  )
+{
+  printf ("ASSERT %s(%d): %s\n", FileName, (int)LineNumber, Description);
+  abort ();
+}
+
+UINT64 EFIAPI LShiftU64 (IN UINT64 Operand, IN UINTN Count) { return Operand << Count; }
+
+VOID *
+EFIAPI
+ZeroMem (
+  OUT VOID  *Buffer,
+  IN UINTN  Length
+  )
+{
+  UINT8  *Ptr;
+
+  for (Ptr = Buffer; Length > 0; Length--) {
+    *Ptr++ = 0;
+  }
+  return Buffer;
+}
+
+VOID *
+EFIAPI
+CopyMem (
+  OUT VOID       *DestinationBuffer,
+  IN CONST VOID  *SourceBuffer,
+  IN UINTN       Length
+  )
+{
+  UINT8        *Dst;
+  CONST UINT8  *Src;
+
+  for (Dst = DestinationBuffer, Src = SourceBuffer; Length > 0; Length--) {
+    *Dst++ = *Src++;
+  }
+  return DestinationBuffer;
+}
+
+VOID *
+EFIAPI
+AllocatePool (
+  IN UINTN  AllocationSize
+  )
+{
+  STATIC UINT64  Heap[0x2000];
+  STATIC UINTN   Used;
+  VOID           *Buffer;
+
+  AllocationSize = ALIGN_VALUE (AllocationSize, sizeof (UINT64));
+  if (Used + AllocationSize > sizeof (Heap)) {
+    return NULL;
+  }
+  Buffer = (UINT8 *)Heap + Used;
+  Used  += AllocationSize;
+  return Buffer;
+}
+
+EFI_STATUS EFIAPI RegisterService (IN VOID *ServicePtr) { return EFI_SUCCESS; }
+CONST HECI_SERVICE * EFIAPI MeGetHeciServiceInstance (VOID) { return NULL; }
+BOOLEAN EFIAPI MeHeciTimeoutsEnabled (VOID) { return TRUE; }
+HECI_DEVICE EFIAPI MeGetIshHeciDevice (VOID) { return ISH_HECI; }
+
+UINTN
+EFIAPI
+MeGetHeciMmPciAddress (
+  IN HECI_DEVICE                  HeciDev,
+  IN UINTN                        Register
+  )
+{
+  return MODEL_PCI_BASE + ((UINTN)HeciDev << 12) + Register;
+}
+
+//
+// Modeled ME
+//
+STATIC
+UINT32
+MeFreeSlots (
+  VOID
+  )
+{
+  return MODEL_ME_CB_DEPTH - (UINT8)(mMeWr - mMeRd);
+}
+
+/**
+  Move due response packets into the ME circular buffer.
+**/
+STATIC
+VOID
+MePump (
+  VOID
+  )
+{
+  HECI_MESSAGE_HEADER  Header;
+  UINT32               Dwords;
+
+  while (mOutHead != mOutTail) {
+    Header.Data = mOut[mOutHead];
+    Dwords      = 1 + (Header.Fields.Length + 3) / 4;
+    if ((mOutDue[mOutHead] > mNow) || (MeFreeSlots () < Dwords)) {
+      return;
+    }
+    while (Dwords-- > 0) {
+      mMeCb[mMeWr % MODEL_ME_CB_DEPTH] = mOut[mOutHead++];
+      mMeWr++;
+      mMeDwords++;
+    }
+  }
+}
+
+STATIC
+VOID
+MeQueueResponse (
+  IN UINT32  *Message,
+  IN UINT32  Length
+  )
+{
+  HECI_MESSAGE_HEADER  Header;
+  UINT32               Sent;
+  UINT32               Chunk;
+  UINT32               Index;
+
+  Sent = 0;
+  while (Sent < Length) {
+    Chunk              = MIN (Length - Sent, (MODEL_ME_CB_DEPTH - 1) * sizeof (UINT32));
+    Header.Data        = 0;
+    Header.Fields.MeAddress       = HECI_MKHI_MESSAGE_ADDR;
+    Header.Fields.HostAddress     = BIOS_FIXED_HOST_ADDR;
+    Header.Fields.Length          = Chunk;
+    Header.Fields.MessageComplete = (Sent + Chunk == Length);
+    mOutDue[mOutTail] = mNow + MODEL_ME_LATENCY;
+    mOut[mOutTail++]  = Header.Data;
+    for (Index = 0; Index < (Chunk + 3) / 4; Index++) {
+      mOutDue[mOutTail] = mNow + MODEL_ME_LATENCY;
+      mOut[mOutTail++]  = Message[(Sent / 4) + Index];
+    }
+    Sent += Chunk;
+  }
+  if (mOutTail > MODEL_OUT_DWORDS - 256) {
+    printf ("ASSERT model response queue overflow\n");
+    abort ();
+  }
+}
+
+/**
+  Answer one complete host message.
+
+  Test group messages are echoed back with their tag. The CSME boot time data
+  query gets a 64 entry response whose entries encode the query count.
+**/
+STATIC
+VOID
+MeAnswer (
+  VOID
+  )
+{
+  STATIC UINT32                    Response[128];
+  MKHI_MESSAGE_HEADER              Mkhi;
+  GET_EARLY_BOOT_PERF_DATA_BUFFER  *Perf;
+  UINT32                           Index;
+
+  Mkhi.Data = mInMsg[0];
+  ZeroMem (Response, sizeof (Response));
+  mMessagesAnswered++;
+
+  if ((Mkhi.Fields.GroupId == BUP_COMMON_GROUP_ID) && (Mkhi.Fields.Command == GET_EARLY_BOOT_PERFORMANCE_DATA_CMD)) {
+    Perf = (GET_EARLY_BOOT_PERF_DATA_BUFFER *)Response;
+    Perf->Response.Header.Data              = Mkhi.Data;
+    Perf->Response.Header.Fields.IsResponse = 1;
+    Perf->Response.BootDataVersion          = EARLY_BOOT_PERF_DATA_CMD_VERSION;
+    Perf->Response.BootDataLength           = EARLY_BOOT_PERF_DATA_LENGTH_VERSION_1;
+    for (Index = 0; Index < EARLY_BOOT_PERF_DATA_LENGTH_VERSION_1; Index++) {
+      Perf->Response.BootPerformanceData[Index] = (mMessagesAnswered << 16) | Index;
+    }
+    MeQueueResponse (Response, sizeof (GET_EARLY_BOOT_PERF_DATA_RESPONSE) + EARLY_BOOT_PERF_DATA_LENGTH_VERSION_1 * sizeof (UINT32));
+  } else {
+    Mkhi.Fields.IsResponse = 1;
+    Response[0] = Mkhi.Data;
+    Response[1] = mInMsg[1];
+    Response[2] = ~mInMsg[1];
+    MeQueueResponse (Response, 3 * sizeof (UINT32));
+  }
+}
+
+/**
+  Consume the packets the host put in its circular buffer.
+**/
+STATIC
+VOID
+MeConsumeHostBuffer (
+  VOID
+  )
+{
+  HECI_MESSAGE_HEADER  Header;
+  UINT32               Dwords;
+
+  while (mHostRd != mHostWr) {
+    Header.Data = mHostCb[mHostRd++ % MODEL_HOST_CB_DEPTH];
+    Dwords      = (Header.Fields.Length + 3) / 4;
+    while (Dwords-- > 0) {
+      mInMsg[mInLength++] = mHostCb[mHostRd++ % MODEL_HOST_CB_DEPTH];
+    }
+    if (Header.Fields.MessageComplete) {
+      MeAnswer ();
+      mInLength = 0;
+    }
+  }
+}
+
+STATIC
+VOID
+ModelReset (
+  VOID
+  )
+{
+  HECI_CONTROL_STATUS_REGISTER  Csr;
+
+  mHostRd   = 0;
+  mHostWr   = 0;
+  mMeRd     = 0;
+  mMeWr     = 0;
+  mOutHead  = 0;
+  mOutTail  = 0;
+  mInLength = 0;
+  Csr.Data  = 0;
+  Csr.Fields.Ready = 1;
+  mHostCsr  = Csr.Data;
+}
+
+UINTN
+EFIAPI
+MicroSecondDelay (
+  IN UINTN  MicroSeconds
+  )
+{
+  mNow += (UINT32)MicroSeconds;
+  MePump ();
+  return MicroSeconds;
+}
+
+UINT8
+EFIAPI
+MmioAnd8 (
+  IN UINTN  Address,
+  IN UINT8  AndData
+  )
+{
+  return AndData;
+}
+
+UINT16
+EFIAPI
+MmioRead16 (
+  IN UINTN  Address
+  )
+{
+  if (Address == MeGetHeciMmPciAddress (HECI1_DEVICE, PCI_DEVICE_ID_OFFSET)) {
+    return 0x51E0;
+  }
+  return 0xFFFF;
+}
+
+UINT32
+EFIAPI
+MmioRead32 (
+  IN UINTN  Address
+  )
+{
+  HECI_CONTROL_STATUS_REGISTER  Csr;
+  HECI_FWS_REGISTER             Fws;
+  UINT32                        Value;
+
+  if (Address == MeGetHeciMmPciAddress (HECI1_DEVICE, PCI_BASE_ADDRESSREG_OFFSET)) {
+    return MODEL_MBAR;
+  } else if (Address == MeGetHeciMmPciAddress (HECI1_DEVICE, R_ME_HFS)) {
+    Fws.ul = 0;
+    Fws.r.CurrentState   = 5;
+    Fws.r.FwInitComplete = 1;
+    return Fws.ul;
+  } else if (Address == MODEL_MBAR + H_CSR) {
+    Csr.Data = mHostCsr;
+    Csr.Fields.CBReadPointer  = mHostRd;
+    Csr.Fields.CBWritePointer = mHostWr;
+    Csr.Fields.CBDepth        = MODEL_HOST_CB_DEPTH;
+    return Csr.Data;
+  } else if (Address == MODEL_MBAR + ME_CSR_HA) {
+    Csr.Data = 0;
+    Csr.Fields.Ready          = 1;
+    Csr.Fields.CBReadPointer  = mMeRd;
+    Csr.Fields.CBWritePointer = mMeWr;
+    Csr.Fields.CBDepth        = MODEL_ME_CB_DEPTH;
+    return Csr.Data;
+  } else if (Address == MODEL_MBAR + ME_CB_RW) {
+    if (mMeRd == mMeWr) {
+      printf ("ASSERT read from empty ME circular buffer\n");
+      abort ();
+    }
+    Value = mMeCb[mMeRd++ % MODEL_ME_CB_DEPTH];
+    MePump ();
+    return Value;
+  }
+
+  printf ("ASSERT unexpected MMIO read 0x%lx\n", (unsigned long)Address);
+  abort ();
+  return 0;
+}
+
+UINT32
+EFIAPI
+MmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  HECI_CONTROL_STATUS_REGISTER  Csr;
+
+  if (Address == MODEL_MBAR + H_CB_WW) {
+    if ((UINT8)(mHostWr - mHostRd) >= MODEL_HOST_CB_DEPTH) {
+      printf ("ASSERT host circular buffer overflow\n");
+      abort ();
+    }
+    mHostCb[mHostWr++ % MODEL_HOST_CB_DEPTH] = Value;
+    mHostDwords++;
+  } else if (Address == MODEL_MBAR + H_CSR) {
+    Csr.Data = Value;
+    if (Csr.Fields.Reset) {
+      mResets++;
+      ModelReset ();
+      return Value;
+    }
+    if (Csr.Fields.IntGenerate) {
+      MeConsumeHostBuffer ();
+      Csr.Fields.IntGenerate = 0;
+    }
+    Csr.Fields.IntStatus = 0;
+    mHostCsr = Csr.Data & (BIT0 | BIT3);
+  } else {
+    printf ("ASSERT unexpected MMIO write 0x%lx\n", (unsigned long)Address);
+    abort ();
+  }
+  return Value;
+}
+
+//
+// Test scenarios
+//
+typedef struct {
+  MKHI_MESSAGE_HEADER  Header;
+  UINT32               Tag;
+  UINT32               InvTag;
+} TEST_MESSAGE;
+
+STATIC
+VOID
+BuildTestMessage (
+  OUT TEST_MESSAGE  *Message,
+  IN  UINT32        Tag
+  )
+{
+  ZeroMem (Message, sizeof (*Message));
+  Message->Header.Fields.GroupId = MODEL_TEST_GROUP_ID;
+  Message->Header.Fields.Command = 1;
+  Message->Tag                   = Tag;
+}
+
+STATIC
+BOOLEAN
+IsTestResponse (
+  IN TEST_MESSAGE  *Message,
+  IN UINT32        Tag
+  )
+{
+  return (Message->Header.Fields.GroupId == MODEL_TEST_GROUP_ID) &&
+         (Message->Header.Fields.IsResponse == 1) &&
+         (Message->Tag == Tag) && (Message->InvTag == ~Tag);
+}
+
+/**
+  Stage2 flow of the CSME boot time data query on Alderlake: post at
+  PrePayloadLoading, poll at PostPayloadLoading, complete at EndOfStages, then
+  a synchronous message stands in for the FSP End-of-Post.
+**/
+STATIC
+VOID
+TestBootFlow (
+  VOID
+  )
+{
+  EFI_STATUS    Status;
+  UINT32        *Data;
+  UINT32        Length;
+  UINT32        Version;
+  UINT32        Index;
+  UINT32        Bad;
+  TEST_MESSAGE  Eop;
+  UINT32        RecLength;
+
+  Status = HeciPostEarlyBootPerfDataRequest ();
+  printf ("flow.post=%u\n", (UINT32)Status);
+
+  //
+  // Payload loading takes less than the ME latency here
+  //
+  mNow += MODEL_ME_LATENCY / 2;
+  Status = HeciPollAsync ();
+  printf ("flow.poll_early=%s\n", (Status == EFI_NOT_READY) ? "not_ready" : "other");
+
+  //
+  // EndOfStages
+  //
+  Status = HeciGetEarlyBootPerfData (&Data, &Length, &Version);
+  printf ("flow.get=%u\n", (UINT32)Status);
+  Bad = 0;
+  if (Status == EFI_SUCCESS) {
+    for (Index = 0; Index < Length; Index++) {
+      if (Data[Index] != ((1 << 16) | Index)) {
+        Bad++;
+      }
+    }
+    printf ("flow.length=%u\n", Length);
+    printf ("flow.version=%u\n", Version);
+  }
+  printf ("flow.bad_entries=%u\n", Bad);
+  printf ("flow.poll_after=%u\n", (UINT32)HeciPollAsync ());
+  printf ("flow.me_cb_filled=%u\n", (UINT8)(mMeWr - mMeRd));
+  printf ("flow.me_queued=%u\n", mOutTail - mOutHead);
+
+  BuildTestMessage (&Eop, 0xE0F);
+  RecLength = sizeof (Eop);
+  Status = HeciSendwAck (HECI1_DEVICE, (UINT32 *)&Eop, sizeof (Eop), &RecLength, BIOS_FIXED_HOST_ADDR, HECI_MKHI_MESSAGE_ADDR);
+  printf ("flow.eop=%u\n", (UINT32)Status);
+  printf ("flow.eop_matched=%u\n", IsTestResponse (&Eop, 0xE0F));
+}
+
+/**
+  A synchronous message sent while an asynchronous one is pending gets its own
+  response.
+**/
+STATIC
+VOID
+TestInterleave (
+  VOID
+  )
+{
+  TEST_MESSAGE  Async;
+  TEST_MESSAGE  AsyncResp;
+  TEST_MESSAGE  Sync;
+  UINT32        RequestId;
+  UINT32        RecLength;
+  EFI_STATUS    Status;
+
+  BuildTestMessage (&Async, 0xA1);
+  ZeroMem (&AsyncResp, sizeof (AsyncResp));
+  Status = HeciSendAsync (HECI1_DEVICE, (UINT32 *)&Async, sizeof (Async), BIOS_FIXED_HOST_ADDR,
+             HECI_MKHI_MESSAGE_ADDR, (UINT32 *)&AsyncResp, sizeof (AsyncResp), &RequestId);
+  printf ("interleave.post=%u\n", (UINT32)Status);
+
+  BuildTestMessage (&Sync, 0xB2);
+  RecLength = sizeof (Sync);
+  Status = HeciSendwAck (HECI1_DEVICE, (UINT32 *)&Sync, sizeof (Sync), &RecLength, BIOS_FIXED_HOST_ADDR, HECI_MKHI_MESSAGE_ADDR);
+  printf ("interleave.sync=%u\n", (UINT32)Status);
+  printf ("interleave.sync_matched=%u\n", IsTestResponse (&Sync, 0xB2));
+
+  Status = HeciWaitAsync (RequestId, &RecLength);
+  printf ("interleave.wait=%u\n", (UINT32)Status);
+  printf ("interleave.async_matched=%u\n", IsTestResponse (&AsyncResp, 0xA1));
+  printf ("interleave.async_length=%u\n", RecLength);
+}
+
+/**
+  Keep the request queue full for many rounds so that both circular buffer
+  pointers wrap several times, and wait for the requests out of order.
+**/
+STATIC
+VOID
+TestWrap (
+  VOID
+  )
+{
+  TEST_MESSAGE  Requests[HECI_ASYNC_QUEUE_DEPTH];
+  TEST_MESSAGE  Responses[HECI_ASYNC_QUEUE_DEPTH];
+  UINT32        RequestIds[HECI_ASYNC_QUEUE_DEPTH];
+  UINT32        Tags[HECI_ASYNC_QUEUE_DEPTH];
+  TEST_MESSAGE  Extra;
+  TEST_MESSAGE  ExtraResp;
+  UINT32        ExtraId;
+  UINT32        Round;
+  UINT32        Index;
+  UINT32        Slot;
+  UINT32        Tag;
+  UINT32        Mismatches;
+  UINT32        Errors;
+  UINT32        QueueFull;
+  EFI_STATUS    Status;
+
+  Mismatches = 0;
+  Errors     = 0;
+  QueueFull  = 0;
+  Tag        = 0x1000;
+
+  for (Round = 0; Round < 64; Round++) {
+    for (Index = 0; Index < HECI_ASYNC_QUEUE_DEPTH; Index++) {
+      Tags[Index] = Tag++;
+      BuildTestMessage (&Requests[Index], Tags[Index]);
+      ZeroMem (&Responses[Index], sizeof (Responses[Index]));
+      Status = HeciSendAsync (HECI1_DEVICE, (UINT32 *)&Requests[Index], sizeof (Requests[Index]), BIOS_FIXED_HOST_ADDR,
+                 HECI_MKHI_MESSAGE_ADDR, (UINT32 *)&Responses[Index], sizeof (Responses[Index]), &RequestIds[Index]);
+      if (EFI_ERROR (Status)) {
+        Errors++;
+      }
+    }
+
+    BuildTestMessage (&Extra, 0);
+    Status = HeciSendAsync (HECI1_DEVICE, (UINT32 *)&Extra, sizeof (Extra), BIOS_FIXED_HOST_ADDR,
+               HECI_MKHI_MESSAGE_ADDR, (UINT32 *)&ExtraResp, sizeof (ExtraResp), &ExtraId);
+    if (Status == EFI_OUT_OF_RESOURCES) {
+      QueueFull++;
+    }
+
+    if ((Round & 1) != 0) {
+      mNow += MODEL_ME_LATENCY;
+      HeciPollAsync ();
+    }
+
+    for (Index = 0; Index < HECI_ASYNC_QUEUE_DEPTH; Index++) {
+      //
+      // Newest first on even rounds, oldest first on odd rounds
+      //
+      Slot = ((Round & 1) == 0) ? (HECI_ASYNC_QUEUE_DEPTH - 1 - Index) : Index;
+      if (EFI_ERROR (HeciWaitAsync (RequestIds[Slot], NULL))) {
+        Errors++;
+      }
+      if (!IsTestResponse (&Responses[Slot], Tags[Slot])) {
+        Mismatches++;
+      }
+    }
+  }
+
+  printf ("wrap.requests=%u\n", Tag - 0x1000);
+  printf ("wrap.mismatches=%u\n", Mismatches);
+  printf ("wrap.errors=%u\n", Errors);
+  printf ("wrap.queue_full=%u\n", QueueFull);
+  printf ("wrap.poll_after=%u\n", (UINT32)HeciPollAsync ());
+}
+
+int
+main (
+  void
+  )
+{
+  ModelReset ();
+
+  TestBootFlow ();
+  TestInterleave ();
+  TestWrap ();
+
+  printf ("model.resets=%u\n", mResets);
+  printf ("model.answered=%u\n", mMessagesAnswered);
+  printf ("model.host_dwords=%u\n", mHostDwords);
+  printf ("model.me_dwords=%u\n", mMeDwords);
+  return 0;
+}
@@ -0,0 +1,606 @@
+/** @file
+  Host harness for the lite variable store on a file-backed flash model.
+
+  Links BootloaderCommonPkg/Library/LiteVariableLib/LiteVariableLib.c against
+  a NOR flash model: erase sets 4KB blocks to 0xFF, and writes can only clear
+  bits. The flash content and the erase count of every block are loaded from
+  and saved to an image file, so that each run of the harness is one boot of
+  a platform and LiteVariableTest.py drives many boots over the same flash.
+
+  Every boot checks the variables written by the previous boot, writes a new
+  generation of them and runs the deferred store maintenance at the end, like
+  OsLoader does before the OS handoff. With "cut=N" the boot loses power in
+  the middle of its Nth flash operation: half of the bytes or blocks of that
+  operation reach the flash, the image is saved and the harness exits.
+
+  Usage: LiteVariableHarness <image> <boot> [cut=N] [force]
+
+  Results are printed as "key=value" lines for LiteVariableTest.py.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BootloaderCommonLib.h>
+#include <Library/VariableLib.h>
+#include <Service/SpiFlashService.h>
+
+typedef struct _IO_FILE  FILE;
+
+int printf (const char *Format, ...);
+void abort (void);
+void exit (int Status);
+FILE *fopen (const char *Path, const char *Mode);
+unsigned long fread (void *Buffer, unsigned long Size, unsigned long Count, FILE *File);
+unsigned long fwrite (const void *Buffer, unsigned long Size, unsigned long Count, FILE *File);
+int fclose (FILE *File);
+int atoi (const char *String);
+
+#define MODEL_STORE_SIZE       SIZE_32KB
+#define MODEL_BLOCK_SIZE       SIZE_4KB
+#define MODEL_BLOCK_COUNT      (MODEL_STORE_SIZE / MODEL_BLOCK_SIZE)
+#define MODEL_REGION_SIZE      SIZE_8MB
+#define MODEL_POOL_SIZE        SIZE_64KB
+#define MODEL_CONFIG_COUNT     8
+
+STATIC UINT8               mFlash[MODEL_STORE_SIZE] __attribute__ ((aligned (MODEL_BLOCK_SIZE)));
+STATIC UINT32              mEraseCount[MODEL_BLOCK_COUNT];
+STATIC UINT8               mPool[MODEL_POOL_SIZE] __attribute__ ((aligned (16)));
+STATIC UINTN               mPoolUsed;
+STATIC VOID               *mLibraryData;
+STATIC VOID               *mService;
+STATIC CONST CHAR8        *mImagePath;
+STATIC UINT32              mFlashOps;
+STATIC UINT32              mCutAt;
+STATIC UINT32              mBadWrites;
+
+//
+// DebugLib, BaseLib, BaseMemoryLib and allocation stubs
+//
+VOID
+EFIAPI
+DebugPrint (
+  IN  UINTN        ErrorLevel,
+  IN  CONST CHAR8  *Format,
+  ...
+  )
+{
+}
+
+VOID
+EFIAPI
+DebugAssert (
+  IN CONST CHAR8  *FileName,
+  IN UINTN        LineNumber,
+  IN CONST CHAR8  *Description
+  )
+{
+  printf ("ASSERT %s(%d): %s\n", FileName, (int)LineNumber, Description);
+  abort ();
+}
+
+BOOLEAN EFIAPI DebugAssertEnabled (VOID) { return TRUE; }
+BOOLEAN EFIAPI DebugPrintEnabled (VOID) { return FALSE; }
+BOOLEAN EFIAPI DebugPrintLevelEnabled (IN CONST UINTN ErrorLevel) { return FALSE; }
+VOID EFIAPI AsmFlushCacheRange (IN VOID *Address, IN UINTN Length) { }
+
+UINT64
+EFIAPI
+AsmReadTsc (
+  VOID
+  )
+{
+  return __builtin_ia32_rdtsc ();
+}
+
+VOID *
+EFIAPI
+SetMem (
+  OUT VOID  *Buffer,
+  IN UINTN  Length,
+  IN UINT8  Value
+  )
+{
+  UINT8  *Ptr;
+
+  for (Ptr = Buffer; Length > 0; Length--) {
+    *Ptr++ = Value;
+  }
+  return Buffer;
+}
+
+VOID *
+EFIAPI
+ZeroMem (
+  OUT VOID  *Buffer,
+  IN UINTN  Length
+  )
+{
+  return SetMem (Buffer, Length, 0);
+}
+
+VOID *
+EFIAPI
+CopyMem (
+  OUT VOID       *DestinationBuffer,
+  IN CONST VOID  *SourceBuffer,
+  IN UINTN       Length
+  )
+{
+  UINT8        *Dst;
+  CONST UINT8  *Src;
+
+  for (Dst = DestinationBuffer, Src = SourceBuffer; Length > 0; Length--) {
+    *Dst++ = *Src++;
+  }
+  return DestinationBuffer;
+}
+
+INTN
+EFIAPI
+CompareMem (
+  IN CONST VOID  *DestinationBuffer,
+  IN CONST VOID  *SourceBuffer,
+  IN UINTN       Length
+  )
+{
+  CONST UINT8  *Dst;
+  CONST UINT8  *Src;
+
+  for (Dst = DestinationBuffer, Src = SourceBuffer; Length > 0; Length--, Dst++, Src++) {
+    if (*Dst != *Src) {
+      return (INTN)*Dst - (INTN)*Src;
+    }
+  }
+  return 0;
+}
+
+UINTN
+EFIAPI
+AsciiStrLen (
+  IN CONST CHAR8  *String
+  )
+{
+  UINTN  Length;
+
+  for (Length = 0; String[Length] != 0; Length++) {
+  }
+  return Length;
+}
+
+INTN
+EFIAPI
+AsciiStrCmp (
+  IN CONST CHAR8  *FirstString,
+  IN CONST CHAR8  *SecondString
+  )
+{
+  while ((*FirstString != 0) && (*FirstString == *SecondString)) {
+    FirstString++;
+    SecondString++;
+  }
+  return (INTN)(UINT8)*FirstString - (INTN)(UINT8)*SecondString;
+}
+
+//
+// The variable instance and the name index keep 32-bit addresses, so the
+// pool is static data below 4GB. Freed buffers are not reused.
+//
+VOID *
+EFIAPI
+AllocateZeroPool (
+  IN UINTN  AllocationSize
+  )
+{
+  VOID  *Buffer;
+
+  AllocationSize = ALIGN_VALUE (AllocationSize, 16);
+  if (mPoolUsed + AllocationSize > sizeof (mPool)) {
+    return NULL;
+  }
+  Buffer     = &mPool[mPoolUsed];
+  mPoolUsed += AllocationSize;
+  return ZeroMem (Buffer, AllocationSize);
+}
+
+VOID
+EFIAPI
+FreePool (
+  IN VOID  *Buffer
+  )
+{
+}
+
+EFI_STATUS
+EFIAPI
+GetLibraryData (
+  IN      UINT32    LibId,
+  IN OUT  VOID    **BufPtr
+  )
+{
+  if (mLibraryData == NULL) {
+    return EFI_NOT_FOUND;
+  }
+  *BufPtr = mLibraryData;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+SetLibraryData (
+  IN  UINT32    LibId,
+  IN  VOID     *BufPtr,
+  IN  UINT32    BufSize
+  )
+{
+  mLibraryData = BufPtr;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+RegisterService (
+  IN VOID      *Service
+  )
+{
+  mService = Service;
+  return EFI_SUCCESS;
+}
+
+//
+// File-backed flash model
+//
+STATIC
+VOID
+SaveImage (
+  VOID
+  )
+{
+  FILE  *File;
+
+  File = fopen (mImagePath, "wb");
+  if ((File == NULL) ||
+      (fwrite (mFlash, 1, sizeof (mFlash), File) != sizeof (mFlash)) ||
+      (fwrite (mEraseCount, 1, sizeof (mEraseCount), File) != sizeof (mEraseCount))) {
+    printf ("ASSERT cannot save %s\n", mImagePath);
+    abort ();
+  }
+  fclose (File);
+}
+
+STATIC
+BOOLEAN
+LoadImage (
+  VOID
+  )
+{
+  FILE     *File;
+  BOOLEAN   Loaded;
+
+  File = fopen (mImagePath, "rb");
+  if (File == NULL) {
+    return FALSE;
+  }
+  Loaded = (fread (mFlash, 1, sizeof (mFlash), File) == sizeof (mFlash)) &&
+           (fread (mEraseCount, 1, sizeof (mEraseCount), File) == sizeof (mEraseCount));
+  fclose (File);
+  return Loaded;
+}
+
+//
+// Count a flash operation and return the part of Length that reaches the
+// flash before the power is cut
+//
+STATIC
+UINT32
+FlashOperation (
+  IN UINT32    Length,
+  IN UINT32    Granularity
+  )
+{
+  mFlashOps++;
+  if (mFlashOps != mCutAt) {
+    return Length;
+  }
+  return (Length / Granularity / 2) * Granularity;
+}
+
+STATIC
+VOID
+PowerCut (
+  VOID
+  )
+{
+  SaveImage ();
+  printf ("cut=1\n");
+  printf ("flash_ops=%u\n", mFlashOps);
+  exit (0);
+}
+
+STATIC
+UINT8 *
+FlashAddress (
+  IN UINT32    Address,
+  IN UINT32    ByteCount
+  )
+{
+  UINT32  Offset;
+
+  //
+  // The library passes the BIOS region offset of a host address, which is
+  // the host address plus the region size
+  //
+  Offset = (UINT32)(Address - MODEL_REGION_SIZE - (UINT32)(UINTN)mFlash);
+  if ((Offset >= sizeof (mFlash)) || (ByteCount > sizeof (mFlash) - Offset)) {
+    printf ("ASSERT flash access out of the variable region: 0x%x 0x%x\n", Address, ByteCount);
+    abort ();
+  }
+  return &mFlash[Offset];
+}
+
+EFI_STATUS
+EFIAPI
+ModelSpiGetRegion (
+  IN     FLASH_REGION_TYPE  FlashRegionType,
+  OUT    UINT32             *BaseAddress,
+  OUT    UINT32             *RegionSize
+  )
+{
+  *BaseAddress = 0;
+  *RegionSize  = MODEL_REGION_SIZE;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+ModelSpiErase (
+  IN     FLASH_REGION_TYPE  FlashRegionType,
+  IN     UINT32             Address,
+  IN     UINT32             ByteCount
+  )
+{
+  UINT8   *Flash;
+  UINT32   Length;
+  UINT32   Block;
+
+  Flash = FlashAddress (Address, ByteCount);
+  if ((((UINTN)Flash | ByteCount) & (MODEL_BLOCK_SIZE - 1)) != 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Length = FlashOperation (ByteCount, MODEL_BLOCK_SIZE);
+  SetMem (Flash, Length, 0xFF);
+  for (Block = 0; Block < Length / MODEL_BLOCK_SIZE; Block++) {
+    mEraseCount[(Flash - mFlash) / MODEL_BLOCK_SIZE + Block]++;
+  }
+  if (Length != ByteCount) {
+    PowerCut ();
+  }
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+ModelSpiWrite (
+  IN     FLASH_REGION_TYPE  FlashRegionType,
+  IN     UINT32             Address,
+  IN     UINT32             ByteCount,
+  IN     UINT8              *Buffer
+  )
+{
+  UINT8   *Flash;
+  UINT32   Length;
+  UINT32   Index;
+
+  Flash  = FlashAddress (Address, ByteCount);
+  Length = FlashOperation (ByteCount, 1);
+  for (Index = 0; Index < Length; Index++) {
+    //
+    // Programming can only clear bits
+    //
+    if ((Buffer[Index] & ~Flash[Index]) != 0) {
+      mBadWrites++;
+    }
+    Flash[Index] &= Buffer[Index];
+  }
+  if (Length != ByteCount) {
+    PowerCut ();
+  }
+  return EFI_SUCCESS;
+}
+
+STATIC SPI_FLASH_SERVICE  mSpiService = {
+  { SPI_FLASH_SERVICE_SIGNATURE, SPI_FLASH_SERVICE_VERSION, 0 },
+  NULL,
+  NULL,
+  ModelSpiWrite,
+  ModelSpiErase,
+  ModelSpiGetRegion
+};
+
+VOID *
+EFIAPI
+GetServiceBySignature (
+  IN UINT32                 Signature
+  )
+{
+  if (Signature == SPI_FLASH_SERVICE_SIGNATURE) {
+    return &mSpiService;
+  }
+  return NULL;
+}
+
+//
+// Boot workload
+//
+STATIC
+UINTN
+ConfigSize (
+  IN UINT32  Config
+  )
+{
+  return 1 + (Config * 37) % 200;
+}
+
+STATIC
+VOID
+ConfigName (
+  IN  UINT32  Config,
+  OUT CHAR8   *Name
+  )
+{
+  CopyMem (Name, "ConfigN", sizeof ("ConfigN"));
+  Name[6] = (CHAR8)('0' + Config);
+}
+
+//
+// Check that a variable holds the value of boot Boot - 1, or the value of
+// boot Boot if an earlier attempt of this boot lost power
+//
+STATIC
+UINT32
+CheckConfig (
+  IN UINT32  Boot,
+  IN UINT32  Config
+  )
+{
+  CHAR8       Name[8];
+  UINT8       Data[256];
+  UINTN       DataSize;
+  UINTN       Index;
+  UINT32      Generation;
+  EFI_STATUS  Status;
+  BOOLEAN     Match;
+
+  ConfigName (Config, Name);
+  DataSize = sizeof (Data);
+  Status   = GetVariable (Name, NULL, &DataSize, Data);
+  if (Boot == 0) {
+    return (Status == EFI_NOT_FOUND) ? 0 : 1;
+  }
+  if (EFI_ERROR (Status) || (DataSize != ConfigSize (Config))) {
+    return 1;
+  }
+  for (Generation = Boot - 1; Generation <= Boot; Generation++) {
+    Match = TRUE;
+    for (Index = 0; Index < DataSize; Index++) {
+      if (Data[Index] != (UINT8)(Generation + Config + Index)) {
+        Match = FALSE;
+        break;
+      }
+    }
+    if (Match) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+STATIC
+EFI_STATUS
+SetConfig (
+  IN UINT32  Boot,
+  IN UINT32  Config
+  )
+{
+  CHAR8   Name[8];
+  UINT8   Data[256];
+  UINTN   Index;
+
+  ConfigName (Config, Name);
+  for (Index = 0; Index < ConfigSize (Config); Index++) {
+    Data[Index] = (UINT8)(Boot + Config + Index);
+  }
+  return SetVariable (Name, 0, ConfigSize (Config), Data);
+}
+
+int
+main (
+  int    Argc,
+  char  *Argv[]
+  )
+{
+  VARIABLE_STORE_STATS  Stats;
+  EFI_STATUS            Status;
+  UINT32                Boot;
+  UINT32                Config;
+  UINT32                Mismatches;
+  UINT32                Errors;
+  UINT32                Block;
+  BOOLEAN               Force;
+  int                   Arg;
+
+  if (Argc < 3) {
+    printf ("usage: %s <image> <boot> [cut=N] [force]\n", Argv[0]);
+    return 2;
+  }
+  mImagePath = Argv[1];
+  Boot       = (UINT32)atoi (Argv[2]);
+  Force      = FALSE;
+  for (Arg = 3; Arg < Argc; Arg++) {
+    if (CompareMem (Argv[Arg], "cut=", 4) == 0) {
+      mCutAt = (UINT32)atoi (Argv[Arg] + 4);
+    } else if (AsciiStrCmp (Argv[Arg], "force") == 0) {
+      Force = TRUE;
+    }
+  }
+
+  if (!LoadImage ()) {
+    SetMem (mFlash, sizeof (mFlash), 0xFF);
+    ZeroMem (mEraseCount, sizeof (mEraseCount));
+  }
+
+  Status = VariableConstructor ((UINT32)(UINTN)mFlash, sizeof (mFlash));
+  printf ("init=%u\n", (UINT32)Status);
+  if (EFI_ERROR (Status)) {
+    SaveImage ();
+    return 0;
+  }
+
+  Mismatches = 0;
+  Errors     = 0;
+  for (Config = 0; Config < MODEL_CONFIG_COUNT; Config++) {
+    Mismatches += CheckConfig (Boot, Config);
+  }
+
+  //
+  // One generation of configuration variables and a temporary variable
+  // created and deleted again
+  //
+  for (Config = 0; Config < MODEL_CONFIG_COUNT; Config++) {
+    Errors += EFI_ERROR (SetConfig (Boot, Config)) ? 1 : 0;
+  }
+  Errors += EFI_ERROR (SetVariable ("Temporary", 0, sizeof (Boot), &Boot)) ? 1 : 0;
+  Errors += EFI_ERROR (SetVariable ("Temporary", 0, 0, NULL)) ? 1 : 0;
+  for (Config = 0; Config < MODEL_CONFIG_COUNT; Config++) {
+    Mismatches += CheckConfig (Boot + 1, Config);
+  }
+
+  Status  = CompactVariableStore (Force);
+  Errors += EFI_ERROR (Status) ? 1 : 0;
+  for (Config = 0; Config < MODEL_CONFIG_COUNT; Config++) {
+    Mismatches += CheckConfig (Boot + 1, Config);
+  }
+
+  GetVariableStoreStats (&Stats);
+  SaveImage ();
+
+  printf ("cut=0\n");
+  printf ("flash_ops=%u\n", mFlashOps);
+  printf ("mismatches=%u\n", Mismatches);
+  printf ("errors=%u\n", Errors);
+  printf ("bad_writes=%u\n", mBadWrites);
+  printf ("reclaims=%u\n", Stats.ReclaimCount);
+  printf ("inline_erases=%u\n", Stats.InlineEraseCount);
+  printf ("deferred_erases=%u\n", Stats.DeferredEraseCount);
+  printf ("banks=%u\n", MODEL_VARIABLE_STORE_BANKS);
+  for (Block = 0; Block < MODEL_BLOCK_COUNT; Block++) {
+    printf ("block%u.erases=%u\n", Block, mEraseCount[Block]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,25 @@
+/** @file
+  PCDs of BootloaderCommonPkg/Library/LiteVariableLib for the host harness.
+
+  Force-included into every source of LiteVariableHarness in place of the
+  AutoGen.h a firmware build would generate. MODEL_VARIABLE_STORE_BANKS
+  selects the number of variable store banks.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __LITE_VARIABLE_PCD_H__
+#define __LITE_VARIABLE_PCD_H__
+
+#include <Library/PcdLib.h>
+
+#ifndef MODEL_VARIABLE_STORE_BANKS
+#define MODEL_VARIABLE_STORE_BANKS              2
+#endif
+
+#define _PCD_VALUE_PcdVariableStoreBanks        MODEL_VARIABLE_STORE_BANKS
+#define _PCD_GET_MODE_8_PcdVariableLibId        1
+
+#endif
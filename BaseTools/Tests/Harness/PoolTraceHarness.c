@@ -0,0 +1,424 @@
+/** @file
+  Host harness replaying an allocation trace through the payload allocator.
+
+  Links BootloaderCommonPkg/Library/FullMemoryAllocationLib against a heap in
+  host memory and replays a generated trace of pool and page allocations in
+  the shape the payload produces. Every buffer is filled with a pattern that
+  is checked when it is freed, so overlapping allocations are caught.
+
+  CoreAllocatePoolPages () and CoreFreePoolPages () are wrapped at link time
+  to count how often the pool code converts pages in the memory map, which
+  is the slow path of a pool allocation. Time stamp ticks are reported for
+  information only.
+
+  Results are printed as "key=value" lines for PoolTraceTest.py.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/BlMemoryAllocationLib.h>
+
+int printf (const char *Format, ...);
+void abort (void);
+
+#define MODEL_HEAP_PAGES       4096
+#define TRACE_SLOTS            512
+#define TRACE_CHURN_OPS        40000
+#define TRACE_PINGPONG_OPS     20000
+#define TRACE_PAGE_OPS         4000
+
+typedef struct {
+  UINT8   *Buffer;
+  UINTN    Size;
+  UINTN    Pages;
+  UINT8    Pattern;
+} TRACE_SLOT;
+
+STATIC UINT8       mHeap[MODEL_HEAP_PAGES * EFI_PAGE_SIZE] __attribute__ ((aligned (EFI_PAGE_SIZE)));
+STATIC TRACE_SLOT  mSlots[TRACE_SLOTS];
+STATIC UINT32      mSeed;
+STATIC UINT32      mPoolPageAllocs;
+STATIC UINT32      mPoolPageFrees;
+STATIC UINT32      mErrors;
+STATIC UINT32      mCorruptions;
+STATIC UINT32      mOps;
+
+//
+// DebugLib and BaseMemoryLib stubs
+//
+VOID
+EFIAPI
+DebugPrint (
+  IN  UINTN        ErrorLevel,
+  IN  CONST CHAR8  *Format,
+  ...
+  )
+{
+}
+
+VOID
+EFIAPI
+DebugAssert (
+  IN CONST CHAR8  *FileName,
+  IN UINTN        LineNumber,
+  IN CONST CHAR8  *Description
+  )
+{
+  printf ("ASSERT %s(%d): %s\n", FileName, (int)LineNumber, Description);
+  abort ();
+}
+
+BOOLEAN EFIAPI DebugAssertEnabled (VOID) { return TRUE; }
+BOOLEAN EFIAPI DebugPrintEnabled (VOID) { return FALSE; }
+BOOLEAN EFIAPI DebugPrintLevelEnabled (IN CONST UINTN ErrorLevel) { return FALSE; }
+BOOLEAN EFIAPI DebugCodeEnabled (VOID) { return TRUE; }
+BOOLEAN EFIAPI DebugClearMemoryEnabled (VOID) { return FALSE; }
+VOID * EFIAPI DebugClearMemory (OUT VOID *Buffer, IN UINTN Length) { return Buffer; }
+
+VOID *
+EFIAPI
+SetMem (
+  OUT VOID  *Buffer,
+  IN UINTN  Length,
+  IN UINT8  Value
+  )
+{
+  UINT8  *Ptr;
+
+  for (Ptr = Buffer; Length > 0; Length--) {
+    *Ptr++ = Value;
+  }
+  return Buffer;
+}
+
+VOID *
+EFIAPI
+ZeroMem (
+  OUT VOID  *Buffer,
+  IN UINTN  Length
+  )
+{
+  return SetMem (Buffer, Length, 0);
+}
+
+VOID *
+EFIAPI
+CopyMem (
+  OUT VOID       *DestinationBuffer,
+  IN CONST VOID  *SourceBuffer,
+  IN UINTN       Length
+  )
+{
+  UINT8        *Dst;
+  CONST UINT8  *Src;
+
+  Dst = DestinationBuffer;
+  Src = SourceBuffer;
+  if ((Dst > Src) && (Dst < Src + Length)) {
+    while (Length > 0) {
+      Length--;
+      Dst[Length] = Src[Length];
+    }
+  } else {
+    for (; Length > 0; Length--) {
+      *Dst++ = *Src++;
+    }
+  }
+  return DestinationBuffer;
+}
+
+UINT64
+EFIAPI
+AsmReadTsc (
+  VOID
+  )
+{
+  return __builtin_ia32_rdtsc ();
+}
+
+//
+// Pool page conversion counters
+//
+VOID *
+__real_CoreAllocatePoolPages (
+  IN EFI_MEMORY_TYPE    PoolType,
+  IN UINTN              NumberOfPages,
+  IN UINTN              Alignment
+  );
+
+VOID
+__real_CoreFreePoolPages (
+  IN EFI_PHYSICAL_ADDRESS   Memory,
+  IN UINTN                  NumberOfPages
+  );
+
+VOID *
+__wrap_CoreAllocatePoolPages (
+  IN EFI_MEMORY_TYPE    PoolType,
+  IN UINTN              NumberOfPages,
+  IN UINTN              Alignment
+  )
+{
+  mPoolPageAllocs++;
+  return __real_CoreAllocatePoolPages (PoolType, NumberOfPages, Alignment);
+}
+
+VOID
+__wrap_CoreFreePoolPages (
+  IN EFI_PHYSICAL_ADDRESS   Memory,
+  IN UINTN                  NumberOfPages
+  )
+{
+  mPoolPageFrees++;
+  __real_CoreFreePoolPages (Memory, NumberOfPages);
+}
+
+//
+// Trace replay
+//
+STATIC
+UINT32
+TraceRandom (
+  VOID
+  )
+{
+  mSeed = mSeed * 1103515245 + 12345;
+  return mSeed >> 8;
+}
+
+//
+// Mostly small requests, like device paths, file names and block I/O
+// descriptors, with a tail of buffers larger than a page
+//
+STATIC
+UINTN
+TracePoolSize (
+  VOID
+  )
+{
+  UINT32  Pick;
+
+  Pick = TraceRandom () % 100;
+  if (Pick < 60) {
+    return 8 + TraceRandom () % 120;
+  } else if (Pick < 85) {
+    return 128 + TraceRandom () % 896;
+  } else if (Pick < 97) {
+    return 1024 + TraceRandom () % 3072;
+  }
+  return 4096 + TraceRandom () % 28672;
+}
+
+STATIC
+VOID
+TraceFill (
+  IN TRACE_SLOT  *Slot
+  )
+{
+  SetMem (Slot->Buffer, Slot->Size, Slot->Pattern);
+}
+
+STATIC
+VOID
+TraceCheck (
+  IN TRACE_SLOT  *Slot
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Slot->Size; Index++) {
+    if (Slot->Buffer[Index] != Slot->Pattern) {
+      mCorruptions++;
+      return;
+    }
+  }
+}
+
+STATIC
+VOID
+TraceAllocate (
+  IN TRACE_SLOT  *Slot,
+  IN UINTN       Size,
+  IN UINTN       Pages
+  )
+{
+  mOps++;
+  if (Pages != 0) {
+    Slot->Buffer = AllocatePages (Pages);
+    Slot->Size   = EFI_PAGES_TO_SIZE (Pages);
+    if (((UINTN)Slot->Buffer & EFI_PAGE_MASK) != 0) {
+      mErrors++;
+    }
+  } else {
+    Slot->Buffer = AllocatePool (Size);
+    Slot->Size   = Size;
+    if (((UINTN)Slot->Buffer & (sizeof (UINT64) - 1)) != 0) {
+      mErrors++;
+    }
+  }
+  Slot->Pages   = Pages;
+  Slot->Pattern = (UINT8)(mOps | 1);
+  if ((Slot->Buffer < mHeap) || (Slot->Buffer + Slot->Size > mHeap + sizeof (mHeap))) {
+    mErrors++;
+    Slot->Buffer = NULL;
+    return;
+  }
+  TraceFill (Slot);
+}
+
+STATIC
+VOID
+TraceFree (
+  IN TRACE_SLOT  *Slot
+  )
+{
+  if (Slot->Buffer == NULL) {
+    return;
+  }
+  mOps++;
+  TraceCheck (Slot);
+  if (Slot->Pages != 0) {
+    FreePages (Slot->Buffer, Slot->Pages);
+  } else {
+    FreePool (Slot->Buffer);
+  }
+  Slot->Buffer = NULL;
+}
+
+STATIC
+UINT64
+UsedBytes (
+  VOID
+  )
+{
+  UINT64  FreeAddr;
+  UINT64  EndAddr;
+
+  GetMemoryResourceInfo (EfiBootServicesData, NULL, &FreeAddr, &EndAddr);
+  return EndAddr - FreeAddr;
+}
+
+STATIC
+VOID
+Report (
+  IN CONST CHAR8  *Name,
+  IN UINT64       StartTick
+  )
+{
+  UINT64  Ticks;
+
+  Ticks = AsmReadTsc () - StartTick;
+  printf ("%s.ops=%u\n", Name, mOps);
+  printf ("%s.pool_page_allocs=%u\n", Name, mPoolPageAllocs);
+  printf ("%s.pool_page_frees=%u\n", Name, mPoolPageFrees);
+  printf ("%s.errors=%u\n", Name, mErrors);
+  printf ("%s.corruptions=%u\n", Name, mCorruptions);
+  printf ("%s.ticks_per_op=%u\n", Name, (UINT32)(Ticks / (mOps == 0 ? 1 : mOps)));
+  mOps            = 0;
+  mPoolPageAllocs = 0;
+  mPoolPageFrees  = 0;
+}
+
+STATIC
+VOID
+FreeAllSlots (
+  VOID
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < TRACE_SLOTS; Index++) {
+    TraceFree (&mSlots[Index]);
+  }
+}
+
+int
+main (
+  void
+  )
+{
+  EFI_MEMORY_RANGE_ENTRY  MemoryRanges[2];
+  TRACE_SLOT             *Slot;
+  UINT64                  StartTick;
+  UINT64                  UsedAtStart;
+  UINTN                   Index;
+
+  MemoryRanges[0].BaseAddress   = (EFI_PHYSICAL_ADDRESS)(UINTN)mHeap;
+  MemoryRanges[0].NumberOfPages = MODEL_HEAP_PAGES;
+  MemoryRanges[0].Type          = EfiBootServicesData;
+  MemoryRanges[1].BaseAddress   = 0;
+  MemoryRanges[1].NumberOfPages = 0;
+  MemoryRanges[1].Type          = EfiMaxMemoryType;
+  AddMemoryResourceRange (MemoryRanges, 2);
+
+  //
+  // Allocate the payload global data that lives for the whole boot
+  //
+  mSeed = 1;
+  TraceAllocate (&mSlots[0], 512, 0);
+  UsedAtStart = UsedBytes ();
+  mOps        = 0;
+
+  //
+  // Random pool allocations and frees with up to TRACE_SLOTS buffers live
+  //
+  StartTick = AsmReadTsc ();
+  for (Index = 0; Index < TRACE_CHURN_OPS; Index++) {
+    Slot = &mSlots[1 + TraceRandom () % (TRACE_SLOTS - 1)];
+    if (Slot->Buffer != NULL) {
+      TraceFree (Slot);
+    } else {
+      TraceAllocate (Slot, TracePoolSize (), 0);
+    }
+  }
+  for (Index = 1; Index < TRACE_SLOTS; Index++) {
+    TraceFree (&mSlots[Index]);
+  }
+  Report ("churn", StartTick);
+
+  //
+  // A temporary buffer allocated and freed in a loop with nothing else live,
+  // like a file system reading a file block by block
+  //
+  StartTick = AsmReadTsc ();
+  for (Index = 0; Index < TRACE_PINGPONG_OPS; Index++) {
+    TraceAllocate (&mSlots[1], TracePoolSize () & 0x3FF, 0);
+    TraceFree (&mSlots[1]);
+  }
+  Report ("pingpong", StartTick);
+
+  //
+  // Page allocations mixed with pool allocations
+  //
+  StartTick = AsmReadTsc ();
+  for (Index = 0; Index < TRACE_PAGE_OPS; Index++) {
+    Slot = &mSlots[1 + TraceRandom () % 64];
+    if (Slot->Buffer != NULL) {
+      TraceFree (Slot);
+    } else if ((TraceRandom () & 1) != 0) {
+      TraceAllocate (Slot, 0, 1 + TraceRandom () % 16);
+    } else {
+      TraceAllocate (Slot, TracePoolSize (), 0);
+    }
+  }
+  for (Index = 1; Index < TRACE_SLOTS; Index++) {
+    TraceFree (&mSlots[Index]);
+  }
+  Report ("pages", StartTick);
+
+  //
+  // Everything but the global data is freed again. One spare pool page per
+  // memory type may stay allocated.
+  //
+  printf ("heap.leaked_pages=%u\n", (UINT32)((UsedBytes () - UsedAtStart) / EFI_PAGE_SIZE));
+  FreeAllSlots ();
+  printf ("heap.corruptions=%u\n", mCorruptions);
+
+  return 0;
+}
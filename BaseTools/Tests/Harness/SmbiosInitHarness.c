@@ -0,0 +1,395 @@
+/** @file
+  Host harness for the BootloaderCorePkg SMBIOS table builder.
+
+  Links BootloaderCorePkg/Library/SmbiosInitLib/SmbiosInitLib.c and
+  SmbiosTemplate.c against fixed CPU, memory and platform string data, builds
+  the tables the way Stage2 and a board library do, and prints the whole
+  SMBIOS region as hex. SmbiosInitTest.py builds it once with the current
+  sources and once with a reference revision and compares the output.
+
+  The PCDs are 32 bits wide, so the tables and strings are static data, which
+  a static non-PIE host binary keeps below 4GB.
+
+  Results are printed as "key=value" lines for SmbiosInitTest.py.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include <IndustryStandard/SmBios.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BootloaderCoreLib.h>
+#include <Library/SmbiosInitLib.h>
+#include <Library/MpInitLib.h>
+#include "SmbiosTables.h"
+
+int printf (const char *Format, ...);
+void abort (void);
+
+#define MODEL_TABLES_SIZE      0x2000
+#define MODEL_CPU_COUNT        4
+
+UINT32  gPcdSmbiosTablesBase;
+UINT16  gPcdSmbiosTablesSize = MODEL_TABLES_SIZE;
+UINT32  gPcdSmbiosStringsPtr;
+UINT16  gPcdSmbiosStringsCnt;
+
+STATIC UINT8   mTables[MODEL_TABLES_SIZE] __attribute__ ((aligned (16)));
+STATIC UINT8   mPool[0x1000] __attribute__ ((aligned (16)));
+STATIC UINTN   mPoolUsed;
+
+STATIC struct {
+  SYS_CPU_INFO  Info;
+  CPU_INFO      Cpu[MODEL_CPU_COUNT];
+} mSysCpuInfo;
+
+//
+// Platform strings with a duplicate index, empty strings that fall back to
+// the defaults, a type without a template and indexes past the template
+// strings. The last two entries are past PcdSmbiosStringsCnt in the
+// "truncated" run.
+//
+STATIC SMBIOS_TYPE_STRINGS  mPlatformStrings[] = {
+  { SMBIOS_TYPE_BIOS_INFORMATION,      1, "Harness Vendor"    },
+  { SMBIOS_TYPE_BIOS_INFORMATION,      2, "1.0.0"             },
+  { SMBIOS_TYPE_BIOS_INFORMATION,      3, ""                  },
+  { SMBIOS_TYPE_SYSTEM_INFORMATION,    1, "Manufacturer"      },
+  { SMBIOS_TYPE_SYSTEM_INFORMATION,    2, "Product"           },
+  { SMBIOS_TYPE_SYSTEM_INFORMATION,    3, "Version"           },
+  { SMBIOS_TYPE_SYSTEM_INFORMATION,    4, "Serial"            },
+  { SMBIOS_TYPE_SYSTEM_INFORMATION,    1, "Duplicate"         },
+  { SMBIOS_TYPE_BASEBOARD_INFORMATION, 2, "Board"             },
+  { SMBIOS_TYPE_BASEBOARD_INFORMATION, 6, ""                  },
+  { SMBIOS_TYPE_SYSTEM_ENCLOSURE,      1, "Chassis"           },
+  { SMBIOS_TYPE_SYSTEM_ENCLOSURE,      2, "Chassis Version"   },
+  { SMBIOS_TYPE_SYSTEM_ENCLOSURE,      3, "Chassis Serial"    },
+  { SMBIOS_TYPE_SYSTEM_ENCLOSURE,      4, "Chassis Asset Tag" },
+  { SMBIOS_TYPE_PROCESSOR_INFORMATION, 4, "CPU Serial"        },
+  { SMBIOS_TYPE_TEMPERATURE_PROBE,     1, "Board Probe"       },
+  { SMBIOS_TYPE_SYSTEM_INFORMATION,    4, "Past Count"        },
+  { SMBIOS_TYPE_BASEBOARD_INFORMATION, 1, "Past Count"        },
+  { SMBIOS_TYPE_END_OF_TABLE,          0, ""                  }
+};
+
+//
+// Library stubs
+//
+VOID
+EFIAPI
+DebugPrint (
+  IN  UINTN        ErrorLevel,
+  IN  CONST CHAR8  *Format,
+  ...
+  )
+{
+}
+
+VOID
+EFIAPI
+DebugAssert (
+  IN CONST CHAR8  *FileName,
+  IN UINTN        LineNumber,
+  IN CONST CHAR8  *Description
+  )
+{
+  printf ("ASSERT %s(%d): %s\n", FileName, (int)LineNumber, Description);
+  abort ();
+}
+
+BOOLEAN EFIAPI DebugAssertEnabled (VOID) { return TRUE; }
+BOOLEAN EFIAPI DebugPrintEnabled (VOID) { return FALSE; }
+BOOLEAN EFIAPI DebugPrintLevelEnabled (IN CONST UINTN ErrorLevel) { return FALSE; }
+BOOLEAN EFIAPI DebugCodeEnabled (VOID) { return TRUE; }
+
+VOID *
+EFIAPI
+ZeroMem (
+  OUT VOID  *Buffer,
+  IN UINTN  Length
+  )
+{
+  UINT8  *Ptr;
+
+  for (Ptr = Buffer; Length > 0; Length--) {
+    *Ptr++ = 0;
+  }
+  return Buffer;
+}
+
+VOID *
+EFIAPI
+CopyMem (
+  OUT VOID       *DestinationBuffer,
+  IN CONST VOID  *SourceBuffer,
+  IN UINTN       Length
+  )
+{
+  UINT8        *Dst;
+  CONST UINT8  *Src;
+
+  Dst = DestinationBuffer;
+  Src = SourceBuffer;
+  if ((Dst > Src) && (Dst < Src + Length)) {
+    while (Length > 0) {
+      Length--;
+      Dst[Length] = Src[Length];
+    }
+  } else {
+    for (; Length > 0; Length--) {
+      *Dst++ = *Src++;
+    }
+  }
+  return DestinationBuffer;
+}
+
+VOID *
+EFIAPI
+AllocateZeroPool (
+  IN UINTN  AllocationSize
+  )
+{
+  VOID  *Buffer;
+
+  AllocationSize = ALIGN_VALUE (AllocationSize, 16);
+  if (mPoolUsed + AllocationSize > sizeof (mPool)) {
+    return NULL;
+  }
+  Buffer     = &mPool[mPoolUsed];
+  mPoolUsed += AllocationSize;
+  return ZeroMem (Buffer, AllocationSize);
+}
+
+UINTN
+EFIAPI
+AsciiStrLen (
+  IN CONST CHAR8  *String
+  )
+{
+  UINTN  Length;
+
+  for (Length = 0; String[Length] != 0; Length++) {
+  }
+  return Length;
+}
+
+UINTN
+EFIAPI
+AsciiStrSize (
+  IN CONST CHAR8  *String
+  )
+{
+  return AsciiStrLen (String) + 1;
+}
+
+CHAR8 *
+EFIAPI
+AsciiStrStr (
+  IN CONST CHAR8  *String,
+  IN CONST CHAR8  *SearchString
+  )
+{
+  UINTN  Index;
+
+  for (; *String != 0; String++) {
+    for (Index = 0; (SearchString[Index] != 0) && (String[Index] == SearchString[Index]); Index++) {
+    }
+    if (SearchString[Index] == 0) {
+      return (CHAR8 *)String;
+    }
+  }
+  return NULL;
+}
+
+RETURN_STATUS
+EFIAPI
+AsciiStrCpyS (
+  OUT CHAR8        *Destination,
+  IN  UINTN        DestMax,
+  IN  CONST CHAR8  *Source
+  )
+{
+  CopyMem (Destination, Source, AsciiStrSize (Source));
+  return RETURN_SUCCESS;
+}
+
+UINT8
+EFIAPI
+CalculateCheckSum8 (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length
+  )
+{
+  UINT8  Sum;
+
+  for (Sum = 0; Length > 0; Length--) {
+    Sum = (UINT8)(Sum + *Buffer++);
+  }
+  return (UINT8)(0x100 - Sum);
+}
+
+UINT64
+EFIAPI
+DivU64x32 (
+  IN UINT64  Dividend,
+  IN UINT32  Divisor
+  )
+{
+  return Dividend / Divisor;
+}
+
+//
+// Brand string returned by the three CPUID brand string leaves
+//
+STATIC CONST CHAR8  mBrandString[48] = "Genuine Intel(R) Atom(TM) CPU";
+
+UINT32
+EFIAPI
+AsmCpuid (
+  IN  UINT32  Index,
+  OUT UINT32  *RegisterEax   OPTIONAL,
+  OUT UINT32  *RegisterEbx   OPTIONAL,
+  OUT UINT32  *RegisterEcx   OPTIONAL,
+  OUT UINT32  *RegisterEdx   OPTIONAL
+  )
+{
+  UINT32  Regs[4];
+
+  if ((Index >= CPUID_BRAND_STRING1) && (Index <= CPUID_BRAND_STRING3)) {
+    CopyMem (Regs, &mBrandString[(Index - CPUID_BRAND_STRING1) * 16], sizeof (Regs));
+  } else {
+    Regs[0] = 0x000906EA;
+    Regs[1] = 0x00100800;
+    Regs[2] = 0x7FFAFBBF;
+    Regs[3] = 0xBFEBFBFF;
+  }
+  if (RegisterEax != NULL) {
+    *RegisterEax = Regs[0];
+  }
+  if (RegisterEbx != NULL) {
+    *RegisterEbx = Regs[1];
+  }
+  if (RegisterEcx != NULL) {
+    *RegisterEcx = Regs[2];
+  }
+  if (RegisterEdx != NULL) {
+    *RegisterEdx = Regs[3];
+  }
+  return Index;
+}
+
+UINT64
+EFIAPI
+GetTimeStampFrequency (
+  VOID
+  )
+{
+  return 2400000;
+}
+
+UINT64
+EFIAPI
+GetMemoryInfo (
+  IN  MEM_INFO_TYPE  MemInfoType
+  )
+{
+  return SIZE_8GB;
+}
+
+SYS_CPU_INFO *
+EFIAPI
+MpGetInfo (
+  VOID
+  )
+{
+  return &mSysCpuInfo.Info;
+}
+
+//
+// Tests
+//
+STATIC
+VOID
+Report (
+  IN CONST CHAR8  *Name,
+  IN EFI_STATUS   Status
+  )
+{
+  SMBIOS_TABLE_ENTRY_POINT  *SmbiosEntry;
+  UINTN                      Index;
+  UINTN                      Length;
+
+  SmbiosEntry = (SMBIOS_TABLE_ENTRY_POINT *)mTables;
+  Length      = SmbiosEntry->EntryPointLength + sizeof (UINT8) + SmbiosEntry->TableLength;
+
+  printf ("%s.status=%u\n", Name, (UINT32)Status);
+  printf ("%s.structures=%u\n", Name, SmbiosEntry->NumberOfSmbiosStructures);
+  printf ("%s.table_length=%u\n", Name, SmbiosEntry->TableLength);
+  printf ("%s.max_structure_size=%u\n", Name, SmbiosEntry->MaxStructureSize);
+  printf ("%s.entry_checksum=%u\n", Name, CalculateCheckSum8 (mTables, sizeof (SMBIOS_TABLE_ENTRY_POINT)));
+  printf ("%s.tables=", Name);
+  for (Index = 0; Index < Length; Index++) {
+    printf ("%02x", mTables[Index]);
+  }
+  printf ("\n");
+}
+
+STATIC
+VOID
+TestBuild (
+  IN CONST CHAR8  *Name,
+  IN UINT16       StringsCnt
+  )
+{
+  SMBIOS_TABLE_TYPE28  Probe;
+  EFI_STATUS           Status;
+  UINTN                Index;
+
+  ZeroMem (mTables, sizeof (mTables));
+  mPoolUsed            = 0;
+  gPcdSmbiosTablesBase = (UINT32)(UINTN)mTables;
+  gPcdSmbiosStringsPtr = (UINT32)(UINTN)mPlatformStrings;
+  gPcdSmbiosStringsCnt = StringsCnt;
+
+  Status = SmbiosInit ();
+
+  //
+  // A board library adding several instances of a type, with strings
+  // appended to the last instance and to an earlier one
+  //
+  ZeroMem (&Probe, sizeof (Probe));
+  Probe.Hdr.Type   = SMBIOS_TYPE_TEMPERATURE_PROBE;
+  Probe.Hdr.Length = sizeof (Probe);
+  Probe.Description = SMBIOS_STRING_INDEX_1;
+  for (Index = 0; Index < 3; Index++) {
+    Probe.NominalValue = (UINT16)Index;
+    Status |= AddSmbiosType (&Probe);
+    Status |= AddSmbiosString (SMBIOS_TYPE_TEMPERATURE_PROBE, "Probe");
+    Status |= AddSmbiosString (SMBIOS_TYPE_TEMPERATURE_PROBE, "");
+  }
+  Status |= AddSmbiosString (SMBIOS_TYPE_SYSTEM_ENCLOSURE, "Appended");
+  Status |= AddSmbiosType (&Probe);
+
+  Status |= FinalizeSmbios ();
+  Report (Name, Status);
+}
+
+int
+main (
+  void
+  )
+{
+  UINT32  Index;
+
+  mSysCpuInfo.Info.CpuCount = MODEL_CPU_COUNT;
+  for (Index = 0; Index < MODEL_CPU_COUNT; Index++) {
+    mSysCpuInfo.Info.CpuInfo[Index].ApicId = Index;
+  }
+
+  TestBuild ("full", ARRAY_SIZE (mPlatformStrings));
+  TestBuild ("truncated", ARRAY_SIZE (mPlatformStrings) - 3);
+
+  return 0;
+}
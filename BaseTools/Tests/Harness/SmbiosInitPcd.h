@@ -0,0 +1,27 @@
+/** @file
+  PCDs of BootloaderCorePkg/Library/SmbiosInitLib for the host harness.
+
+  Force-included into every source of SmbiosInitHarness in place of the
+  AutoGen.h a firmware build would generate.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __SMBIOS_INIT_PCD_H__
+#define __SMBIOS_INIT_PCD_H__
+
+extern UINT32  gPcdSmbiosTablesBase;
+extern UINT16  gPcdSmbiosTablesSize;
+extern UINT32  gPcdSmbiosStringsPtr;
+extern UINT16  gPcdSmbiosStringsCnt;
+
+#define _PCD_GET_MODE_32_PcdSmbiosTablesBase            gPcdSmbiosTablesBase
+#define _PCD_GET_MODE_16_PcdSmbiosTablesSize            gPcdSmbiosTablesSize
+#define _PCD_GET_MODE_32_PcdSmbiosStringsPtr            gPcdSmbiosStringsPtr
+#define _PCD_GET_MODE_16_PcdSmbiosStringsCnt            gPcdSmbiosStringsCnt
+#define _PCD_SET_MODE_32_S_PcdSmbiosStringsPtr(Value)   (gPcdSmbiosStringsPtr = (Value), RETURN_SUCCESS)
+#define _PCD_GET_MODE_BOOL_PcdLegacyEfSegmentEnabled    FALSE
+
+#endif
@@ -0,0 +1,82 @@
+## @file
+# Circular buffer test for the asynchronous HECI requests
+#
+# Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+#
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import unittest
+import TestTools
+
+class HeciAsyncTests(TestTools.HostHarnessTestCase):
+    """Run the HECI library against modeled host and ME circular buffers.
+
+    Both buffers are 32 DWORDs deep, so the 268 byte CSME boot time data
+    response is split into several packets, and the 8-bit buffer pointers
+    wrap many times over the test.
+    """
+    Harness  = 'HeciAsyncHarness.c'
+    Sources  = [
+      'Silicon/CommonSocPkg/Library/HeciLib/HeciCore.c',
+      'Silicon/CommonSocPkg/Library/HeciLib/HeciLib.c',
+      ]
+    Includes = [
+      'Silicon/CommonSocPkg/Include',
+      'Silicon/CommonSocPkg/Library/HeciLib',
+      ]
+
+    def setUp(self):
+        super().setUp()
+        self.Values = self.RunHarness(self.BuildHarness())
+
+    def GetCount(self, Key):
+        return int(self.Values[Key])
+
+    def testBootFlow(self):
+        self.assertEqual(self.GetCount('flow.post'), 0)
+        #
+        # The response is not there while the payload is loaded
+        #
+        self.assertEqual(self.Values['flow.poll_early'], 'not_ready')
+        self.assertEqual(self.GetCount('flow.get'), 0)
+        self.assertEqual(self.GetCount('flow.length'), 64)
+        self.assertEqual(self.GetCount('flow.version'), 1)
+        self.assertEqual(self.GetCount('flow.bad_entries'), 0)
+
+    def testNothingPendingAtEndOfStages(self):
+        self.assertEqual(self.GetCount('flow.poll_after'), 0)
+        self.assertEqual(self.GetCount('flow.me_cb_filled'), 0)
+        self.assertEqual(self.GetCount('flow.me_queued'), 0)
+        self.assertEqual(self.GetCount('flow.eop'), 0)
+        self.assertEqual(self.GetCount('flow.eop_matched'), 1)
+
+    def testSyncMessageWhileAsyncPending(self):
+        self.assertEqual(self.GetCount('interleave.post'), 0)
+        self.assertEqual(self.GetCount('interleave.sync'), 0)
+        self.assertEqual(self.GetCount('interleave.sync_matched'), 1)
+        self.assertEqual(self.GetCount('interleave.wait'), 0)
+        self.assertEqual(self.GetCount('interleave.async_matched'), 1)
+        self.assertEqual(self.GetCount('interleave.async_length'), 12)
+
+    def testPointerWrapAndOrdering(self):
+        self.assertEqual(self.GetCount('wrap.requests'), 256)
+        self.assertEqual(self.GetCount('wrap.mismatches'), 0)
+        self.assertEqual(self.GetCount('wrap.errors'), 0)
+        self.assertEqual(self.GetCount('wrap.queue_full'), 64)
+        self.assertEqual(self.GetCount('wrap.poll_after'), 0)
+        self.assertGreater(self.GetCount('model.host_dwords'), 2 * 256)
+        self.assertGreater(self.GetCount('model.me_dwords'), 2 * 256)
+
+    def testNoInterfaceReset(self):
+        self.assertEqual(self.GetCount('model.resets'), 0)
+        self.assertEqual(self.GetCount('model.answered'), 260)
+
+def TheTestSuite():
+    return unittest.TestLoader().loadTestsFromTestCase(HeciAsyncTests)
+
+if __name__ == '__main__':
+    unittest.TextTestRunner(verbosity=2).run(TheTestSuite())
@@ -0,0 +1,130 @@
+## @file
+# Bank rotation and power loss tests for the lite variable store
+#
+# Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+#
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import os
+import shutil
+import unittest
+import TestTools
+
+#
+# Boots run over the same flash image. Each boot appends about 1KB of
+# variables, so this rotates through every bank several times.
+#
+RotationBoots = 64
+
+#
+# Boot that loses power in every one of its flash operations in turn
+#
+PowerCutBoot = 4
+
+class LiteVariableTests(TestTools.HostHarnessTestCase):
+    """Boot the lite variable store many times on a file-backed flash model.
+
+    Every boot reads back the previous generation of variables, writes a new
+    one and runs the deferred store maintenance. The store must keep all
+    variables, never program a bit from 0 to 1 and spread the block erases
+    over all banks. After power is lost in any flash operation, the next
+    boot must find either generation of every variable.
+    """
+    Harness  = 'LiteVariableHarness.c'
+    Sources  = [
+      'BootloaderCommonPkg/Library/LiteVariableLib/LiteVariableLib.c',
+      ]
+    Includes = [
+      'BootloaderCommonPkg/Library/LiteVariableLib',
+      ]
+    ForceIncludes = [
+      'LiteVariablePcd.h',
+      ]
+    BankCounts = (2, 4)
+
+    def BuildForBanks(self, Banks):
+        return self.BuildHarness(Defines = ['MODEL_VARIABLE_STORE_BANKS=%d' % Banks])
+
+    def RunBoot(self, Program, Image, Boot, *Args):
+        return self.RunHarness(Program, [Image, str(Boot)] + list(Args))
+
+    def CheckBoot(self, Values):
+        self.assertEqual(int(Values['init']), 0)
+        self.assertEqual(int(Values['cut']), 0)
+        self.assertEqual(int(Values['mismatches']), 0)
+        self.assertEqual(int(Values['errors']), 0)
+        self.assertEqual(int(Values['bad_writes']), 0)
+
+    def testBankRotation(self):
+        for Banks in self.BankCounts:
+            with self.subTest(Banks = Banks):
+                Program  = self.BuildForBanks(Banks)
+                Image    = os.path.join(self.WorkDir, 'rotation%d.img' % Banks)
+                Reclaims = 0
+                for Boot in range(RotationBoots):
+                    Values = self.RunBoot(Program, Image, Boot)
+                    self.CheckBoot(Values)
+                    self.assertEqual(int(Values['banks']), Banks)
+                    #
+                    # Stale banks are erased at the end of a boot, so a reclaim
+                    # always finds its target bank erased already
+                    #
+                    if Boot > 0:
+                        self.assertEqual(int(Values['inline_erases']), 0)
+                    Reclaims += int(Values['reclaims'])
+                self.assertGreaterEqual(Reclaims, Banks)
+
+                Blocks = sorted([Key for Key in Values if Key.startswith('block')],
+                                key = lambda Key: int(Key[5:].split('.')[0]))
+                Erases = [int(Values[Key]) for Key in Blocks]
+                BankBlocks = len(Erases) // Banks
+                BankErases = []
+                for Bank in range(Banks):
+                    Counts = Erases[Bank * BankBlocks:(Bank + 1) * BankBlocks]
+                    self.assertEqual(min(Counts), max(Counts))
+                    BankErases.append(Counts[0])
+                print('')
+                print('  %d banks: %d reclaims, erases per bank %s' % (Banks, Reclaims, BankErases))
+                self.assertGreater(min(BankErases), 1)
+                self.assertLessEqual(max(BankErases) - min(BankErases), 1)
+
+    def testPowerCutRecovery(self):
+        for Banks in self.BankCounts:
+            with self.subTest(Banks = Banks):
+                Program = self.BuildForBanks(Banks)
+                Base    = os.path.join(self.WorkDir, 'base%d.img' % Banks)
+                Image   = os.path.join(self.WorkDir, 'cut%d.img' % Banks)
+                for Boot in range(PowerCutBoot):
+                    self.CheckBoot(self.RunBoot(Program, Base, Boot))
+
+                #
+                # A forced compaction makes the boot erase a bank and reclaim
+                # into the next one, so the cuts hit every kind of operation
+                #
+                shutil.copyfile(Base, Image)
+                Values = self.RunBoot(Program, Image, PowerCutBoot, 'force')
+                self.CheckBoot(Values)
+                self.assertGreater(int(Values['reclaims']), 0)
+                Operations = int(Values['flash_ops'])
+
+                for Cut in range(1, Operations + 1):
+                    shutil.copyfile(Base, Image)
+                    Values = self.RunBoot(Program, Image, PowerCutBoot, 'cut=%d' % Cut, 'force')
+                    self.assertEqual(int(Values['cut']), 1, 'cut=%d' % Cut)
+                    #
+                    # The same boot again, then the next one on top of it
+                    #
+                    Values = self.RunBoot(Program, Image, PowerCutBoot, 'force')
+                    self.CheckBoot(Values)
+                    Values = self.RunBoot(Program, Image, PowerCutBoot + 1)
+                    self.CheckBoot(Values)
+
+def TheTestSuite():
+    return unittest.TestLoader().loadTestsFromTestCase(LiteVariableTests)
+
+if __name__ == '__main__':
+    unittest.TextTestRunner(verbosity=2).run(TheTestSuite())
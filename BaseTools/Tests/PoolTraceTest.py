@@ -0,0 +1,106 @@
+## @file
+# Trace replay benchmark for the payload memory allocator
+#
+# Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+#
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import os
+import unittest
+import TestTools
+
+AllocationLibDir = 'BootloaderCommonPkg/Library/FullMemoryAllocationLib'
+AllocationLibFiles = ['MemData.c', 'Page.c', 'Pool.c', 'FullMemoryAllocationLib.c', 'Imem.h']
+AllocationLibHeader = 'BootloaderCommonPkg/Include/Library/BlMemoryAllocationLib.h'
+
+#
+# Last revision of the allocator without the pool bin lookup table and the
+# spare pool page
+#
+ReferenceRevision = 'e9e54022c424c6ed302a9bc25dbc32040e66160d'
+
+BaseLibSources = [
+  'MdePkg/Library/BaseLib/LinkedList.c',
+  'MdePkg/Library/BaseLib/LShiftU64.c',
+  'MdePkg/Library/BaseLib/RShiftU64.c',
+  'MdePkg/Library/BaseLib/Math64.c',
+  'MdePkg/Library/BaseLib/SwapBytes16.c',
+  'MdePkg/Library/BaseLib/SwapBytes32.c',
+  ]
+
+class PoolTraceTests(TestTools.HostHarnessTestCase):
+    """Replay an allocation trace through the current and reference allocator.
+
+    Both must hand out intact, non-overlapping buffers. The current allocator
+    must convert pool pages in the memory map less often. Time stamp ticks
+    per operation are printed for comparison but not checked, as they depend
+    on the host.
+    """
+    Harness  = 'PoolTraceHarness.c'
+    Sources  = [os.path.join(AllocationLibDir, File) for File in AllocationLibFiles if File.endswith('.c')] + BaseLibSources
+    Includes = [
+      AllocationLibDir,
+      ]
+    Defines  = [
+      '_PCD_GET_MODE_32_PcdMaximumLinkedListLength=0',
+      '_PCD_GET_MODE_BOOL_PcdVerifyNodeInList=FALSE',
+      ]
+    LinkFlags = [
+      '-Wl,--wrap=CoreAllocatePoolPages',
+      '-Wl,--wrap=CoreFreePoolPages',
+      ]
+    Phases = ('churn', 'pingpong', 'pages')
+
+    def setUp(self):
+        super().setUp()
+        self.Values = self.RunHarness(self.BuildHarness())
+
+    def GetReferenceValues(self):
+        Sources = []
+        for File in AllocationLibFiles:
+            Path = self.GetRepoFile(os.path.join(AllocationLibDir, File), ReferenceRevision)
+            if File.endswith('.c'):
+                Sources.append(Path)
+        self.GetRepoFile(AllocationLibHeader, ReferenceRevision, 'Library/BlMemoryAllocationLib.h')
+        Includes = [os.path.dirname(Sources[0])]
+        return self.RunHarness(self.BuildHarness(Sources + BaseLibSources, Includes = Includes))
+
+    def GetCount(self, Values, Key):
+        return int(Values[Key])
+
+    def CheckIntact(self, Values):
+        for Phase in self.Phases:
+            self.assertEqual(self.GetCount(Values, Phase + '.errors'), 0)
+            self.assertEqual(self.GetCount(Values, Phase + '.corruptions'), 0)
+        self.assertEqual(self.GetCount(Values, 'heap.corruptions'), 0)
+        self.assertLessEqual(self.GetCount(Values, 'heap.leaked_pages'), 1)
+
+    def testBuffersIntact(self):
+        self.CheckIntact(self.Values)
+
+    def testFewerPoolPageConversions(self):
+        Reference = self.GetReferenceValues()
+        self.CheckIntact(Reference)
+        print('')
+        for Phase in self.Phases:
+            print('  %-8s ticks/op %6s -> %6s, pool page allocs %6s -> %6s' % (Phase,
+                  Reference[Phase + '.ticks_per_op'], self.Values[Phase + '.ticks_per_op'],
+                  Reference[Phase + '.pool_page_allocs'], self.Values[Phase + '.pool_page_allocs']))
+            self.assertEqual(self.Values[Phase + '.ops'], Reference[Phase + '.ops'])
+            self.assertLessEqual(self.GetCount(self.Values, Phase + '.pool_page_allocs'),
+                                 self.GetCount(Reference, Phase + '.pool_page_allocs'))
+        #
+        # A buffer allocated and freed in a loop keeps reusing the spare page
+        #
+        self.assertLessEqual(self.GetCount(self.Values, 'pingpong.pool_page_allocs'), 1)
+        self.assertGreater(self.GetCount(Reference, 'pingpong.pool_page_allocs'), 1000)
+
+def TheTestSuite():
+    return unittest.TestLoader().loadTestsFromTestCase(PoolTraceTests)
+
+if __name__ == '__main__':
+    unittest.TextTestRunner(verbosity=2).run(TheTestSuite())
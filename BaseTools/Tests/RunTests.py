@@ -1,7 +1,7 @@
 ## @file
 # Unit tests for BaseTools utilities
 #
-#  Copyright (c) 2008, Intel Corporation. All rights reserved.<BR>
+#  Copyright (c) 2008 - 2020, Intel Corporation. All rights reserved.<BR>
 #
 #  SPDX-License-Identifier: BSD-2-Clause-Patent
 #
@@ -11,8 +11,18 @@
 #
 import os
 import sys
+import unittest
 
-# Dummy test
-if __name__ == '__main__':
-    pass
+sys.path.insert(0, os.path.realpath(os.path.split(__file__)[0]))
+
+import FirmwareTests
 
+def GetAllTestsSuite():
+    return unittest.TestSuite([
+        FirmwareTests.TheTestSuite(),
+        ])
+
+if __name__ == '__main__':
+    allTests = GetAllTestsSuite()
+    Result = unittest.TextTestRunner(verbosity=2).run(allTests)
+    sys.exit(0 if Result.wasSuccessful() else 1)
@@ -0,0 +1,69 @@
+## @file
+# Output comparison test for the BootloaderCorePkg SMBIOS table builder
+#
+# Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+#
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import unittest
+import TestTools
+
+SmbiosInitLib = 'BootloaderCorePkg/Library/SmbiosInitLib/SmbiosInitLib.c'
+
+#
+# Last revision of SmbiosInitLib.c that walked the structure area and the
+# string tables without the build index
+#
+ReferenceRevision = 'e95cb67cc5af947d4f049ff91961c4c858575a53'
+
+class SmbiosInitTests(TestTools.HostHarnessTestCase):
+    """Build the SMBIOS tables with the current and the reference sources.
+
+    The build index only changes how structures and strings are looked up,
+    so both must produce a byte-identical SMBIOS region.
+    """
+    Harness  = 'SmbiosInitHarness.c'
+    Sources  = [
+      SmbiosInitLib,
+      'BootloaderCorePkg/Library/SmbiosInitLib/SmbiosTemplate.c',
+      ]
+    Includes = [
+      'BootloaderCorePkg/Library/SmbiosInitLib',
+      ]
+    ForceIncludes = [
+      'SmbiosInitPcd.h',
+      ]
+
+    def setUp(self):
+        super().setUp()
+        self.Values = self.RunHarness(self.BuildHarness())
+
+    def GetReferenceValues(self):
+        Reference = self.GetRepoFile(SmbiosInitLib, ReferenceRevision)
+        Sources = [Reference] + self.Sources[1:]
+        return self.RunHarness(self.BuildHarness(Sources))
+
+    def testTablesBuilt(self):
+        for Run in ('full', 'truncated'):
+            self.assertEqual(int(self.Values[Run + '.status']), 0)
+            self.assertEqual(int(self.Values[Run + '.entry_checksum']), 0)
+            #
+            # Six common types, four temperature probes and the end of table
+            #
+            self.assertEqual(int(self.Values[Run + '.structures']), 11)
+
+    def testMatchesReference(self):
+        Reference = self.GetReferenceValues()
+        for Key in sorted(Reference):
+            self.assertIn(Key, self.Values)
+            self.assertEqual(self.Values[Key], Reference[Key], 'Mismatch in %s' % Key)
+
+def TheTestSuite():
+    return unittest.TestLoader().loadTestsFromTestCase(SmbiosInitTests)
+
+if __name__ == '__main__':
+    unittest.TextTestRunner(verbosity=2).run(TheTestSuite())
@@ -0,0 +1,115 @@
+## @file
+# Utility functions and classes for BaseTools unit tests
+#
+# Copyright (c) 2008 - 2020, Intel Corporation. All rights reserved.<BR>
+#
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import os
+import platform
+import shutil
+import subprocess
+import tempfile
+import unittest
+
+TestsDir     = os.path.realpath(os.path.split(__file__)[0])
+HarnessDir   = os.path.join(TestsDir, 'Harness')
+WorkspaceDir = os.path.realpath(os.path.join(TestsDir, '..', '..'))
+
+#
+# Include directories every host harness is built with, relative to the workspace
+#
+HostIncludes = [
+  'MdePkg/Include',
+  'MdePkg/Include/X64',
+  'BootloaderCommonPkg/Include',
+  'BootloaderCorePkg/Include',
+  ]
+
+class HostHarnessTestCase(unittest.TestCase):
+    """Build firmware sources together with a host harness and run it.
+
+    The harness in Harness/ replaces the libraries and hardware the firmware
+    sources use, and prints its results as "key=value" lines.
+    """
+    Harness  = None
+    Sources  = []
+    Includes = []
+    Defines  = []
+    ForceIncludes = []
+    LinkFlags = []
+
+    def setUp(self):
+        if platform.machine().lower() not in ('x86_64', 'amd64'):
+            self.skipTest('host harness needs an x86_64 host')
+        self.Compiler = shutil.which('gcc')
+        if self.Compiler is None:
+            self.skipTest('gcc is not available')
+        self.WorkDir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        if hasattr(self, 'WorkDir'):
+            shutil.rmtree(self.WorkDir, ignore_errors=True)
+
+    def BuildHarness(self, Sources = None, Defines = None, Includes = None):
+        if Sources is None:
+            Sources = self.Sources
+        if Defines is None:
+            Defines = self.Defines
+        if Includes is None:
+            Includes = self.Includes
+        Output = os.path.join(self.WorkDir, '%s_%d' % (os.path.splitext(self.Harness)[0], len(os.listdir(self.WorkDir))))
+        Cmd = [self.Compiler, '-static', '-fshort-wchar', '-w', '-O1',
+               '-include', os.path.join(WorkspaceDir, 'MdePkg/Include/Base.h')]
+        for Inc in self.ForceIncludes:
+            Cmd.extend(['-include', os.path.join(HarnessDir, Inc)])
+        for Inc in Includes + HostIncludes:
+            Cmd.append('-I' + os.path.join(WorkspaceDir, Inc))
+        Cmd.extend(['-D' + Define for Define in Defines])
+        Cmd.append(os.path.join(HarnessDir, self.Harness))
+        Cmd.extend([Src if os.path.isabs(Src) else os.path.join(WorkspaceDir, Src) for Src in Sources])
+        Cmd.extend(self.LinkFlags)
+        Cmd.extend(['-o', Output])
+        Result = subprocess.run(Cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        self.assertEqual(Result.returncode, 0, 'Failed to build %s:\n%s' % (self.Harness, Result.stdout))
+        return Output
+
+    def GetRepoFile(self, Path, Revision, Target = None):
+        """Extract a source file at a git revision into the work directory.
+
+        The file is written to Target, or to its base name when Target is
+        not given, below a directory for the revision.
+
+        Skips the test if git or the revision is not available, e.g. in a
+        source snapshot without history.
+        """
+        Git = shutil.which('git')
+        if Git is None:
+            self.skipTest('git is not available')
+        Result = subprocess.run([Git, '-C', WorkspaceDir, 'show', '%s:%s' % (Revision, Path)],
+                                stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        if Result.returncode != 0:
+            self.skipTest('%s is not available at %s' % (Path, Revision))
+        if Target is None:
+            Target = os.path.basename(Path)
+        Output = os.path.join(self.WorkDir, Revision[:12], Target)
+        if not os.path.isdir(os.path.dirname(Output)):
+            os.makedirs(os.path.dirname(Output))
+        with open(Output, 'wb') as File:
+            File.write(Result.stdout)
+        return Output
+
+    def RunHarness(self, Program, Args = []):
+        Result = subprocess.run([Program] + list(Args), stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                universal_newlines=True)
+        self.assertEqual(Result.returncode, 0, 'Harness %s failed:\n%s' % (self.Harness, Result.stdout))
+        Values = {}
+        for Line in Result.stdout.splitlines():
+            if '=' in Line:
+                Key, Value = Line.split('=', 1)
+                Values[Key.strip()] = Value.strip()
+        return Values
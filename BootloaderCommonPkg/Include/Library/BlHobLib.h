@@ -0,0 +1,59 @@
+/** @file
+
+  Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __BL_HOB_LIB_H__
+#define __BL_HOB_LIB_H__
+
+#include <Library/HobLib.h>
+
+///
+/// Maximum number of HOB lists that can be indexed at the same time
+///
+#define  HOB_GUID_INDEX_MAX         2
+
+///
+/// GUID HOB lookup counters
+///
+typedef struct {
+  UINT32                IndexedLookups;    // GUID HOB lookups served by an index, HOB walks saved
+  UINT32                WalkedLookups;     // GUID HOB lookups that walked a HOB list not indexed
+} HOB_GUID_INDEX_STATS;
+
+/**
+  Build a sorted GUID index for a HOB list.
+
+  GetNextGuidHob () and GetFirstGuidHob () use the index for any lookup starting
+  inside the indexed list. HOBs appended to the list after the index was built
+  are still found by walking the part of the list that follows the indexed HOBs.
+  The HOBs already in the list must not be removed or changed afterwards.
+
+  @param[in]  HobList         The HOB list to index.
+
+  @retval EFI_SUCCESS             The index was built or already exists.
+  @retval EFI_INVALID_PARAMETER   HobList is NULL.
+  @retval EFI_OUT_OF_RESOURCES    No free index slot or not enough memory.
+
+**/
+EFI_STATUS
+EFIAPI
+BuildGuidHobIndex (
+  IN CONST VOID            *HobList
+  );
+
+/**
+  Get the GUID HOB lookup counters.
+
+  @retval   Pointer to the GUID HOB lookup counters.
+
+**/
+CONST HOB_GUID_INDEX_STATS *
+EFIAPI
+GetGuidHobIndexStats (
+  VOID
+  );
+
+#endif
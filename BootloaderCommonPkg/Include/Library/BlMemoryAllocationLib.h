@@ -16,6 +16,23 @@ typedef struct {
   UINT32                Type;
 } EFI_MEMORY_RANGE_ENTRY;
 
+///
+/// Call count and latency in time stamp ticks of one allocation operation
+///
+typedef struct {
+  UINT32                Count;
+  UINT32                Reserved;
+  UINT64                TotalTicks;
+  UINT64                MaxTicks;
+} MEMORY_ALLOCATION_COUNTER;
+
+typedef struct {
+  MEMORY_ALLOCATION_COUNTER   AllocatePool;
+  MEMORY_ALLOCATION_COUNTER   FreePool;
+  MEMORY_ALLOCATION_COUNTER   AllocatePages;
+  MEMORY_ALLOCATION_COUNTER   FreePages;
+} MEMORY_ALLOCATION_STATS;
+
 /**
   This function allocates temporary memory pool.
 
@@ -51,6 +51,26 @@ typedef struct {
 
 typedef VOID (*LOAD_COMPONENT_CALLBACK) (UINT32 ProgressId, COMPONENT_CALLBACK_INFO *CbInfo);
 
+typedef struct {
+  UINT32                   ComponentId;
+  UINT32                   Usage;
+  UINT8                    AuthType;
+  BOOLEAN                  IsInFlash;
+  BOOLEAN                  AllocCompBase;
+  UINT8                    Reserved;
+  UINT32                   SignedDataLen;
+  UINT32                   DecompressedLen;
+  UINT32                   AllocLen;
+  UINT8                   *CompData;
+  UINT8                   *CompBuf;
+  UINT8                   *HashData;
+  VOID                    *ScrBuf;
+  VOID                    *AllocBuf;
+  VOID                    *CompBase;
+  EFI_STATUS               AuthStatus;
+  COMPONENT_CALLBACK_INFO  CbInfo;
+} COMPONENT_LOAD_CONTEXT;
+
 typedef struct {
   UINT32           Signature;
   UINT32           HeaderCache;
@@ -117,6 +137,81 @@ LoadComponentWithCallback (
   IN     LOAD_COMPONENT_CALLBACK  LoadComponentCallback
   );
 
+/**
+  Locate a component from a container or flash map and reserve all memory
+  required to load it.
+
+  All memory allocation for the component load happens here, so that the
+  following ExecuteComponentLoad () does not touch the memory pool.
+
+  @param[in]     ContainerSig    Container signature or component type.
+  @param[in]     ComponentName   Component name.
+  @param[in]     Buffer          Required component base, or NULL to allocate one.
+  @param[in]     Length          Size of the required component base, 0 if unknown.
+  @param[out]    LoadCtx         Pointer to receive the component load context.
+
+  @retval EFI_UNSUPPORTED          Unsupported AuthType or compression.
+  @retval EFI_NOT_FOUND            Cannot locate component.
+  @retval EFI_BUFFER_TOO_SMALL     Specified buffer size is too small.
+  @retval EFI_OUT_OF_RESOURCES     Not enough memory to load the component.
+  @retval EFI_SUCCESS              The component is ready to be loaded.
+
+**/
+EFI_STATUS
+EFIAPI
+PrepareComponentLoad (
+  IN     UINT32                   ContainerSig,
+  IN     UINT32                   ComponentName,
+  IN     VOID                    *Buffer,
+  IN     UINT32                   Length,
+  OUT    COMPONENT_LOAD_CONTEXT  *LoadCtx
+  );
+
+/**
+  Copy, authenticate and decompress a component prepared by
+  PrepareComponentLoad ().
+
+  This function does not allocate memory. When called without a callback for a
+  component authenticated by hash, it only reads the loader data and can be
+  executed on an AP.
+
+  @param[in,out] LoadCtx         Component load context.
+  @param[in]     LoadComponentCallback  Callback function pointer.
+
+  @retval EFI_UNSUPPORTED          Unsupported AuthType.
+  @retval EFI_SECURITY_VIOLATION   Authentication failed.
+  @retval EFI_OUT_OF_RESOURCES     No memory was reserved for the component.
+  @retval EFI_SUCCESS              The component has been loaded.
+
+**/
+EFI_STATUS
+EFIAPI
+ExecuteComponentLoad (
+  IN OUT COMPONENT_LOAD_CONTEXT  *LoadCtx,
+  IN     LOAD_COMPONENT_CALLBACK  LoadComponentCallback
+  );
+
+/**
+  Release the temporary memory used by a component load and return the loaded
+  component.
+
+  @param[in]     LoadCtx         Component load context.
+  @param[in]     LoadStatus      Status returned by ExecuteComponentLoad ().
+  @param[in,out] Buffer          Pointer to receive component base.
+  @param[in,out] Length          Pointer to receive component size.
+
+  @retval        LoadStatus
+
+**/
+EFI_STATUS
+EFIAPI
+FinishComponentLoad (
+  IN     COMPONENT_LOAD_CONTEXT  *LoadCtx,
+  IN     EFI_STATUS               LoadStatus,
+  IN OUT VOID                   **Buffer,
+  IN OUT UINT32                  *Length
+  );
+
 /**
   Locate a component region information from a container or flash map.
 
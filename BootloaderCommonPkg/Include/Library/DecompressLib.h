@@ -18,6 +18,21 @@
 #define  LZ_SIGNATURE_16    SIGNATURE_16 ('L', 'Z')
 #define  IS_COMPRESSED(x)   (*(UINT16 *)(UINTN)(x) == LZ_SIGNATURE_16)
 
+#define  BLOCK_STREAM_MARKER  0xFFFFFFFF
+
+///
+/// Header of a block stream generated by the LZ4/LZMA compress tools in block
+/// mode. It is followed by UINT32 CompressedSize[BlockCount] and then by the
+/// blocks, each of them a regular compressed stream of at most BlockSize bytes
+/// once decompressed.
+///
+typedef struct {
+  UINT32    Marker;
+  UINT32    DecompressedSize;
+  UINT32    BlockSize;
+  UINT32    BlockCount;
+} BLOCK_STREAM_HEADER;
+
 
 /**
   Given a Lzma compressed source buffer, this function retrieves the size of
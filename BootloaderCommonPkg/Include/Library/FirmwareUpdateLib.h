@@ -53,6 +53,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define CAPSULE_FLAG_FORCE_BIOS_UPDATE    BIT31
 
+#define DELTA_IMAGE_SIGNATURE             SIGNATURE_32('$', 'D', 'L', 'T')
+#define DELTA_IMAGE_VERSION               1
+
+#define DELTA_IMAGE_CMD_COPY              1
+#define DELTA_IMAGE_CMD_DATA              2
+
 typedef enum {
   TopSwapSet,
   TopSwapClear
@@ -115,6 +121,37 @@ typedef struct {
   UINT64                      UpdateHardwareInstance;
 } EFI_FW_MGMT_CAP_IMAGE_HEADER;
 
+//
+// Delta image header for firmware update
+// A delta image is placed in the capsule payload in place of the full
+// component image. The target image is rebuilt in memory from the base
+// image currently on flash, followed by DELTA_IMAGE_CMD entries.
+//
+typedef struct {
+  UINT32                      Signature;
+  UINT16                      HeaderSize;
+  UINT8                       Version;
+  UINT8                       HashAlg;
+  UINT32                      BaseSize;
+  UINT32                      TargetSize;
+  UINT32                      CmdCount;
+  UINT32                      Reserved;
+  UINT8                       BaseHash[HASH_DIGEST_MAX];
+  UINT8                       TargetHash[HASH_DIGEST_MAX];
+} DELTA_IMAGE_HEADER;
+
+//
+// Delta image command
+// COPY: copy Length bytes from base image at BaseOffset
+// DATA: copy Length bytes following this command, padded to 4 bytes
+//
+typedef struct {
+  UINT16                      Command;
+  UINT16                      Reserved;
+  UINT32                      Length;
+  UINT32                      BaseOffset;
+} DELTA_IMAGE_CMD;
+
 //
 // Region information for firmware update
 //
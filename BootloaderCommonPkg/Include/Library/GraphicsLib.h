@@ -55,11 +55,46 @@ typedef struct {
 extern EFI_NARROW_GLYPH gUsStdNarrowGlyphData[];
 extern UINT32 mNarrowFontSize;
 
+//
+// Pre-converted splash image in frame buffer native BGRA layout.
+// Lines are stored top-down. With FB_SPLASH_COMPRESS_RLE each line is a
+// sequence of UINT32 control words: bits[30:0] give the pixel count and
+// BIT31 marks a run of a single pixel value that follows, otherwise the
+// pixels follow literally.
+//
+#define FB_SPLASH_SIGNATURE         SIGNATURE_32 ('$', 'F', 'B', 'S')
+#define FB_SPLASH_COMPRESS_NONE     0
+#define FB_SPLASH_COMPRESS_RLE      1
+#define FB_SPLASH_RLE_RUN           BIT31
+
+typedef struct {
+  UINT32                        Signature;
+  UINT16                        HeaderSize;
+  UINT8                         Compression;
+  UINT8                         Reserved;
+  UINT32                        PixelWidth;
+  UINT32                        PixelHeight;
+  UINT32                        DataSize;
+} FB_SPLASH_HEADER;
+
 typedef struct {
   EFI_PEI_GRAPHICS_INFO_HOB     *GfxInfoHob;
   CHAR8                         *TextDisplayBuf;
-  CHAR8                         *TextSwapBuf;
   CHAR8                         *TextDrawBuf;
+  //
+  // Shadow copy of the console area in system memory. Glyphs are rendered
+  // into it and the dirty rectangle is flushed to the frame buffer in one
+  // pass. GlyphRowAtlas holds every possible glyph row pre-expanded into
+  // GLYPH_WIDTH pixels using the console colors.
+  //
+  UINT32                        *ShadowBuf;
+  UINT32                        *GlyphRowAtlas;
+  UINTN                         ShadowWidth;
+  UINTN                         ShadowHeight;
+  UINTN                         DirtyLeft;
+  UINTN                         DirtyTop;
+  UINTN                         DirtyRight;
+  UINTN                         DirtyBottom;
   UINTN                         OffX;
   UINTN                         OffY;
   UINTN                         Width;
@@ -77,7 +112,7 @@ typedef struct {
   Verify a BMP image header and determine its centralized display location
   on screen.
 
-  @param  BmpImage      Pointer to BMP file
+  @param  BmpImage      Pointer to BMP file or frame buffer splash image
   @param  OffX          Pointer to receive X offset for BMP display position.
   @param  OffY          Pointer to receive Y offset for BMP display position.
   @param  GfxInfoHob    Pointer to graphics info HOB.
@@ -100,7 +135,7 @@ GetBmpDisplayPos (
   GopBlt buffer is passed in, the BMP image will be displayed into BLT memory
   buffer. Otherwise, it will be dispalyed into the actual frame buffer.
 
-  @param  BmpImage      Pointer to BMP file
+  @param  BmpImage      Pointer to BMP file or frame buffer splash image
   @param  GopBlt        Buffer for transferring BmpImage to the BLT memory buffer.
   @param  GopBltSize    Size of GopBlt in bytes.
   @param  GfxInfoHob    Pointer to graphics info HOB.
@@ -120,6 +155,54 @@ DisplayBmpToFrameBuffer (
   IN  EFI_PEI_GRAPHICS_INFO_HOB *GfxInfoHob
   );
 
+/**
+  Verify a pre-converted frame buffer splash image header and determine its
+  centralized display location on screen.
+
+  @param  SplashImage   Pointer to the frame buffer splash image
+  @param  OffX          Pointer to receive X offset for display position.
+  @param  OffY          Pointer to receive Y offset for display position.
+  @param  GfxInfoHob    Pointer to graphics info HOB.
+
+  @retval EFI_SUCCESS           The display position is returned.
+  @retval EFI_UNSUPPORTED       SplashImage is not a valid frame buffer splash image
+  @retval EFI_INVALID_PARAMETER The image does not fit on the screen
+**/
+EFI_STATUS
+EFIAPI
+GetFbSplashDisplayPos (
+  IN     VOID    *SplashImage,
+  OUT  UINT32    *OffX,          OPTIONAL
+  OUT  UINT32    *OffY,          OPTIONAL
+  IN   EFI_PEI_GRAPHICS_INFO_HOB *GfxInfoHob
+  );
+
+/**
+  Display a pre-converted frame buffer splash image to the frame buffer or
+  BLT buffer. If a NULL GopBlt buffer is passed in, the image is written
+  into the actual frame buffer. Otherwise, it is written into GopBlt with
+  lines stored bottom-up so that GopBlt can back a 32-bit BMP image.
+
+  @param  SplashImage   Pointer to the frame buffer splash image
+  @param  GopBlt        Buffer for transferring the image to the BLT memory buffer.
+  @param  GopBltSize    Size of GopBlt in bytes.
+  @param  GfxInfoHob    Pointer to graphics info HOB.
+
+  @retval EFI_SUCCESS           The image was displayed.
+  @retval EFI_UNSUPPORTED       SplashImage is not a valid frame buffer splash image
+  @retval EFI_BUFFER_TOO_SMALL  The passed in GopBlt buffer is not big enough.
+  @retval EFI_COMPROMISED_DATA  The compressed image data is malformed.
+
+**/
+EFI_STATUS
+EFIAPI
+DisplayFbSplashToFrameBuffer (
+  IN  VOID      *SplashImage,
+  IN  VOID      *GopBlt,
+  IN  UINTN      GopBltSize,
+  IN  EFI_PEI_GRAPHICS_INFO_HOB *GfxInfoHob
+  );
+
 /**
   Copy image into frame buffer.
 
@@ -10,6 +10,12 @@
 
 typedef CHAR8 * (EFIAPI *PERF_ID_TO_STR) (UINT32 Id);
 
+//
+// Stage2 measure point Ids are multiples of 0x10. BIT0 is set on the
+// Stage2 initialization phases that form the critical path.
+//
+#define  PERF_ID_CRITICAL_PATH        BIT0
+
 /**
   Add a given performance measure point timestamp.
 
@@ -123,6 +123,52 @@ CreateIdentityMappingPageTables (
   IN  UINT8         RequestedAddressBits
   );
 
+/**
+  Create 1:1 Virtual to Physical mapping page tables that are populated on demand.
+
+  Only the low 4GB and the 1GB regions covering Ranges are mapped up front.
+  Other addresses below the physical address limit are mapped one 1GB region
+  at a time by HandleIdentityMappingPageFault() out of SparePages spare pages
+  reserved together with the page tables.
+
+  @param[in] RequestedAddressBits   Same as CreateIdentityMappingPageTables().
+  @param[in] Ranges                 Address ranges to map up front. Only Start and
+                                    Limit are used.
+  @param[in] RangeCount             Number of entries in Ranges.
+  @param[in] SparePages             Number of pages reserved for on demand mapping.
+
+  @retval    EFI_SUCCESS            Page table was created successfully.
+  @retval    EFI_OUT_OF_RESOURCES   Failed to allocate page buffer
+
+**/
+EFI_STATUS
+EFIAPI
+CreateLazyIdentityMappingPageTables (
+  IN  UINT8         RequestedAddressBits,
+  IN  MAP_RANGE    *Ranges,     OPTIONAL
+  IN  UINT32        RangeCount,
+  IN  UINT32        SparePages
+  );
+
+/**
+  Map the 1GB region containing a faulting address into the current on demand
+  page tables created by CreateLazyIdentityMappingPageTables().
+
+  @param[in] FaultAddress           Page fault linear address from CR2.
+  @param[in] ErrorCode              Page fault error code.
+
+  @retval    EFI_SUCCESS            The region is mapped, the access can be retried.
+  @retval    EFI_UNSUPPORTED        The fault is not caused by a lazily mapped region.
+  @retval    EFI_OUT_OF_RESOURCES   No spare page is left to map the region.
+
+**/
+EFI_STATUS
+EFIAPI
+HandleIdentityMappingPageFault (
+  IN  UINT64        FaultAddress,
+  IN  UINTN         ErrorCode
+  );
+
 /**
   ASM inline function Paging32.nasm - Enable Paging
   Set Page Global Enable (Set PGE in CR4)
@@ -17,6 +17,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 
 #define UEFI_VARIABLE_INDEX_TABLE_VOLUME 122
+
+///
+/// Number of slots in the variable name hash table, a power of 2 larger than
+/// twice UEFI_VARIABLE_INDEX_TABLE_VOLUME.
+///
+#define UEFI_VARIABLE_HASH_TABLE_SIZE    256
 ///
 /// Variable data start flag.
 ///
@@ -144,6 +150,26 @@ typedef struct {
   UINT16          Index[UEFI_VARIABLE_INDEX_TABLE_VOLUME];
 } UEFI_VARIABLE_INDEX_TABLE;
 
+typedef struct {
+  ///
+  /// Hash of the variable vendor GUID and name.
+  ///
+  UINT32          Hash;
+  ///
+  /// Offset of the variable from UEFI_VARIABLE_INDEX_TABLE.StartPtr plus 1, 0 for a free slot.
+  ///
+  UINT32          Offset;
+} UEFI_VARIABLE_HASH_ENTRY;
+
+///
+/// Open addressing hash table over the variables recorded in UEFI_VARIABLE_INDEX_TABLE.
+/// It is only built once the index table covers the whole variable store.
+///
+typedef struct {
+  UINT32                    Ready;
+  UEFI_VARIABLE_HASH_ENTRY  Entry[UEFI_VARIABLE_HASH_TABLE_SIZE];
+} UEFI_VARIABLE_HASH_TABLE;
+
 //
 // FTW Last write data. It will be used as gEdkiiFaultTolerantWriteGuid GUID hob data.
 //
@@ -166,6 +192,7 @@ typedef struct {
 typedef struct {
   UEFI_VARIABLE_STORE_HEADER                   *VariableStoreHeader;
   UEFI_VARIABLE_INDEX_TABLE                    *IndexTable;
+  UEFI_VARIABLE_HASH_TABLE                     *HashTable;
   //
   // If it is not NULL, it means there may be an inconsecutive variable whose
   // partial content is still in NV storage, but another partial content is backed up
@@ -230,6 +257,7 @@ typedef struct {
 typedef struct {
   UEFI_FAULT_TOLERANT_WRITE_LAST_WRITE_DATA   FtwLastWriteData;
   UEFI_VARIABLE_INDEX_TABLE                   IndexTable;
+  UEFI_VARIABLE_HASH_TABLE                    HashTable;
   UEFI_VARIABLE_HEADER                        VariableHdr;
   BOOLEAN                                     StoreLibVarHdrSet;
 } UEFI_VAR_STORE_LIBRARY_DATA;
@@ -9,6 +9,17 @@
 #ifndef _VAIRABLE_LIB_H_
 #define _VAIRABLE_LIB_H_
 
+///
+/// Variable store reclaim statistics
+///
+typedef struct {
+  UINT32                ReclaimCount;          // Reclaims done, inline or deferred
+  UINT32                InlineEraseCount;      // Bank erases a reclaim had to wait for
+  UINT32                DeferredEraseCount;    // Bank erases done by CompactVariableStore ()
+  UINT32                Reserved;
+  UINT64                ReclaimTicks;          // Total time stamp counter ticks spent in reclaims
+} VARIABLE_STORE_STATS;
+
 
 /**
 
@@ -110,7 +121,8 @@ SetVariable (
 
 /**
   Initialize an varaible instance.
-  Base needs to be 4KB aligned and Size needs to be 8KB aligned.
+  Base needs to be 4KB aligned and Size needs to be a multiple of
+  4KB times the number of variable store banks.
 
   @param     Base         Variable storage region base
   @param     Size         Variable storage region size
@@ -124,4 +136,40 @@ VariableConstructor (
   IN  UINT32    Size
   );
 
+/**
+  Perform the deferred variable store maintenance.
+
+  Stale banks left behind by earlier reclaims are erased so that the next
+  reclaim only has to copy the live variables. The active bank is compacted
+  ahead of time when less than a quarter of it is free, or whenever it holds
+  obsolete variables if Force is TRUE.
+
+  @param[in]  Force         Compact the active bank whenever it can be shrunk.
+
+  @retval     EFI_SUCCESS             Variable store maintenance completed.
+  @retval     EFI_NOT_READY           Variable service is not initialized.
+  @retval     EFI_VOLUME_CORRUPTED    No valid active variable store.
+  @retval     Others                  Flash erase or write failed.
+**/
+EFI_STATUS
+EFIAPI
+CompactVariableStore (
+  IN BOOLEAN    Force
+  );
+
+/**
+  Get the variable store reclaim statistics.
+
+  @param[out] Stats         Pointer to receive the statistics.
+
+  @retval     EFI_SUCCESS             The statistics were returned.
+  @retval     EFI_INVALID_PARAMETER   Stats is NULL.
+  @retval     EFI_NOT_READY           Variable service is not initialized.
+**/
+EFI_STATUS
+EFIAPI
+GetVariableStoreStats (
+  OUT VARIABLE_STORE_STATS  *Stats
+  );
+
 #endif
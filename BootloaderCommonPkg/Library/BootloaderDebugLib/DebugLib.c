@@ -11,6 +11,7 @@
 #include <Library/PrintLib.h>
 #include <Library/PcdLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/SynchronizationLib.h>
 #include <Library/SerialPortLib.h>
 #include <Library/DebugPortLib.h>
 #include <Library/DebugLogBufferLib.h>
@@ -23,6 +24,12 @@
 //
 #define MAX_DEBUG_MESSAGE_LENGTH  0x100
 
+//
+// Serializes debug output from phases running on APs with the BSP.
+// Only touched from Stage2 and the payload since earlier stages can be XIP.
+//
+STATIC volatile UINT32  mDebugPrintLock = 0;
+
 /**
   Prints a debug message to the debug output device if the specified error level is enabled.
 
@@ -50,6 +57,7 @@ DebugPrint (
   VA_LIST  Marker;
   UINTN    Length;
   BOOLEAN  OutputToSerial;
+  BOOLEAN  MultiProcessor;
 
 
   //
@@ -73,6 +81,13 @@ DebugPrint (
 
   Length = AsciiStrLen (Buffer);
 
+  MultiProcessor = (GetLoaderStage () >= LOADER_STAGE_2) ? TRUE : FALSE;
+  if (MultiProcessor) {
+    while (InterlockedCompareExchange32 ((UINT32 *)&mDebugPrintLock, 0, 1) != 0) {
+      CpuPause ();
+    }
+  }
+
   //
   // Send the print string to debug output handler
   //
@@ -98,6 +113,10 @@ DebugPrint (
   if (PcdGet32 (PcdDebugOutputDeviceMask) & DEBUG_OUTPUT_DEVICE_DEBUG_PORT) {
     DebugPortWrite ((UINT8 *)Buffer, Length);
   }
+
+  if (MultiProcessor) {
+    InterlockedCompareExchange32 ((UINT32 *)&mDebugPrintLock, 1, 0);
+  }
 }
 
 /**
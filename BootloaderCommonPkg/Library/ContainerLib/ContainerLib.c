@@ -686,30 +686,33 @@ LocateComponent (
 }
 
 /**
-  Load a component from a container or flahs map to memory and call callback
-  function at predefined point.
+  Locate a component from a container or flash map and reserve all memory
+  required to load it.
+
+  All memory allocation for the component load happens here, so that the
+  following ExecuteComponentLoad () does not touch the memory pool.
 
   @param[in]     ContainerSig    Container signature or component type.
   @param[in]     ComponentName   Component name.
-  @param[in,out] Buffer          Pointer to receive component base.
-  @param[in,out] Length          Pointer to receive component size.
-  @param[in,out] LoadComponentCallback  Callback function pointer.
+  @param[in]     Buffer          Required component base, or NULL to allocate one.
+  @param[in]     Length          Size of the required component base, 0 if unknown.
+  @param[out]    LoadCtx         Pointer to receive the component load context.
 
-  @retval EFI_UNSUPPORTED          Unsupported AuthType.
+  @retval EFI_UNSUPPORTED          Unsupported AuthType or compression.
   @retval EFI_NOT_FOUND            Cannot locate component.
   @retval EFI_BUFFER_TOO_SMALL     Specified buffer size is too small.
-  @retval EFI_SECURITY_VIOLATION   Authentication failed.
-  @retval EFI_SUCCESS              Authentication succeeded.
+  @retval EFI_OUT_OF_RESOURCES     Not enough memory to load the component.
+  @retval EFI_SUCCESS              The component is ready to be loaded.
 
 **/
 EFI_STATUS
 EFIAPI
-LoadComponentWithCallback (
+PrepareComponentLoad (
   IN     UINT32                   ContainerSig,
   IN     UINT32                   ComponentName,
-  IN OUT VOID                   **Buffer,
-  IN OUT UINT32                  *Length,
-  IN     LOAD_COMPONENT_CALLBACK  LoadComponentCallback
+  IN     VOID                    *Buffer,
+  IN     UINT32                   Length,
+  OUT    COMPONENT_LOAD_CONTEXT  *LoadCtx
   )
 {
   EFI_STATUS                Status;
@@ -718,28 +721,16 @@ LoadComponentWithCallback (
   CONTAINER_ENTRY          *ContainerEntry;
   COMPONENT_ENTRY          *CompEntry;
   UINT8                    *CompData;
-  UINT8                    *CompBuf;
-  UINT8                    *HashData;
-  VOID                     *CompBase;
-  VOID                     *ScrBuf;
-  VOID                     *AllocBuf;
-  VOID                     *ReqCompBase;
-  UINT32                    Usage;
-  UINT8                     AuthType;
-  UINT32                    DecompressedLen;
   UINT32                    CompLen;
   UINT32                    CompLoc;
   UINT32                    AllocLen;
-  UINT32                    SignedDataLen;
   UINT32                    DstLen;
   UINT32                    ScrLen;
-  BOOLEAN                   IsInFlash;
-  COMPONENT_CALLBACK_INFO   CbInfo;
-  UINT32                    ComponentId;
   UINT64                    ContainerIdBuf;
   UINT64                    ComponentIdBuf;
 
-  ComponentId = ContainerSig;
+  ZeroMem (LoadCtx, sizeof (COMPONENT_LOAD_CONTEXT));
+  LoadCtx->ComponentId = ContainerSig;
   CompLoc = 0;
 
   ComponentIdBuf = ComponentName;
@@ -752,8 +743,7 @@ LoadComponentWithCallback (
 
   if (ContainerSig < COMP_TYPE_INVALID) {
     // Check if it is component type
-    Usage        =  1 << ContainerSig;
-    ContainerSig = 0;
+    LoadCtx->Usage = 1 << ContainerSig;
     Status = GetComponentInfo (ComponentName, &CompLoc, &CompLen);
     if (EFI_ERROR (Status)) {
       return EFI_NOT_FOUND;
@@ -761,16 +751,16 @@ LoadComponentWithCallback (
     CompData = (VOID *)(UINTN)CompLoc;
     if (FeaturePcdGet (PcdVerifiedBootEnabled)) {
       if(FixedPcdGet8(PcdCompSignHashAlg) == HASH_TYPE_SHA256) {
-        AuthType = AUTH_TYPE_SHA2_256;
+        LoadCtx->AuthType = AUTH_TYPE_SHA2_256;
       } else if (FixedPcdGet8(PcdCompSignHashAlg) == HASH_TYPE_SHA384) {
-        AuthType = AUTH_TYPE_SHA2_384;
+        LoadCtx->AuthType = AUTH_TYPE_SHA2_384;
       } else {
         return EFI_UNSUPPORTED;
       }
     } else {
-      AuthType = AUTH_TYPE_NONE;
+      LoadCtx->AuthType = AUTH_TYPE_NONE;
     }
-    HashData = NULL;
+    LoadCtx->HashData = NULL;
   } else {
     // Find the component info
     Status = LocateComponentEntry (ContainerSig, ComponentName, &ContainerEntry, &CompEntry);
@@ -788,17 +778,13 @@ LoadComponentWithCallback (
 
     // Collect component info
     ContainerHdr = (CONTAINER_HDR *)(UINTN)ContainerEntry->HeaderCache;
-    AuthType  = CompEntry->AuthType;
-    HashData  = CompEntry->HashData;
-    Usage     = 0;
+    LoadCtx->AuthType = CompEntry->AuthType;
+    LoadCtx->HashData = CompEntry->HashData;
+    LoadCtx->Usage    = 0;
     CompData  = (UINT8 *)(UINTN)(ContainerEntry->Base + ContainerHdr->DataOffset + CompEntry->Offset);
     CompLen   = CompEntry->Size;
   }
 
-  if (LoadComponentCallback != NULL) {
-    LoadComponentCallback (PROGESS_ID_LOCATE, NULL);
-  }
-
   // Component must have LOADER_COMPRESSED_HEADER
   Status = EFI_UNSUPPORTED;
   CompressHdr  = (LOADER_COMPRESSED_HEADER *)CompData;
@@ -806,14 +792,14 @@ LoadComponentWithCallback (
     return EFI_NOT_FOUND;
   }
 
+  DstLen = 0;
+  ScrLen = 0;
   if (IS_COMPRESSED (CompressHdr)) {
-    SignedDataLen = sizeof (LOADER_COMPRESSED_HEADER) + CompressHdr->CompressedSize;
+    LoadCtx->SignedDataLen = sizeof (LOADER_COMPRESSED_HEADER) + CompressHdr->CompressedSize;
     if (CompressHdr->Size == 0) {
       Status = EFI_SUCCESS;
-      DstLen = 0;
-      ScrLen = 0;
     } else {
-      if (SignedDataLen <= CompLen) {
+      if (LoadCtx->SignedDataLen <= CompLen) {
         Status = DecompressGetInfo (CompressHdr->Signature, CompressHdr->Data,
                                     CompressHdr->CompressedSize, &DstLen, &ScrLen);
       }
@@ -824,100 +810,210 @@ LoadComponentWithCallback (
   }
 
   // If it is required to use an existing buffer, verify the size
-  ReqCompBase = NULL;
-  DecompressedLen = CompressHdr->Size;
-  if ((Buffer != NULL) && (*Buffer != NULL)) {
-    ReqCompBase = *Buffer;
-    if ((Length != NULL) && (*Length != 0) && (*Length < DecompressedLen)) {
+  LoadCtx->DecompressedLen = CompressHdr->Size;
+  if (Buffer != NULL) {
+    if ((Length != 0) && (Length < LoadCtx->DecompressedLen)) {
       return EFI_BUFFER_TOO_SMALL;
     }
   }
 
   // If it is on flash, the data needs to be copied into memory first
   // before authentication for security concern.
-  IsInFlash = IS_FLASH_ADDRESS (CompData);
+  LoadCtx->CompData  = CompData;
+  LoadCtx->IsInFlash = IS_FLASH_ADDRESS (CompData);
   AllocLen  = ScrLen + TEMP_BUF_ALIGN * 2;
-  if (IsInFlash) {
-    AllocLen += SignedDataLen;
+  if (LoadCtx->IsInFlash) {
+    AllocLen += LoadCtx->SignedDataLen;
   }
-  AllocBuf = AllocateTemporaryMemory (AllocLen);
-  if (AllocBuf == NULL) {
+  LoadCtx->AllocBuf = AllocateTemporaryMemory (AllocLen);
+  if (LoadCtx->AllocBuf == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
-  if (IsInFlash) {
-    // Authenticate component and decompress it if required
-    CompBuf = AllocBuf;
-    ScrBuf  = (UINT8 *)AllocBuf + ALIGN_UP (SignedDataLen, TEMP_BUF_ALIGN);
-    CopyMem (CompBuf, CompData, SignedDataLen);
+  LoadCtx->AllocLen = AllocLen;
+  if (LoadCtx->IsInFlash) {
+    LoadCtx->CompBuf = LoadCtx->AllocBuf;
+    LoadCtx->ScrBuf  = (UINT8 *)LoadCtx->AllocBuf + ALIGN_UP (LoadCtx->SignedDataLen, TEMP_BUF_ALIGN);
+  } else {
+    LoadCtx->CompBuf = CompData;
+    LoadCtx->ScrBuf  = LoadCtx->AllocBuf;
+  }
+
+  if (Buffer == NULL) {
+    LoadCtx->CompBase      = AllocatePages (EFI_SIZE_TO_PAGES ((UINTN) LoadCtx->DecompressedLen));
+    LoadCtx->AllocCompBase = TRUE;
+  } else {
+    LoadCtx->CompBase      = Buffer;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Copy, authenticate and decompress a component prepared by
+  PrepareComponentLoad ().
+
+  This function does not allocate memory. When called without a callback for a
+  component authenticated by hash, it only reads the loader data and can be
+  executed on an AP.
+
+  @param[in,out] LoadCtx         Component load context.
+  @param[in]     LoadComponentCallback  Callback function pointer.
+
+  @retval EFI_UNSUPPORTED          Unsupported AuthType.
+  @retval EFI_SECURITY_VIOLATION   Authentication failed.
+  @retval EFI_OUT_OF_RESOURCES     No memory was reserved for the component.
+  @retval EFI_SUCCESS              The component has been loaded.
+
+**/
+EFI_STATUS
+EFIAPI
+ExecuteComponentLoad (
+  IN OUT COMPONENT_LOAD_CONTEXT  *LoadCtx,
+  IN     LOAD_COMPONENT_CALLBACK  LoadComponentCallback
+  )
+{
+  EFI_STATUS                Status;
+  LOADER_COMPRESSED_HEADER *CompressHdr;
+
+  if (LoadCtx->IsInFlash) {
+    CopyMem (LoadCtx->CompBuf, LoadCtx->CompData, LoadCtx->SignedDataLen);
     if (LoadComponentCallback != NULL) {
       LoadComponentCallback (PROGESS_ID_COPY, NULL);
     }
-  } else {
-    CompBuf = CompData;
-    ScrBuf  = AllocBuf;
   }
 
   // Verify the component
-  Status = AuthenticateComponent (CompBuf, SignedDataLen, AuthType,
-             CompData + ALIGN_UP(SignedDataLen, AUTH_DATA_ALIGN),  HashData, Usage);
+  Status = AuthenticateComponent (LoadCtx->CompBuf, LoadCtx->SignedDataLen, LoadCtx->AuthType,
+             LoadCtx->CompData + ALIGN_UP(LoadCtx->SignedDataLen, AUTH_DATA_ALIGN),  LoadCtx->HashData, LoadCtx->Usage);
+  LoadCtx->AuthStatus = Status;
+  if (Status == EFI_SUCCESS) {
+    // Update component Call back info after authenticaton is done
+    // This info will used by firmware stage to extend to TPM
+    LoadCtx->CbInfo.ComponentType    = LoadCtx->ComponentId;
+    LoadCtx->CbInfo.CompBuf          = LoadCtx->CompBuf;
+    LoadCtx->CbInfo.CompLen          = LoadCtx->SignedDataLen;
+    LoadCtx->CbInfo.HashAlg          = GetHashAlg(LoadCtx->AuthType);
+    LoadCtx->CbInfo.HashData         = LoadCtx->HashData;
+  }
   if (LoadComponentCallback != NULL) {
-    if(Status == EFI_SUCCESS){
-      // Update component Call back info after authenticaton is done
-      // This info will used by firmware stage to extend to TPM
-      CbInfo.ComponentType    = ComponentId;
-      CbInfo.CompBuf          = CompBuf;
-      CbInfo.CompLen          = SignedDataLen;
-      CbInfo.HashAlg          = GetHashAlg(AuthType);
-      CbInfo.HashData         = HashData;
-      LoadComponentCallback (PROGESS_ID_AUTHENTICATE, &CbInfo);
-    } else {
-      LoadComponentCallback (PROGESS_ID_AUTHENTICATE, NULL);
-    }
+    LoadComponentCallback (PROGESS_ID_AUTHENTICATE, (Status == EFI_SUCCESS) ? &LoadCtx->CbInfo : NULL);
   }
-  if (!EFI_ERROR (Status)) {
-    CompressHdr = (LOADER_COMPRESSED_HEADER *)CompBuf;
-    if (ReqCompBase == NULL) {
-      CompBase = AllocatePages (EFI_SIZE_TO_PAGES ((UINTN) DecompressedLen));
-    } else {
-      CompBase = ReqCompBase;
-    }
 
-    if (CompBase != NULL) {
-      Status = Decompress (CompressHdr->Signature, CompressHdr->Data, CompressHdr->CompressedSize,
-                           CompBase, ScrBuf);
-      if (LoadComponentCallback != NULL) {
-        LoadComponentCallback (PROGESS_ID_DECOMPRESS, NULL);
-      }
-      if (EFI_ERROR (Status)) {
-        if (ReqCompBase == NULL) {
-          FreePages (CompBase, EFI_SIZE_TO_PAGES ((UINTN) DecompressedLen));
-        }
-      }
-    } else {
-      if (CompressHdr->Size == 0) {
-        Status = EFI_BAD_BUFFER_SIZE;
-      } else {
-        Status = EFI_OUT_OF_RESOURCES;
-      }
+  if (EFI_ERROR (Status)) {
+    return EFI_SECURITY_VIOLATION;
+  }
+
+  CompressHdr = (LOADER_COMPRESSED_HEADER *)LoadCtx->CompBuf;
+  if (LoadCtx->CompBase == NULL) {
+    if (CompressHdr->Size == 0) {
+      return EFI_BAD_BUFFER_SIZE;
     }
+    return EFI_OUT_OF_RESOURCES;
+  }
 
-  } else {
-    Status = EFI_SECURITY_VIOLATION;
+  Status = Decompress (CompressHdr->Signature, CompressHdr->Data, CompressHdr->CompressedSize,
+                       LoadCtx->CompBase, LoadCtx->ScrBuf);
+  if (LoadComponentCallback != NULL) {
+    LoadComponentCallback (PROGESS_ID_DECOMPRESS, NULL);
   }
-  FreeTemporaryMemory (AllocBuf);
 
-  if (!EFI_ERROR (Status)) {
+  return Status;
+}
+
+/**
+  Release the temporary memory used by a component load and return the loaded
+  component.
+
+  @param[in]     LoadCtx         Component load context.
+  @param[in]     LoadStatus      Status returned by ExecuteComponentLoad ().
+  @param[in,out] Buffer          Pointer to receive component base.
+  @param[in,out] Length          Pointer to receive component size.
+
+  @retval        LoadStatus
+
+**/
+EFI_STATUS
+EFIAPI
+FinishComponentLoad (
+  IN     COMPONENT_LOAD_CONTEXT  *LoadCtx,
+  IN     EFI_STATUS               LoadStatus,
+  IN OUT VOID                   **Buffer,
+  IN OUT UINT32                  *Length
+  )
+{
+  if (EFI_ERROR (LoadStatus)) {
+    if (LoadCtx->AllocCompBase && (LoadCtx->CompBase != NULL)) {
+      FreePages (LoadCtx->CompBase, EFI_SIZE_TO_PAGES ((UINTN) LoadCtx->DecompressedLen));
+    }
+  }
+  FreeTemporaryMemory (LoadCtx->AllocBuf);
+
+  if (!EFI_ERROR (LoadStatus)) {
     if (Buffer != NULL) {
-      *Buffer = CompBase;
+      *Buffer = LoadCtx->CompBase;
     }
     if (Length != NULL) {
-      *Length = DecompressedLen;
+      *Length = LoadCtx->DecompressedLen;
     }
   }
 
-  return Status;
+  return LoadStatus;
 }
 
+/**
+  Load a component from a container or flahs map to memory and call callback
+  function at predefined point.
+
+  @param[in]     ContainerSig    Container signature or component type.
+  @param[in]     ComponentName   Component name.
+  @param[in,out] Buffer          Pointer to receive component base.
+  @param[in,out] Length          Pointer to receive component size.
+  @param[in,out] LoadComponentCallback  Callback function pointer.
+
+  @retval EFI_UNSUPPORTED          Unsupported AuthType.
+  @retval EFI_NOT_FOUND            Cannot locate component.
+  @retval EFI_BUFFER_TOO_SMALL     Specified buffer size is too small.
+  @retval EFI_SECURITY_VIOLATION   Authentication failed.
+  @retval EFI_SUCCESS              Authentication succeeded.
+
+**/
+EFI_STATUS
+EFIAPI
+LoadComponentWithCallback (
+  IN     UINT32                   ContainerSig,
+  IN     UINT32                   ComponentName,
+  IN OUT VOID                   **Buffer,
+  IN OUT UINT32                  *Length,
+  IN     LOAD_COMPONENT_CALLBACK  LoadComponentCallback
+  )
+{
+  EFI_STATUS                Status;
+  COMPONENT_LOAD_CONTEXT    LoadCtx;
+  VOID                     *ReqCompBase;
+  UINT32                    ReqLength;
+
+  ReqCompBase = NULL;
+  ReqLength   = 0;
+  if ((Buffer != NULL) && (*Buffer != NULL)) {
+    ReqCompBase = *Buffer;
+    if (Length != NULL) {
+      ReqLength = *Length;
+    }
+  }
+
+  Status = PrepareComponentLoad (ContainerSig, ComponentName, ReqCompBase, ReqLength, &LoadCtx);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (LoadComponentCallback != NULL) {
+    LoadComponentCallback (PROGESS_ID_LOCATE, NULL);
+  }
+
+  Status = ExecuteComponentLoad (&LoadCtx, LoadComponentCallback);
+
+  return FinishComponentLoad (&LoadCtx, Status, Buffer, Length);
+}
 
 /**
   Load a component from a container or flash map to memory.
@@ -10,6 +10,126 @@
 #include <Library/Lz4CompressLib.h>
 #include <Library/DecompressLib.h>
 
+/**
+  Check whether a compressed buffer is a block stream.
+
+  @param  Signature       The signature to indicate the decompression algorithm.
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size, in bytes, of the source buffer.
+
+  @retval TRUE            The source buffer is a block stream.
+  @retval FALSE           The source buffer is a single compressed stream.
+
+**/
+STATIC
+BOOLEAN
+IsBlockStream (
+  IN UINT32        Signature,
+  IN CONST VOID   *Source,
+  IN UINTN         SourceSize
+  )
+{
+  CONST BLOCK_STREAM_HEADER  *Header;
+
+  if ((Signature != LZ4_SIGNATURE) && (Signature != LZMA_SIGNATURE)) {
+    return FALSE;
+  }
+
+  Header = (CONST BLOCK_STREAM_HEADER *)Source;
+  if ((SourceSize < sizeof (BLOCK_STREAM_HEADER)) || (Header->Marker != BLOCK_STREAM_MARKER)) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Retrieve the decompressed and scratch buffer sizes of a single compressed
+  stream. Block streams are not accepted here.
+
+  @param  Signature       The signature to indicate the decompression algorithm.
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size, in bytes, of the source buffer.
+  @param  DestinationSize A pointer to the size, in bytes, of the uncompressed buffer.
+  @param  ScratchSize     A pointer to the size, in bytes, of the scratch buffer.
+
+  @retval  RETURN_SUCCESS      The sizes were returned.
+  @retval  RETURN_UNSUPPORTED  The decompression is not supported.
+
+**/
+STATIC
+RETURN_STATUS
+DecompressStreamGetInfo (
+  IN UINT32        Signature,
+  IN  CONST VOID  *Source,
+  IN  UINT32       SourceSize,
+  OUT UINT32      *DestinationSize,
+  OUT UINT32      *ScratchSize
+  )
+{
+  RETURN_STATUS              Status;
+
+  Status = RETURN_UNSUPPORTED;
+  if (Signature == LZ4_SIGNATURE) {
+    Status = Lz4DecompressGetInfo (Source, SourceSize, DestinationSize, ScratchSize);
+  } else if (Signature == LZDM_SIGNATURE) {
+    if (DestinationSize != NULL) {
+      *DestinationSize = SourceSize;
+    }
+    if (ScratchSize != NULL) {
+      *ScratchSize = 0;
+    }
+    Status = RETURN_SUCCESS;
+  } else if (!FeaturePcdGet (PcdMinDecompression)) {
+    if (Signature == LZMA_SIGNATURE) {
+      Status = LzmaUefiDecompressGetInfo (Source, SourceSize, DestinationSize, ScratchSize);
+    }
+  }
+
+  return Status;
+}
+
+/**
+  Decompress a single compressed stream. Block streams are not accepted here.
+
+  @param  Signature   The signature to indicate the decompression algorithm.
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data
+  @param  Scratch     A temporary scratch buffer that is used to perform the decompression.
+
+  @retval  RETURN_SUCCESS      Decompression completed successfully.
+  @retval  RETURN_UNSUPPORTED  The decompression is not supported.
+  @retval  Others              The source buffer is corrupted.
+
+**/
+STATIC
+RETURN_STATUS
+DecompressStream (
+  IN UINT32       Signature,
+  IN CONST VOID  *Source,
+  IN UINTN        SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  )
+{
+  RETURN_STATUS              Status;
+
+  Status = RETURN_UNSUPPORTED;
+  if (Signature == LZ4_SIGNATURE) {
+    Status = Lz4Decompress (Source, SourceSize, Destination, Scratch);
+  } else if (Signature == LZDM_SIGNATURE) {
+    CopyMem (Destination, Source, SourceSize);
+    Status = RETURN_SUCCESS;
+  } else if (!FeaturePcdGet (PcdMinDecompression)) {
+    if (Signature == LZMA_SIGNATURE) {
+      Status = LzmaUefiDecompress (Source, SourceSize, Destination, Scratch);
+    }
+  }
+
+  return Status;
+}
+
 /**
   Given a compressed source buffer, this function retrieves the size of
   the uncompressed buffer and the size of the scratch buffer required
@@ -48,27 +168,54 @@ DecompressGetInfo (
   OUT UINT32      *ScratchSize
   )
 {
-  RETURN_STATUS  Status;
+  RETURN_STATUS              Status;
+  CONST BLOCK_STREAM_HEADER  *Header;
+  CONST UINT32               *BlockSizes;
+  UINT8                      *Block;
+  UINT32                     Remaining;
+  UINT32                     BlockDestSize;
+  UINT32                     BlockScratchSize;
+  UINT32                     Index;
 
-  Status = RETURN_UNSUPPORTED;
+  if (!IsBlockStream (Signature, Source, SourceSize)) {
+    return DecompressStreamGetInfo (Signature, Source, SourceSize, DestinationSize, ScratchSize);
+  }
 
-  if (Signature == LZ4_SIGNATURE) {
-    Status = Lz4DecompressGetInfo (Source, SourceSize, DestinationSize, ScratchSize);
-  } else if (Signature == LZDM_SIGNATURE) {
-    if (DestinationSize != NULL) {
-      *DestinationSize = SourceSize;
+  //
+  // Blocks are decompressed one after another into the same scratch buffer,
+  // so it has to fit the largest block requirement.
+  //
+  Header     = (CONST BLOCK_STREAM_HEADER *)Source;
+  BlockSizes = (CONST UINT32 *)(Header + 1);
+  if ((Header->BlockCount == 0) ||
+      (Header->BlockCount >= (SourceSize - sizeof (BLOCK_STREAM_HEADER)) / sizeof (UINT32))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  Block     = (UINT8 *)&BlockSizes[Header->BlockCount];
+  Remaining = SourceSize - (UINT32)(Block - (UINT8 *)Source);
+  if (ScratchSize != NULL) {
+    *ScratchSize = 0;
+  }
+  for (Index = 0; Index < Header->BlockCount; Index++) {
+    if (BlockSizes[Index] > Remaining) {
+      return RETURN_INVALID_PARAMETER;
     }
-    if (ScratchSize != NULL) {
-      *ScratchSize = 0;
+    Status = DecompressStreamGetInfo (Signature, Block, BlockSizes[Index], &BlockDestSize, &BlockScratchSize);
+    if (RETURN_ERROR (Status)) {
+      return Status;
     }
-    Status = RETURN_SUCCESS;
-  } else if (!FeaturePcdGet (PcdMinDecompression)) {
-    if (Signature == LZMA_SIGNATURE) {
-      Status = LzmaUefiDecompressGetInfo (Source, SourceSize, DestinationSize, ScratchSize);
+    if ((ScratchSize != NULL) && (BlockScratchSize > *ScratchSize)) {
+      *ScratchSize = BlockScratchSize;
     }
+    Block     += BlockSizes[Index];
+    Remaining -= BlockSizes[Index];
   }
 
-  return Status;
+  if (DestinationSize != NULL) {
+    *DestinationSize = Header->DecompressedSize;
+  }
+
+  return RETURN_SUCCESS;
 }
 
 /**
@@ -104,19 +251,55 @@ Decompress (
   IN OUT VOID    *Scratch
   )
 {
-  RETURN_STATUS  Status;
+  RETURN_STATUS              Status;
+  CONST BLOCK_STREAM_HEADER  *Header;
+  CONST UINT32               *BlockSizes;
+  UINT8                      *Block;
+  UINTN                      Remaining;
+  UINT32                     Offset;
+  UINT32                     BlockDestSize;
+  UINT32                     BlockScratchSize;
+  UINT32                     Index;
 
-  Status = RETURN_UNSUPPORTED;
-  if (Signature == LZ4_SIGNATURE) {
-    Status = Lz4Decompress (Source, SourceSize, Destination, Scratch);
-  } else if (Signature == LZDM_SIGNATURE) {
-    CopyMem (Destination, Source, SourceSize);
-    Status = RETURN_SUCCESS;
-  } else if (!FeaturePcdGet (PcdMinDecompression)) {
-    if (Signature == LZMA_SIGNATURE) {
-      Status = LzmaUefiDecompress (Source, SourceSize, Destination, Scratch);
+  if (!IsBlockStream (Signature, Source, SourceSize)) {
+    return DecompressStream (Signature, Source, SourceSize, Destination, Scratch);
+  }
+
+  //
+  // Each block is a regular compressed stream, decompress them in place
+  // one after another.
+  //
+  Header     = (CONST BLOCK_STREAM_HEADER *)Source;
+  BlockSizes = (CONST UINT32 *)(Header + 1);
+  if (Header->BlockCount > (SourceSize - sizeof (BLOCK_STREAM_HEADER)) / sizeof (UINT32)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  Block     = (UINT8 *)&BlockSizes[Header->BlockCount];
+  Remaining = SourceSize - (Block - (UINT8 *)Source);
+  Offset    = 0;
+  for (Index = 0; Index < Header->BlockCount; Index++) {
+    if (BlockSizes[Index] > Remaining) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    Status = DecompressStreamGetInfo (Signature, Block, BlockSizes[Index], &BlockDestSize, &BlockScratchSize);
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
+    if ((BlockDestSize > Header->BlockSize) || (BlockDestSize > Header->DecompressedSize - Offset)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    Status = DecompressStream (Signature, Block, BlockSizes[Index], (UINT8 *)Destination + Offset, Scratch);
+    if (RETURN_ERROR (Status)) {
+      return Status;
     }
+    Offset    += BlockDestSize;
+    Block     += BlockSizes[Index];
+    Remaining -= BlockSizes[Index];
   }
 
-  return Status;
+  if (Offset != Header->DecompressedSize) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return RETURN_SUCCESS;
 }
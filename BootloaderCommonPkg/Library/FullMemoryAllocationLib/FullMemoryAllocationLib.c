@@ -27,6 +27,7 @@ AddMemoryResourceRange (
 {
   UINTN                   Index;
 
+  ZeroMem (&gMemoryAllocationStats, sizeof (gMemoryAllocationStats));
   CoreInitializePool ();
   CoreInitializePages ();
 
@@ -14,6 +14,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/BlMemoryAllocationLib.h>
 
 #define  EFI_LOCK    UINTN
 
@@ -93,10 +94,25 @@ typedef struct {
   UINT64          Attribute;
 } MEMORY_MAP;
 
+extern MEMORY_ALLOCATION_STATS  gMemoryAllocationStats;
+
 //
 // Internal prototypes
 //
 
+/**
+  Account one allocation operation in the memory allocation statistics.
+
+  @param  Counter                The counter of the operation
+  @param  StartTick              Time stamp taken when the operation started
+
+**/
+VOID
+CoreUpdateAllocationCounter (
+  IN OUT MEMORY_ALLOCATION_COUNTER  *Counter,
+  IN     UINT64                      StartTick
+  );
+
 
 /**
   Internal function.  Used by the pool functions to allocate pages
@@ -19,6 +19,34 @@ EFI_LOCK          gMemoryLock;
 //
 LIST_ENTRY        gMemoryMap  = INITIALIZE_LIST_HEAD_VARIABLE (gMemoryMap);
 
+//
+// Allocation call counts and latencies
+//
+MEMORY_ALLOCATION_STATS  gMemoryAllocationStats;
+
+/**
+  Account one allocation operation in the memory allocation statistics.
+
+  @param  Counter                The counter of the operation
+  @param  StartTick              Time stamp taken when the operation started
+
+**/
+VOID
+CoreUpdateAllocationCounter (
+  IN OUT MEMORY_ALLOCATION_COUNTER  *Counter,
+  IN     UINT64                      StartTick
+  )
+{
+  UINT64   Ticks;
+
+  Ticks = AsmReadTsc () - StartTick;
+  Counter->Count++;
+  Counter->TotalTicks += Ticks;
+  if (Counter->MaxTicks < Ticks) {
+    Counter->MaxTicks = Ticks;
+  }
+}
+
 
 /**
   Raising to the task priority level of the mutual exclusion
@@ -997,8 +997,11 @@ CoreAllocatePages (
   )
 {
   EFI_STATUS  Status;
+  UINT64      StartTick;
 
+  StartTick = AsmReadTsc ();
   Status = CoreInternalAllocatePages (Type, MemoryType, NumberOfPages, Memory);
+  CoreUpdateAllocationCounter (&gMemoryAllocationStats.AllocatePages, StartTick);
   return Status;
 }
 
@@ -1102,8 +1105,11 @@ CoreFreePages (
 {
   EFI_STATUS        Status;
   EFI_MEMORY_TYPE   MemoryType;
+  UINT64            StartTick;
 
+  StartTick = AsmReadTsc ();
   Status = CoreInternalFreePages (Memory, NumberOfPages, &MemoryType);
+  CoreUpdateAllocationCounter (&gMemoryAllocationStats.FreePages, StartTick);
   return Status;
 }
 
@@ -1244,3 +1250,17 @@ GetMemoryResourceInfo (
 
   return EFI_SUCCESS;
 }
+
+/**
+  Retrieve the allocation call counts and latencies.
+
+  @return   Pointer to the memory allocation statistics.
+**/
+CONST MEMORY_ALLOCATION_STATS *
+EFIAPI
+GetMemoryAllocationStats (
+  VOID
+  )
+{
+  return &gMemoryAllocationStats;
+}
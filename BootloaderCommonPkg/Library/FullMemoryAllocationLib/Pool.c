@@ -48,6 +48,18 @@ STATIC CONST UINT16 mPoolSizeTable[] = {
   128, 256, 384, 640, 1024, 1664, 2688, 4352, 7040, 11392, 18432, 29824
 };
 
+//
+// Bin index for each 128 byte step up to one page, every bin size above is a
+// multiple of 128 so the lookup is exact
+//
+#define POOL_INDEX_SHIFT        7
+#define POOL_INDEX_MAX_SIZE     EFI_PAGE_SIZE
+
+STATIC CONST UINT8 mPoolIndexTable[POOL_INDEX_MAX_SIZE >> POOL_INDEX_SHIFT] = {
+  0, 1, 2, 3, 3, 4, 4, 4, 5, 5, 5, 5, 5, 6, 6, 6,
+  6, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7
+};
+
 #define SIZE_TO_LIST(a)   (GetPoolIndexFromSize (a))
 #define LIST_TO_SIZE(a)   (mPoolSizeTable [a])
 
@@ -66,6 +78,7 @@ typedef struct {
   EFI_MEMORY_TYPE  MemoryType;
   LIST_ENTRY       FreeList[MAX_POOL_LIST];
   LIST_ENTRY       Link;
+  CHAR8           *SparePage;
 } POOL;
 
 //
@@ -94,6 +107,10 @@ GetPoolIndexFromSize (
 {
   UINTN   Index;
 
+  if ((Size > 0) && (Size <= POOL_INDEX_MAX_SIZE)) {
+    return mPoolIndexTable[(Size - 1) >> POOL_INDEX_SHIFT];
+  }
+
   for (Index = 0; Index < MAX_POOL_LIST; Index++) {
     if (mPoolSizeTable [Index] >= Size) {
       return Index;
@@ -102,6 +119,42 @@ GetPoolIndexFromSize (
   return MAX_POOL_LIST;
 }
 
+/**
+  Check if all the pool entries carved from a pool page are free.
+
+  @param  Page          The pool page to check.
+  @param  Granularity   The pool page size.
+
+  @retval TRUE          All the pool entries in the page are free.
+  @retval FALSE         Page is NULL or some pool entry in the page is in use.
+
+**/
+STATIC
+BOOLEAN
+IsPoolPageFree (
+  IN CHAR8   *Page,
+  IN UINTN    Granularity
+  )
+{
+  POOL_FREE   *Free;
+  UINTN       Offset;
+
+  if (Page == NULL) {
+    return FALSE;
+  }
+
+  Offset = 0;
+  while (Offset < Granularity) {
+    Free = (POOL_FREE *) &Page[Offset];
+    if (Free->Signature != POOL_FREE_SIGNATURE) {
+      return FALSE;
+    }
+    Offset += LIST_TO_SIZE (Free->Index);
+  }
+
+  return TRUE;
+}
+
 /**
   Called to initialize the pool.
 
@@ -119,6 +172,7 @@ CoreInitializePool (
     mPoolHead[Type].Signature  = 0;
     mPoolHead[Type].Used       = 0;
     mPoolHead[Type].MemoryType = (EFI_MEMORY_TYPE) Type;
+    mPoolHead[Type].SparePage  = NULL;
     for (Index = 0; Index < MAX_POOL_LIST; Index++) {
       InitializeListHead (&mPoolHead[Type].FreeList[Index]);
     }
@@ -169,6 +223,7 @@ LookupPoolHead (
     Pool->Signature = POOL_SIGNATURE;
     Pool->Used      = 0;
     Pool->MemoryType = MemoryType;
+    Pool->SparePage  = NULL;
     for (Index = 0; Index < MAX_POOL_LIST; Index++) {
       InitializeListHead (&Pool->FreeList[Index]);
     }
@@ -267,8 +322,11 @@ CoreAllocatePool (
   )
 {
   EFI_STATUS  Status;
+  UINT64      StartTick;
 
+  StartTick = AsmReadTsc ();
   Status = CoreInternalAllocatePool (PoolType, Size, Buffer);
+  CoreUpdateAllocationCounter (&gMemoryAllocationStats.AllocatePool, StartTick);
   return Status;
 }
 
@@ -492,8 +550,11 @@ CoreFreePool (
 {
   EFI_STATUS        Status;
   EFI_MEMORY_TYPE   PoolType;
+  UINT64            StartTick;
 
+  StartTick = AsmReadTsc ();
   Status = CoreInternalFreePool (Buffer, &PoolType);
+  CoreUpdateAllocationCounter (&gMemoryAllocationStats.FreePool, StartTick);
   return Status;
 }
 
@@ -615,46 +676,42 @@ CoreFreePoolI (
     // entries
     //
     NewPage = (CHAR8 *) ((UINTN)Free & ~ (Granularity - 1));
-    Free = (POOL_FREE *) &NewPage[0];
-    ASSERT (Free != NULL);
+    AllFree = IsPoolPageFree (NewPage, Granularity);
 
-    if (Free->Signature == POOL_FREE_SIGNATURE) {
+    //
+    // Keep one free page per memory type as a slab for the next small
+    // allocations, so that alternating allocate and free calls do not
+    // convert the same page back and forth in the memory map
+    //
+    if (AllFree && ((UINT32) Pool->MemoryType < EfiMaxMemoryType)) {
+      if ((Pool->SparePage == NewPage) || !IsPoolPageFree (Pool->SparePage, Granularity)) {
+        Pool->SparePage = NewPage;
+        AllFree = FALSE;
+      }
+    }
+
+    if (AllFree) {
 
-      AllFree = TRUE;
+      //
+      // All of the pool entries in the same page as Free are free pool
+      // entries
+      // Remove all of these pool entries from the free loop lists.
+      //
+      Free = (POOL_FREE *) &NewPage[0];
+      ASSERT (Free != NULL);
       Offset = 0;
 
-      while ((Offset < Granularity) && (AllFree)) {
+      while (Offset < Granularity) {
         Free = (POOL_FREE *) &NewPage[Offset];
         ASSERT (Free != NULL);
-        if (Free->Signature != POOL_FREE_SIGNATURE) {
-          AllFree = FALSE;
-        }
+        RemoveEntryList (&Free->Link);
         Offset += LIST_TO_SIZE (Free->Index);
       }
 
-      if (AllFree) {
-
-        //
-        // All of the pool entries in the same page as Free are free pool
-        // entries
-        // Remove all of these pool entries from the free loop lists.
-        //
-        Free = (POOL_FREE *) &NewPage[0];
-        ASSERT (Free != NULL);
-        Offset = 0;
-
-        while (Offset < Granularity) {
-          Free = (POOL_FREE *) &NewPage[Offset];
-          ASSERT (Free != NULL);
-          RemoveEntryList (&Free->Link);
-          Offset += LIST_TO_SIZE (Free->Index);
-        }
-
-        //
-        // Free the page
-        //
-        CoreFreePoolPages ((EFI_PHYSICAL_ADDRESS) (UINTN)NewPage, EFI_SIZE_TO_PAGES (Granularity));
-      }
+      //
+      // Free the page
+      //
+      CoreFreePoolPages ((EFI_PHYSICAL_ADDRESS) (UINTN)NewPage, EFI_SIZE_TO_PAGES (Granularity));
     }
   }
 
@@ -17,7 +17,7 @@
   Verify a BMP image header and determine its centralized display location
   on screen.
 
-  @param  BmpImage      Pointer to BMP file
+  @param  BmpImage      Pointer to BMP file or frame buffer splash image
   @param  OffX          Pointer to receive X offset for BMP display position.
   @param  OffY          Pointer to receive Y offset for BMP display position.
   @param  GfxInfoHob    Pointer to graphics info HOB.
@@ -43,6 +43,10 @@ GetBmpDisplayPos (
   UINT32                        DataSizePerLine;
   UINT32                        ColorMapNum;
 
+  if (((FB_SPLASH_HEADER *)BmpImage)->Signature == FB_SPLASH_SIGNATURE) {
+    return GetFbSplashDisplayPos (BmpImage, OffX, OffY, GfxInfoHob);
+  }
+
   BmpHeader = (BMP_IMAGE_HEADER *) BmpImage;
 
   if (BmpHeader->CharB != 'B' || BmpHeader->CharM != 'M') {
@@ -135,12 +139,91 @@ GetBmpDisplayPos (
   return EFI_SUCCESS;
 }
 
+/**
+  Convert one line of a palette based BMP image into BLT pixels.
+
+  @param  Image         Pointer to the BMP line data.
+  @param  Palette       Pointer to the palette converted into BLT pixels.
+  @param  BitPerPixel   Bits per pixel, 1, 4 or 8.
+  @param  PixelWidth    Number of pixels in the line.
+  @param  Blt           Pointer to receive the BLT pixels.
+
+**/
+STATIC
+VOID
+ConvertBmpPaletteLine (
+  IN     UINT8         *Image,
+  IN     UINT32        *Palette,
+  IN     UINT16         BitPerPixel,
+  IN     UINTN          PixelWidth,
+  OUT    UINT32        *Blt
+  )
+{
+  UINTN                 Width;
+  UINT8                 Shift;
+  UINT8                 Mask;
+  UINT8                 PixelsPerByte;
+
+  if (BitPerPixel == 8) {
+    for (Width = 0; Width < PixelWidth; Width++) {
+      Blt[Width] = Palette[Image[Width]];
+    }
+    return;
+  }
+
+  Mask          = (UINT8)((1 << BitPerPixel) - 1);
+  PixelsPerByte = (UINT8)(8 / BitPerPixel);
+  for (Width = 0; Width < PixelWidth; Width++) {
+    Shift = (UINT8)((PixelsPerByte - 1 - (Width % PixelsPerByte)) * BitPerPixel);
+    Blt[Width] = Palette[(Image[Width / PixelsPerByte] >> Shift) & Mask];
+  }
+}
+
+/**
+  Convert one line of a 24-bit BMP image into BLT pixels.
+
+  Four pixels are handled per iteration using three 32-bit loads and four
+  32-bit stores instead of twelve byte accesses.
+
+  @param  Image         Pointer to the BMP line data.
+  @param  PixelWidth    Number of pixels in the line.
+  @param  Blt           Pointer to receive the BLT pixels.
+
+**/
+STATIC
+VOID
+ConvertBmp24Line (
+  IN     UINT8         *Image,
+  IN     UINTN          PixelWidth,
+  OUT    UINT32        *Blt
+  )
+{
+  UINTN                 Width;
+  UINT32                Word0;
+  UINT32                Word1;
+  UINT32                Word2;
+
+  for (Width = 0; Width + 4 <= PixelWidth; Width += 4, Image += 12, Blt += 4) {
+    Word0  = *(UINT32 *)(Image + 0);
+    Word1  = *(UINT32 *)(Image + 4);
+    Word2  = *(UINT32 *)(Image + 8);
+    Blt[0] = Word0 & 0x00FFFFFF;
+    Blt[1] = (Word0 >> 24) | ((Word1 & 0x0000FFFF) << 8);
+    Blt[2] = (Word1 >> 16) | ((Word2 & 0x000000FF) << 16);
+    Blt[3] = Word2 >> 8;
+  }
+
+  for (; Width < PixelWidth; Width++, Image += 3, Blt++) {
+    *Blt = Image[0] | (Image[1] << 8) | (Image[2] << 16);
+  }
+}
+
 /**
   Display a *.BMP graphics image to the frame buffer or BLT buffer. If a NULL
   GopBlt buffer is passed in, the BMP image will be displayed into BLT memory
   buffer. Otherwise, it will be dispalyed into the actual frame buffer.
 
-  @param  BmpImage      Pointer to BMP file
+  @param  BmpImage      Pointer to BMP file or frame buffer splash image
   @param  GopBlt        Buffer for transferring BmpImage to the BLT memory buffer.
   @param  GopBltSize    Size of GopBlt in bytes.
   @param  GfxInfoHob    Pointer to graphics info HOB.
@@ -162,25 +245,28 @@ DisplayBmpToFrameBuffer (
 {
   BMP_IMAGE_HEADER              *BmpHeader;
   BMP_COLOR_MAP                 *BmpColorMap;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltLineBuf;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Blt;
+  UINT32                        *BltLineBuf;
+  UINT32                        *Blt;
+  UINT32                        Palette[256];
   BOOLEAN                       IsAllocated;
   UINTN                         Index;
   UINTN                         Height;
-  UINTN                         Width;
-  UINTN                         ImageIndex;
   UINTN                         PixelHeight;
   UINTN                         PixelWidth;
   UINT32                        OffX;
   UINT32                        OffY;
+  UINT32                        DataSizePerLine;
   UINT64                        LineBufferSize;
   UINT64                        BltBufferSize;
   UINT32                        FrameBufferOffset;
   UINT32                        *FrameBufferPtr;
   UINT8                         *Image;
-  UINT8                         *ImageHeader;
   EFI_STATUS                    Status;
 
+  if (((FB_SPLASH_HEADER *)BmpImage)->Signature == FB_SPLASH_SIGNATURE) {
+    return DisplayFbSplashToFrameBuffer (BmpImage, GopBlt, GopBltSize, GfxInfoHob);
+  }
+
   Status = GetBmpDisplayPos (BmpImage, &OffX, &OffY, GfxInfoHob);
   if (EFI_ERROR(Status)) {
     return EFI_UNSUPPORTED;
@@ -191,7 +277,28 @@ DisplayBmpToFrameBuffer (
   PixelWidth   = BmpHeader->PixelWidth;
   PixelHeight  = BmpHeader->PixelHeight;
   Image        = ((UINT8 *) BmpImage) + BmpHeader->ImageOffset;
-  ImageHeader  = Image;
+  DataSizePerLine = ((BmpHeader->PixelWidth * BmpHeader->BitPerPixel + 31) >> 3) & (~0x3);
+
+  switch (BmpHeader->BitPerPixel) {
+  case 1:
+  case 4:
+  case 8:
+    //
+    // Convert the palette into BLT pixels once instead of once per pixel
+    //
+    for (Index = 0; Index < (UINTN)(1 << BmpHeader->BitPerPixel); Index++) {
+      Palette[Index] = BmpColorMap[Index].Blue | (BmpColorMap[Index].Green << 8) | (BmpColorMap[Index].Red << 16);
+    }
+    break;
+  case 24:
+  case 32:
+    break;
+  default:
+    //
+    // Other bit format BMP is not supported.
+    //
+    return EFI_UNSUPPORTED;
+  }
 
   //
   // Calculate the BltBuffer size needed for one line of splashing at a time.
@@ -199,11 +306,13 @@ DisplayBmpToFrameBuffer (
   LineBufferSize = MultU64x32 ((UINT64)PixelWidth, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
 
   IsAllocated   = FALSE;
+  FrameBufferPtr    = NULL;
+  FrameBufferOffset = 0;
   if (GopBlt == NULL) {
     //
     // GopBlt is not allocated by caller.
     //
-    BltLineBuf  = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) AllocateTemporaryMemory ((UINTN)LineBufferSize);
+    BltLineBuf  = (UINT32 *) AllocateTemporaryMemory ((UINTN)LineBufferSize);
     if (BltLineBuf == NULL) {
       return EFI_OUT_OF_RESOURCES;
     }
@@ -218,96 +327,38 @@ DisplayBmpToFrameBuffer (
     if (GopBltSize < (UINTN) BltBufferSize) {
       return EFI_BUFFER_TOO_SMALL;
     }
-    BltLineBuf = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)GopBlt;
+    BltLineBuf = (UINT32 *)GopBlt;
   }
 
   //
-  // Convert image from BMP to Blt buffer format
+  // Convert image from BMP to Blt buffer format one line at a time. The
+  // converted line is written into the frame buffer with a single copy.
   //
-  Status = EFI_SUCCESS;
-  for (Height = 0; Height < BmpHeader->PixelHeight; Height++) {
+  for (Height = 0; Height < PixelHeight; Height++, Image += DataSizePerLine) {
     Blt = BltLineBuf;
-    for (Width = 0; Width < BmpHeader->PixelWidth; Width++, Image++, Blt++) {
-      switch (BmpHeader->BitPerPixel) {
-      case 1:
-        //
-        // Convert 1-bit (2 colors) BMP to 24-bit color
-        //
-        for (Index = 0; Index < 8 && Width < BmpHeader->PixelWidth; Index++) {
-          Blt->Red    = BmpColorMap[ ((*Image) >> (7 - Index)) & 0x1].Red;
-          Blt->Green  = BmpColorMap[ ((*Image) >> (7 - Index)) & 0x1].Green;
-          Blt->Blue   = BmpColorMap[ ((*Image) >> (7 - Index)) & 0x1].Blue;
-          Blt++;
-          Width++;
-        }
-
-        Blt--;
-        Width--;
-        break;
-
-      case 4:
-        //
-        // Convert 4-bit (16 colors) BMP Palette to 24-bit color
-        //
-        Index       = (*Image) >> 4;
-        Blt->Red    = BmpColorMap[Index].Red;
-        Blt->Green  = BmpColorMap[Index].Green;
-        Blt->Blue   = BmpColorMap[Index].Blue;
-        if (Width < (BmpHeader->PixelWidth - 1)) {
-          Blt++;
-          Width++;
-          Index       = (*Image) & 0x0f;
-          Blt->Red    = BmpColorMap[Index].Red;
-          Blt->Green  = BmpColorMap[Index].Green;
-          Blt->Blue   = BmpColorMap[Index].Blue;
-        }
-        break;
-
-      case 8:
-        //
-        // Convert 8-bit (256 colors) BMP Palette to 24-bit color
-        //
-        Blt->Red    = BmpColorMap[*Image].Red;
-        Blt->Green  = BmpColorMap[*Image].Green;
-        Blt->Blue   = BmpColorMap[*Image].Blue;
-        break;
-
-      case 24:
-        //
-        // It is 24-bit BMP.
-        //
-        Blt->Blue   = *Image++;
-        Blt->Green  = *Image++;
-        Blt->Red    = *Image;
-        break;
-
-      default:
-        //
-        // Other bit format BMP is not supported.
-        //
-        Status = EFI_UNSUPPORTED;
-        goto End;
-      }
-    }
-
-    ImageIndex = (UINTN) (Image - ImageHeader);
-    if ((ImageIndex % 4) != 0) {
+    if ((BmpHeader->BitPerPixel == 32) && (GopBlt == NULL)) {
       //
-      // Bmp Image starts each row on a 32-bit boundary!
+      // 32-bit BMP is already in BLT pixel layout, copy it directly.
       //
-      Image = Image + (4 - (ImageIndex % 4));
+      Blt = (UINT32 *)Image;
+    } else if (BmpHeader->BitPerPixel == 32) {
+      CopyMem (Blt, Image, (UINTN)LineBufferSize);
+    } else if (BmpHeader->BitPerPixel == 24) {
+      ConvertBmp24Line (Image, PixelWidth, Blt);
+    } else {
+      ConvertBmpPaletteLine (Image, Palette, BmpHeader->BitPerPixel, PixelWidth, Blt);
     }
+
     if (GopBlt == NULL) {
-      CopyMem (&FrameBufferPtr[FrameBufferOffset], BltLineBuf, Width * 4);
+      CopyMem (&FrameBufferPtr[FrameBufferOffset], Blt, (UINTN)LineBufferSize);
       FrameBufferOffset -= GfxInfoHob->GraphicsMode.HorizontalResolution;
     } else {
       BltLineBuf += PixelWidth;
     }
   }
 
-End:
   if (IsAllocated) {
-    FreePool (BltLineBuf);
+    FreeTemporaryMemory (BltLineBuf);
   }
 
   return Status;
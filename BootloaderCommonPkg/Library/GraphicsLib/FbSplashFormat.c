@@ -0,0 +1,209 @@
+/** @file
+  Pre-converted frame buffer splash image support.
+
+  Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/GraphicsLib.h>
+#include <Guid/GraphicsInfoHob.h>
+
+
+/**
+  Verify a pre-converted frame buffer splash image header and determine its
+  centralized display location on screen.
+
+  @param  SplashImage   Pointer to the frame buffer splash image
+  @param  OffX          Pointer to receive X offset for display position.
+  @param  OffY          Pointer to receive Y offset for display position.
+  @param  GfxInfoHob    Pointer to graphics info HOB.
+
+  @retval EFI_SUCCESS           The display position is returned.
+  @retval EFI_UNSUPPORTED       SplashImage is not a valid frame buffer splash image
+  @retval EFI_INVALID_PARAMETER The image does not fit on the screen
+**/
+EFI_STATUS
+EFIAPI
+GetFbSplashDisplayPos (
+  IN     VOID    *SplashImage,
+  OUT  UINT32    *OffX,          OPTIONAL
+  OUT  UINT32    *OffY,          OPTIONAL
+  IN   EFI_PEI_GRAPHICS_INFO_HOB *GfxInfoHob
+  )
+{
+  FB_SPLASH_HEADER              *SplashHeader;
+  UINT64                        ImageSize;
+
+  SplashHeader = (FB_SPLASH_HEADER *) SplashImage;
+  if ((SplashHeader->Signature != FB_SPLASH_SIGNATURE) ||
+      (SplashHeader->HeaderSize < sizeof (FB_SPLASH_HEADER))) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (SplashHeader->Compression == FB_SPLASH_COMPRESS_NONE) {
+    ImageSize = MultU64x32 ((UINT64)SplashHeader->PixelWidth * sizeof (UINT32), SplashHeader->PixelHeight);
+    if (ImageSize != SplashHeader->DataSize) {
+      return EFI_UNSUPPORTED;
+    }
+  } else if (SplashHeader->Compression != FB_SPLASH_COMPRESS_RLE) {
+    return EFI_UNSUPPORTED;
+  }
+
+  // Check dimensions
+  if ((SplashHeader->PixelHeight > GfxInfoHob->GraphicsMode.VerticalResolution)
+      || (SplashHeader->PixelWidth > GfxInfoHob->GraphicsMode.HorizontalResolution)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // Center the image on the display
+  if (OffX != NULL) {
+    *OffX = (GfxInfoHob->GraphicsMode.HorizontalResolution - SplashHeader->PixelWidth) / 2;
+  }
+
+  if (OffY != NULL) {
+    *OffY = (GfxInfoHob->GraphicsMode.VerticalResolution - SplashHeader->PixelHeight) / 2;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Decode one RLE compressed line of a frame buffer splash image.
+
+  Runs are filled with SetMem32 and literals are copied with CopyMem, so the
+  destination is written with wide (streaming on SSE2) stores.
+
+  @param  Data          Pointer to the compressed line data.
+  @param  DataEnd       Pointer to the end of the compressed image data.
+  @param  PixelWidth    Number of pixels in the line.
+  @param  Dest          Pointer to receive the decoded pixels.
+
+  @retval Pointer to the next compressed line, or NULL if the data is malformed.
+**/
+STATIC
+UINT32 *
+DecodeFbSplashRleLine (
+  IN     UINT32        *Data,
+  IN     UINT32        *DataEnd,
+  IN     UINTN          PixelWidth,
+  OUT    UINT32        *Dest
+  )
+{
+  UINTN                 Count;
+  UINTN                 Width;
+
+  Width = 0;
+  while (Width < PixelWidth) {
+    if (Data >= DataEnd) {
+      return NULL;
+    }
+    Count = *Data & ~FB_SPLASH_RLE_RUN;
+    if ((Count == 0) || (Count > PixelWidth - Width)) {
+      return NULL;
+    }
+    if ((*Data++ & FB_SPLASH_RLE_RUN) != 0) {
+      if (Data >= DataEnd) {
+        return NULL;
+      }
+      SetMem32 (&Dest[Width], Count * sizeof (UINT32), *Data++);
+    } else {
+      if ((UINTN)(DataEnd - Data) < Count) {
+        return NULL;
+      }
+      CopyMem (&Dest[Width], Data, Count * sizeof (UINT32));
+      Data += Count;
+    }
+    Width += Count;
+  }
+
+  return Data;
+}
+
+/**
+  Display a pre-converted frame buffer splash image to the frame buffer or
+  BLT buffer. If a NULL GopBlt buffer is passed in, the image is written
+  into the actual frame buffer. Otherwise, it is written into GopBlt with
+  lines stored bottom-up so that GopBlt can back a 32-bit BMP image.
+
+  @param  SplashImage   Pointer to the frame buffer splash image
+  @param  GopBlt        Buffer for transferring the image to the BLT memory buffer.
+  @param  GopBltSize    Size of GopBlt in bytes.
+  @param  GfxInfoHob    Pointer to graphics info HOB.
+
+  @retval EFI_SUCCESS           The image was displayed.
+  @retval EFI_UNSUPPORTED       SplashImage is not a valid frame buffer splash image
+  @retval EFI_BUFFER_TOO_SMALL  The passed in GopBlt buffer is not big enough.
+  @retval EFI_COMPROMISED_DATA  The compressed image data is malformed.
+
+**/
+EFI_STATUS
+EFIAPI
+DisplayFbSplashToFrameBuffer (
+  IN     VOID      *SplashImage,
+  IN     VOID      *GopBlt,
+  IN     UINTN     GopBltSize,
+  IN     EFI_PEI_GRAPHICS_INFO_HOB *GfxInfoHob
+  )
+{
+  FB_SPLASH_HEADER              *SplashHeader;
+  UINT32                        *Data;
+  UINT32                        *DataEnd;
+  UINT32                        *Dest;
+  UINTN                         Height;
+  UINTN                         PixelWidth;
+  UINTN                         PixelHeight;
+  UINTN                         LineSize;
+  INTN                          Stride;
+  UINT32                        OffX;
+  UINT32                        OffY;
+  EFI_STATUS                    Status;
+
+  Status = GetFbSplashDisplayPos (SplashImage, &OffX, &OffY, GfxInfoHob);
+  if (EFI_ERROR(Status)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  SplashHeader = (FB_SPLASH_HEADER *) SplashImage;
+  PixelWidth   = SplashHeader->PixelWidth;
+  PixelHeight  = SplashHeader->PixelHeight;
+  LineSize     = PixelWidth * sizeof (UINT32);
+  Data         = (UINT32 *)((UINT8 *)SplashImage + SplashHeader->HeaderSize);
+  DataEnd      = (UINT32 *)((UINT8 *)Data + SplashHeader->DataSize);
+
+  if (GopBlt == NULL) {
+    Dest   = (UINT32 *)(UINTN)GfxInfoHob->FrameBufferBase;
+    Dest  += OffY * GfxInfoHob->GraphicsMode.HorizontalResolution + OffX;
+    Stride = GfxInfoHob->GraphicsMode.HorizontalResolution;
+  } else {
+    if (GopBltSize < (UINTN)MultU64x32 (LineSize, (UINT32)PixelHeight)) {
+      return EFI_BUFFER_TOO_SMALL;
+    }
+    Dest   = (UINT32 *)GopBlt + (PixelHeight - 1) * PixelWidth;
+    Stride = -(INTN)PixelWidth;
+  }
+
+  if ((SplashHeader->Compression == FB_SPLASH_COMPRESS_NONE) && (GopBlt == NULL) &&
+      (PixelWidth == GfxInfoHob->GraphicsMode.HorizontalResolution)) {
+    //
+    // Full width image, write the whole frame buffer area in one copy
+    //
+    CopyMem (Dest, Data, LineSize * PixelHeight);
+    return EFI_SUCCESS;
+  }
+
+  for (Height = 0; Height < PixelHeight; Height++) {
+    if (SplashHeader->Compression == FB_SPLASH_COMPRESS_NONE) {
+      CopyMem (Dest, Data, LineSize);
+      Data += PixelWidth;
+    } else {
+      Data = DecodeFbSplashRleLine (Data, DataEnd, PixelWidth, Dest);
+      if (Data == NULL) {
+        return EFI_COMPROMISED_DATA;
+      }
+    }
+    Dest += Stride;
+  }
+
+  return EFI_SUCCESS;
+}
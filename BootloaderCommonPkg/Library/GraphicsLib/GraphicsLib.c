@@ -87,6 +87,37 @@ BltToFrameBuffer (
   return EFI_SUCCESS;
 }
 
+/**
+  Get the glyph bitmap for an ASCII character.
+
+  @param[in] Glyph               ASCII character
+
+  @retval Pointer to GLYPH_HEIGHT bytes of glyph bitmap rows.
+
+**/
+STATIC
+UINT8 *
+GetGlyphBitmap (
+  IN CHAR8                         Glyph
+  )
+{
+  UINTN                            Code;
+  UINTN                            Base;
+
+  // Glyph table maps to ASCII characters, index the table with the character
+  Code = (UINTN)(Glyph & 0xFF);
+  Base = 0xAF;
+  if ((Code >= Base) && (Code <= 0xF2)) {
+    Code = (0x80 - 0x20) + (Code - Base);
+  } else if ((Code >= 0x20) && (Code <= 0x7F)) {
+    Code = Code - 0x20;
+  } else {
+    Code = 0;
+  }
+
+  return gUsStdNarrowGlyphData[Code].GlyphCol1;
+}
+
 /**
   Draw a glyph into the frame buffer (ASCII only).
 
@@ -116,8 +147,6 @@ BltGlyphToFrameBuffer (
   UINTN                            Width, Height;
   UINTN                            Row;
   UINTN                            Col;
-  UINTN                            Code;
-  UINTN                            Base;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL    GopBlt[GLYPH_WIDTH * GLYPH_HEIGHT];
 
   if (GfxInfoHob == NULL) {
@@ -127,19 +156,7 @@ BltGlyphToFrameBuffer (
   Width = GLYPH_WIDTH;
   Height = GLYPH_HEIGHT;
 
-  // Glyph table maps to ASCII characters, index the table with the character
-  Code = (UINTN)(Glyph & 0xFF);
-  Base = 0xAF;
-  if ((Code >= Base) && (Code <= 0xF2)) {
-    Code = (0x80 - 0x20) + (Code - Base);
-  } else if ((Code >= 0x20) && (Code <= 0x7F)) {
-    Code = Code - 0x20;
-  } else {
-    Code = 0;
-  }
-
-  // Glyph table maps to ASCII characters, index the table with the character
-  GlyphBitmap = gUsStdNarrowGlyphData[Code].GlyphCol1;
+  GlyphBitmap = GetGlyphBitmap (Glyph);
 
   for (Row = 0; Row < Height; Row++) {
     for (Col = 0; Col < Width; Col++) {
@@ -150,6 +167,243 @@ BltGlyphToFrameBuffer (
   return BltToFrameBuffer (GfxInfoHob, GopBlt, Width, Height, OffX, OffY);
 }
 
+/**
+  Add a rectangle of the console area to the pending dirty rectangle.
+
+  @param[in] Console             Pointer to the frame buffer console
+  @param[in] X                   X offset inside the console area
+  @param[in] Y                   Y offset inside the console area
+  @param[in] Width               Width of the rectangle
+  @param[in] Height              Height of the rectangle
+
+**/
+STATIC
+VOID
+MarkConsoleDirty (
+  IN FRAME_BUFFER_CONSOLE          *Console,
+  IN UINTN                         X,
+  IN UINTN                         Y,
+  IN UINTN                         Width,
+  IN UINTN                         Height
+  )
+{
+  if (Console->DirtyRight <= Console->DirtyLeft) {
+    Console->DirtyLeft   = X;
+    Console->DirtyTop    = Y;
+    Console->DirtyRight  = X + Width;
+    Console->DirtyBottom = Y + Height;
+    return;
+  }
+
+  Console->DirtyLeft   = MIN (Console->DirtyLeft, X);
+  Console->DirtyTop    = MIN (Console->DirtyTop, Y);
+  Console->DirtyRight  = MAX (Console->DirtyRight, X + Width);
+  Console->DirtyBottom = MAX (Console->DirtyBottom, Y + Height);
+}
+
+/**
+  Copy the dirty rectangle of the console shadow buffer into the frame buffer.
+
+  The frame buffer is only written, never read, one pixel row at a time.
+
+  @param[in] Console             Pointer to the frame buffer console
+
+**/
+STATIC
+VOID
+FlushConsoleShadow (
+  IN FRAME_BUFFER_CONSOLE          *Console
+  )
+{
+  UINT32                           *FrameBufferPtr;
+  UINT32                           *ShadowPtr;
+  UINTN                            Stride;
+  UINTN                            Width;
+  UINTN                            Row;
+
+  if ((Console->ShadowBuf == NULL) || (Console->DirtyRight <= Console->DirtyLeft)) {
+    return;
+  }
+
+  Stride         = Console->GfxInfoHob->GraphicsMode.HorizontalResolution;
+  Width          = Console->DirtyRight - Console->DirtyLeft;
+  FrameBufferPtr = (UINT32 *)(UINTN)Console->GfxInfoHob->FrameBufferBase;
+  FrameBufferPtr += (Console->OffY + Console->DirtyTop) * Stride + Console->OffX + Console->DirtyLeft;
+  ShadowPtr      = Console->ShadowBuf + Console->DirtyTop * Console->ShadowWidth + Console->DirtyLeft;
+
+  if ((Width == Console->ShadowWidth) && (Width == Stride)) {
+    CopyMem (FrameBufferPtr, ShadowPtr, Width * (Console->DirtyBottom - Console->DirtyTop) * sizeof (UINT32));
+  } else {
+    for (Row = Console->DirtyTop; Row < Console->DirtyBottom; Row++) {
+      CopyMem (FrameBufferPtr, ShadowPtr, Width * sizeof (UINT32));
+      FrameBufferPtr += Stride;
+      ShadowPtr      += Console->ShadowWidth;
+    }
+  }
+
+  Console->DirtyLeft  = 0;
+  Console->DirtyRight = 0;
+}
+
+/**
+  Draw a glyph into the console shadow buffer.
+
+  Glyphs in the console colors are built from the pre-expanded glyph row
+  atlas; other colors are expanded bit by bit.
+
+  @param[in] Console             Pointer to the frame buffer console
+  @param[in] Glyph               ASCII character to write
+  @param[in] ForegroundColor     Foreground color to use
+  @param[in] BackgroundColor     Background color to use
+  @param[in] X                   X offset inside the console area
+  @param[in] Y                   Y offset inside the console area
+
+**/
+STATIC
+VOID
+DrawGlyphToShadow (
+  IN FRAME_BUFFER_CONSOLE          *Console,
+  IN CHAR8                         Glyph,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL ForegroundColor,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL BackgroundColor,
+  IN UINTN                         X,
+  IN UINTN                         Y
+  )
+{
+  UINT8                            *GlyphBitmap;
+  UINT32                           *Dst;
+  UINT32                           *Src;
+  UINT32                           Fg;
+  UINT32                           Bg;
+  UINTN                            Row;
+  UINTN                            Col;
+  BOOLEAN                          UseAtlas;
+
+  if ((X + GLYPH_WIDTH > Console->ShadowWidth) || (Y + GLYPH_HEIGHT > Console->ShadowHeight)) {
+    return;
+  }
+
+  Fg = *(UINT32 *)&ForegroundColor;
+  Bg = *(UINT32 *)&BackgroundColor;
+  UseAtlas = (Fg == *(UINT32 *)&Console->ForegroundColor) && (Bg == *(UINT32 *)&Console->BackgroundColor);
+
+  GlyphBitmap = GetGlyphBitmap (Glyph);
+  Dst = Console->ShadowBuf + Y * Console->ShadowWidth + X;
+  for (Row = 0; Row < GLYPH_HEIGHT; Row++) {
+    if (UseAtlas) {
+      Src = &Console->GlyphRowAtlas[GlyphBitmap[Row] * GLYPH_WIDTH];
+      for (Col = 0; Col < GLYPH_WIDTH; Col++) {
+        Dst[Col] = Src[Col];
+      }
+    } else {
+      for (Col = 0; Col < GLYPH_WIDTH; Col++) {
+        Dst[Col] = ((GlyphBitmap[Row] & (1 << (GLYPH_WIDTH - Col - 1))) != 0) ? Fg : Bg;
+      }
+    }
+    Dst += Console->ShadowWidth;
+  }
+
+  MarkConsoleDirty (Console, X, Y, GLYPH_WIDTH, GLYPH_HEIGHT);
+}
+
+/**
+  Draw a glyph at a console text position.
+
+  @param[in] Console             Pointer to the frame buffer console
+  @param[in] Glyph               ASCII character to write
+  @param[in] ForegroundColor     Foreground color to use
+  @param[in] BackgroundColor     Background color to use
+  @param[in] X                   X offset inside the console area
+  @param[in] Y                   Y offset inside the console area
+
+  @retval EFI_SUCCESS            Success
+  @retval EFI_INVALID_PARAMETER  Could not draw entire glyph in frame buffer
+
+**/
+STATIC
+EFI_STATUS
+DrawConsoleGlyph (
+  IN FRAME_BUFFER_CONSOLE          *Console,
+  IN CHAR8                         Glyph,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL ForegroundColor,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL BackgroundColor,
+  IN UINTN                         X,
+  IN UINTN                         Y
+  )
+{
+  if (Console->ShadowBuf != NULL) {
+    DrawGlyphToShadow (Console, Glyph, ForegroundColor, BackgroundColor, X, Y);
+    return EFI_SUCCESS;
+  }
+
+  return BltGlyphToFrameBuffer (Console->GfxInfoHob, Glyph, ForegroundColor, BackgroundColor,
+                                Console->OffX + X, Console->OffY + Y);
+}
+
+/**
+  Allocate and initialize the console shadow buffer and glyph row atlas.
+
+  If memory is not available, the console keeps drawing into the frame
+  buffer directly.
+
+  @param[in] Console             Pointer to the frame buffer console
+  @param[in] ClearScreen         TRUE if the console area will be cleared
+
+**/
+STATIC
+VOID
+InitConsoleShadow (
+  IN FRAME_BUFFER_CONSOLE          *Console,
+  IN BOOLEAN                       ClearScreen
+  )
+{
+  UINT32                           *FrameBufferPtr;
+  UINTN                            Stride;
+  UINTN                            Bits;
+  UINTN                            Col;
+  UINTN                            Row;
+  UINT32                           Fg;
+  UINT32                           Bg;
+
+  Console->ShadowWidth  = Console->Cols * GLYPH_WIDTH;
+  Console->ShadowHeight = Console->Rows * GLYPH_HEIGHT;
+  Console->ShadowBuf    = AllocatePool (Console->ShadowWidth * Console->ShadowHeight * sizeof (UINT32));
+  Console->GlyphRowAtlas = AllocatePool (256 * GLYPH_WIDTH * sizeof (UINT32));
+  if ((Console->ShadowBuf == NULL) || (Console->GlyphRowAtlas == NULL)) {
+    if (Console->ShadowBuf != NULL) {
+      FreePool (Console->ShadowBuf);
+    }
+    if (Console->GlyphRowAtlas != NULL) {
+      FreePool (Console->GlyphRowAtlas);
+    }
+    Console->ShadowBuf     = NULL;
+    Console->GlyphRowAtlas = NULL;
+    return;
+  }
+
+  Fg = *(UINT32 *)&Console->ForegroundColor;
+  Bg = *(UINT32 *)&Console->BackgroundColor;
+  for (Bits = 0; Bits < 256; Bits++) {
+    for (Col = 0; Col < GLYPH_WIDTH; Col++) {
+      Console->GlyphRowAtlas[Bits * GLYPH_WIDTH + Col] = ((Bits & (1 << (GLYPH_WIDTH - Col - 1))) != 0) ? Fg : Bg;
+    }
+  }
+
+  if (ClearScreen) {
+    return;
+  }
+
+  //
+  // Keep what is on screen (e.g. the logo) by reading the console area once
+  //
+  Stride = Console->GfxInfoHob->GraphicsMode.HorizontalResolution;
+  FrameBufferPtr = (UINT32 *)(UINTN)Console->GfxInfoHob->FrameBufferBase + Console->OffY * Stride + Console->OffX;
+  for (Row = 0; Row < Console->ShadowHeight; Row++) {
+    CopyMem (&Console->ShadowBuf[Row * Console->ShadowWidth], FrameBufferPtr, Console->ShadowWidth * sizeof (UINT32));
+    FrameBufferPtr += Stride;
+  }
+}
+
 /**
   Initialize the frame buffer console.
 
@@ -209,10 +463,11 @@ InitFrameBufferConsole (
   Console->BackgroundColor = mColors[0];
   Console->TextDisplayBuf = AllocateZeroPool (Console->Rows * Console->Cols);
   ASSERT (Console->TextDisplayBuf != NULL);
-  Console->TextSwapBuf = AllocateZeroPool (Console->Rows * Console->Cols);
-  ASSERT (Console->TextSwapBuf != NULL);
   Console->TextDrawBuf = AllocateZeroPool (Console->Rows * Console->Cols * 2);
   ASSERT (Console->TextDrawBuf != NULL);
+  Console->DirtyLeft   = 0;
+  Console->DirtyRight  = 0;
+  InitConsoleShadow (Console, ClearScreen);
 
   if (ClearScreen) {
     // Clear screen using standard ANSI Escape Sequences 'ESC[2J'
@@ -225,6 +480,9 @@ InitFrameBufferConsole (
 /**
   Scroll the console area of the screen up.
 
+  With a shadow buffer the pixel rows are moved with a single memory move in
+  system memory and the console area is flushed later as one dirty rectangle.
+
   @param[in] ScrollAmount Amount (in rows) to scroll
 
   @retval EFI_SUCCESS
@@ -240,8 +498,8 @@ FrameBufferConsoleScroll (
   UINTN                  BufX;
   UINTN                  BufY;
   UINTN                  BufPos;
-  UINTN                  ScreenX;
-  UINTN                  ScreenY;
+  UINTN                  ScrollLines;
+  CHAR8                  Glyph;
 
   Console = &mFbConsole;
   if (Console->Height == 0) {
@@ -252,38 +510,48 @@ FrameBufferConsoleScroll (
     ScrollAmount = Console->Rows;
   }
 
-  if (ScrollAmount < Console->Rows) {
-    // Move all lines in text buffer up
-    CopyMem (&Console->TextSwapBuf[0],
-             &Console->TextDisplayBuf[Console->Cols * ScrollAmount],
-             Console->Cols * (Console->Rows - ScrollAmount));
-  }
+  if (Console->ShadowBuf != NULL) {
+    // Move all lines in text buffer and shadow buffer up
+    ScrollLines = ScrollAmount * GLYPH_HEIGHT;
+    if (ScrollAmount < Console->Rows) {
+      CopyMem (&Console->TextDisplayBuf[0],
+               &Console->TextDisplayBuf[Console->Cols * ScrollAmount],
+               Console->Cols * (Console->Rows - ScrollAmount));
+      CopyMem (Console->ShadowBuf,
+               &Console->ShadowBuf[ScrollLines * Console->ShadowWidth],
+               (Console->ShadowHeight - ScrollLines) * Console->ShadowWidth * sizeof (UINT32));
+    }
 
-  // Blank remaining lines
-  ZeroMem (&Console->TextSwapBuf[Console->Cols * (Console->Rows - ScrollAmount)],
-           Console->Cols * ScrollAmount);
+    // Blank remaining lines
+    ZeroMem (&Console->TextDisplayBuf[Console->Cols * (Console->Rows - ScrollAmount)],
+             Console->Cols * ScrollAmount);
+    SetMem32 (&Console->ShadowBuf[(Console->ShadowHeight - ScrollLines) * Console->ShadowWidth],
+              ScrollLines * Console->ShadowWidth * sizeof (UINT32),
+              *(UINT32 *)&Console->BackgroundColor);
+
+    MarkConsoleDirty (Console, 0, 0, Console->ShadowWidth, Console->ShadowHeight);
+    return EFI_SUCCESS;
+  }
 
   // Write text buffer to screen
   //
-  // Note: At this point, TextDisplayBuf contains what is currently being
-  // displayed and TextSwapBuf contains what *should* be displayed. Step through
-  // every character of the buffer and update the framebuffer with any
-  // differences.
+  // Note: Without a shadow buffer, step through every character and update
+  // the framebuffer for each character that differs from the scrolled text.
   BufPos = 0;
-  ScreenY = Console->OffY;
   for (BufY = 0; BufY < Console->Rows; BufY++) {
-    ScreenX = Console->OffX;
     for (BufX = 0; BufX < Console->Cols; BufX++) {
-      if (Console->TextSwapBuf[BufPos] != Console->TextDisplayBuf[BufPos]) {
-        Console->TextDisplayBuf[BufPos] = Console->TextSwapBuf[BufPos];
-        BltGlyphToFrameBuffer (Console->GfxInfoHob, Console->TextSwapBuf[BufPos],
+      Glyph = 0;
+      if (BufY + ScrollAmount < Console->Rows) {
+        Glyph = Console->TextDisplayBuf[BufPos + Console->Cols * ScrollAmount];
+      }
+      if (Glyph != Console->TextDisplayBuf[BufPos]) {
+        Console->TextDisplayBuf[BufPos] = Glyph;
+        BltGlyphToFrameBuffer (Console->GfxInfoHob, Glyph,
                                Console->ForegroundColor, Console->BackgroundColor,
-                               ScreenX, ScreenY);
+                               Console->OffX + BufX * GLYPH_WIDTH, Console->OffY + BufY * GLYPH_HEIGHT);
       }
       BufPos++;
-      ScreenX += GLYPH_WIDTH;
     }
-    ScreenY += GLYPH_HEIGHT;
   }
 
   return EFI_SUCCESS;
@@ -334,6 +602,11 @@ FrameBufferWrite (
   if ((NumberOfBytes == 4) && (CompareMem (ANSI_ESCAPE_SEQ_CLEAR_SCREEN, Buffer, 4)) == 0) {
     // Clear screen
     SetMem (Console->TextDisplayBuf, Console->Rows * Console->Cols, 0);
+    if (Console->ShadowBuf != NULL) {
+      ZeroMem (Console->ShadowBuf, Console->ShadowWidth * Console->ShadowHeight * sizeof (UINT32));
+      Console->DirtyLeft  = 0;
+      Console->DirtyRight = 0;
+    }
     // Zero framebuffer
     GfxInfoHob = Console->GfxInfoHob;
     Length = (GfxInfoHob->GraphicsMode.HorizontalResolution * GfxInfoHob->GraphicsMode.PixelsPerScanLine) * 4;
@@ -379,10 +652,10 @@ FrameBufferWrite (
       Console->CursorX = 0;
     } else {
       Console->TextDisplayBuf[Console->CursorY * Console->Cols + Console->CursorX] = Buffer[Pos];
-      Status = BltGlyphToFrameBuffer (Console->GfxInfoHob, Buffer[Pos],
-                                      Console->ForegroundColor, Console->BackgroundColor,
-                                      Console->OffX + Console->CursorX * GLYPH_WIDTH,
-                                      Console->OffY + Console->CursorY * GLYPH_HEIGHT);
+      Status = DrawConsoleGlyph (Console, Buffer[Pos],
+                                 Console->ForegroundColor, Console->BackgroundColor,
+                                 Console->CursorX * GLYPH_WIDTH,
+                                 Console->CursorY * GLYPH_HEIGHT);
       if (Status != EFI_SUCCESS) {
         break;
       }
@@ -390,6 +663,8 @@ FrameBufferWrite (
     }
   }
 
+  FlushConsoleShadow (Console);
+
   return Pos;
 }
 
@@ -453,17 +728,19 @@ DrawFrameBuffer (
       Ptr   = (UINT16 *)(Console->TextDrawBuf + Pos);
       if (*Ptr != Value) {
         *Ptr = Value;
-        BltGlyphToFrameBuffer (
-          Console->GfxInfoHob, Buffer[Pos],
+        DrawConsoleGlyph (
+          Console, Buffer[Pos],
           mColors[(Value >>  8) & 0x0F],
           mColors[(Value >> 12) & 0x0F],
-          Console->OffX + (PosX + OffX) * GLYPH_WIDTH,
-          Console->OffY + (PosY + OffY) * GLYPH_HEIGHT);
+          (PosX + OffX) * GLYPH_WIDTH,
+          (PosY + OffY) * GLYPH_HEIGHT);
       }
       Pos += 2;
     }
   }
 
+  FlushConsoleShadow (Console);
+
   return EFI_SUCCESS;
 }
 
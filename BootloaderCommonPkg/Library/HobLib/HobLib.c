@@ -8,11 +8,23 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <PiPei.h>
 
-#include <Library/HobLib.h>
+#include <Library/BlHobLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/BootloaderCommonLib.h>
 
+typedef struct {
+  CONST UINT8                *HobList;
+  // End of list HOB at the time the index was built
+  CONST UINT8                *IndexedEnd;
+  UINT32                      Count;
+  EFI_HOB_GUID_TYPE         **Entry;
+} HOB_GUID_INDEX;
+
+STATIC HOB_GUID_INDEX         mHobGuidIndex[HOB_GUID_INDEX_MAX];
+STATIC HOB_GUID_INDEX_STATS   mHobGuidIndexStats;
+
 /**
   Returns the pointer to the HOB list.
 
@@ -96,6 +108,132 @@ GetFirstHob (
   return GetNextHob (Type, HobList);
 }
 
+/**
+  Compare a GUID HOB lookup key with a GUID HOB index entry.
+
+  Entries are sorted by GUID first and then by HOB address.
+
+  @param[in]  Guid          The GUID of the key.
+  @param[in]  Hob           The HOB address of the key.
+  @param[in]  Entry         The GUID HOB index entry.
+
+  @retval 0                 The key equals to the entry.
+  @retval <0                The key is less than the entry.
+  @retval >0                The key is greater than the entry.
+
+**/
+STATIC
+INTN
+CompareGuidHobKey (
+  IN CONST EFI_GUID           *Guid,
+  IN CONST VOID               *Hob,
+  IN CONST EFI_HOB_GUID_TYPE  *Entry
+  )
+{
+  INTN      Result;
+
+  Result = CompareMem (Guid, &Entry->Name, sizeof (EFI_GUID));
+  if (Result == 0) {
+    if ((UINTN)Hob > (UINTN)Entry) {
+      Result = 1;
+    } else if ((UINTN)Hob < (UINTN)Entry) {
+      Result = -1;
+    }
+  }
+
+  return Result;
+}
+
+/**
+  Find the position of the first GUID HOB index entry not less than a key.
+
+  @param[in]  Index         The GUID HOB index.
+  @param[in]  Guid          The GUID of the key.
+  @param[in]  Hob           The HOB address of the key.
+
+  @return The entry position, Index->Count if all entries are less than the key.
+
+**/
+STATIC
+UINT32
+GuidHobIndexLowerBound (
+  IN CONST HOB_GUID_INDEX     *Index,
+  IN CONST EFI_GUID           *Guid,
+  IN CONST VOID               *Hob
+  )
+{
+  UINT32    Low;
+  UINT32    High;
+  UINT32    Mid;
+
+  Low  = 0;
+  High = Index->Count;
+  while (Low < High) {
+    Mid = (Low + High) >> 1;
+    if (CompareGuidHobKey (Guid, Hob, Index->Entry[Mid]) > 0) {
+      Low = Mid + 1;
+    } else {
+      High = Mid;
+    }
+  }
+
+  return Low;
+}
+
+/**
+  Find the GUID HOB index covering a HOB pointer.
+
+  @param[in]  HobStart      The HOB pointer.
+
+  @return The GUID HOB index, or NULL if HobStart is not in an indexed HOB list.
+
+**/
+STATIC
+HOB_GUID_INDEX *
+FindGuidHobIndex (
+  IN CONST VOID             *HobStart
+  )
+{
+  UINT32    Idx;
+
+  for (Idx = 0; (Idx < HOB_GUID_INDEX_MAX) && (mHobGuidIndex[Idx].HobList != NULL); Idx++) {
+    if (((CONST UINT8 *)HobStart >= mHobGuidIndex[Idx].HobList) &&
+        ((CONST UINT8 *)HobStart <= mHobGuidIndex[Idx].IndexedEnd)) {
+      return &mHobGuidIndex[Idx];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Look up the first indexed GUID HOB at or after a HOB pointer.
+
+  @param[in]  Index         The GUID HOB index.
+  @param[in]  Guid          The GUID to match with.
+  @param[in]  HobStart      The starting HOB pointer.
+
+  @return The matched GUID HOB, or NULL if it is not indexed.
+
+**/
+STATIC
+VOID *
+LookupGuidHobIndex (
+  IN CONST HOB_GUID_INDEX   *Index,
+  IN CONST EFI_GUID         *Guid,
+  IN CONST VOID             *HobStart
+  )
+{
+  UINT32    Pos;
+
+  Pos = GuidHobIndexLowerBound (Index, Guid, HobStart);
+  if ((Pos < Index->Count) && CompareGuid (Guid, &Index->Entry[Pos]->Name)) {
+    return Index->Entry[Pos];
+  }
+
+  return NULL;
+}
+
 /**
   Returns the next instance of the matched GUID HOB from the starting HOB.
 
@@ -126,6 +264,20 @@ GetNextGuidHob (
   )
 {
   EFI_PEI_HOB_POINTERS  GuidHob;
+  HOB_GUID_INDEX       *Index;
+
+  Index = FindGuidHobIndex (HobStart);
+  if (Index != NULL) {
+    mHobGuidIndexStats.IndexedLookups++;
+    GuidHob.Raw = LookupGuidHobIndex (Index, Guid, HobStart);
+    if (GuidHob.Raw != NULL) {
+      return GuidHob.Raw;
+    }
+    // Only HOBs appended after the index was built are left to check
+    HobStart = Index->IndexedEnd;
+  } else if (mHobGuidIndex[0].HobList != NULL) {
+    mHobGuidIndexStats.WalkedLookups++;
+  }
 
   GuidHob.Raw = (UINT8 *) HobStart;
   while ((GuidHob.Raw = GetNextHob (EFI_HOB_TYPE_GUID_EXTENSION, GuidHob.Raw)) != NULL) {
@@ -166,3 +318,98 @@ GetFirstGuidHob (
   HobList = GetHobList ();
   return GetNextGuidHob (Guid, HobList);
 }
+
+/**
+  Build a sorted GUID index for a HOB list.
+
+  GetNextGuidHob () and GetFirstGuidHob () use the index for any lookup starting
+  inside the indexed list. HOBs appended to the list after the index was built
+  are still found by walking the part of the list that follows the indexed HOBs.
+  The HOBs already in the list must not be removed or changed afterwards.
+
+  @param[in]  HobList         The HOB list to index.
+
+  @retval EFI_SUCCESS             The index was built or already exists.
+  @retval EFI_INVALID_PARAMETER   HobList is NULL.
+  @retval EFI_OUT_OF_RESOURCES    No free index slot or not enough memory.
+
+**/
+EFI_STATUS
+EFIAPI
+BuildGuidHobIndex (
+  IN CONST VOID            *HobList
+  )
+{
+  HOB_GUID_INDEX        *Index;
+  EFI_PEI_HOB_POINTERS   Hob;
+  UINT32                 Count;
+  UINT32                 Pos;
+  UINT32                 Idx;
+
+  if (HobList == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Index = NULL;
+  for (Idx = 0; Idx < HOB_GUID_INDEX_MAX; Idx++) {
+    if (mHobGuidIndex[Idx].HobList == HobList) {
+      return EFI_SUCCESS;
+    }
+    if (mHobGuidIndex[Idx].HobList == NULL) {
+      Index = &mHobGuidIndex[Idx];
+      break;
+    }
+  }
+  if (Index == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Count   = 0;
+  Hob.Raw = (UINT8 *)HobList;
+  while (!END_OF_HOB_LIST (Hob)) {
+    if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      Count++;
+    }
+    Hob.Raw = GET_NEXT_HOB (Hob);
+  }
+
+  Index->Entry = AllocatePool (MAX (Count, 1) * sizeof (EFI_HOB_GUID_TYPE *));
+  if (Index->Entry == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  // HOBs are visited in address order, so the insertion keeps the sort stable
+  Index->Count = 0;
+  Hob.Raw      = (UINT8 *)HobList;
+  while (!END_OF_HOB_LIST (Hob)) {
+    if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      Pos = GuidHobIndexLowerBound (Index, &Hob.Guid->Name, Hob.Raw);
+      CopyMem (&Index->Entry[Pos + 1], &Index->Entry[Pos], (Index->Count - Pos) * sizeof (EFI_HOB_GUID_TYPE *));
+      Index->Entry[Pos] = Hob.Guid;
+      Index->Count++;
+    }
+    Hob.Raw = GET_NEXT_HOB (Hob);
+  }
+
+  Index->IndexedEnd = Hob.Raw;
+  Index->HobList    = HobList;
+
+  DEBUG ((DEBUG_VERBOSE, "Indexed %d GUID HOBs in HOB list 0x%p\n", Index->Count, HobList));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the GUID HOB lookup counters.
+
+  @retval   Pointer to the GUID HOB lookup counters.
+
+**/
+CONST HOB_GUID_INDEX_STATS *
+EFIAPI
+GetGuidHobIndexStats (
+  VOID
+  )
+{
+  return &mHobGuidIndexStats;
+}
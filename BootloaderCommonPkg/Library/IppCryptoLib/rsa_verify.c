@@ -11,20 +11,105 @@
 #include "pcpngrsa.h"
 #include "pcphash.h"
 #include "pcptool.h"
+#include "gsmodmethod.h"
 
 #include <Library/CryptoLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/BlMemoryAllocationLib.h>
+#include <Library/BootloaderCommonLib.h>
+
+#define RSA_KEY_CACHE_SIGNATURE   SIGNATURE_32 ('R', 'K', 'C', 'H')
+#define RSA_KEY_CACHE_ENTRIES     2
+#define RSA_KEY_CACHE_ALIGNMENT   16
+
+//
+// An initialized IPP public key state keeps absolute pointers into itself and
+// into the module that built it. The cache lives in the library data, which is
+// copied to permanent memory in Stage1B and into the payload, so an entry is
+// only reused when it was built by the current module at its current address
+// and is rebuilt in place otherwise.
+//
+typedef struct {
+  UINT32      KeyTag;
+  UINT16      KeySize;
+  UINT16      Reserved;
+  UINT64      ModuleTag;
+  UINT64      StateBase;
+  UINT8       KeyData[RSA_MOD_SIZE_MAX + RSA_E_SIZE];
+} RSA_KEY_CACHE_ENTRY;
+
+typedef struct {
+  UINT32      Signature;
+  UINT32      EntrySize;
+  UINT32      EntryCount;
+  UINT32      NextVictim;
+} RSA_KEY_CACHE;
+
+/* Compute the tag to index a public key in the key cache.
+ */
+static UINT32 GetRsaKeyTag (CONST UINT8 *KeyData, UINT16 KeySize)
+{
+  UINT32  Tag;
+  UINT16  Idx;
 
-/* Wrapper function for RSA PKCS_1.5 Verify to make the inferface consistent.
- * Returns non-zero on failure, 0 on success.
+  // FNV-1a
+  Tag = 0x811C9DC5;
+  for (Idx = 0; Idx < KeySize; Idx++) {
+    Tag = (Tag ^ KeyData[Idx]) * 0x01000193;
+  }
+
+  return (Tag == 0) ? 1 : Tag;
+}
+
+/* Return the public key cache from the library data, create it on first use.
+ * Returns NULL if the cache is not available.
  */
-int VerifyRsaPkcs1Signature (CONST PUB_KEY_HDR *PubKeyHdr, CONST SIGNATURE_HDR *SignatureHdr,  CONST UINT8  *Hash)
+static RSA_KEY_CACHE *GetRsaKeyCache (void)
+{
+  RSA_KEY_CACHE  *Cache;
+  EFI_STATUS      Status;
+  int             sz_rsa;
+  UINT32          EntrySize;
+  UINT32          CacheSize;
+
+  Cache  = NULL;
+  Status = GetLibraryData (PcdGet8 (PcdCryptoLibId), (VOID **)&Cache);
+  if (!EFI_ERROR (Status)) {
+    return (Cache->Signature == RSA_KEY_CACHE_SIGNATURE) ? Cache : NULL;
+  }
+  if (Status != EFI_NOT_FOUND) {
+    return NULL;
+  }
+
+  if (ippsRSA_GetSizePublicKey (RSA_MOD_SIZE_MAX * 8, RSA_E_SIZE * 8, &sz_rsa) != ippStsNoErr) {
+    return NULL;
+  }
+
+  EntrySize = ALIGN_UP (sizeof (RSA_KEY_CACHE_ENTRY), RSA_KEY_CACHE_ALIGNMENT) + ALIGN_UP (sz_rsa, RSA_KEY_CACHE_ALIGNMENT);
+  CacheSize = ALIGN_UP (sizeof (RSA_KEY_CACHE), RSA_KEY_CACHE_ALIGNMENT) + EntrySize * RSA_KEY_CACHE_ENTRIES;
+  Cache = AllocateZeroPool (CacheSize);
+  if (Cache == NULL) {
+    return NULL;
+  }
+
+  Cache->Signature  = RSA_KEY_CACHE_SIGNATURE;
+  Cache->EntrySize  = EntrySize;
+  Cache->EntryCount = RSA_KEY_CACHE_ENTRIES;
+  if (EFI_ERROR (SetLibraryData (PcdGet8 (PcdCryptoLibId), Cache, CacheSize))) {
+    FreePool (Cache);
+    return NULL;
+  }
+
+  return Cache;
+}
+
+/* Build an IPP public key state from the public key into the given buffer.
+ * Returns ippStsNoErr on success.
+ */
+static IppStatus BuildRsaPublicKey (CONST PUB_KEY_HDR *PubKeyHdr, IppsRSAPublicKeyState *rsa_key_s, int sz_rsa)
 {
   int    sz_n;
   int    sz_e;
-  int    sz_rsa;
-  int    sz_scratch;
-  int    signature_verified;
 
   Ipp8u  *rsa_n;
   Ipp8u  *rsa_e;
@@ -32,23 +117,12 @@ int VerifyRsaPkcs1Signature (CONST PUB_KEY_HDR *PubKeyHdr, CONST SIGNATURE_HDR *
   Ipp8u  *bn_buf;
   IppsBigNumState *bn_rsa_n;
   IppsBigNumState *bn_rsa_e;
-  Ipp8u *scratch_buf;
   IppStatus err;
-  IppsRSAPublicKeyState *rsa_key_s;
-  Ipp8u *bn_buf_ptr;
-  const IppsHashMethod  *pHashMethod = NULL;
-
-  signature_verified = 0;
 
   rsa_n = (Ipp8u *) PubKeyHdr->KeyData;
   rsa_e = (Ipp8u *) PubKeyHdr->KeyData + PubKeyHdr->KeySize - RSA_E_SIZE;
   mod_len = PubKeyHdr->KeySize - RSA_E_SIZE;
 
-  err = ippsRSA_GetSizePublicKey(mod_len * 8, RSA_E_SIZE * 8, &sz_rsa);
-  if (err != ippStsNoErr) {
-    return err;
-  }
-
   err = ippsBigNumGetSize(mod_len / sizeof(Ipp32u), &sz_n);
   if (err != ippStsNoErr) {
     return err;
@@ -59,23 +133,17 @@ int VerifyRsaPkcs1Signature (CONST PUB_KEY_HDR *PubKeyHdr, CONST SIGNATURE_HDR *
   }
 
   // Allign sz
-  sz_rsa = IPP_ALIGNED_SIZE (sz_rsa, sizeof(Ipp32u));
   sz_n   = IPP_ALIGNED_SIZE (sz_n, sizeof(Ipp32u));
   sz_e   = IPP_ALIGNED_SIZE (sz_e, sizeof(Ipp32u));
 
   // Allocate BN Buf
-  bn_buf = AllocateTemporaryMemory (sz_rsa + sz_n + sz_e);
+  bn_buf = AllocateTemporaryMemory (sz_n + sz_e);
   if (bn_buf ==  NULL) {
     return ippStsNoMemErr;
   }
 
-  scratch_buf  = NULL;
-  bn_buf_ptr   = bn_buf;
-  rsa_key_s    = (IppsRSAPublicKeyState*) bn_buf_ptr;
-  bn_buf_ptr   = bn_buf_ptr + sz_rsa;
-  bn_rsa_n     = (IppsBigNumState *) bn_buf_ptr;
-  bn_buf_ptr   = bn_buf_ptr + sz_n;
-  bn_rsa_e     = (IppsBigNumState *) bn_buf_ptr;
+  bn_rsa_n     = (IppsBigNumState *) bn_buf;
+  bn_rsa_e     = (IppsBigNumState *) (bn_buf + sz_n);
 
   err = ippsBigNumInit(mod_len / sizeof(Ipp32u), bn_rsa_n);
   if (err != ippStsNoErr) {
@@ -103,28 +171,149 @@ int VerifyRsaPkcs1Signature (CONST PUB_KEY_HDR *PubKeyHdr, CONST SIGNATURE_HDR *
   }
 
   err = ippsRSA_SetPublicKey(bn_rsa_n, bn_rsa_e, rsa_key_s);
-  if (err != ippStsNoErr) {
-    goto Done;
+
+  Done:
+    FreeTemporaryMemory (bn_buf);
+
+  return err;
+}
+
+/* Get an initialized IPP public key state for the public key.
+ * The state comes from the key cache when possible, otherwise it is built in
+ * temporary memory returned through key_buf and must be freed by the caller.
+ * Returns ippStsNoErr on success.
+ */
+static IppStatus GetRsaPublicKey (CONST PUB_KEY_HDR *PubKeyHdr, IppsRSAPublicKeyState **rsa_key_s, Ipp8u **key_buf)
+{
+  RSA_KEY_CACHE        *Cache;
+  RSA_KEY_CACHE_ENTRY  *Entry;
+  IppsRSAPublicKeyState *State;
+  UINT64                ModuleTag;
+  UINT32                KeyTag;
+  UINT32                Idx;
+  int                   sz_rsa;
+  IppStatus             err;
+
+  *rsa_key_s = NULL;
+  *key_buf   = NULL;
+
+  if ((PubKeyHdr->KeySize <= RSA_E_SIZE) || (PubKeyHdr->KeySize > RSA_MOD_SIZE_MAX + RSA_E_SIZE)) {
+    return ippStsSizeErr;
   }
 
-  err =ippsRSA_GetBufferSizePublicKey (&sz_scratch, rsa_key_s);
+  Cache = GetRsaKeyCache ();
+  if (Cache != NULL) {
+    KeyTag    = GetRsaKeyTag (PubKeyHdr->KeyData, PubKeyHdr->KeySize);
+    ModuleTag = (UINT64)(UINTN)gsModArithRSA ();
+    sz_rsa    = (int)(Cache->EntrySize - ALIGN_UP (sizeof (RSA_KEY_CACHE_ENTRY), RSA_KEY_CACHE_ALIGNMENT));
+
+    for (Idx = 0; Idx < Cache->EntryCount; Idx++) {
+      Entry = (RSA_KEY_CACHE_ENTRY *)((UINT8 *)Cache + ALIGN_UP (sizeof (RSA_KEY_CACHE), RSA_KEY_CACHE_ALIGNMENT) + Idx * Cache->EntrySize);
+      if ((Entry->KeyTag == KeyTag) && (Entry->KeySize == PubKeyHdr->KeySize) &&
+          (CompareMem (Entry->KeyData, PubKeyHdr->KeyData, PubKeyHdr->KeySize) == 0)) {
+        break;
+      }
+    }
+
+    if (Idx == Cache->EntryCount) {
+      Idx = Cache->NextVictim;
+      Cache->NextVictim = (Idx + 1) % Cache->EntryCount;
+      Entry = (RSA_KEY_CACHE_ENTRY *)((UINT8 *)Cache + ALIGN_UP (sizeof (RSA_KEY_CACHE), RSA_KEY_CACHE_ALIGNMENT) + Idx * Cache->EntrySize);
+      Entry->KeyTag  = 0;
+      Entry->KeySize = PubKeyHdr->KeySize;
+      CopyMem (Entry->KeyData, PubKeyHdr->KeyData, PubKeyHdr->KeySize);
+    }
+
+    State = (IppsRSAPublicKeyState *)((UINT8 *)Entry + ALIGN_UP (sizeof (RSA_KEY_CACHE_ENTRY), RSA_KEY_CACHE_ALIGNMENT));
+    if ((Entry->KeyTag != KeyTag) || (Entry->ModuleTag != ModuleTag) || (Entry->StateBase != (UINT64)(UINTN)State)) {
+      err = BuildRsaPublicKey (PubKeyHdr, State, sz_rsa);
+      if (err != ippStsNoErr) {
+        Entry->KeyTag = 0;
+        return err;
+      }
+      Entry->KeyTag    = KeyTag;
+      Entry->ModuleTag = ModuleTag;
+      Entry->StateBase = (UINT64)(UINTN)State;
+    }
+
+    *rsa_key_s = State;
+    return ippStsNoErr;
+  }
+
+  // No cache available, build the key state in temporary memory
+  err = ippsRSA_GetSizePublicKey((PubKeyHdr->KeySize - RSA_E_SIZE) * 8, RSA_E_SIZE * 8, &sz_rsa);
   if (err != ippStsNoErr) {
-    goto Done;
+    return err;
   }
 
-  scratch_buf = AllocateTemporaryMemory (sz_scratch);
-  if (scratch_buf ==  NULL) {
-    goto Done;
+  sz_rsa   = IPP_ALIGNED_SIZE (sz_rsa, sizeof(Ipp32u));
+  *key_buf = AllocateTemporaryMemory (sz_rsa);
+  if (*key_buf == NULL) {
+    return ippStsNoMemErr;
+  }
+
+  err = BuildRsaPublicKey (PubKeyHdr, (IppsRSAPublicKeyState *)*key_buf, sz_rsa);
+  if (err != ippStsNoErr) {
+    FreeTemporaryMemory (*key_buf);
+    *key_buf = NULL;
+    return err;
   }
 
+  *rsa_key_s = (IppsRSAPublicKeyState *)*key_buf;
+  return ippStsNoErr;
+}
+
+/* Get the IPP hash method for the signature hash algorithm.
+ * Returns NULL if the hash algorithm is not supported.
+ */
+static const IppsHashMethod *GetRsaHashMethod (CONST SIGNATURE_HDR *SignatureHdr)
+{
   if ((SignatureHdr->HashAlg == HASH_TYPE_SHA256) &&
       ((FixedPcdGet8(PcdIppHashLibSupportedMask) & IPP_HASHLIB_SHA2_256) != 0)) {
-    pHashMethod = ippsHashMethod_SHA256();
+    return ippsHashMethod_SHA256();
   } else if ((SignatureHdr->HashAlg == HASH_TYPE_SHA384) &&
              ((FixedPcdGet8(PcdIppHashLibSupportedMask) & IPP_HASHLIB_SHA2_384) != 0)) {
-    pHashMethod = ippsHashMethod_SHA384();
+    return ippsHashMethod_SHA384();
+  }
+
+  return NULL;
+}
+
+
+/* Wrapper function for RSA PKCS_1.5 Verify to make the inferface consistent.
+ * Returns non-zero on failure, 0 on success.
+ */
+int VerifyRsaPkcs1Signature (CONST PUB_KEY_HDR *PubKeyHdr, CONST SIGNATURE_HDR *SignatureHdr,  CONST UINT8  *Hash)
+{
+  int    sz_scratch;
+  int    signature_verified;
+
+  Ipp8u *key_buf;
+  Ipp8u *scratch_buf;
+  IppStatus err;
+  IppsRSAPublicKeyState *rsa_key_s;
+  const IppsHashMethod  *pHashMethod;
+
+  signature_verified = 0;
+  scratch_buf        = NULL;
+
+  err = GetRsaPublicKey (PubKeyHdr, &rsa_key_s, &key_buf);
+  if (err != ippStsNoErr) {
+    return err;
+  }
+
+  err =ippsRSA_GetBufferSizePublicKey (&sz_scratch, rsa_key_s);
+  if (err != ippStsNoErr) {
+    goto Done;
   }
 
+  scratch_buf = AllocateTemporaryMemory (sz_scratch);
+  if (scratch_buf ==  NULL) {
+    err = ippStsNoMemErr;
+    goto Done;
+  }
+
+  pHashMethod = GetRsaHashMethod (SignatureHdr);
   if (pHashMethod != NULL) {
     err = ippsRSAVerifyHash_PKCS1v15_rmf((const Ipp8u *)Hash, (Ipp8u *)SignatureHdr->Signature, &signature_verified, rsa_key_s, pHashMethod, scratch_buf);
   } else {
@@ -132,11 +321,11 @@ int VerifyRsaPkcs1Signature (CONST PUB_KEY_HDR *PubKeyHdr, CONST SIGNATURE_HDR *
   }
 
   Done:
-    if (scratch_buf) {
+    if (scratch_buf != NULL) {
       FreeTemporaryMemory (scratch_buf);
     }
-    if (bn_buf) {
-      FreeTemporaryMemory (bn_buf);
+    if (key_buf != NULL) {
+      FreeTemporaryMemory (key_buf);
     }
     if (err != ippStsNoErr) {
       return err;
@@ -151,94 +340,23 @@ int VerifyRsaPkcs1Signature (CONST PUB_KEY_HDR *PubKeyHdr, CONST SIGNATURE_HDR *
  */
 int VerifyRsaPssSignature (CONST PUB_KEY_HDR *PubKeyHdr, CONST SIGNATURE_HDR *SignatureHdr,  CONST UINT8  *Src, CONST UINT32  Size)
 {
-  int    sz_n;
-  int    sz_e;
-  int    sz_rsa;
   int    sz_scratch;
   int    signature_verified;
 
-  Ipp8u  *rsa_n;
-  Ipp8u  *rsa_e;
-  Ipp16u  mod_len;
-  Ipp8u  *bn_buf;
-  IppsBigNumState *bn_rsa_n;
-  IppsBigNumState *bn_rsa_e;
+  Ipp8u *key_buf;
   Ipp8u *scratch_buf;
   IppStatus err;
   IppsRSAPublicKeyState *rsa_key_s;
-  Ipp8u *bn_buf_ptr;
-  const IppsHashMethod  *pHashMethod = NULL;
-
-  scratch_buf = NULL;
+  const IppsHashMethod  *pHashMethod;
 
   signature_verified = 0;
+  scratch_buf        = NULL;
 
-  rsa_n = (Ipp8u *) PubKeyHdr->KeyData;
-  rsa_e = (Ipp8u *) PubKeyHdr->KeyData + PubKeyHdr->KeySize - RSA_E_SIZE;
-  mod_len = PubKeyHdr->KeySize - RSA_E_SIZE;
-
-  err = ippsRSA_GetSizePublicKey(mod_len * 8, RSA_E_SIZE * 8, &sz_rsa);
-  if (err != ippStsNoErr) {
-    return err;
-  }
-
-  err = ippsBigNumGetSize(mod_len / sizeof(Ipp32u), &sz_n);
-  if (err != ippStsNoErr) {
-    return err;
-  }
-  err = ippsBigNumGetSize(RSA_E_SIZE / sizeof(Ipp32u), &sz_e);
+  err = GetRsaPublicKey (PubKeyHdr, &rsa_key_s, &key_buf);
   if (err != ippStsNoErr) {
     return err;
   }
 
-  // Allign sz
-  sz_rsa = IPP_ALIGNED_SIZE (sz_rsa, sizeof(Ipp32u));
-  sz_n   = IPP_ALIGNED_SIZE (sz_n, sizeof(Ipp32u));
-  sz_e   = IPP_ALIGNED_SIZE (sz_e, sizeof(Ipp32u));
-
-  // Allocate BN Buf
-  bn_buf = AllocateTemporaryMemory (sz_rsa + sz_n + sz_e);
-  if (bn_buf ==  NULL) {
-    return ippStsNoMemErr;
-  }
-
-  bn_buf_ptr   = bn_buf;
-  rsa_key_s    = (IppsRSAPublicKeyState*) bn_buf_ptr;
-  bn_buf_ptr   = bn_buf_ptr + sz_rsa;
-  bn_rsa_n     = (IppsBigNumState *) bn_buf_ptr;
-  bn_buf_ptr   = bn_buf_ptr + sz_n;
-  bn_rsa_e     = (IppsBigNumState *) bn_buf_ptr;
-
-  err = ippsBigNumInit(mod_len / sizeof(Ipp32u), bn_rsa_n);
-  if (err != ippStsNoErr) {
-    goto Done;
-  }
-
-  err = ippsSetOctString_BN(rsa_n, mod_len, bn_rsa_n);
-  if (err != ippStsNoErr) {
-    goto Done;
-  }
-
-  err = ippsBigNumInit(RSA_E_SIZE / sizeof(Ipp32u), bn_rsa_e);
-  if (err != ippStsNoErr) {
-    goto Done;
-  }
-
-  err = ippsSetOctString_BN(rsa_e, RSA_E_SIZE, bn_rsa_e);
-  if (err != ippStsNoErr) {
-    goto Done;
-  }
-
-  err = ippsRSA_InitPublicKey(mod_len * 8, RSA_E_SIZE * 8, rsa_key_s, sz_rsa);
-  if (err != ippStsNoErr) {
-    goto Done;
-  }
-
-  err = ippsRSA_SetPublicKey(bn_rsa_n, bn_rsa_e, rsa_key_s);
-  if (err != ippStsNoErr) {
-    goto Done;
-  }
-
   err =ippsRSA_GetBufferSizePublicKey (&sz_scratch, rsa_key_s);
   if (err != ippStsNoErr) {
     goto Done;
@@ -246,17 +364,11 @@ int VerifyRsaPssSignature (CONST PUB_KEY_HDR *PubKeyHdr, CONST SIGNATURE_HDR *Si
 
   scratch_buf = AllocateTemporaryMemory (sz_scratch);
   if (scratch_buf ==  NULL) {
+    err = ippStsNoMemErr;
     goto Done;
   }
 
-  if ((SignatureHdr->HashAlg == HASH_TYPE_SHA256)
-          && ((FixedPcdGet8(PcdIppHashLibSupportedMask) & IPP_HASHLIB_SHA2_256) != 0)){
-    pHashMethod = ippsHashMethod_SHA256();
-  } else if ((SignatureHdr->HashAlg == HASH_TYPE_SHA384)
-          && ((FixedPcdGet8(PcdIppHashLibSupportedMask) & IPP_HASHLIB_SHA2_384) != 0)){
-     pHashMethod = ippsHashMethod_SHA384();
-  }
-
+  pHashMethod = GetRsaHashMethod (SignatureHdr);
   if (pHashMethod != NULL) {
     err = ippsRSAVerify_PSS_rmf((const Ipp8u *)Src, Size, (Ipp8u *)SignatureHdr->Signature, &signature_verified, rsa_key_s, pHashMethod, scratch_buf);
   } else {
@@ -267,8 +379,8 @@ int VerifyRsaPssSignature (CONST PUB_KEY_HDR *PubKeyHdr, CONST SIGNATURE_HDR *Si
     if (scratch_buf != NULL) {
       FreeTemporaryMemory (scratch_buf);
     }
-    if (bn_buf) {
-      FreeTemporaryMemory (bn_buf);
+    if (key_buf != NULL) {
+      FreeTemporaryMemory (key_buf);
     }
     if (err != ippStsNoErr) {
       return err;
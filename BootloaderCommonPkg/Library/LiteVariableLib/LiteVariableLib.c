@@ -175,6 +175,91 @@ IsVariableStoreValid (
   }
 }
 
+/**
+
+  This function returns a variable store bank header pointer.
+
+  @param    Bank      Variable store bank index.
+  @param    BankSize  Pointer to receive the variable store bank size.
+
+  @retval   Variable store bank header pointer, NULL if the store is not configured.
+
+**/
+STATIC
+VARIABLE_STORE_HEADER *
+GetVariableBank (
+  IN  UINT32    Bank,
+  OUT UINT32   *BankSize  OPTIONAL
+  )
+{
+  UINT8                  *VarStoreBase;
+  UINT32                  VarStoreLen;
+
+  VarStoreBase = (UINT8 *)GetVaraibelStoreBase (&VarStoreLen);
+  if (VarStoreBase == NULL) {
+    return NULL;
+  }
+
+  VarStoreLen /= VARIABLE_STORE_BANKS;
+  if (BankSize != NULL) {
+    *BankSize = VarStoreLen;
+  }
+
+  return (VARIABLE_STORE_HEADER *) (VarStoreBase + VarStoreLen * (Bank % VARIABLE_STORE_BANKS));
+}
+
+/**
+
+  This function checks if a variable store bank holds the active store.
+
+  @param    VarStoreHdrPtr      Variable store bank header pointer.
+  @param    BankSize            Variable store bank size.
+
+  @retval   TRUE          The bank has a valid store header and is not deleted.
+  @retval   FALSE         The bank is erased, stale or corrupted.
+
+**/
+STATIC
+BOOLEAN
+IsVariableBankActive (
+  IN  VARIABLE_STORE_HEADER  *VarStoreHdrPtr,
+  IN  UINT32                  BankSize
+  )
+{
+  return (BOOLEAN) (IsVariableStoreValid (VarStoreHdrPtr) && (VarStoreHdrPtr->Size == BankSize) &&
+                    IS_HEADER_VALID (VarStoreHdrPtr->State) && !IS_DELETED (VarStoreHdrPtr->State));
+}
+
+/**
+
+  This function checks if a variable store bank is erased.
+
+  @param    VarStoreHdrPtr      Variable store bank header pointer.
+  @param    Length              Number of bytes to check from the bank start.
+
+  @retval   TRUE          The checked range is erased.
+  @retval   FALSE         The checked range needs to be erased before use.
+
+**/
+STATIC
+BOOLEAN
+IsVariableBankErased (
+  IN  VARIABLE_STORE_HEADER  *VarStoreHdrPtr,
+  IN  UINT32                  Length
+  )
+{
+  UINT32                 *Ptr;
+  UINT32                  Idx;
+
+  Ptr = (UINT32 *)VarStoreHdrPtr;
+  for (Idx = 0; Idx < Length / sizeof (UINT32); Idx++) {
+    if (Ptr[Idx] != MAX_UINT32) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
 /**
 
   This function returns the active variable store header pointer.
@@ -189,28 +274,25 @@ GetActiveVaraibelStoreBase (
   IN UINT32    *Size
   )
 {
-  UINT32                  VarStoreLen;
-  VARIABLE_STORE_HEADER  *VarStoreHdrPtr1;
-  VARIABLE_STORE_HEADER  *VarStoreHdrPtr2;
+  UINT32                  BankSize;
+  UINT32                  Bank;
   VARIABLE_STORE_HEADER  *VarStoreHdrPtr;
 
-  VarStoreHdrPtr1 = (VARIABLE_STORE_HEADER *)GetVaraibelStoreBase (&VarStoreLen);
-  if (VarStoreHdrPtr1 == NULL) {
-    return NULL;
-  }
-
-  VarStoreHdrPtr2 = (VARIABLE_STORE_HEADER *) ((UINT8 *)VarStoreHdrPtr1 + (VarStoreLen >> 1));
-  if (((VarStoreHdrPtr1->State & VAR_HEADER_VALID) == 0) && ((VarStoreHdrPtr1->State & VAR_DELETED) != 0)) {
-    VarStoreHdrPtr = VarStoreHdrPtr1;
-  } else if (((VarStoreHdrPtr2->State & VAR_HEADER_VALID) == 0) && ((VarStoreHdrPtr2->State & VAR_DELETED) != 0)) {
-    VarStoreHdrPtr = VarStoreHdrPtr2;
-  } else {
+  VarStoreHdrPtr = NULL;
+  for (Bank = 0; Bank < VARIABLE_STORE_BANKS; Bank++) {
+    VarStoreHdrPtr = GetVariableBank (Bank, &BankSize);
+    if (VarStoreHdrPtr == NULL) {
+      return NULL;
+    }
+    if (IsVariableBankActive (VarStoreHdrPtr, BankSize)) {
+      break;
+    }
     VarStoreHdrPtr = NULL;
   }
 
   ASSERT ((VarStoreHdrPtr != NULL) && (VarStoreHdrPtr->Signature == VARIABLE_STORE_SIGNATURE));
 
-  if (Size) {
+  if (Size && (VarStoreHdrPtr != NULL)) {
     *Size = VarStoreHdrPtr->Size;
   }
 
@@ -235,65 +317,59 @@ InitializeVariableStore (
 {
   UINT32                  FullVarStoreLen;
   UINT32                  VarStoreLen;
+  UINT32                  Bank;
   VARIABLE_STORE_HEADER   VarStoreHdr;
-  VARIABLE_STORE_HEADER  *VarStoreHdrPtr1;
-  VARIABLE_STORE_HEADER  *VarStoreHdrPtr2;
+  VARIABLE_STORE_HEADER  *VarStoreHdrPtr;
   VARIABLE_STORE_HEADER  *ActivateVarStoreHdrPtr;
   VARIABLE_STORE_HEADER  *InactiveVarStoreHdrPtr;
   UINT8                   State;
   EFI_STATUS              Status;
 
-  VarStoreHdrPtr1 = (VARIABLE_STORE_HEADER *)GetVaraibelStoreBase (&FullVarStoreLen);
-  if (VarStoreHdrPtr1 == NULL) {
+  if (GetVaraibelStoreBase (&FullVarStoreLen) == NULL) {
     return EFI_NOT_READY;
   }
 
-  VarStoreLen     = FullVarStoreLen >> 1;
-  VarStoreHdrPtr2 = (VARIABLE_STORE_HEADER *) ((UINT8 *)VarStoreHdrPtr1 + VarStoreLen);
+  ActivateVarStoreHdrPtr = NULL;
+  for (Bank = 0; Bank < VARIABLE_STORE_BANKS; Bank++) {
+    VarStoreHdrPtr = GetVariableBank (Bank, &VarStoreLen);
+    if (!IsVariableBankActive (VarStoreHdrPtr, VarStoreLen)) {
+      continue;
+    }
+
+    if (ActivateVarStoreHdrPtr == NULL) {
+      ActivateVarStoreHdrPtr = VarStoreHdrPtr;
+      continue;
+    }
 
-  if (((VarStoreHdrPtr1->State & VAR_HEADER_VALID) == 0) && ((VarStoreHdrPtr2->State & VAR_HEADER_VALID) == 0)) {
     //
-    // Both headers are valid, check delete state
+    // Both headers are active, check migration state
     //
-    if ((VarStoreHdrPtr1->State & VAR_DELETED) == 0) {
-      ActivateVarStoreHdrPtr = VarStoreHdrPtr2;
-    } else if ((VarStoreHdrPtr2->State & VAR_DELETED) == 0) {
-      ActivateVarStoreHdrPtr = VarStoreHdrPtr1;
+    if (IS_IN_MIGRATION (ActivateVarStoreHdrPtr->State)) {
+      InactiveVarStoreHdrPtr = ActivateVarStoreHdrPtr;
+      ActivateVarStoreHdrPtr = VarStoreHdrPtr;
     } else {
-      //
-      // Both headers are active, check migration state
-      //
-      if ((VarStoreHdrPtr1->State & VAR_IN_MIGRATION) == 0) {
-        ActivateVarStoreHdrPtr = VarStoreHdrPtr2;
-        InactiveVarStoreHdrPtr = VarStoreHdrPtr1;
-      } else {
-        ActivateVarStoreHdrPtr = VarStoreHdrPtr1;
-        InactiveVarStoreHdrPtr = VarStoreHdrPtr2;
-      }
-      //
-      // Mark migration copy as deleted
-      //
-      State  = InactiveVarStoreHdrPtr->State & ~VAR_DELETED;
-      Status = WriteVariableStore (&InactiveVarStoreHdrPtr->State, sizeof (InactiveVarStoreHdrPtr->State), &State);
-      if (EFI_ERROR (Status)) {
-        return Status;
-      }
+      InactiveVarStoreHdrPtr = VarStoreHdrPtr;
+    }
+
+    //
+    // Mark migration copy as deleted
+    //
+    State  = InactiveVarStoreHdrPtr->State & ~VAR_DELETED;
+    Status = WriteVariableStore (&InactiveVarStoreHdrPtr->State, sizeof (InactiveVarStoreHdrPtr->State), &State);
+    if (EFI_ERROR (Status)) {
+      return Status;
     }
-  } else if ((VarStoreHdrPtr2->State & VAR_HEADER_VALID) == 0) {
-    ActivateVarStoreHdrPtr = VarStoreHdrPtr2;
-  } else {
-    ActivateVarStoreHdrPtr = VarStoreHdrPtr1;
   }
 
-  if (!IsVariableStoreValid (ActivateVarStoreHdrPtr)) {
+  if (ActivateVarStoreHdrPtr == NULL) {
     //
     // Erase current partition
     //
-    Status = EraseVariableStore (VarStoreHdrPtr1, VarStoreLen * 2);
+    ActivateVarStoreHdrPtr = GetVariableBank (0, &VarStoreLen);
+    Status = EraseVariableStore (ActivateVarStoreHdrPtr, FullVarStoreLen);
     if (EFI_ERROR (Status)) {
       return EFI_DEVICE_ERROR;
     }
-    ActivateVarStoreHdrPtr = VarStoreHdrPtr1;
 
     //
     // Write store header
@@ -321,6 +397,348 @@ InitializeVariableStore (
   return EFI_SUCCESS;
 }
 
+/**
+  Calculate the hash of a variable name.
+
+  @param[in]  VariableName      Variable name.
+
+  @retval     The variable name hash.
+
+**/
+STATIC
+UINT32
+GetVariableNameHash (
+  IN CONST CHAR8            *VariableName
+  )
+{
+  UINT32                  Hash;
+
+  // FNV-1a
+  Hash = 0x811C9DC5;
+  while (*VariableName != 0) {
+    Hash = (Hash ^ (UINT8)*VariableName++) * 0x01000193;
+  }
+
+  return Hash;
+}
+
+/**
+  Check if the variable name index matches the variable store.
+
+  @param[in]  VarInstance       Variable instance.
+  @param[in]  VarStoreHdrPtr    Active variable store header pointer.
+
+  @retval     TRUE              The index can be used for the variable store.
+  @retval     FALSE             The index needs to be rebuilt.
+
+**/
+STATIC
+BOOLEAN
+IsVariableIndexValid (
+  IN VARIABLE_INSTANCE      *VarInstance,
+  IN VARIABLE_STORE_HEADER  *VarStoreHdrPtr
+  )
+{
+  VARIABLE_HEADER        *VarHdrPtr;
+
+  if ((VarInstance->IndexBase == 0) || (VarInstance->IndexOwner != (UINT32)(UINTN)&mVariableService) ||
+      (VarInstance->IndexedStore != (UINT32)(UINTN)VarStoreHdrPtr)) {
+    return FALSE;
+  }
+
+  // Nothing must have been appended to the store since the index was updated
+  if (VarInstance->IndexedEnd < VarStoreHdrPtr->Size) {
+    VarHdrPtr = (VARIABLE_HEADER *)((UINT8 *)VarStoreHdrPtr + VarInstance->IndexedEnd);
+    if (IS_HEADER_VALID (VarHdrPtr->State)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Add a slot to a variable name index without checking for duplicates.
+
+  @param[in]  Index             Variable name index slots.
+  @param[in]  IndexSize         Number of slots, a power of 2.
+  @param[in]  Hash              Variable name hash.
+  @param[in]  Offset            Variable header offset in the variable store.
+
+  @retval     TRUE              An empty slot was used.
+  @retval     FALSE             A deleted slot was reused.
+
+**/
+STATIC
+BOOLEAN
+AddVariableIndexEntry (
+  IN VARIABLE_INDEX_ENTRY   *Index,
+  IN UINT32                  IndexSize,
+  IN UINT32                  Hash,
+  IN UINT32                  Offset
+  )
+{
+  UINT32                  Slot;
+
+  Slot = Hash & (IndexSize - 1);
+  while ((Index[Slot].Offset != 0) && (Index[Slot].Offset != VARIABLE_INDEX_DELETED)) {
+    Slot = (Slot + 1) & (IndexSize - 1);
+  }
+
+  Index[Slot].Hash   = Hash;
+  if (Index[Slot].Offset == 0) {
+    Index[Slot].Offset = Offset;
+    return TRUE;
+  }
+  Index[Slot].Offset = Offset;
+  return FALSE;
+}
+
+/**
+  Look up a variable in the variable name index.
+
+  @param[in]  VarInstance       Variable instance.
+  @param[in]  VarStoreHdrPtr    Variable store header pointer the index refers to.
+  @param[in]  VariableName      Variable name.
+  @param[in]  Hash              Variable name hash.
+
+  @retval     The index slot of the variable, or NULL if it is not indexed.
+
+**/
+STATIC
+VARIABLE_INDEX_ENTRY *
+LookupVariableIndex (
+  IN VARIABLE_INSTANCE      *VarInstance,
+  IN VARIABLE_STORE_HEADER  *VarStoreHdrPtr,
+  IN CONST CHAR8            *VariableName,
+  IN UINT32                  Hash
+  )
+{
+  VARIABLE_INDEX_ENTRY   *Index;
+  VARIABLE_HEADER        *VarHdrPtr;
+  UINT32                  Slot;
+  UINT32                  Count;
+
+  Index = (VARIABLE_INDEX_ENTRY *)(UINTN)VarInstance->IndexBase;
+  if (Index == NULL) {
+    return NULL;
+  }
+
+  Slot = Hash & (VarInstance->IndexSize - 1);
+  for (Count = 0; (Count < VarInstance->IndexSize) && (Index[Slot].Offset != 0); Count++) {
+    if ((Index[Slot].Offset != VARIABLE_INDEX_DELETED) && (Index[Slot].Hash == Hash)) {
+      VarHdrPtr = (VARIABLE_HEADER *)((UINT8 *)VarStoreHdrPtr + Index[Slot].Offset);
+      if (AsciiStrCmp ((CONST CHAR8 *)&VarHdrPtr[1], VariableName) == 0) {
+        return &Index[Slot];
+      }
+    }
+    Slot = (Slot + 1) & (VarInstance->IndexSize - 1);
+  }
+
+  return NULL;
+}
+
+/**
+  Allocate the variable name index slots.
+
+  Live slots are moved over to the new slots if the index is owned by
+  this module.
+
+  @param[in]  VarInstance       Variable instance.
+  @param[in]  IndexSize         Number of slots, a power of 2.
+
+  @retval     EFI_SUCCESS            The index slots were allocated.
+  @retval     EFI_OUT_OF_RESOURCES   Not enough memory.
+
+**/
+STATIC
+EFI_STATUS
+ResizeVariableIndex (
+  IN VARIABLE_INSTANCE      *VarInstance,
+  IN UINT32                  IndexSize
+  )
+{
+  VARIABLE_INDEX_ENTRY   *Index;
+  VARIABLE_INDEX_ENTRY   *OldIndex;
+  UINT32                  Slot;
+
+  Index = AllocateZeroPool (IndexSize * sizeof (VARIABLE_INDEX_ENTRY));
+  if (Index == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  VarInstance->IndexUsed = 0;
+  OldIndex = (VARIABLE_INDEX_ENTRY *)(UINTN)VarInstance->IndexBase;
+  if ((OldIndex != NULL) && (VarInstance->IndexOwner == (UINT32)(UINTN)&mVariableService)) {
+    for (Slot = 0; Slot < VarInstance->IndexSize; Slot++) {
+      if ((OldIndex[Slot].Offset != 0) && (OldIndex[Slot].Offset != VARIABLE_INDEX_DELETED)) {
+        AddVariableIndexEntry (Index, IndexSize, OldIndex[Slot].Hash, OldIndex[Slot].Offset);
+        VarInstance->IndexUsed++;
+      }
+    }
+    FreePool (OldIndex);
+  }
+
+  VarInstance->IndexOwner = (UINT32)(UINTN)&mVariableService;
+  VarInstance->IndexBase  = (UINT32)(UINTN)Index;
+  VarInstance->IndexSize  = IndexSize;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Add or update a variable in the variable name index.
+
+  @param[in]  VarInstance       Variable instance.
+  @param[in]  VarStoreHdrPtr    Variable store header pointer the index refers to.
+  @param[in]  VariableName      Variable name.
+  @param[in]  Hash              Variable name hash.
+  @param[in]  Offset            Variable header offset in the variable store.
+
+  @retval     EFI_SUCCESS            The variable was indexed.
+  @retval     EFI_OUT_OF_RESOURCES   Not enough memory to grow the index.
+
+**/
+STATIC
+EFI_STATUS
+InsertVariableIndex (
+  IN VARIABLE_INSTANCE      *VarInstance,
+  IN VARIABLE_STORE_HEADER  *VarStoreHdrPtr,
+  IN CONST CHAR8            *VariableName,
+  IN UINT32                  Hash,
+  IN UINT32                  Offset
+  )
+{
+  VARIABLE_INDEX_ENTRY   *Entry;
+  EFI_STATUS              Status;
+
+  Entry = LookupVariableIndex (VarInstance, VarStoreHdrPtr, VariableName, Hash);
+  if (Entry != NULL) {
+    Entry->Offset = Offset;
+    return EFI_SUCCESS;
+  }
+
+  // Keep the load factor below 3/4, deleted slots included
+  if ((VarInstance->IndexUsed + 1) * 4 > VarInstance->IndexSize * 3) {
+    Status = ResizeVariableIndex (VarInstance, VarInstance->IndexSize * 2);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  if (AddVariableIndexEntry ((VARIABLE_INDEX_ENTRY *)(UINTN)VarInstance->IndexBase,
+                             VarInstance->IndexSize, Hash, Offset)) {
+    VarInstance->IndexUsed++;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Build the variable name index for a variable store.
+
+  Every name is mapped to the same variable InternalGetVariable () would
+  find by walking the store: the first one not in migration, or else the
+  last one. The index is marked valid only if the whole store was indexed.
+
+  @param[in]  VarInstance       Variable instance.
+  @param[in]  VarStoreHdrPtr    Variable store header pointer.
+
+  @retval     EFI_SUCCESS            The index was built.
+  @retval     EFI_VOLUME_CORRUPTED   The store is corrupted, the index only covers
+                                     the variables before the corruption.
+  @retval     EFI_OUT_OF_RESOURCES   Not enough memory.
+
+**/
+STATIC
+EFI_STATUS
+BuildVariableIndex (
+  IN VARIABLE_INSTANCE      *VarInstance,
+  IN VARIABLE_STORE_HEADER  *VarStoreHdrPtr
+  )
+{
+  VARIABLE_HEADER        *VarHdrPtr;
+  VARIABLE_HEADER        *IdxHdrPtr;
+  VARIABLE_INDEX_ENTRY   *Entry;
+  UINT8                  *VarEndPtr;
+  UINT32                  Count;
+  UINT32                  IndexSize;
+  UINT32                  Hash;
+  UINT32                  Offset;
+  EFI_STATUS              Status;
+
+  VarInstance->IndexedStore = 0;
+
+  VarHdrPtr = (VARIABLE_HEADER *)&VarStoreHdrPtr[1];
+  VarEndPtr = (UINT8 *)VarStoreHdrPtr + VarStoreHdrPtr->Size;
+  Count     = 0;
+  while (((UINT8 *)VarHdrPtr < VarEndPtr) && IS_HEADER_VALID (VarHdrPtr->State)) {
+    if (IS_DATA_VALID (VarHdrPtr->State) && !IS_DELETED (VarHdrPtr->State)) {
+      Count++;
+    }
+    VarHdrPtr = (VARIABLE_HEADER *) ((UINT8 *)&VarHdrPtr[1] + VarHdrPtr->DataSize);
+  }
+
+  IndexSize = VARIABLE_INDEX_MIN_SIZE;
+  while (IndexSize < Count * 2) {
+    IndexSize <<= 1;
+  }
+
+  if ((VarInstance->IndexBase != 0) && (VarInstance->IndexOwner == (UINT32)(UINTN)&mVariableService) &&
+      (VarInstance->IndexSize >= IndexSize)) {
+    ZeroMem ((VOID *)(UINTN)VarInstance->IndexBase, VarInstance->IndexSize * sizeof (VARIABLE_INDEX_ENTRY));
+    VarInstance->IndexUsed = 0;
+  } else {
+    if ((VarInstance->IndexBase != 0) && (VarInstance->IndexOwner == (UINT32)(UINTN)&mVariableService)) {
+      FreePool ((VOID *)(UINTN)VarInstance->IndexBase);
+    }
+    VarInstance->IndexBase = 0;
+    Status = ResizeVariableIndex (VarInstance, IndexSize);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  Status    = EFI_SUCCESS;
+  VarHdrPtr = (VARIABLE_HEADER *)&VarStoreHdrPtr[1];
+  while ((UINT8 *)VarHdrPtr < VarEndPtr) {
+    if (!IS_HEADER_VALID (VarHdrPtr->State)) {
+      break;
+    }
+
+    if (VarHdrPtr->StartId != VARIABLE_DATA) {
+      Status = EFI_VOLUME_CORRUPTED;
+      break;
+    }
+
+    if (IS_DATA_VALID (VarHdrPtr->State) && !IS_DELETED (VarHdrPtr->State)) {
+      Offset = (UINT32)((UINT8 *)VarHdrPtr - (UINT8 *)VarStoreHdrPtr);
+      Hash   = GetVariableNameHash ((CONST CHAR8 *)&VarHdrPtr[1]);
+      Entry  = LookupVariableIndex (VarInstance, VarStoreHdrPtr, (CONST CHAR8 *)&VarHdrPtr[1], Hash);
+      if (Entry == NULL) {
+        if (AddVariableIndexEntry ((VARIABLE_INDEX_ENTRY *)(UINTN)VarInstance->IndexBase,
+                                   VarInstance->IndexSize, Hash, Offset)) {
+          VarInstance->IndexUsed++;
+        }
+      } else {
+        IdxHdrPtr = (VARIABLE_HEADER *)((UINT8 *)VarStoreHdrPtr + Entry->Offset);
+        if (IS_IN_MIGRATION (IdxHdrPtr->State)) {
+          Entry->Offset = Offset;
+        }
+      }
+    }
+
+    VarHdrPtr = (VARIABLE_HEADER *) ((UINT8 *)&VarHdrPtr[1] + VarHdrPtr->DataSize);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    VarInstance->IndexedEnd   = (UINT32)((UINT8 *)VarHdrPtr - (UINT8 *)VarStoreHdrPtr);
+    VarInstance->IndexedStore = (UINT32)(UINTN)VarStoreHdrPtr;
+  }
+
+  return Status;
+}
+
 /**
 
   This internal function finds variable in storage blocks.
@@ -363,6 +781,8 @@ InternalGetVariable (
   UINT32                  VariableNameLen;
   UINT32                  VariableDataLen;
   UINTN                   DataSizeIn;
+  VARIABLE_INSTANCE      *VarInstance;
+  VARIABLE_INDEX_ENTRY   *Entry;
 
   if ((DataSize == NULL) || (VariableName == NULL)) {
     return EFI_INVALID_PARAMETER;
@@ -374,39 +794,57 @@ InternalGetVariable (
   }
 
   VariableNameLen = (UINT32)AsciiStrLen (VariableName) + 1;
-  VarHdrPtr = (VARIABLE_HEADER *)&VarStoreHdrPtr[1];
-  VarEndPtr = (UINT8 *)VarStoreHdrPtr + VarStoreHdrPtr->Size;
 
   FindVarHdrPtr = NULL;
-  while ((UINT8 *)VarHdrPtr < VarEndPtr) {
-    State = VarHdrPtr->State;
-    if (!IS_HEADER_VALID (State)) {
-      break;
+  VarInstance   = GetVariableInstance ();
+  if ((VarInstance != NULL) && (IsVariableIndexValid (VarInstance, VarStoreHdrPtr) ||
+      !EFI_ERROR (BuildVariableIndex (VarInstance, VarStoreHdrPtr)))) {
+    Entry = LookupVariableIndex (VarInstance, VarStoreHdrPtr, VariableName, GetVariableNameHash (VariableName));
+    if (Entry == NULL) {
+      return EFI_NOT_FOUND;
     }
-
-    if (VarHdrPtr->StartId != VARIABLE_DATA) {
-      VarHdrPtr = NULL;
-      break;
+    FindVarHdrPtr = (VARIABLE_HEADER *)((UINT8 *)VarStoreHdrPtr + Entry->Offset);
+    if (!IS_DATA_VALID (FindVarHdrPtr->State) || IS_DELETED (FindVarHdrPtr->State)) {
+      // The store was updated without the index, walk it instead
+      VarInstance->IndexedStore = 0;
+      FindVarHdrPtr = NULL;
     }
+  }
 
-    if (IS_DATA_VALID (State) && !IS_DELETED (State)) {
-      if (AsciiStrCmp ((VOID *)&VarHdrPtr[1], VariableName) == 0) {
-        FindVarHdrPtr = VarHdrPtr;
-        if (!IS_IN_MIGRATION (State)) {
-          break;
+  if (FindVarHdrPtr == NULL) {
+    VarHdrPtr = (VARIABLE_HEADER *)&VarStoreHdrPtr[1];
+    VarEndPtr = (UINT8 *)VarStoreHdrPtr + VarStoreHdrPtr->Size;
+
+    while ((UINT8 *)VarHdrPtr < VarEndPtr) {
+      State = VarHdrPtr->State;
+      if (!IS_HEADER_VALID (State)) {
+        break;
+      }
+
+      if (VarHdrPtr->StartId != VARIABLE_DATA) {
+        VarHdrPtr = NULL;
+        break;
+      }
+
+      if (IS_DATA_VALID (State) && !IS_DELETED (State)) {
+        if (AsciiStrCmp ((VOID *)&VarHdrPtr[1], VariableName) == 0) {
+          FindVarHdrPtr = VarHdrPtr;
+          if (!IS_IN_MIGRATION (State)) {
+            break;
+          }
         }
       }
-    }
 
-    VarHdrPtr = (VARIABLE_HEADER *) ((UINT8 *)&VarHdrPtr[1] + VarHdrPtr->DataSize);
-  }
+      VarHdrPtr = (VARIABLE_HEADER *) ((UINT8 *)&VarHdrPtr[1] + VarHdrPtr->DataSize);
+    }
 
-  if (VarHdrPtr == NULL) {
-    return EFI_VOLUME_CORRUPTED;
-  }
+    if (VarHdrPtr == NULL) {
+      return EFI_VOLUME_CORRUPTED;
+    }
 
-  if (FindVarHdrPtr == NULL) {
-    return EFI_NOT_FOUND;
+    if (FindVarHdrPtr == NULL) {
+      return EFI_NOT_FOUND;
+    }
   }
 
   DataSizeIn = *DataSize;
@@ -558,7 +996,12 @@ GetNextVariableName (
 
 /**
 
-  This function reclaim the variable store from active region to the alternative region.
+  This function reclaim the variable store from active bank to the next bank.
+
+  The banks are used in turn so that each bank is erased once every
+  VARIABLE_STORE_BANKS reclaims. The source bank is left stale and is only
+  erased by CompactVariableStore (). The target bank is erased here only if
+  that has not happened yet.
 
   @param   ActiveVarStoreHdrPtr       The active variable store header pointer
 
@@ -572,58 +1015,63 @@ Reclaim (
   IN VARIABLE_STORE_HEADER  *ActiveVarStoreHdrPtr
   )
 {
-  UINT32                  FullVarStoreLen;
   UINT32                  VarStoreLen;
+  UINT32                  Bank;
   VARIABLE_STORE_HEADER   VarStoreHdr;
-  VARIABLE_STORE_HEADER  *VarStoreHdrPtr1;
-  VARIABLE_STORE_HEADER  *VarStoreHdrPtr2;
   VARIABLE_STORE_HEADER  *InactiveVarStoreHdrPtr;
-  CHAR8                   VarName[VARIABLE_NAME_MAX_LEN];
   EFI_STATUS              Status;
   VARIABLE_HEADER        *VarHdrPtr;
   VARIABLE_HEADER         VarHdr;
+  VARIABLE_INSTANCE      *VarInstance;
+  VARIABLE_INDEX_ENTRY   *Entry;
   UINT8                  *CurPtr;
-  UINTN                   DataLen;
-  UINTN                   NameSize;
-  UINTN                   Key;
+  UINT8                  *VarEndPtr;
   UINT8                   ActiveState;
   UINT8                   InactiveState;
+  UINT64                  StartTick;
+  UINT64                  Ticks;
 
   DEBUG ((DEBUG_INFO, "Reclaiming variable storage\n"));
 
-  VarStoreHdrPtr1 = (VARIABLE_STORE_HEADER *)GetVaraibelStoreBase (&FullVarStoreLen);
-  if (VarStoreHdrPtr1 == NULL) {
+  VarInstance = GetVariableInstance ();
+  if ((VarInstance == NULL) || (GetVariableBank (0, &VarStoreLen) == NULL)) {
     return EFI_NOT_READY;
   }
 
-  VarStoreLen     = FullVarStoreLen >> 1;
-  VarStoreHdrPtr2 = (VARIABLE_STORE_HEADER *) ((UINT8 *)VarStoreHdrPtr1 + VarStoreLen);
-
-  if (VarStoreHdrPtr1 == ActiveVarStoreHdrPtr) {
-    InactiveVarStoreHdrPtr = VarStoreHdrPtr2;
-  } else {
-    InactiveVarStoreHdrPtr = VarStoreHdrPtr1;
-  }
+  StartTick = AsmReadTsc ();
+  Bank = (UINT32)((UINTN)ActiveVarStoreHdrPtr - VarInstance->StoreBase) / VarStoreLen;
+  InactiveVarStoreHdrPtr = GetVariableBank (Bank + 1, NULL);
   CurPtr = (UINT8 *) (InactiveVarStoreHdrPtr + 1);
 
   //
-  // Erase InactiveVarStoreHdrPtr
+  // Erase InactiveVarStoreHdrPtr if the deferred erase did not run yet
   //
-  Status = EraseVariableStore (InactiveVarStoreHdrPtr, VarStoreLen);
-  if (EFI_ERROR (Status)) {
-    return EFI_DEVICE_ERROR;
+  if (!IsVariableBankErased (InactiveVarStoreHdrPtr, VarStoreLen)) {
+    DEBUG ((DEBUG_INFO, "Variable bank %d is not erased in advance\n", (Bank + 1) % VARIABLE_STORE_BANKS));
+    Status = EraseVariableStore (InactiveVarStoreHdrPtr, VarStoreLen);
+    if (EFI_ERROR (Status)) {
+      return EFI_DEVICE_ERROR;
+    }
+    VarInstance->InlineEraseCount++;
   }
 
   //
-  // Copy variable over one by one
+  // Copy variable over one by one in a single pass. The name index tells
+  // which instance of a variable is the current one. On a corrupted store
+  // it only covers the variables before the corruption.
   //
-  Key = 0;
-  while (TRUE) {
-    NameSize = sizeof (VarName);
-    Status   = GetNextVariableName (&NameSize, VarName, &Key);
-    if (!EFI_ERROR (Status)) {
-      Status = InternalGetVariable (VarName, NULL, &DataLen, NULL, &VarHdrPtr);
-      if (!EFI_ERROR (Status)) {
+  Status = BuildVariableIndex (VarInstance, ActiveVarStoreHdrPtr);
+  if (Status == EFI_OUT_OF_RESOURCES) {
+    return Status;
+  }
+
+  VarHdrPtr = (VARIABLE_HEADER *)&ActiveVarStoreHdrPtr[1];
+  VarEndPtr = (UINT8 *)ActiveVarStoreHdrPtr + ActiveVarStoreHdrPtr->Size;
+  while (((UINT8 *)VarHdrPtr < VarEndPtr) && IS_HEADER_VALID (VarHdrPtr->State)) {
+    if (IS_DATA_VALID (VarHdrPtr->State) && !IS_DELETED (VarHdrPtr->State)) {
+      Entry = LookupVariableIndex (VarInstance, ActiveVarStoreHdrPtr, (CONST CHAR8 *)&VarHdrPtr[1],
+                                   GetVariableNameHash ((CONST CHAR8 *)&VarHdrPtr[1]));
+      if ((Entry != NULL) && ((UINT8 *)ActiveVarStoreHdrPtr + Entry->Offset == (UINT8 *)VarHdrPtr)) {
         CopyMem (&VarHdr, VarHdrPtr, sizeof (VarHdr));
         VarHdr.State |= VAR_IN_MIGRATION;
         Status  = WriteVariableStore (CurPtr, sizeof (VarHdr), &VarHdr);
@@ -636,11 +1084,13 @@ Reclaim (
           return Status;
         }
       }
-    } else {
-      break;
     }
+    VarHdrPtr = (VARIABLE_HEADER *) ((UINT8 *)&VarHdrPtr[1] + VarHdrPtr->DataSize);
   }
 
+  // The index is rebuilt for the new active store on next access
+  VarInstance->IndexedStore = 0;
+
   //
   // Write inactive store header
   //
@@ -679,6 +1129,12 @@ Reclaim (
     return Status;
   }
 
+  Ticks = AsmReadTsc () - StartTick;
+  VarInstance->ReclaimCount++;
+  VarInstance->ReclaimTicks += Ticks;
+  DEBUG ((DEBUG_INFO, "Variable reclaim %d into bank %d: 0x%X bytes, %ld ticks\n", VarInstance->ReclaimCount,
+          (Bank + 1) % VARIABLE_STORE_BANKS, (UINT32)(CurPtr - (UINT8 *)InactiveVarStoreHdrPtr), Ticks));
+
   return EFI_SUCCESS;
 }
 
@@ -735,6 +1191,10 @@ SetVariable (
   BOOLEAN                 SkipVarWrite;
   BOOLEAN                 CheckVarDataValid;
   BOOLEAN                 NeedReclaim;
+  VARIABLE_INSTANCE      *VarInstance;
+  VARIABLE_INDEX_ENTRY   *Entry;
+  BOOLEAN                 IndexValid;
+  UINT32                  Hash;
 
   if (VariableName == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -766,11 +1226,62 @@ SetVariable (
     return EFI_INVALID_PARAMETER;
   }
 
-  NeedReclaim   = FALSE;
-  SkipVarWrite  = FALSE;
+  //
+  // Use the name index to find the variable and the free space without
+  // walking the store. Deletes still walk the store so that a stale copy
+  // left by an interrupted update is deleted as well.
+  //
+  Hash          = GetVariableNameHash (VariableName);
+  VarInstance   = GetVariableInstance ();
+  IndexValid    = (VarInstance != NULL) && (IsVariableIndexValid (VarInstance, VarStoreHdrPtr) ||
+                  !EFI_ERROR (BuildVariableIndex (VarInstance, VarStoreHdrPtr)));
   FoundSpace    = FALSE;
   FindVarHdrPtr = NULL;
   FindVarState  = 0;
+  if (IndexValid && (DataSize > 0)) {
+    FoundSpace = TRUE;
+    Entry = LookupVariableIndex (VarInstance, VarStoreHdrPtr, VariableName, Hash);
+    if (Entry != NULL) {
+      FindVarHdrPtr = (VARIABLE_HEADER *)((UINT8 *)VarStoreHdrPtr + Entry->Offset);
+      FindVarState  = FindVarHdrPtr->State;
+      if (!IS_DATA_VALID (FindVarState) || IS_DELETED (FindVarState)) {
+        FoundSpace = FALSE;
+      } else if ((FindVarHdrPtr->DataSize == VariableNameLen + DataSize) &&
+                 (CompareMem ((UINT8 *)&FindVarHdrPtr[1] + VariableNameLen, Data, DataSize) == 0)) {
+        return EFI_SUCCESS;
+      }
+    }
+
+    //
+    // The new variable goes right after the last indexed one if that area is empty
+    //
+    VarHdrPtr = (VARIABLE_HEADER *)((UINT8 *)VarStoreHdrPtr + VarInstance->IndexedEnd);
+    CurPtr    = (UINT8 *)VarHdrPtr;
+    if (CurPtr + TotalLen > VarEndPtr) {
+      FoundSpace = FALSE;
+    }
+    for (Idx = 0; FoundSpace && (Idx < sizeof (VARIABLE_HEADER)); Idx++) {
+      if (CurPtr[Idx] != 0xFF) {
+        FoundSpace = FALSE;
+      }
+    }
+
+    if (!FoundSpace) {
+      VarHdrPtr     = (VARIABLE_HEADER *)&VarStoreHdrPtr[1];
+      FindVarHdrPtr = NULL;
+      FindVarState  = 0;
+    }
+  }
+
+  //
+  // The index is updated once the store update completes
+  //
+  if (IndexValid) {
+    VarInstance->IndexedStore = 0;
+  }
+
+  NeedReclaim   = FALSE;
+  SkipVarWrite  = FALSE;
   while (!FoundSpace) {
     CheckVarDataValid = FALSE;
     State = VarHdrPtr->State;
@@ -973,12 +1484,173 @@ SetVariable (
     }
   }
 
+  if (IndexValid) {
+    if (DataSize > 0) {
+      Status = InsertVariableIndex (VarInstance, VarStoreHdrPtr, VariableName, Hash,
+                                    (UINT32)((UINT8 *)VarHdrPtr - (UINT8 *)VarStoreHdrPtr));
+      VarInstance->IndexedEnd = (UINT32)((UINT8 *)VarHdrPtr + TotalLen - (UINT8 *)VarStoreHdrPtr);
+    } else {
+      Entry = LookupVariableIndex (VarInstance, VarStoreHdrPtr, VariableName, Hash);
+      if (Entry != NULL) {
+        Entry->Offset = VARIABLE_INDEX_DELETED;
+      }
+      Status = EFI_SUCCESS;
+    }
+    if (!EFI_ERROR (Status)) {
+      VarInstance->IndexedStore = (UINT32)(UINTN)VarStoreHdrPtr;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Perform the deferred variable store maintenance.
+
+  Stale banks left behind by earlier reclaims are erased so that the next
+  reclaim only has to copy the live variables. The active bank is compacted
+  ahead of time when less than a quarter of it is free, or whenever it holds
+  obsolete variables if Force is TRUE.
+
+  It is meant to be called at a point where a flash erase does not delay the
+  boot, such as right before the OS handoff.
+
+  @param[in]  Force         Compact the active bank whenever it can be shrunk.
+
+  @retval     EFI_SUCCESS             Variable store maintenance completed.
+  @retval     EFI_NOT_READY           Variable service is not initialized.
+  @retval     EFI_VOLUME_CORRUPTED    No valid active variable store.
+  @retval     Others                  Flash erase or write failed.
+**/
+EFI_STATUS
+EFIAPI
+CompactVariableStore (
+  IN BOOLEAN    Force
+  )
+{
+  VARIABLE_INSTANCE      *VarInstance;
+  VARIABLE_STORE_HEADER  *VarStoreHdrPtr;
+  VARIABLE_STORE_HEADER  *BankHdrPtr;
+  VARIABLE_HEADER        *VarHdrPtr;
+  VARIABLE_INDEX_ENTRY   *Entry;
+  UINT8                  *VarEndPtr;
+  UINT32                  VarStoreLen;
+  UINT32                  LiveLen;
+  UINT32                  Bank;
+  UINT32                  Pass;
+  EFI_STATUS              Status;
+
+  VarInstance = GetVariableInstance ();
+  if ((VarInstance == NULL) || (VarInstance->Signature != VARIABLE_INSTANCE_SIGNATURE)) {
+    return EFI_NOT_READY;
+  }
+
+  for (Pass = 0; Pass < 2; Pass++) {
+    VarStoreHdrPtr = GetActiveVaraibelStoreBase (&VarStoreLen);
+    if (!IsVariableStoreValid (VarStoreHdrPtr)) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    //
+    // Erase the stale banks. A bank with an erased header but other content
+    // left is erased by Reclaim () before it is used.
+    //
+    for (Bank = 0; Bank < VARIABLE_STORE_BANKS; Bank++) {
+      BankHdrPtr = GetVariableBank (Bank, NULL);
+      if ((BankHdrPtr == VarStoreHdrPtr) || IsVariableBankErased (BankHdrPtr, sizeof (VARIABLE_STORE_HEADER))) {
+        continue;
+      }
+      Status = EraseVariableStore (BankHdrPtr, VarStoreLen);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+      VarInstance->DeferredEraseCount++;
+    }
+
+    if (Pass > 0) {
+      break;
+    }
+
+    //
+    // Leave a corrupted store to the inline reclaim
+    //
+    if (!IsVariableIndexValid (VarInstance, VarStoreHdrPtr) &&
+        EFI_ERROR (BuildVariableIndex (VarInstance, VarStoreHdrPtr))) {
+      break;
+    }
+
+    LiveLen   = sizeof (VARIABLE_STORE_HEADER);
+    VarHdrPtr = (VARIABLE_HEADER *)&VarStoreHdrPtr[1];
+    VarEndPtr = (UINT8 *)VarStoreHdrPtr + VarInstance->IndexedEnd;
+    while ((UINT8 *)VarHdrPtr < VarEndPtr) {
+      if (IS_DATA_VALID (VarHdrPtr->State) && !IS_DELETED (VarHdrPtr->State)) {
+        Entry = LookupVariableIndex (VarInstance, VarStoreHdrPtr, (CONST CHAR8 *)&VarHdrPtr[1],
+                                     GetVariableNameHash ((CONST CHAR8 *)&VarHdrPtr[1]));
+        if ((Entry != NULL) && ((UINT8 *)VarStoreHdrPtr + Entry->Offset == (UINT8 *)VarHdrPtr)) {
+          LiveLen += sizeof (VARIABLE_HEADER) + VarHdrPtr->DataSize;
+        }
+      }
+      VarHdrPtr = (VARIABLE_HEADER *) ((UINT8 *)&VarHdrPtr[1] + VarHdrPtr->DataSize);
+    }
+
+    if ((LiveLen >= VarInstance->IndexedEnd) ||
+        (!Force && (VarInstance->IndexedEnd + (VarStoreLen >> 2) <= VarStoreLen))) {
+      break;
+    }
+
+    Status = Reclaim (VarStoreHdrPtr);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  DEBUG ((DEBUG_INFO, "Variable store: %d reclaims in %ld ticks, %d inline erases, %d deferred erases\n",
+          VarInstance->ReclaimCount, VarInstance->ReclaimTicks, VarInstance->InlineEraseCount,
+          VarInstance->DeferredEraseCount));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the variable store reclaim statistics.
+
+  The counters accumulate across all the stages sharing the variable service.
+
+  @param[out] Stats         Pointer to receive the statistics.
+
+  @retval     EFI_SUCCESS             The statistics were returned.
+  @retval     EFI_INVALID_PARAMETER   Stats is NULL.
+  @retval     EFI_NOT_READY           Variable service is not initialized.
+**/
+EFI_STATUS
+EFIAPI
+GetVariableStoreStats (
+  OUT VARIABLE_STORE_STATS  *Stats
+  )
+{
+  VARIABLE_INSTANCE      *VarInstance;
+
+  if (Stats == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  VarInstance = GetVariableInstance ();
+  if ((VarInstance == NULL) || (VarInstance->Signature != VARIABLE_INSTANCE_SIGNATURE)) {
+    return EFI_NOT_READY;
+  }
+
+  Stats->ReclaimCount       = VarInstance->ReclaimCount;
+  Stats->InlineEraseCount   = VarInstance->InlineEraseCount;
+  Stats->DeferredEraseCount = VarInstance->DeferredEraseCount;
+  Stats->ReclaimTicks       = VarInstance->ReclaimTicks;
+
   return EFI_SUCCESS;
 }
 
 /**
   Initialize an varaible instance.
-  Base needs to be 4KB aligned and Size needs to be 8KB aligned.
+  Base needs to be 4KB aligned and Size needs to be a multiple of
+  4KB times the number of variable store banks.
 
   @param     Base         Variable storage region base
   @param     Size         Variable storage region size
@@ -1003,21 +1675,24 @@ VariableConstructor (
   }
 
   // Base needs to be 4KB aligned
-  // Size needs to be 8KB * n
-  if (((Base & (SIZE_4KB - 1)) != 0) || ((Size & (SIZE_8KB - 1)) != 0)) {
+  // Size needs to be 4KB * VARIABLE_STORE_BANKS * n
+  if ((VARIABLE_STORE_BANKS < 2) || ((Base & (SIZE_4KB - 1)) != 0) || ((Size % (SIZE_4KB * VARIABLE_STORE_BANKS)) != 0)) {
     return EFI_INVALID_PARAMETER;
   }
 
   VarInstance->Signature  = VARIABLE_INSTANCE_SIGNATURE;
   VarInstance->StoreBase  = Base;
   VarInstance->StoreSize  = Size;
-  DEBUG ((DEBUG_INFO, "Variable region: 0x%08X:0x%X\n", Base, Size));
+  DEBUG ((DEBUG_INFO, "Variable region: 0x%08X:0x%X, %d banks\n", Base, Size, VARIABLE_STORE_BANKS));
   Status = InitializeVariableStore ();
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Variable service init failed %r!\n", Status));
     return Status;
   }
 
+  // Lookups build the index on demand if this fails
+  BuildVariableIndex (VarInstance, GetActiveVaraibelStoreBase (NULL));
+
   Status = RegisterService ((VOID *)&mVariableService);
   return Status;
 }
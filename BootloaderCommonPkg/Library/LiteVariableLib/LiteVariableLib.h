@@ -26,10 +26,46 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 ///
 #define VARIABLE_INSTANCE_SIGNATURE  SIGNATURE_32 ('V', 'A', 'R', 'I')
 
+///
+/// The variable region is split into equal banks used in turn by reclaims
+///
+#define VARIABLE_STORE_BANKS         FixedPcdGet32 (PcdVariableStoreBanks)
+
+#define VARIABLE_INDEX_MIN_SIZE      32
+#define VARIABLE_INDEX_DELETED       MAX_UINT32
+
+///
+/// Variable name hash index slot
+///
+typedef struct {
+  UINT32                Hash;
+  ///
+  /// Variable header offset in the variable store, 0 for an empty slot
+  ///
+  UINT32                Offset;
+} VARIABLE_INDEX_ENTRY;
+
 typedef struct {
   UINT32                Signature;
   UINT32                StoreSize;
   UINT32                StoreBase;
+  ///
+  /// Name hash index of the active variable store. The index memory belongs
+  /// to the module that built it, other modules build their own copy.
+  ///
+  UINT32                IndexOwner;
+  UINT32                IndexBase;
+  UINT32                IndexSize;
+  UINT32                IndexUsed;
+  UINT32                IndexedStore;
+  UINT32                IndexedEnd;
+  ///
+  /// Reclaim statistics, see VARIABLE_STORE_STATS
+  ///
+  UINT32                ReclaimCount;
+  UINT64                ReclaimTicks;
+  UINT32                InlineEraseCount;
+  UINT32                DeferredEraseCount;
 } VARIABLE_INSTANCE;
 
 #endif
@@ -89,6 +89,8 @@ DefPerfIdToStr (
     return "Rebase Stage2";
   case 0x3000:
     return "Stage2 entry point";
+  case 0x3008:
+    return "Create page tables";
   case 0x3010:
     return "Board PreSiliconInit hook";
   case 0x3020:
@@ -101,6 +103,8 @@ DefPerfIdToStr (
     return "Display splash";
   case 0x3060:
     return "MP wake up";
+  case 0x3070:
+    return "SMBIOS init";
   case 0x3080:
     return "MP init run";
   case 0x3090:
@@ -443,6 +447,7 @@ PrintBootloaderPerfData (
   UINT16      Id;
   UINT64      Tsc;
   const CHAR8 *Desc;
+  BOOLEAN     Critical;
 
   PrevTime = 0;
 
@@ -453,8 +458,12 @@ PrintBootloaderPerfData (
     Id   = ((UINT16 *)&Tsc)[3];
     ((UINT16 *)&Tsc)[3] = 0;
     Time = (UINT32)DivU64x32 (Tsc, PerfData->FreqKhz);
+    Critical = (((Id & 0xF000) == 0x3000) && ((Id & PERF_ID_CRITICAL_PATH) != 0));
+    if (Critical) {
+      Id &= (UINT16)~PERF_ID_CRITICAL_PATH;
+    }
     Desc = PerfIdToStr (Id, PerfIdToStrTbl);
-    DEBUG ((DEBUG_INFO | DEBUG_EVENT, " %4X | %7d ms | %7d ms | %a\n", Id, Time, Time - PrevTime, Desc));
+    DEBUG ((DEBUG_INFO | DEBUG_EVENT, " %4X | %7d ms | %7d ms |%a%a\n", Id, Time, Time - PrevTime, Critical ? "*" : " ", Desc));
     PrevTime = Time;
   }
   DEBUG ((DEBUG_INFO | DEBUG_EVENT, "------+------------+------------+----------------------------------\n"));
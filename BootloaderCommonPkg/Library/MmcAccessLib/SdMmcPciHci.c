@@ -1825,6 +1825,7 @@ SdMmcSendCommand (
 {
   EFI_STATUS                      Status;
   SD_MMC_HC_TRB                   *Trb;
+  UINT8                           SwReset;
 
   if ((Private == 0x0) || (Packet == NULL)) {
     return EFI_INVALID_PARAMETER;
@@ -1862,6 +1863,16 @@ SdMmcSendCommand (
   }
 
   Status = SdMmcWaitTrbResult (Private, Trb);
+  if (Status == EFI_TIMEOUT) {
+    //
+    // Reset the CMD and DAT lines so the controller stops accessing the
+    // ADMA descriptor table before it is freed.
+    //
+    SwReset = BIT1 | BIT2;
+    SdMmcHcRwMmio (Private->SdMmcHcBase, SD_MMC_HC_SW_RST, FALSE, sizeof (SwReset), &SwReset);
+    SdMmcHcWaitMmioSet (Private->SdMmcHcBase, SD_MMC_HC_SW_RST, sizeof (SwReset), 0xFF, 0,
+                        SD_MMC_HC_GENERIC_TIMEOUT);
+  }
   if (EFI_ERROR (Status)) {
     goto Done;
   }
@@ -11,12 +11,30 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PagingLib.h>
 #include <Library/BootloaderCommonLib.h>
+#include <Library/SynchronizationLib.h>
 
 #define IS_PD_SET     (((Address & 0xFFF) & IA32_PG_PD) == IA32_PG_PD)
 #define PD_SET_ADDR   (Address & ~(0xFFFF))
 #define PD_UNSET_ADDR (Address & ~(0xFFF))
 #define MIN_ADDR_BITS 36
 
+#define PAGING_ADDR_MASK            0x000FFFFFFFFFF000ull
+#define LAZY_PAGE_TABLE_SIGNATURE   SIGNATURE_32 ('L', 'Z', 'P', 'T')
+
+//
+// On demand page table state, located in the page just below the PML4.
+// Spare pages follow the PML4 and are handed out from FreeBase.
+//
+typedef struct {
+  UINT32            Signature;
+  volatile UINT32   Lock;
+  UINT32            FreePages;
+  UINT32            FaultCount;
+  UINT64            FreeBase;
+  UINT64            MaxAddress;
+  BOOLEAN           Page1GSupport;
+} LAZY_PAGE_TABLE;
+
 /**
   The function will check if 5-level paging is needed
 
@@ -432,3 +450,253 @@ CreateIdentityMappingPageTables (
 
   return EFI_SUCCESS;
 }
+
+/**
+  Allocate a zeroed page from the lazy page table spare pages.
+
+  @param[in] LazyTable     Lazy page table state.
+
+  @retval    Page address, or NULL if no spare page is left.
+
+**/
+STATIC
+UINT64 *
+AllocateLazyPageTablePage (
+  IN LAZY_PAGE_TABLE   *LazyTable
+  )
+{
+  UINT64              *Page;
+
+  if (LazyTable->FreePages == 0) {
+    return NULL;
+  }
+
+  Page = (UINT64 *)(UINTN)LazyTable->FreeBase;
+  LazyTable->FreeBase += SIZE_4KB;
+  LazyTable->FreePages--;
+  ZeroMem (Page, SIZE_4KB);
+
+  return Page;
+}
+
+/**
+  Map the 1GB region containing an address into the lazy page tables.
+
+  The new page directory is filled completely before it is linked so that
+  other processors never observe a partially populated table.
+
+  @param[in] LazyTable     Lazy page table state.
+  @param[in] Address       Address within the 1GB region to map.
+
+  @retval    EFI_SUCCESS            The region is mapped.
+  @retval    EFI_OUT_OF_RESOURCES   No spare page is left.
+
+**/
+STATIC
+EFI_STATUS
+MapLazyPageTable1G (
+  IN LAZY_PAGE_TABLE   *LazyTable,
+  IN UINT64             Address
+  )
+{
+  UINT64              *Pml4;
+  UINT64              *Pdpt;
+  UINT64              *Pde;
+  UINTN                Pml4Idx;
+  UINTN                PdptIdx;
+  UINTN                Idx;
+  UINT32               Attribute;
+
+  Attribute = IA32_PG_P | IA32_PG_RW;
+  Pml4Idx   = (UINTN)RShiftU64 (Address, 39) & 0x1FF;
+  PdptIdx   = (UINTN)RShiftU64 (Address, 30) & 0x1FF;
+  Address  &= ~((UINT64)SIZE_1GB - 1);
+
+  Pml4 = (UINT64 *)((UINTN)LazyTable + SIZE_4KB);
+  if ((Pml4[Pml4Idx] & IA32_PG_P) == 0) {
+    Pdpt = AllocateLazyPageTablePage (LazyTable);
+    if (Pdpt == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Pml4[Pml4Idx] = (UINTN)Pdpt + Attribute;
+  } else {
+    Pdpt = (UINT64 *)(UINTN)(Pml4[Pml4Idx] & PAGING_ADDR_MASK);
+  }
+
+  if ((Pdpt[PdptIdx] & IA32_PG_P) != 0) {
+    return EFI_SUCCESS;
+  }
+
+  if (LazyTable->Page1GSupport) {
+    Pdpt[PdptIdx] = Address + (Attribute | IA32_PG_PD);
+  } else {
+    Pde = AllocateLazyPageTablePage (LazyTable);
+    if (Pde == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    for (Idx = 0; Idx < 512; Idx++, Address += SIZE_2MB) {
+      Pde[Idx] = Address + (Attribute | IA32_PG_PD);
+    }
+    Pdpt[PdptIdx] = (UINTN)Pde + Attribute;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Create 1:1 Virtual to Physical mapping page tables that are populated on demand.
+
+  Only the low 4GB and the 1GB regions covering Ranges are mapped up front.
+  Other addresses below the physical address limit are mapped one 1GB region
+  at a time by HandleIdentityMappingPageFault() out of SparePages spare pages
+  reserved together with the page tables.
+
+  @param[in] RequestedAddressBits   Same as CreateIdentityMappingPageTables().
+  @param[in] Ranges                 Address ranges to map up front. Only Start and
+                                    Limit are used.
+  @param[in] RangeCount             Number of entries in Ranges.
+  @param[in] SparePages             Number of pages reserved for on demand mapping.
+
+  @retval    EFI_SUCCESS            Page table was created successfully.
+  @retval    EFI_OUT_OF_RESOURCES   Failed to allocate page buffer
+
+**/
+EFI_STATUS
+EFIAPI
+CreateLazyIdentityMappingPageTables (
+  IN  UINT8         RequestedAddressBits,
+  IN  MAP_RANGE    *Ranges,     OPTIONAL
+  IN  UINT32        RangeCount,
+  IN  UINT32        SparePages
+  )
+{
+  LAZY_PAGE_TABLE  *LazyTable;
+  UINT8             PhysicalAddressBits;
+  UINT32            TotalPagesNum;
+  UINT32            Idx;
+  UINT64            Start;
+  UINT64            Limit;
+  UINT64            Address;
+  UINTN             Cr0;
+
+  PhysicalAddressBits = GetPhysicalAddressBits ();
+  if ((RequestedAddressBits != 0) && (PhysicalAddressBits > RequestedAddressBits)) {
+    PhysicalAddressBits = RequestedAddressBits;
+  }
+  if (PhysicalAddressBits < MIN_ADDR_BITS) {
+    PhysicalAddressBits = MIN_ADDR_BITS;
+  }
+  // 5-level paging is not supported
+  if (PhysicalAddressBits > 48) {
+    PhysicalAddressBits = 48;
+  }
+
+  if (Ranges == NULL) {
+    RangeCount = 0;
+  }
+
+  //
+  // Header and PML4, then one PDPT and four PDs for the low 4GB,
+  // then the worst case for the up front ranges and the spare pages.
+  //
+  TotalPagesNum = 2 + 5 + SparePages;
+  for (Idx = 0; Idx < RangeCount; Idx++) {
+    Start = Ranges[Idx].Start;
+    Limit = MIN (Ranges[Idx].Limit, LShiftU64 (1, PhysicalAddressBits) - 1);
+    if (Start > Limit) {
+      continue;
+    }
+    TotalPagesNum += (UINT32)(RShiftU64 (Limit, 39) - RShiftU64 (Start, 39) + 1);
+    TotalPagesNum += (UINT32)(RShiftU64 (Limit, 30) - RShiftU64 (Start, 30) + 1);
+  }
+
+  LazyTable = (LAZY_PAGE_TABLE *)AllocatePages (TotalPagesNum);
+  if (LazyTable == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  ZeroMem (LazyTable, 2 * SIZE_4KB);
+
+  LazyTable->Signature     = LAZY_PAGE_TABLE_SIGNATURE;
+  LazyTable->Page1GSupport = IsPage1GSupport ();
+  LazyTable->MaxAddress    = LShiftU64 (1, PhysicalAddressBits);
+  LazyTable->FreeBase      = (UINTN)LazyTable + 2 * SIZE_4KB;
+  LazyTable->FreePages     = TotalPagesNum - 2;
+
+  for (Address = 0; Address < SIZE_4GB; Address += SIZE_1GB) {
+    MapLazyPageTable1G (LazyTable, Address);
+  }
+  for (Idx = 0; Idx < RangeCount; Idx++) {
+    Limit = MIN (Ranges[Idx].Limit, LazyTable->MaxAddress - 1);
+    Address = Ranges[Idx].Start & ~((UINT64)SIZE_1GB - 1);
+    for (; Address <= Limit; Address += SIZE_1GB) {
+      MapLazyPageTable1G (LazyTable, Address);
+    }
+  }
+
+  DEBUG ((DEBUG_INFO, "Lazy page table PhysicalAddressBits=%u 1GPage=%u TotalPage=%u Spare=%u\n",
+    PhysicalAddressBits, LazyTable->Page1GSupport, TotalPagesNum, LazyTable->FreePages));
+
+  Cr0 = AsmReadCr0 ();
+  // Set PAE
+  AsmWriteCr4 (AsmReadCr4() | BIT5);
+  AsmWriteCr3 ((UINTN)LazyTable + SIZE_4KB);
+  if ((Cr0 & BIT31) != BIT31) {
+    AsmWriteCr0 (Cr0 | BIT31);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Map the 1GB region containing a faulting address into the current on demand
+  page tables created by CreateLazyIdentityMappingPageTables().
+
+  @param[in] FaultAddress           Page fault linear address from CR2.
+  @param[in] ErrorCode              Page fault error code.
+
+  @retval    EFI_SUCCESS            The region is mapped, the access can be retried.
+  @retval    EFI_UNSUPPORTED        The fault is not caused by a lazily mapped region.
+  @retval    EFI_OUT_OF_RESOURCES   No spare page is left to map the region.
+
+**/
+EFI_STATUS
+EFIAPI
+HandleIdentityMappingPageFault (
+  IN  UINT64        FaultAddress,
+  IN  UINTN         ErrorCode
+  )
+{
+  LAZY_PAGE_TABLE  *LazyTable;
+  UINTN             Cr3;
+  EFI_STATUS        Status;
+
+  // Only not-present faults can be resolved
+  if (((ErrorCode & BIT0) != 0) || !IsLongModeEnabled ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Cr3 = AsmReadCr3 () & ~(SIZE_4KB - 1);
+  if (Cr3 < SIZE_4KB) {
+    return EFI_UNSUPPORTED;
+  }
+
+  // The lazy page table state lives in the page just below the PML4
+  LazyTable = (LAZY_PAGE_TABLE *)(Cr3 - SIZE_4KB);
+  if ((LazyTable->Signature != LAZY_PAGE_TABLE_SIGNATURE) || (FaultAddress >= LazyTable->MaxAddress)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  // APs share the page tables with the BSP
+  while (InterlockedCompareExchange32 (&LazyTable->Lock, 0, 1) != 0) {
+    CpuPause ();
+  }
+  Status = MapLazyPageTable1G (LazyTable, FaultAddress);
+  if (!EFI_ERROR (Status)) {
+    LazyTable->FaultCount++;
+  }
+  InterlockedCompareExchange32 (&LazyTable->Lock, 1, 0);
+
+  DEBUG ((DEBUG_VERBOSE, "Lazy page fault @ 0x%lX: %r (%u spare pages)\n", FaultAddress, Status, LazyTable->FreePages));
+
+  return Status;
+}
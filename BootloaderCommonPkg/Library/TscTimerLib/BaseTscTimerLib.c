@@ -0,0 +1,27 @@
+/** @file
+  TSC Timer Library instance for modules without writable global data.
+
+  Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include "TscTimerLibInternal.h"
+
+/**
+  Internal function to get the invariant TSC frequency.
+
+  Stages executed in place cannot keep writable globals, so the frequency is
+  calculated on every call.
+
+  @return The TSC frequency in Hz, or 0 if the ACPI PM timer has to be used.
+
+**/
+UINT64
+InternalGetTscFrequency (
+  VOID
+  )
+{
+  return InternalCalculateTscFrequency ();
+}
@@ -0,0 +1,34 @@
+/** @file
+  TSC Timer Library instance for modules executed from memory.
+
+  Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include "TscTimerLibInternal.h"
+
+STATIC UINT64   mTscFrequency;
+STATIC BOOLEAN  mTscFrequencyValid;
+
+/**
+  Internal function to get the invariant TSC frequency.
+
+  The frequency is calculated on the first call and cached in the module.
+
+  @return The TSC frequency in Hz, or 0 if the ACPI PM timer has to be used.
+
+**/
+UINT64
+InternalGetTscFrequency (
+  VOID
+  )
+{
+  if (!mTscFrequencyValid) {
+    mTscFrequency      = InternalCalculateTscFrequency ();
+    mTscFrequencyValid = TRUE;
+  }
+
+  return mTscFrequency;
+}
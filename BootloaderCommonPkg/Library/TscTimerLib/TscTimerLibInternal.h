@@ -0,0 +1,36 @@
+/** @file
+  Internal definitions shared by the TSC Timer Library instances.
+
+  Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _TSC_TIMER_LIB_INTERNAL_H_
+#define _TSC_TIMER_LIB_INTERNAL_H_
+
+#define ACPI_TIMER_COUNT_SIZE  BIT24
+
+/**
+  Internal function to calculate the invariant TSC frequency.
+
+  @return The TSC frequency in Hz, or 0 if it cannot be determined.
+
+**/
+UINT64
+InternalCalculateTscFrequency (
+  VOID
+  );
+
+/**
+  Internal function to get the invariant TSC frequency.
+
+  @return The TSC frequency in Hz, or 0 if the ACPI PM timer has to be used.
+
+**/
+UINT64
+InternalGetTscFrequency (
+  VOID
+  );
+
+#endif
@@ -0,0 +1,322 @@
+/** @file
+  TSC Timer implements one instance of Timer Library.
+
+  The invariant time stamp counter is used for all delays and for the
+  performance counter. If CPUID does not report invariant TSC together with
+  its crystal clock information, the ACPI PM timer is used instead.
+
+  Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include <Library/TimerLib.h>
+#include <Library/BaseLib.h>
+#include <Library/IoLib.h>
+#include <Library/DebugLib.h>
+#include <Library/TimeStampLib.h>
+#include <Register/Intel/Cpuid.h>
+#include <IndustryStandard/Acpi.h>
+#include "TscTimerLibInternal.h"
+
+/**
+  Internal function to calculate the invariant TSC frequency.
+
+  The frequency is only reported if CPUID leaf 0x15 enumerates both the
+  TSC/crystal clock ratio and the crystal clock frequency. A frequency
+  derived from an assumed ratio would make every delay too short or too
+  long, so the ACPI PM timer is used in that case.
+
+  @return The TSC frequency in Hz, or 0 if it cannot be determined.
+
+**/
+UINT64
+InternalCalculateTscFrequency (
+  VOID
+  )
+{
+  UINT32                                  MaxFunction;
+  UINT32                                  RegEax;
+  UINT32                                  RegEbx;
+  UINT32                                  RegEcx;
+  CPUID_EXTENDED_TIME_STAMP_COUNTER_EDX   Edx;
+
+  AsmCpuid (CPUID_EXTENDED_FUNCTION, &MaxFunction, NULL, NULL, NULL);
+  if (MaxFunction < CPUID_EXTENDED_TIME_STAMP_COUNTER) {
+    return 0;
+  }
+
+  AsmCpuid (CPUID_EXTENDED_TIME_STAMP_COUNTER, NULL, NULL, NULL, &Edx.Uint32);
+  if (Edx.Bits.InvariantTsc == 0) {
+    return 0;
+  }
+
+  AsmCpuid (CPUID_SIGNATURE, &MaxFunction, NULL, NULL, NULL);
+  if (MaxFunction < CPUID_TIME_STAMP_COUNTER) {
+    return 0;
+  }
+
+  // TSC frequency = (ECX, Core Xtal Frequency) * EBX/EAX
+  AsmCpuid (CPUID_TIME_STAMP_COUNTER, &RegEax, &RegEbx, &RegEcx, NULL);
+  if ((RegEax == 0) || (RegEbx == 0) || (RegEcx == 0)) {
+    return 0;
+  }
+
+  return DivU64x32 (MultU64x32 (RegEcx, RegEbx) + (UINT64)(RegEax >> 1), RegEax);
+}
+
+/**
+  Stalls the CPU for at least the given number of TSC ticks.
+
+  @param  Delay     A period of time to delay in ticks.
+
+**/
+VOID
+InternalTscDelay (
+  IN      UINT64                    Delay
+  )
+{
+  UINT64                            Start;
+
+  //
+  // Timer wrap-arounds are handled correctly by the unsigned subtraction
+  //
+  Start = ReadTimeStamp ();
+  while ((ReadTimeStamp () - Start) < Delay) {
+    CpuPause ();
+  }
+}
+
+/**
+  Internal function to read the current tick counter of ACPI.
+
+  @return The tick counter read.
+
+**/
+UINT32
+InternalAcpiGetTimerTick (
+  VOID
+  )
+{
+  return IoRead32 (PcdGet16 (PcdAcpiPmTimerBase));
+}
+
+/**
+  Stalls the CPU for at least the given number of ticks.
+
+  Stalls the CPU for at least the given number of ticks. It's invoked by
+  MicroSecondDelay() and NanoSecondDelay() when invariant TSC is not supported.
+
+  @param  Delay     A period of time to delay in ticks.
+
+**/
+VOID
+InternalAcpiDelay (
+  IN      UINT32                    Delay
+  )
+{
+  UINT32                            Ticks;
+  UINT32                            Times;
+
+  Times    = Delay >> 22;
+  Delay   &= BIT22 - 1;
+  do {
+    //
+    // The target timer count is calculated here
+    //
+    Ticks    = InternalAcpiGetTimerTick () + Delay;
+    Delay    = BIT22;
+    //
+    // Wait until time out
+    // Delay >= 2^23 could not be handled by this function
+    // Timer wrap-arounds are handled correctly by this function
+    //
+    while (((Ticks - InternalAcpiGetTimerTick ()) & BIT23) == 0) {
+      CpuPause ();
+    }
+  } while (Times-- > 0);
+}
+
+/**
+  Stalls the CPU for at least the given number of microseconds.
+
+  Stalls the CPU for the number of microseconds specified by MicroSeconds.
+
+  @param  MicroSeconds  The minimum number of microseconds to delay.
+
+  @return MicroSeconds
+
+**/
+UINTN
+EFIAPI
+MicroSecondDelay (
+  IN      UINTN                     MicroSeconds
+  )
+{
+  UINT64                            Frequency;
+
+  Frequency = InternalGetTscFrequency ();
+  if (Frequency != 0) {
+    InternalTscDelay (DivU64x32 (MultU64x64 (Frequency, MicroSeconds), 1000000u));
+  } else {
+    InternalAcpiDelay (
+      (UINT32)DivU64x32 (
+        MultU64x32 (
+          MicroSeconds,
+          ACPI_TIMER_FREQUENCY
+          ),
+        1000000u
+        )
+      );
+  }
+  return MicroSeconds;
+}
+
+/**
+  Stalls the CPU for at least the given number of nanoseconds.
+
+  Stalls the CPU for the number of nanoseconds specified by NanoSeconds.
+
+  @param  NanoSeconds The minimum number of nanoseconds to delay.
+
+  @return NanoSeconds
+
+**/
+UINTN
+EFIAPI
+NanoSecondDelay (
+  IN      UINTN                     NanoSeconds
+  )
+{
+  UINT64                            Frequency;
+
+  Frequency = InternalGetTscFrequency ();
+  if (Frequency != 0) {
+    InternalTscDelay (DivU64x32 (MultU64x64 (Frequency, NanoSeconds), 1000000000u));
+  } else {
+    InternalAcpiDelay (
+      (UINT32)DivU64x32 (
+        MultU64x32 (
+          NanoSeconds,
+          ACPI_TIMER_FREQUENCY
+          ),
+        1000000000u
+        )
+      );
+  }
+  return NanoSeconds;
+}
+
+/**
+  Retrieves the current value of a 64-bit free running performance counter.
+
+  The counter is the TSC if invariant TSC is supported, otherwise it is the
+  ACPI PM timer. The properties of the counter can be retrieved from
+  GetPerformanceCounterProperties().
+
+  @return The current value of the free running performance counter.
+
+**/
+UINT64
+EFIAPI
+GetPerformanceCounter (
+  VOID
+  )
+{
+  if (InternalGetTscFrequency () != 0) {
+    return ReadTimeStamp ();
+  }
+  return (UINT64)InternalAcpiGetTimerTick ();
+}
+
+/**
+  Retrieves the 64-bit frequency in Hz and the range of performance counter
+  values.
+
+  If StartValue is not NULL, then the value that the performance counter starts
+  with immediately after is it rolls over is returned in StartValue. If
+  EndValue is not NULL, then the value that the performance counter end with
+  immediately before it rolls over is returned in EndValue. The 64-bit
+  frequency of the performance counter in Hz is always returned.
+
+  @param  StartValue  The value the performance counter starts with when it
+                      rolls over.
+  @param  EndValue    The value that the performance counter ends with before
+                      it rolls over.
+
+  @return The frequency in Hz.
+
+**/
+UINT64
+EFIAPI
+GetPerformanceCounterProperties (
+  OUT      UINT64                    *StartValue,  OPTIONAL
+  OUT      UINT64                    *EndValue     OPTIONAL
+  )
+{
+  UINT64                             Frequency;
+  UINT64                             CounterEnd;
+
+  Frequency = InternalGetTscFrequency ();
+  if (Frequency != 0) {
+    CounterEnd = MAX_UINT64;
+  } else {
+    Frequency  = ACPI_TIMER_FREQUENCY;
+    CounterEnd = ACPI_TIMER_COUNT_SIZE - 1;
+  }
+
+  if (StartValue != NULL) {
+    *StartValue = 0;
+  }
+
+  if (EndValue != NULL) {
+    *EndValue = CounterEnd;
+  }
+
+  return Frequency;
+}
+
+/**
+  Converts elapsed ticks of performance counter to time in nanoseconds.
+
+  This function converts the elapsed ticks of running performance counter to
+  time value in unit of nanoseconds.
+
+  @param  Ticks     The number of elapsed ticks of running performance counter.
+
+  @return The elapsed time in nanoseconds.
+
+**/
+UINT64
+EFIAPI
+GetTimeInNanoSecond (
+  IN      UINT64                     Ticks
+  )
+{
+  UINT64  Frequency;
+  UINT64  NanoSeconds;
+  UINT64  Remainder;
+  INTN    Shift;
+
+  Frequency = GetPerformanceCounterProperties (NULL, NULL);
+
+  //
+  //          Ticks
+  // Time = --------- x 1,000,000,000
+  //        Frequency
+  //
+  NanoSeconds = MultU64x32 (DivU64x64Remainder (Ticks, Frequency, &Remainder), 1000000000u);
+
+  //
+  // Ensure (Remainder * 1,000,000,000) will not overflow 64-bit.
+  // Since 2^29 < 1,000,000,000 = 0x3B9ACA00 < 2^30, Remainder should < 2^(64-30) = 2^34,
+  // i.e. highest bit set in Remainder should <= 33.
+  //
+  Shift = MAX (0, HighBitSet64 (Remainder) - 33);
+  Remainder = RShiftU64 (Remainder, (UINTN) Shift);
+  Frequency = RShiftU64 (Frequency, (UINTN) Shift);
+  NanoSeconds += DivU64x64Remainder (MultU64x32 (Remainder, 1000000000u), Frequency, NULL);
+
+  return NanoSeconds;
+}
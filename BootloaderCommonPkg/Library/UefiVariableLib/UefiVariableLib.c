@@ -494,6 +494,7 @@ GetVariableStore (
   UEFI_VAR_STORE_LIBRARY_DATA                *VarStoreLibData;
 
   StoreInfo->IndexTable = NULL;
+  StoreInfo->HashTable = NULL;
   StoreInfo->FtwLastWriteData = NULL;
   StoreInfo->AuthFlag = FALSE;
   VariableStoreHeader = NULL;
@@ -630,6 +631,7 @@ GetVariableStore (
           VarStoreLibData->IndexTable.StartPtr    = GetStartPointer (VariableStoreHeader);
           VarStoreLibData->IndexTable.EndPtr      = GetEndPointer   (VariableStoreHeader);
           VarStoreLibData->IndexTable.GoneThrough = 0;
+          VarStoreLibData->HashTable.Ready        = 0;
           //
           // Set the Lib data after Ftw and Index table info is updated
           //
@@ -637,6 +639,7 @@ GetVariableStore (
           Status = SetLibraryData (PcdGet8(PcdUefiVariableLibId), VarStoreLibData, sizeof(UEFI_VAR_STORE_LIBRARY_DATA));
         } else {
           StoreInfo->IndexTable = &VarStoreLibData->IndexTable;
+          StoreInfo->HashTable  = &VarStoreLibData->HashTable;
         }
       }
 
@@ -778,6 +781,177 @@ GetVariableNameOrData (
   CopyMem (Buffer, NameOrData, Size);
 }
 
+/**
+  Update a FNV-1a hash with a buffer.
+
+  @param  Hash      Current hash value.
+  @param  Buffer    Pointer to the buffer.
+  @param  Size      Buffer size in bytes.
+
+  @retval The updated hash value.
+
+**/
+STATIC
+UINT32
+UpdateVariableHash (
+  IN UINT32                     Hash,
+  IN CONST VOID                *Buffer,
+  IN UINTN                      Size
+  )
+{
+  CONST UINT8  *Ptr;
+
+  for (Ptr = (CONST UINT8 *) Buffer; Size > 0; Size--, Ptr++) {
+    Hash = (Hash ^ *Ptr) * 0x01000193;
+  }
+  return Hash;
+}
+
+/**
+  Get the hash of a variable stored in the variable store.
+
+  @param  StoreInfo       Pointer to the store info structure.
+  @param  Variable        Pointer to the Variable Header.
+  @param  VariableHeader  Pointer to the Variable Header that has consecutive content.
+
+  @retval The hash of the variable vendor GUID and name.
+
+**/
+STATIC
+UINT32
+GetStoredVariableHash (
+  IN UEFI_VARIABLE_STORE_INFO  *StoreInfo,
+  IN UEFI_VARIABLE_HEADER      *Variable,
+  IN UEFI_VARIABLE_HEADER      *VariableHeader
+  )
+{
+  UINT32                Hash;
+  UINT8                *Name;
+  UINTN                 NameSize;
+  EFI_PHYSICAL_ADDRESS  TargetAddress;
+  UINTN                 PartialNameSize;
+
+  Hash     = UpdateVariableHash (0x811C9DC5, GetVendorGuidPtr (VariableHeader, StoreInfo->AuthFlag), sizeof (EFI_GUID));
+  Name     = (UINT8 *) GetVariableNamePtr (Variable, StoreInfo->AuthFlag);
+  NameSize = NameSizeOfVariable (VariableHeader, StoreInfo->AuthFlag);
+
+  if (StoreInfo->FtwLastWriteData != NULL) {
+    TargetAddress = StoreInfo->FtwLastWriteData->TargetAddress;
+    if (((UINTN) Name < (UINTN) TargetAddress) && (((UINTN) Name + NameSize) > (UINTN) TargetAddress)) {
+      //
+      // Name is inconsecutive, the remaining part is in the spare block.
+      //
+      PartialNameSize = (UINTN) TargetAddress - (UINTN) Name;
+      Hash = UpdateVariableHash (Hash, Name, PartialNameSize);
+      return UpdateVariableHash (Hash, (UINT8 *) (UINTN) StoreInfo->FtwLastWriteData->SpareAddress, NameSize - PartialNameSize);
+    }
+  }
+
+  return UpdateVariableHash (Hash, Name, NameSize);
+}
+
+/**
+  Build the variable hash table from a complete variable index table.
+
+  @param  StoreInfo       Pointer to the store info structure.
+
+**/
+STATIC
+VOID
+BuildVariableHashTable (
+  IN UEFI_VARIABLE_STORE_INFO  *StoreInfo
+  )
+{
+  UEFI_VARIABLE_INDEX_TABLE  *IndexTable;
+  UEFI_VARIABLE_HASH_TABLE   *HashTable;
+  UEFI_VARIABLE_HEADER       *Variable;
+  UEFI_VARIABLE_HEADER       *VariableHeader;
+  UINT32                      Hash;
+  UINTN                       Slot;
+  UINTN                       Index;
+  UINTN                       Offset;
+
+  IndexTable = StoreInfo->IndexTable;
+  HashTable  = StoreInfo->HashTable;
+  if ((IndexTable == NULL) || (HashTable == NULL)) {
+    return;
+  }
+
+  ZeroMem (HashTable, sizeof (UEFI_VARIABLE_HASH_TABLE));
+  VariableHeader = NULL;
+  for (Offset = 0, Index = 0; Index < IndexTable->Length; Index++) {
+    Offset  += IndexTable->Index[Index];
+    Variable = (UEFI_VARIABLE_HEADER *) ((UINT8 *) IndexTable->StartPtr + Offset);
+    GetVariableHeader (StoreInfo, Variable, &VariableHeader);
+    Hash = GetStoredVariableHash (StoreInfo, Variable, VariableHeader);
+    //
+    // Linear probing keeps variables with the same name in store order.
+    //
+    Slot = Hash & (UEFI_VARIABLE_HASH_TABLE_SIZE - 1);
+    while (HashTable->Entry[Slot].Offset != 0) {
+      Slot = (Slot + 1) & (UEFI_VARIABLE_HASH_TABLE_SIZE - 1);
+    }
+    HashTable->Entry[Slot].Hash   = Hash;
+    HashTable->Entry[Slot].Offset = (UINT32) Offset + 1;
+  }
+
+  HashTable->Ready = 1;
+}
+
+/**
+  Find a variable through the variable hash table.
+
+  @param  StoreInfo           Pointer to the store info structure.
+  @param  VariableName        Name of the variable to be found
+  @param  VendorGuid          Vendor GUID to be found.
+  @param  PtrTrack            Variable Track Pointer structure that contains Variable Information.
+
+  @retval  EFI_SUCCESS            Variable found successfully
+  @retval  EFI_NOT_FOUND          Variable not found
+
+**/
+STATIC
+EFI_STATUS
+FindVariableByHash (
+  IN UEFI_VARIABLE_STORE_INFO         *StoreInfo,
+  IN CONST CHAR16                     *VariableName,
+  IN CONST EFI_GUID                   *VendorGuid,
+  OUT UEFI_VARIABLE_POINTER_TRACK     *PtrTrack
+  )
+{
+  UEFI_VARIABLE_HASH_TABLE   *HashTable;
+  UEFI_VARIABLE_HEADER       *Variable;
+  UEFI_VARIABLE_HEADER       *VariableHeader;
+  UEFI_VARIABLE_HEADER       *InDeletedVariable;
+  UINT32                      Hash;
+  UINTN                       Slot;
+
+  HashTable = StoreInfo->HashTable;
+  Hash = UpdateVariableHash (0x811C9DC5, VendorGuid, sizeof (EFI_GUID));
+  Hash = UpdateVariableHash (Hash, VariableName, StrSize (VariableName));
+
+  InDeletedVariable = NULL;
+  VariableHeader    = NULL;
+  Slot = Hash & (UEFI_VARIABLE_HASH_TABLE_SIZE - 1);
+  while (HashTable->Entry[Slot].Offset != 0) {
+    if (HashTable->Entry[Slot].Hash == Hash) {
+      Variable = (UEFI_VARIABLE_HEADER *) ((UINT8 *) StoreInfo->IndexTable->StartPtr + HashTable->Entry[Slot].Offset - 1);
+      GetVariableHeader (StoreInfo, Variable, &VariableHeader);
+      if (CompareWithValidVariable (StoreInfo, Variable, VariableHeader, VariableName, VendorGuid, PtrTrack) == EFI_SUCCESS) {
+        if (VariableHeader->State == (UEFI_VAR_IN_DELETED_TRANSITION & UEFI_VAR_ADDED)) {
+          InDeletedVariable = PtrTrack->CurrPtr;
+        } else {
+          return EFI_SUCCESS;
+        }
+      }
+    }
+    Slot = (Slot + 1) & (UEFI_VARIABLE_HASH_TABLE_SIZE - 1);
+  }
+
+  PtrTrack->CurrPtr = InDeletedVariable;
+  return (PtrTrack->CurrPtr == NULL) ? EFI_NOT_FOUND : EFI_SUCCESS;
+}
+
 /**
   Find the variable in the specified variable store.
 
@@ -836,6 +1010,14 @@ FindVariableEx (
   MaxIndex   = NULL;
   VariableHeader = NULL;
 
+  if ((IndexTable != NULL) && (IndexTable->GoneThrough != 0) && (VariableName[0] != 0) &&
+      (StoreInfo->HashTable != NULL) && (StoreInfo->HashTable->Ready != 0)) {
+    //
+    // All the existing variables are indexed, look up the hash table directly.
+    //
+    return FindVariableByHash (StoreInfo, VariableName, VendorGuid, PtrTrack);
+  }
+
   if (IndexTable != NULL) {
     //
     // traverse the variable index table to look for varible.
@@ -919,6 +1101,7 @@ FindVariableEx (
   //
   if ((IndexTable != NULL) && !StopRecord) {
     IndexTable->GoneThrough = 1;
+    BuildVariableHashTable (StoreInfo);
   }
 
   PtrTrack->CurrPtr = InDeletedVariable;
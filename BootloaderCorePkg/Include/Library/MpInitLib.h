@@ -91,6 +91,30 @@ MpRunTask (
   );
 
 
+/**
+  Run a task function on all APs at once and wait for all of them to complete.
+
+  The task is published to all APs in one step instead of being dispatched
+  to each AP in turn. It can only be used between the EnumMpInitRun and
+  EnumMpInitDone phases. An AP busy with another task runs the broadcast task
+  once its current task is done.
+
+  @param[in]  TaskFunc    Task function pointer
+  @param[in]  Argument    Argument for the task function
+
+  @retval EFI_NOT_READY           APs are not waiting for tasks.
+  @retval EFI_TIMEOUT             Not all APs completed the task in time.
+  @retval EFI_SUCCESS             All APs completed the task.
+
+**/
+EFI_STATUS
+EFIAPI
+MpRunTaskAll (
+  IN  CPU_TASK_FUNC  TaskFunc,
+  IN  UINT64         Argument
+  );
+
+
 /**
   Dump MP task state
 
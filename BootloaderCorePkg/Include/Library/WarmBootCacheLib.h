@@ -0,0 +1,105 @@
+/** @file
+  Warm boot image cache library.
+
+  Keeps the signed Stage2 and payload components in a reserved DRAM region
+  so that they can be reused on a warm reset instead of being read from flash
+  again. Cached components are still authenticated and decompressed on use.
+
+  Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _WARM_BOOT_CACHE_LIB_H_
+#define _WARM_BOOT_CACHE_LIB_H_
+
+#include <Library/ContainerLib.h>
+
+#define  WARM_BOOT_CACHE_SIGNATURE     SIGNATURE_32 ('W', 'B', 'C', 'H')
+#define  WARM_BOOT_CACHE_ENTRY_MAX     4
+
+typedef struct {
+  UINT32           ComponentType;
+  UINT32           Offset;
+  UINT32           Length;
+  UINT32           Reserved;
+} WARM_BOOT_CACHE_ENTRY;
+
+typedef struct {
+  UINT32                  Signature;
+  UINT32                  RegionBase;
+  UINT32                  RegionSize;
+  UINT32                  FreeOffset;
+  UINT32                  EntryCount;
+  UINT32                  Reserved;
+  WARM_BOOT_CACHE_ENTRY   Entry[WARM_BOOT_CACHE_ENTRY_MAX];
+} WARM_BOOT_CACHE_HDR;
+
+/**
+  Check if images can be reused from the warm boot cache on this boot.
+
+  @retval TRUE    The cache is enabled, the last reset preserved DRAM and the
+                  cache region holds a valid header.
+  @retval FALSE   Images have to be loaded from flash.
+
+**/
+BOOLEAN
+EFIAPI
+IsWarmBootCacheActive (
+  VOID
+  );
+
+/**
+  Load a component image from the warm boot cache.
+
+  The cache region is not protected from the OS, so the cached component is
+  authenticated against the verified hash store on every use before it is
+  decompressed into the image buffer.
+
+  @param[in]      ComponentType  Component type, COMP_TYPE_STAGE_2 or a payload type.
+  @param[in, out] Buffer         On input, the load address or NULL to allocate.
+                                 On output, the image address.
+  @param[out]     Length         Pointer to receive the image length.
+  @param[in]      LoadComponentCallback  Callback function pointer.
+
+  @retval EFI_SUCCESS            The image was loaded from the cache.
+  @retval EFI_NOT_FOUND          The image is not cached.
+  @retval EFI_SECURITY_VIOLATION The cached component failed authentication.
+  @retval EFI_UNSUPPORTED        The cached component is not compressed.
+  @retval EFI_OUT_OF_RESOURCES   Failed to allocate the image buffer.
+
+**/
+EFI_STATUS
+EFIAPI
+LoadWarmBootImage (
+  IN      UINT32                    ComponentType,
+  IN OUT  VOID                    **Buffer,
+  OUT     UINT32                   *Length,
+  IN      LOAD_COMPONENT_CALLBACK   LoadComponentCallback
+  );
+
+/**
+  Save a verified component into the warm boot cache.
+
+  It is called from the PROGESS_ID_AUTHENTICATE load callback with the signed
+  component that was just authenticated, before it is decompressed.
+
+  @param[in]  ComponentType  Component type, COMP_TYPE_STAGE_2 or a payload type.
+  @param[in]  Image          Signed component starting with its compressed header.
+  @param[in]  Length         Signed component length.
+
+  @retval EFI_SUCCESS            The component was saved or is already cached.
+  @retval EFI_UNSUPPORTED        The cache is disabled or the component has no
+                                 hash store entry.
+  @retval EFI_OUT_OF_RESOURCES   The component does not fit into the cache.
+
+**/
+EFI_STATUS
+EFIAPI
+SaveWarmBootImage (
+  IN  UINT32          ComponentType,
+  IN  CONST VOID     *Image,
+  IN  UINT32          Length
+  );
+
+#endif
@@ -154,6 +154,18 @@ typedef struct {
 
 #define  LDR_GDATA_SIGNATURE     SIGNATURE_32('L', 'D', 'R', 'G')
 
+//
+// Memory pool high-water marks recorded when PcdMemPoolProfileEnabled is set.
+// Each caller field holds the return address of the allocation setting the peak.
+//
+typedef struct {
+  UINT32            PermMaxUsed;
+  UINT32            PermCaller;
+  UINT32            TempMaxUsed;
+  UINT32            TempCaller;
+  UINT32            MaxUsedCaller;
+} MEM_POOL_PROFILE;
+
 typedef struct {
   UINT32            Signature;
   UINT16            PlatformId;
@@ -195,6 +207,8 @@ typedef struct {
   UINT32            CarBase;
   UINT32            CarSize;
   UINT32            MemPoolMaxUsed;
+  UINT32            MemPoolFreeList;
+  MEM_POOL_PROFILE  MemPoolProfile;
 } LOADER_GLOBAL_DATA;
 
 /**
@@ -67,6 +67,9 @@ UpdateBgrt (
   BMP_IMAGE_HEADER                           *OrgBmpHdr;
   UINT32                                      ImageLen;
   UINT32                                      FileLen;
+  UINT32                                      PixelWidth;
+  UINT32                                      PixelHeight;
+  FB_SPLASH_HEADER                           *SplashHdr;
 
   if (PcdGet32 (PcdSplashLogoAddress) == 0) {
     return EFI_UNSUPPORTED;
@@ -85,15 +88,33 @@ UpdateBgrt (
   }
 
   OrgBmpHdr = (BMP_IMAGE_HEADER *)(UINTN)BmpBase;
+  SplashHdr = (FB_SPLASH_HEADER *)(UINTN)BmpBase;
   Bgrt = (EFI_ACPI_5_0_BOOT_GRAPHICS_RESOURCE_TABLE *)Table;
   Bgrt->ImageAddress = (UINTN)OrgBmpHdr;
-  if (!((OrgBmpHdr->BitPerPixel == 24) || (OrgBmpHdr->BitPerPixel == 32))) {
-    // Need to convert the BMP image into 32bit BMP supported by BGRT
-    ImageLen = (UINT32)MultU64x32 (OrgBmpHdr->PixelWidth << 2,  OrgBmpHdr->PixelHeight);
+  if ((SplashHdr->Signature == FB_SPLASH_SIGNATURE) ||
+      !((OrgBmpHdr->BitPerPixel == 24) || (OrgBmpHdr->BitPerPixel == 32))) {
+    // Need to convert the splash image into 32bit BMP supported by BGRT
+    if (SplashHdr->Signature == FB_SPLASH_SIGNATURE) {
+      PixelWidth  = SplashHdr->PixelWidth;
+      PixelHeight = SplashHdr->PixelHeight;
+    } else {
+      PixelWidth  = OrgBmpHdr->PixelWidth;
+      PixelHeight = OrgBmpHdr->PixelHeight;
+    }
+    ImageLen = (UINT32)MultU64x32 (PixelWidth << 2,  PixelHeight);
     FileLen  = sizeof(BMP_IMAGE_HEADER) + ImageLen;
     BmpHdr = (BMP_IMAGE_HEADER *)AllocatePages (EFI_SIZE_TO_PAGES (FileLen));
     if (BmpHdr != NULL) {
-      CopyMem (BmpHdr, OrgBmpHdr, sizeof(BMP_IMAGE_HEADER));
+      if (SplashHdr->Signature == FB_SPLASH_SIGNATURE) {
+        ZeroMem (BmpHdr, sizeof(BMP_IMAGE_HEADER));
+        BmpHdr->CharB        = 'B';
+        BmpHdr->CharM        = 'M';
+        BmpHdr->PixelWidth   = PixelWidth;
+        BmpHdr->PixelHeight  = PixelHeight;
+        BmpHdr->Planes       = 1;
+      } else {
+        CopyMem (BmpHdr, OrgBmpHdr, sizeof(BMP_IMAGE_HEADER));
+      }
       BmpHdr->Size = FileLen;
       BmpHdr->ImageOffset = sizeof(BMP_IMAGE_HEADER);
       BmpHdr->HeaderSize  = sizeof(BMP_IMAGE_HEADER) - OFFSET_OF(BMP_IMAGE_HEADER, HeaderSize);
@@ -105,8 +126,16 @@ UpdateBgrt (
       Status = DisplayBmpToFrameBuffer (OrgBmpHdr, &BmpHdr[1], ImageLen, GfxInfoHob);
       if (!EFI_ERROR(Status)) {
         Bgrt->ImageAddress = (UINTN)BmpHdr;
+      } else {
+        FreePages (BmpHdr, EFI_SIZE_TO_PAGES (FileLen));
       }
     }
+
+    if ((SplashHdr->Signature == FB_SPLASH_SIGNATURE) && (Bgrt->ImageAddress == (UINTN)OrgBmpHdr)) {
+      // The $FBS blob is not a BMP, so do not publish BGRT without a converted image
+      DEBUG ((DEBUG_WARN, "Failed to convert FB splash image for BGRT\n"));
+      return EFI_UNSUPPORTED;
+    }
   }
   Bgrt->ImageOffsetX = OffX;
   Bgrt->ImageOffsetY = OffY;
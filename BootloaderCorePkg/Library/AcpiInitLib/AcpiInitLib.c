@@ -81,6 +81,48 @@ AcpiPlatformChecksum (
   Buffer[ChecksumOffset] = CalculateCheckSum8 (Buffer, Size);
 }
 
+/**
+  This function locates the GNVS OperationRegion through the build time patch map.
+
+  The map is only used if the DSDT header (including its length and checksum)
+  matches the CRC32 recorded at build time and the AML at the mapped offset
+  still encodes the GNVS OperationRegion. The AML body is not hashed since
+  that would cost as much as the scan the map replaces, so the opcode check
+  is what guards against a stale offset.
+
+  @param[in]  Dsdt          Pointer to DSDT table
+
+  @retval     Pointer to the GNVS OperationRegion name, NULL if the map does not apply.
+
+**/
+STATIC
+UINT8 *
+FindAcpiGnvsByPatchMap (
+  IN EFI_ACPI_DESCRIPTION_HEADER   *Dsdt
+  )
+{
+  UINT8  *Ptr;
+  UINT32  Offset;
+
+  Offset = PcdGet32 (PcdAcpiGnvsPatchOffset);
+  if ((Offset == MAX_UINT32) || (Offset < sizeof (EFI_ACPI_DESCRIPTION_HEADER)) || (Offset + 13 > Dsdt->Length)) {
+    return NULL;
+  }
+
+  if (CalculateCrc32 (Dsdt, sizeof (EFI_ACPI_DESCRIPTION_HEADER)) != PcdGet32 (PcdAcpiPatchMapHdrCrc)) {
+    return NULL;
+  }
+
+  Ptr = (UINT8 *)Dsdt + Offset;
+  if ((* (Ptr - 2) != AML_EXT_OP) || (* (Ptr - 1) != AML_EXT_REGION_OP) ||
+      (* (UINT32 *)Ptr != SIGNATURE_32 ('G', 'N', 'V', 'S')) ||
+      (Ptr[5] != AML_DWORD_PREFIX) || (Ptr[10] != AML_WORD_PREFIX)) {
+    return NULL;
+  }
+
+  return Ptr;
+}
+
 /**
   This function updates GNVS data structure base address dynamically.
 
@@ -97,23 +139,30 @@ UpdateAcpiGnvs (
   UINT8 *Ptr;
   UINT8 *End;
 
-  Ptr = (UINT8 *)Dsdt;
-  End = (UINT8 *)Dsdt + Dsdt->Length;
+  Ptr = FindAcpiGnvsByPatchMap (Dsdt);
+  if (Ptr == NULL) {
+    DEBUG ((DEBUG_VERBOSE, "No ACPI patch map for DSDT, scanning for GNVS\n"));
+    End = (UINT8 *)Dsdt + Dsdt->Length;
 
-  /*
-   * Loop through the ASL looking for values that we must fix up.
-   */
-  for (; Ptr < End; Ptr++) {
-    if (* (UINT32 *)Ptr != SIGNATURE_32 ('G', 'N', 'V', 'S')) {
-      continue;
+    /*
+     * Loop through the ASL looking for values that we must fix up.
+     */
+    for (Ptr = (UINT8 *)Dsdt; Ptr < End; Ptr++) {
+      if (* (UINT32 *)Ptr != SIGNATURE_32 ('G', 'N', 'V', 'S')) {
+        continue;
+      }
+      if (* (Ptr - 1) != AML_EXT_REGION_OP) {
+        continue;
+      }
+      break;
     }
-    if (* (Ptr - 1) != AML_EXT_REGION_OP) {
-      continue;
+    if (Ptr >= End) {
+      return;
     }
-    * (UINT32 *) (Ptr + 6)  = GnvsBase;
-    * (UINT16 *) (Ptr + 11) = (UINT16)GetAcpiGnvsSize();
-    break;
   }
+
+  * (UINT32 *) (Ptr + 6)  = GnvsBase;
+  * (UINT16 *) (Ptr + 11) = (UINT16)GetAcpiGnvsSize();
 }
 
 /**
@@ -15,6 +15,9 @@
 #include <Library/CpuExceptionLib.h>
 #include <Library/BootloaderCommonLib.h>
 #include <Library/DebugAgentLib.h>
+#include <Library/PagingLib.h>
+
+#define  EXCEPTION_PAGE_FAULT       14
 
 #endif
 
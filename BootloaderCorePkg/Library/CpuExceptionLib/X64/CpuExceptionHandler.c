@@ -13,8 +13,9 @@ CONST UINT32 mErrorCodeFlag = 0x00027d00;
 /**
   Common exception handler.
 
-  It will print out the location where exception occured and then halt the system.
-  This function will never return.
+  Page faults on the on demand identity mapping are resolved and the function
+  returns to retry the access. For any other exception it will print out the
+  location where exception occured and then halt the system.
 
   @param[in] Stack          Current stack address pointer.
   @param[in] ExceptionType  Exception type code.
@@ -28,6 +29,13 @@ CommonExceptionHandler (
 {
   UINTN  *Ptr;
 
+  if (ExceptionType == EXCEPTION_PAGE_FAULT) {
+    if (!EFI_ERROR (HandleIdentityMappingPageFault (AsmReadCr2 (), Stack[1]))) {
+      return;
+    }
+    DEBUG ((DEBUG_ERROR, "Page fault @ 0x%lX, error code 0x%X\n", (UINT64)AsmReadCr2 (), (UINT32)Stack[1]));
+  }
+
   // Skip the ExceptionType on the stack
   Ptr = Stack + 1;
 
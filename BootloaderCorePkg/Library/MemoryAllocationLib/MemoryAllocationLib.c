@@ -12,24 +12,75 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/BlMemoryAllocationLib.h>
 #include <BootloaderCoreGlobal.h>
 
 #define   POOL_MIN_ALIGNMENT    0x10
 
+//
+// Header kept at the start of a freed page block in the permanent memory pool
+//
+typedef struct {
+  UINT32    Next;
+  UINT32    Pages;
+} FREE_PAGE_BLOCK;
+
+/**
+  Record the memory pool high-water marks and the allocations reaching them.
+
+  @param [in] LdrGlobal   Loader global data pointer.
+  @param [in] Top         New memory pool top address.
+  @param [in] Bottom      New memory pool bottom address.
+  @param [in] Caller      Return address of the allocation.
+ **/
+STATIC
+VOID
+InternalProfileMemPool (
+  IN LOADER_GLOBAL_DATA  *LdrGlobal,
+  IN UINT32               Top,
+  IN UINT32               Bottom,
+  IN VOID                *Caller
+  )
+{
+  MEM_POOL_PROFILE    *Profile;
+  UINT32               PermUsed;
+  UINT32               TempUsed;
+
+  Profile  = &LdrGlobal->MemPoolProfile;
+  PermUsed = LdrGlobal->MemPoolEnd - Top;
+  TempUsed = Bottom - LdrGlobal->MemPoolStart;
+  if (Profile->PermMaxUsed < PermUsed) {
+    Profile->PermMaxUsed = PermUsed;
+    Profile->PermCaller  = (UINT32)(UINTN)Caller;
+  }
+  if (Profile->TempMaxUsed < TempUsed) {
+    Profile->TempMaxUsed = TempUsed;
+    Profile->TempCaller  = (UINT32)(UINTN)Caller;
+  }
+  if (LdrGlobal->MemPoolMaxUsed < PermUsed + TempUsed) {
+    Profile->MaxUsedCaller = (UINT32)(UINTN)Caller;
+  }
+}
+
 /**
   Update the Memory pool top address.
 
-  @param [in] Top Top address to update.
+  @param [in] Top     Top address to update.
+  @param [in] Caller  Return address of the allocation for profiling.
  **/
 VOID
 InternalUpdateMemPoolTop (
-  IN UINT32  Top
+  IN UINT32  Top,
+  IN VOID   *Caller
   )
 {
   LOADER_GLOBAL_DATA  *LdrGlobal;
   UINT32               PoolUsed;
 
   LdrGlobal = GetLoaderGlobalDataPointer();
+  if (FeaturePcdGet (PcdMemPoolProfileEnabled)) {
+    InternalProfileMemPool (LdrGlobal, Top, LdrGlobal->MemPoolCurrBottom, Caller);
+  }
   PoolUsed = (LdrGlobal->MemPoolEnd - Top) +
               (LdrGlobal->MemPoolCurrBottom - LdrGlobal->MemPoolStart);
   if (LdrGlobal->MemPoolMaxUsed < PoolUsed) {
@@ -42,17 +93,22 @@ InternalUpdateMemPoolTop (
 /**
   Update the Memory pool bottom address.
 
-  @param [in] Bottom bottom address to update.
+  @param [in] Bottom  bottom address to update.
+  @param [in] Caller  Return address of the allocation for profiling.
  **/
 VOID
 InternalUpdateMemPoolBottom (
-  IN UINT32  Bottom
+  IN UINT32  Bottom,
+  IN VOID   *Caller
   )
 {
   LOADER_GLOBAL_DATA  *LdrGlobal;
   UINT32               PoolUsed;
 
   LdrGlobal = GetLoaderGlobalDataPointer();
+  if (FeaturePcdGet (PcdMemPoolProfileEnabled)) {
+    InternalProfileMemPool (LdrGlobal, LdrGlobal->MemPoolCurrTop, Bottom, Caller);
+  }
   PoolUsed = (LdrGlobal->MemPoolEnd - LdrGlobal->MemPoolCurrTop) +
               (Bottom - LdrGlobal->MemPoolStart);
   if (LdrGlobal->MemPoolMaxUsed < PoolUsed) {
@@ -62,6 +118,99 @@ InternalUpdateMemPoolBottom (
   LdrGlobal->MemPoolCurrBottom = Bottom;
 }
 
+/**
+  Return free page blocks at the top of the permanent memory pool to the pool.
+
+  @param [in] LdrGlobal   Loader global data pointer.
+ **/
+STATIC
+VOID
+InternalReclaimFreePages (
+  IN LOADER_GLOBAL_DATA  *LdrGlobal
+  )
+{
+  FREE_PAGE_BLOCK  *Block;
+  UINT32           *Link;
+  BOOLEAN           Found;
+
+  do {
+    Found = FALSE;
+    Link  = &LdrGlobal->MemPoolFreeList;
+    while (*Link != 0) {
+      Block = (FREE_PAGE_BLOCK *)(UINTN)*Link;
+      if (*Link == LdrGlobal->MemPoolCurrTop) {
+        *Link = Block->Next;
+        LdrGlobal->MemPoolCurrTop += Block->Pages * EFI_PAGE_SIZE;
+        Found = TRUE;
+        break;
+      }
+      Link = &Block->Next;
+    }
+  } while (Found);
+}
+
+/**
+  Allocate pages from the free page blocks using first fit.
+
+  @param [in] LdrGlobal   Loader global data pointer.
+  @param [in] Pages       The number of 4 KB pages to allocate.
+
+  @return A pointer to the allocated buffer or NULL if no block is large enough.
+ **/
+STATIC
+VOID *
+InternalAllocateFreePages (
+  IN LOADER_GLOBAL_DATA  *LdrGlobal,
+  IN UINTN                Pages
+  )
+{
+  FREE_PAGE_BLOCK  *Block;
+  UINT32           *Link;
+
+  Link = &LdrGlobal->MemPoolFreeList;
+  while (*Link != 0) {
+    Block = (FREE_PAGE_BLOCK *)(UINTN)*Link;
+    if (Block->Pages == Pages) {
+      *Link = Block->Next;
+      return Block;
+    }
+    if (Block->Pages > Pages) {
+      // Keep the block header in place and hand out the upper pages
+      Block->Pages -= (UINT32)Pages;
+      return (UINT8 *)Block + Block->Pages * EFI_PAGE_SIZE;
+    }
+    Link = &Block->Next;
+  }
+
+  return NULL;
+}
+
+/**
+  Allocates a buffer from the top of the memory pool.
+
+  @param [in] AllocationSize    The number of bytes to allocate.
+  @param [in] Caller            Return address of the allocation for profiling.
+
+  @return A pointer to the allocated buffer.
+ **/
+STATIC
+VOID *
+InternalAllocatePool (
+  IN UINTN   AllocationSize,
+  IN VOID   *Caller
+  )
+{
+  LOADER_GLOBAL_DATA  *LdrGlobal;
+  UINT32               Top;
+
+  LdrGlobal = GetLoaderGlobalDataPointer();
+  Top  = LdrGlobal->MemPoolCurrTop;
+  Top -= (UINT32)AllocationSize;
+  Top  = ALIGN_DOWN (Top, POOL_MIN_ALIGNMENT);
+  InternalUpdateMemPoolTop (Top, Caller);
+  return (VOID *)(UINTN)Top;
+}
+
 /**
   Allocates a buffer of type EfiBootServicesData.
 
@@ -81,15 +230,7 @@ AllocatePool (
   IN UINTN  AllocationSize
   )
 {
-  LOADER_GLOBAL_DATA  *LdrGlobal;
-  UINT32               Top;
-
-  LdrGlobal = GetLoaderGlobalDataPointer();
-  Top  = LdrGlobal->MemPoolCurrTop;
-  Top -= (UINT32)AllocationSize;
-  Top  = ALIGN_DOWN (Top, POOL_MIN_ALIGNMENT);
-  InternalUpdateMemPoolTop (Top);
-  return (VOID *)(UINTN)Top;
+  return InternalAllocatePool (AllocationSize, RETURN_ADDRESS (0));
 }
 
 /**
@@ -113,7 +254,7 @@ AllocateZeroPool (
 {
   VOID  *Memory;
 
-  Memory = AllocatePool (AllocationSize);
+  Memory = InternalAllocatePool (AllocationSize, RETURN_ADDRESS (0));
   if (Memory != NULL) {
     Memory = ZeroMem (Memory, AllocationSize);
   }
@@ -125,8 +266,9 @@ AllocateZeroPool (
 
   Allocates the number of 4KB pages of type EfiBootServicesData and returns a pointer to the
   allocated buffer.  The buffer returned is aligned on a 4KB boundary.  If Pages is 0, then
-  NULL is returned.  If there is not enough memory remaining to satisfy the request,
-  InternalUpdateMemPoolTop ASSERTS and the function does not return.
+  NULL is returned.  Page blocks released by FreePages are reused first.  If there is not
+  enough memory remaining to satisfy the request, InternalUpdateMemPoolTop ASSERTS and the
+  function does not return.
 
   @param  Pages                 The number of 4 KB pages to allocate.
 
@@ -141,16 +283,22 @@ AllocatePages (
 {
   LOADER_GLOBAL_DATA  *LdrGlobal;
   UINT32               Top;
+  VOID                *Buffer;
 
   if (Pages == 0) {
     return NULL;
   }
 
   LdrGlobal = GetLoaderGlobalDataPointer();
+  Buffer = InternalAllocateFreePages (LdrGlobal, Pages);
+  if (Buffer != NULL) {
+    return Buffer;
+  }
+
   Top  = LdrGlobal->MemPoolCurrTop;
   Top  = ALIGN_DOWN (Top, EFI_PAGE_SIZE);
   Top -= (UINT32)(Pages * EFI_PAGE_SIZE);
-  InternalUpdateMemPoolTop (Top);
+  InternalUpdateMemPoolTop (Top, RETURN_ADDRESS (0));
   return (VOID *)(UINTN)Top;
 }
 
@@ -194,7 +342,7 @@ AllocateAlignedPages (
     Top  = ALIGN_DOWN (Top, Alignment);
   }
   Top  = ALIGN_DOWN (Top, EFI_PAGE_SIZE);
-  InternalUpdateMemPoolTop (Top);
+  InternalUpdateMemPoolTop (Top, RETURN_ADDRESS (0));
   return (VOID *)(UINTN)Top;
 }
 
@@ -222,7 +370,7 @@ AllocateTemporaryMemory (
   Bottom  = LdrGlobal->MemPoolCurrBottom;
   Bottom  = ALIGN_UP (Bottom, POOL_MIN_ALIGNMENT);
   NewBottom = Bottom + (UINT32)AllocationSize;
-  InternalUpdateMemPoolBottom (NewBottom);
+  InternalUpdateMemPoolBottom (NewBottom, RETURN_ADDRESS (0));
   return (VOID *)(UINTN)Bottom;
 }
 
@@ -247,7 +395,7 @@ FreeTemporaryMemory (
   } else {
     NewBottom = (UINT32)(UINTN)Buffer;
     if (NewBottom < LdrGlobal->MemPoolCurrBottom) {
-      InternalUpdateMemPoolBottom (NewBottom);
+      InternalUpdateMemPoolBottom (NewBottom, NULL);
     }
   }
 }
@@ -265,6 +413,9 @@ FreeTemporaryMemory (
   then ASSERT().
   If Pages is zero, then ASSERT().
 
+  Freed pages at the top of the permanent memory pool are returned to the pool directly,
+  other page blocks are kept in a free list for later page allocations.
+
   @param  Buffer                The pointer to the buffer of pages to free.
   @param  Pages                 The number of 4 KB pages to free.
 
@@ -276,6 +427,32 @@ FreePages (
   IN UINTN  Pages
   )
 {
+  LOADER_GLOBAL_DATA  *LdrGlobal;
+  FREE_PAGE_BLOCK     *Block;
+  UINT32               Base;
+
+  ASSERT (Pages != 0);
+  if ((Buffer == NULL) || (Pages == 0)) {
+    return;
+  }
+
+  LdrGlobal = GetLoaderGlobalDataPointer();
+  Base = (UINT32)(UINTN)Buffer;
+  if (((Base & EFI_PAGE_MASK) != 0) || (Base < LdrGlobal->MemPoolCurrTop) ||
+      (Base + Pages * EFI_PAGE_SIZE > LdrGlobal->MemPoolEnd)) {
+    // Not allocated from the permanent memory pool
+    return;
+  }
+
+  if (Base == LdrGlobal->MemPoolCurrTop) {
+    LdrGlobal->MemPoolCurrTop += (UINT32)(Pages * EFI_PAGE_SIZE);
+  } else {
+    Block        = (FREE_PAGE_BLOCK *)Buffer;
+    Block->Next  = LdrGlobal->MemPoolFreeList;
+    Block->Pages = (UINT32)Pages;
+    LdrGlobal->MemPoolFreeList = Base;
+  }
+  InternalReclaimFreePages (LdrGlobal);
 }
 
 /**
@@ -48,6 +48,57 @@ SetCpuMtrrsTask (
   }
 }
 
+/**
+  Wait until a counter incremented by the APs reaches a target value.
+
+  The counter is polled continuously and the timeout is measured with the
+  performance counter, so the wait ends as soon as the last AP checks in.
+
+  @param[in]  Counter     Counter incremented by the APs.
+  @param[in]  Target      Value the counter has to reach.
+  @param[in]  TimeoutUs   Timeout in microseconds.
+
+  @retval TRUE            The counter reached the target value.
+  @retval FALSE           Timed out.
+
+**/
+STATIC
+BOOLEAN
+WaitForApCounter (
+  IN volatile UINT32   *Counter,
+  IN volatile UINT32   *Target,
+  IN UINT32             TimeoutUs
+  )
+{
+  UINT64   StartValue;
+  UINT64   EndValue;
+  UINT64   Mask;
+  UINT64   Timeout;
+  UINT64   Elapsed;
+  UINT64   Previous;
+  UINT64   Current;
+
+  Timeout  = DivU64x32 (MultU64x32 (GetPerformanceCounterProperties (&StartValue, &EndValue), TimeoutUs), 1000000);
+  Mask     = (StartValue < EndValue) ? (EndValue - StartValue) : (StartValue - EndValue);
+  Elapsed  = 0;
+  Previous = GetPerformanceCounter ();
+  while (*Counter < *Target) {
+    if (Elapsed >= Timeout) {
+      return FALSE;
+    }
+    CpuPause ();
+    Current = GetPerformanceCounter ();
+    if (StartValue < EndValue) {
+      Elapsed += (Current - Previous) & Mask;
+    } else {
+      Elapsed += (Previous - Current) & Mask;
+    }
+    Previous = Current;
+  }
+
+  return TRUE;
+}
+
 /**
   The function is called by PerformQuickSort to sort CPU_INFO by ApicId.
 
@@ -248,6 +299,39 @@ CpuInit (
 }
 
 
+/**
+  Move a ready AP to a new task state.
+
+  MpRunTask () and the broadcast task of MpRunTaskAll () both take an AP out
+  of EnumCpuReady. The state is changed with a compare-exchange so that only
+  one of them can claim the AP. The State byte is the first byte of a DWORD
+  aligned CPU_TASK, so the exchange is done on the DWORD that holds it.
+
+  @param[in]  Index       CPU index
+  @param[in]  NewState    New CPU_STATE for the AP
+
+  @retval TRUE            The AP was ready and is now in NewState.
+  @retval FALSE           The AP was not ready.
+
+**/
+STATIC
+BOOLEAN
+ClaimReadyCpu (
+  IN  UINT32         Index,
+  IN  UINT8          NewState
+  )
+{
+  volatile UINT32    *StateDword;
+  UINT32             Ready;
+
+  StateDword = (volatile UINT32 *)&mSysCpuTask.CpuTask[Index].State;
+  ASSERT (((UINTN)StateDword & (sizeof (UINT32) - 1)) == 0);
+
+  Ready = (*StateDword & ~(UINT32)MAX_UINT8) | EnumCpuReady;
+  return InterlockedCompareExchange32 ((UINT32 *)StateDword, Ready, (Ready & ~(UINT32)MAX_UINT8) | NewState) == Ready;
+}
+
+
 /**
   AP initialization routine.
 
@@ -265,6 +349,7 @@ ApFunc (
   BOOLEAN            WaitTask;
   CPU_TASK_FUNC      ApRunTask;
   volatile UINT8     *State;
+  UINT32             Generation;
 
   // Enable more CPU featurs
   AsmEnableAvx ();
@@ -282,13 +367,31 @@ ApFunc (
   //
   // Enter task loop
   //
-  WaitTask = TRUE;
+  WaitTask   = TRUE;
+  Generation = 0;
   State  = & (mSysCpuTask.CpuTask[Index].State);
   *State = EnumCpuReady;
   while (WaitTask) {
-    while (*State == EnumCpuReady) {
+    while ((*State == EnumCpuReady) && (mMpDataStruct.TaskGeneration == Generation)) {
       CpuPause ();
     }
+
+    if ((*State == EnumCpuReady) && ClaimReadyCpu (Index, EnumCpuBusy)) {
+      //
+      // Broadcast task, report completion through the shared done counter.
+      // If MpRunTask () claimed the AP first, its task runs and the broadcast
+      // task is picked up after it.
+      //
+      Generation = mMpDataStruct.TaskGeneration;
+      ApRunTask  = (CPU_TASK_FUNC)(UINTN)mMpDataStruct.TaskFunc;
+      if (ApRunTask != NULL) {
+        mSysCpuTask.CpuTask[Index].Result = ApRunTask (mMpDataStruct.TaskArgument);
+      }
+      *State = EnumCpuReady;
+      InterlockedIncrement (&mMpDataStruct.TaskDoneCounter);
+      continue;
+    }
+
     switch (*State) {
     case EnumCpuEnd:
       WaitTask = FALSE;
@@ -360,7 +463,7 @@ MpInit (
 {
   UINT8                    *ApBuffer;
   EFI_STATUS                Status;
-  UINT32                    TimeOutCounter;
+  BOOLEAN                   TimedOut;
   AP_DATA_STRUCT           *ApDataPtr;
   volatile UINT32          *ApCounter;
   UINT32                    CpuCount;
@@ -382,6 +485,8 @@ MpInit (
 
       // Init structure for lock
       mMpDataStruct.SmmRebaseDoneCounter = 0;
+      mMpDataStruct.TaskGeneration       = 0;
+      mMpDataStruct.TaskDoneCounter      = 0;
       InitializeSpinLock (&mMpDataStruct.SpinLock);
 
       //
@@ -499,19 +604,11 @@ MpInit (
       // Wait for task done
       ApDataPtr = (AP_DATA_STRUCT *) (ApBuffer + mStubCodeSize);
       ApCounter = (volatile UINT32 *)&ApDataPtr->ApCounter;
-      TimeOutCounter = 0;
-      while (TimeOutCounter < AP_TASK_TIMEOUT_CNT) {
-        if (mMpDataStruct.ApDoneCounter == *ApCounter) {
-          break;
-        }
-        MicroSecondDelay (AP_TASK_TIMEOUT_UNIT);
-        TimeOutCounter++ ;
-      }
-
+      TimedOut  = !WaitForApCounter (&mMpDataStruct.ApDoneCounter, ApCounter, AP_TASK_TIMEOUT_US);
 
       CpuCount = (*ApCounter) + 1;
       DEBUG ((DEBUG_INFO, "Detected %d CPU threads\n", CpuCount));
-      if (TimeOutCounter == AP_TASK_TIMEOUT_CNT) {
+      if (TimedOut) {
         DEBUG ((DEBUG_INFO, "MPINIT timeout with %d APs completed.\n", mMpDataStruct.ApDoneCounter));
       }
 
@@ -539,6 +636,8 @@ MpInit (
 
       // Restore AP buffer (needed for S3)
       CopyMem (ApBuffer, mBackupBuffer, AP_BUFFER_SIZE);
+      FreePages (mBackupBuffer, EFI_SIZE_TO_PAGES (AP_BUFFER_SIZE));
+      mBackupBuffer = NULL;
       mMpInitPhase = EnumMpInitRun;
     }
   }
@@ -554,13 +653,15 @@ MpInit (
       // All APs should be in EnumCpuReady now
       Status = GetCpuMtrrs (&mMtrrTable);
       if (!EFI_ERROR(Status)) {
-        for (Index = 1; Index < mSysCpuTask.CpuCount; Index++) {
-          if (mSysCpuTask.CpuTask[Index].State == EnumCpuReady) {
-            MpRunTask (Index, SetCpuMtrrsTask, (UINT64)(UINTN)&mMtrrTable);
-          }
+        // Sync MTRRs on all APs in a single broadcast
+        Status = MpRunTaskAll (SetCpuMtrrsTask, (UINT64)(UINTN)&mMtrrTable);
+        if (EFI_ERROR (Status)) {
+          //
+          // The APs are put back in WFS state below in any case
+          //
+          DEBUG ((DEBUG_ERROR, "MTRR sync on APs failed - %r, ignored\n", Status));
+          Status = EFI_SUCCESS;
         }
-        // Allow MTRR sync to complete
-        MicroSecondDelay (100);
       }
 
       for (Index = 1; Index < mSysCpuTask.CpuCount; Index++) {
@@ -643,7 +744,61 @@ MpRunTask (
 
   mSysCpuTask.CpuTask[Index].TaskFunc = (UINT64)(UINTN)TaskFunc;
   mSysCpuTask.CpuTask[Index].Argument   = Argument;
-  mSysCpuTask.CpuTask[Index].State      = EnumCpuStart;
+  if (!ClaimReadyCpu (Index, EnumCpuStart)) {
+    //
+    // The AP picked up a broadcast task in the meantime
+    //
+    return EFI_NOT_READY;
+  }
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Run a task function on all APs at once and wait for all of them to complete.
+
+  The task is published to all APs in one step instead of being dispatched
+  to each AP in turn. It can only be used between the EnumMpInitRun and
+  EnumMpInitDone phases. An AP busy with another task runs the broadcast task
+  once its current task is done.
+
+  @param[in]  TaskFunc    Task function pointer
+  @param[in]  Argument    Argument for the task function
+
+  @retval EFI_NOT_READY           APs are not waiting for tasks.
+  @retval EFI_TIMEOUT             Not all APs completed the task in time.
+  @retval EFI_SUCCESS             All APs completed the task.
+
+**/
+EFI_STATUS
+EFIAPI
+MpRunTaskAll (
+  IN  CPU_TASK_FUNC  TaskFunc,
+  IN  UINT64         Argument
+  )
+{
+  UINT32   ApCount;
+
+  if (mMpInitPhase != EnumMpInitRun) {
+    return EFI_NOT_READY;
+  }
+
+  ApCount = mSysCpuTask.CpuCount - 1;
+  if (ApCount == 0) {
+    return EFI_SUCCESS;
+  }
+
+  mMpDataStruct.TaskFunc        = (UINT64)(UINTN)TaskFunc;
+  mMpDataStruct.TaskArgument    = Argument;
+  mMpDataStruct.TaskDoneCounter = 0;
+  MemoryFence ();
+  mMpDataStruct.TaskGeneration++;
+
+  if (!WaitForApCounter (&mMpDataStruct.TaskDoneCounter, &ApCount, AP_TASK_TIMEOUT_US)) {
+    DEBUG ((DEBUG_WARN, "MP task timeout with %d of %d APs completed\n", mMpDataStruct.TaskDoneCounter, ApCount));
+    return EFI_TIMEOUT;
+  }
 
   return EFI_SUCCESS;
 }
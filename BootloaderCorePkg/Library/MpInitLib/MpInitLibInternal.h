@@ -34,6 +34,7 @@
 #define   AP_STACK_SIZE            (1<<AP_STACK_SIZE_SHIFT_BITS)
 #define   AP_TASK_TIMEOUT_UNIT     15
 #define   AP_TASK_TIMEOUT_CNT      1000
+#define   AP_TASK_TIMEOUT_US       (AP_TASK_TIMEOUT_UNIT * AP_TASK_TIMEOUT_CNT)
 
 #define   RSM_SIG                  0x9090AA0F  /// Opcode for 'rsm'
 
@@ -72,6 +73,11 @@ typedef struct {
   UINT32            ApDoneCounter;
   UINT32            SmmRebaseDoneCounter;
   SPIN_LOCK         SpinLock;
+  // Broadcast task, picked up by all APs when TaskGeneration changes
+  UINT32            TaskGeneration;
+  UINT32            TaskDoneCounter;
+  UINT64            TaskFunc;
+  UINT64            TaskArgument;
 } MP_DATA_EXCHANGE_STRUCT;
 #pragma pack()
 
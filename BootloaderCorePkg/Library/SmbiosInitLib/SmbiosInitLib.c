@@ -35,6 +35,24 @@ GLOBAL_REMOVE_IF_UNREFERENCED PROCESSOR_FAMILY_FIELD mProcessorFamilyField[] = {
   { "Xeon(R)",      ProcessorFamilyIntelXeon },
 };
 
+//
+// Index of the SMBIOS structure area being built. It lets the type and string
+// helpers avoid walking the whole structure area for every call. It is only
+// trusted while the table length matches the length recorded here.
+// TypeStrings holds the strings of the type being added. It is kept here
+// rather than on the stack of AddSmbiosType (), which can run on a small
+// AP stack.
+//
+typedef struct {
+  SMBIOS_TABLE_ENTRY_POINT   *SmbiosEntry;
+  SMBIOS_STRUCTURE           *LastTypeHdr;
+  UINT32                      TypePresent[256 / 32];
+  UINT16                      TableLength;
+  CHAR8                      *TypeStrings[MAX_UINT8 + 1];
+} SMBIOS_BUILD_INDEX;
+
+STATIC SMBIOS_BUILD_INDEX  mSmbiosIndex;
+
 //
 // Add more platform specific strings
 // in the following format
@@ -107,6 +125,24 @@ CheckSmbiosOverflow (
   }
 }
 
+/**
+  Check if the SMBIOS build index matches the current structure area.
+
+  @param[in]  SmbiosEntry   SMBIOS entry point structure
+
+  @retval     TRUE          The index can be used.
+  @retval     FALSE         The structure area has to be walked.
+
+**/
+STATIC
+BOOLEAN
+IsSmbiosIndexValid (
+  IN  SMBIOS_TABLE_ENTRY_POINT  *SmbiosEntry
+  )
+{
+  return (mSmbiosIndex.SmbiosEntry == SmbiosEntry) && (mSmbiosIndex.TableLength == SmbiosEntry->TableLength);
+}
+
 /**
   Return the pointer to the last Smbios table spcified by 'Type'
 
@@ -134,6 +170,15 @@ FindSmbiosType (
     return NULL;
   }
 
+  if (IsSmbiosIndexValid (SmbiosEntry)) {
+    if ((mSmbiosIndex.TypePresent[Type >> 5] & (1U << (Type & 0x1F))) == 0) {
+      return NULL;
+    }
+    if (mSmbiosIndex.LastTypeHdr->Type == Type) {
+      return mSmbiosIndex.LastTypeHdr;
+    }
+  }
+
   TypeHdr  = (SMBIOS_STRUCTURE *) (UINTN) SmbiosEntry->TableAddress;
   CurLimit = (UINT32) (UINTN) ((UINT8 *) SmbiosEntry + SmbiosEntry->EntryPointLength + sizeof (UINT8) + SmbiosEntry->TableLength);
 
@@ -217,38 +262,6 @@ FinalizeSmbios (
   return Status;
 }
 
-/**
-  Calculate number of strings in a type.
-
-  @param[in]  Type      Get the num of strings for a Type
-
-  @retval               Number of strings for a Type, if given via PCd structure
-                                            assume 0, otherwise
-**/
-UINT8
-CalculateNumStrInType (
-  IN  UINT8   Type
-)
-{
-  UINT8                   Idx;
-  UINT8                   Count;
-  SMBIOS_TYPE_STRINGS    *SmbiosStringsPtr;
-
-  Idx   = 0;
-  Count = 0;
-  SmbiosStringsPtr = (SMBIOS_TYPE_STRINGS *) (UINTN) PcdGet32 (PcdSmbiosStringsPtr);
-
-  if (SmbiosStringsPtr != NULL) {
-    for (Idx = 0; SmbiosStringsPtr[Idx].Type != SMBIOS_TYPE_END_OF_TABLE; Idx++) {
-      if (SmbiosStringsPtr[Idx].Type == Type && SmbiosStringsPtr[Idx].Idx != 0) {
-        Count++;
-      }
-    }
-  }
-
-  return Count;
-}
-
 /**
   Get the value a particular string in a Type
   from data structure pointed to by PcdSmbiosStringsPtr
@@ -318,6 +331,67 @@ GetSmbiosString (
   return String;
 }
 
+/**
+  Get the strings of a Type from the data structure pointed to by
+  PcdSmbiosStringsPtr in one pass over the string tables.
+
+  The string count is the number of platform entries for the Type. Each string
+  resolves the same way as GetSmbiosString () does.
+
+  @param[in]  Type      Get the strings for a Type
+  @param[out] Strings   Strings indexed by string number. Index 0 is unused.
+
+  @retval               Number of strings for a Type
+
+**/
+STATIC
+UINT8
+GetSmbiosStringsForType (
+  IN  UINT8   Type,
+  OUT CHAR8  *Strings[MAX_UINT8 + 1]
+  )
+{
+  SMBIOS_TYPE_STRINGS       *SmbiosStrings;
+  UINT16                     SmbiosStringsCnt;
+  UINTN                      Index;
+  UINT8                      Count;
+  UINT8                      StringId;
+  UINT32                     Resolved[(MAX_UINT8 + 1) / 32];
+
+  ZeroMem (Resolved, sizeof (Resolved));
+  Count            = 0;
+  SmbiosStrings    = (SMBIOS_TYPE_STRINGS *)(UINTN)PcdGet32 (PcdSmbiosStringsPtr);
+  SmbiosStringsCnt = PcdGet16 (PcdSmbiosStringsCnt);
+
+  if (SmbiosStrings != NULL) {
+    for (Index = 0; SmbiosStrings[Index].Type != SMBIOS_TYPE_END_OF_TABLE; Index++) {
+      if ((SmbiosStrings[Index].Type != Type) || (SmbiosStrings[Index].Idx == 0)) {
+        continue;
+      }
+      Count++;
+      //
+      // The first platform entry of a string index wins. An empty string
+      // falls back to the default string table.
+      //
+      StringId = SmbiosStrings[Index].Idx;
+      if ((Index < SmbiosStringsCnt) && ((Resolved[StringId >> 5] & (1U << (StringId & 0x1F))) == 0)) {
+        Resolved[StringId >> 5] |= 1U << (StringId & 0x1F);
+        Strings[StringId] = SmbiosStrings[Index].String;
+      }
+    }
+  }
+
+  for (Index = 1; Index <= Count; Index++) {
+    if (((Resolved[Index >> 5] & (1U << (Index & 0x1F))) != 0) &&
+        (Strings[Index] != NULL) && (AsciiStrLen (Strings[Index]) != 0)) {
+      continue;
+    }
+    Strings[Index] = GetSmbiosString (Type, (UINT8)Index);
+  }
+
+  return Count;
+}
+
 /**
   Add the string to an Smbios type
 
@@ -367,6 +441,7 @@ AddSmbiosString (
   UINT16                        TypeLength;
   EFI_STATUS                    Status;
   BOOLEAN                       StrPresent;
+  BOOLEAN                       IndexValid;
 
   SmbiosEntry = (SMBIOS_TABLE_ENTRY_POINT *) (UINTN) PcdGet32 (PcdSmbiosTablesBase);
   StrPresent  = FALSE;
@@ -394,11 +469,20 @@ AddSmbiosString (
     String = SMBIOS_STRING_UNKNOWN;
   }
 
-  StringPtr = (CHAR8 *) ((UINT8 *) TypeHdr + TypeHdr->Length);
-  // Find end of an existing string
-  while ( !(StringPtr[0] == 0 && StringPtr[1] == 0) ) {
-    StrPresent = TRUE;
-    StringPtr++;
+  IndexValid = IsSmbiosIndexValid (SmbiosEntry);
+  StringPtr  = (CHAR8 *) ((UINT8 *) TypeHdr + TypeHdr->Length);
+  if (IndexValid && (TypeHdr == mSmbiosIndex.LastTypeHdr)) {
+    //
+    // The last type ends with its string terminator at the end of the table
+    //
+    StringPtr  = (CHAR8 *) (UINTN) (SmbiosEntry->TableAddress + SmbiosEntry->TableLength - TYPE_TERMINATOR_SIZE);
+    StrPresent = (StringPtr != (CHAR8 *) ((UINT8 *) TypeHdr + TypeHdr->Length));
+  } else {
+    // Find end of an existing string
+    while ( !(StringPtr[0] == 0 && StringPtr[1] == 0) ) {
+      StrPresent = TRUE;
+      StringPtr++;
+    }
   }
   if (StrPresent == TRUE) {
     *StringPtr++ = 0; // Leave a 00 between strings
@@ -420,6 +504,10 @@ AddSmbiosString (
     SmbiosEntry->MaxStructureSize = TypeLength;
   }
 
+  if (IndexValid) {
+    mSmbiosIndex.TableLength = SmbiosEntry->TableLength;
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -446,6 +534,7 @@ AddSmbiosType (
   EFI_STATUS                    Status;
   SMBIOS_STRUCTURE             *TypeHdr;
   UINT16                        HdrLen;
+  BOOLEAN                       IndexValid;
 
   SmbiosEntry = (SMBIOS_TABLE_ENTRY_POINT *) (UINTN) PcdGet32 (PcdSmbiosTablesBase);
   NumStr      = 0;
@@ -460,7 +549,7 @@ AddSmbiosType (
     }
   }
 
-  NumStr = CalculateNumStrInType (TypeHdr->Type);
+  NumStr = GetSmbiosStringsForType (TypeHdr->Type, mSmbiosIndex.TypeStrings);
 
   //
   // Check for overflow before adding the Type
@@ -484,12 +573,13 @@ AddSmbiosType (
   //
   // Copy header, init string ptr, add strings
   //
+  IndexValid = IsSmbiosIndexValid (SmbiosEntry);
   TypeHdr = (VOID *) (UINTN) (SmbiosEntry->TableAddress + SmbiosEntry->TableLength);
   CopyMem (TypeHdr, HdrInfo, HdrLen);
   StringPtr = (CHAR8 *) ((UINT8 *) TypeHdr + HdrLen);
   if (NumStr > 0) {
     for (StrIdx = 1; StrIdx <= NumStr; ++StrIdx) {
-      StringPtr = CopySmbiosString (StringPtr, GetSmbiosString (TypeHdr->Type, StrIdx));
+      StringPtr = CopySmbiosString (StringPtr, mSmbiosIndex.TypeStrings[StrIdx]);
     }
   } else {
     *StringPtr++ = 0; // Add string terminator
@@ -512,6 +602,12 @@ AddSmbiosType (
   TypeHdr->Length = (UINT8) HdrLen;
   TypeHdr->Handle = SmbiosEntry->NumberOfSmbiosStructures++;
 
+  if (IndexValid) {
+    mSmbiosIndex.TypePresent[TypeHdr->Type >> 5] |= 1U << (TypeHdr->Type & 0x1F);
+    mSmbiosIndex.LastTypeHdr = TypeHdr;
+    mSmbiosIndex.TableLength = SmbiosEntry->TableLength;
+  }
+
   return Status;
 }
 
@@ -733,6 +829,12 @@ SmbiosInit (
   SmbiosEntryPoint->TableAddress                              = (UINT32)(UINTN)SmbiosEntryPoint + sizeof (SMBIOS_TABLE_ENTRY_POINT) + sizeof (UINT8);
   SmbiosEntryPoint->NumberOfSmbiosStructures                  = 0;
 
+  //
+  // Start indexing the empty structure area
+  //
+  ZeroMem (&mSmbiosIndex, sizeof (mSmbiosIndex));
+  mSmbiosIndex.SmbiosEntry = SmbiosEntryPoint;
+
   //
   // Patch common Type headers if necessary
   //
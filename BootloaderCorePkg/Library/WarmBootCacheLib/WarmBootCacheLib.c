@@ -0,0 +1,386 @@
+/** @file
+  Warm boot image cache library.
+
+  The cache region is carved out of the top of low memory right below the
+  ACPI reclaim region and is reported as reserved memory, so its content
+  survives a warm reset. The OS can still write to it, so nothing in the
+  cache is trusted before it is authenticated against the hash store.
+
+  Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/BootloaderCoreLib.h>
+#include <Library/BlMemoryAllocationLib.h>
+#include <Library/SecureBootLib.h>
+#include <Library/DecompressLib.h>
+#include <Library/WarmBootCacheLib.h>
+#include <Guid/OsBootOptionGuid.h>
+#include <BootloaderCoreGlobal.h>
+
+#define  WARM_BOOT_CACHE_ALIGN         EFI_PAGE_SIZE
+
+/**
+  Get the warm boot cache header.
+
+  @retval   The cache header, or NULL if the cache is disabled.
+
+**/
+STATIC
+WARM_BOOT_CACHE_HDR *
+GetWarmBootCacheHdr (
+  VOID
+  )
+{
+  LOADER_GLOBAL_DATA   *LdrGlobal;
+  UINT32                CacheSize;
+
+  CacheSize = PcdGet32 (PcdWarmBootCacheSize);
+  if (CacheSize < sizeof (WARM_BOOT_CACHE_HDR) + WARM_BOOT_CACHE_ALIGN) {
+    return NULL;
+  }
+
+  LdrGlobal = (LOADER_GLOBAL_DATA *)GetLoaderGlobalDataPointer ();
+  return (WARM_BOOT_CACHE_HDR *)(UINTN)(LdrGlobal->MemPoolStart - PcdGet32 (PcdLoaderAcpiNvsSize)
+                                        - PcdGet32 (PcdLoaderAcpiReclaimSize) - CacheSize);
+}
+
+/**
+  Check if the cache header is consistent with the current memory layout.
+
+  @param[in] CacheHdr     The cache header.
+
+  @retval TRUE            The header is valid.
+  @retval FALSE           The header is not valid.
+
+**/
+STATIC
+BOOLEAN
+IsWarmBootCacheHdrValid (
+  IN WARM_BOOT_CACHE_HDR   *CacheHdr
+  )
+{
+  return (CacheHdr->Signature  == WARM_BOOT_CACHE_SIGNATURE) &&
+         (CacheHdr->RegionBase == (UINT32)(UINTN)CacheHdr) &&
+         (CacheHdr->RegionSize == PcdGet32 (PcdWarmBootCacheSize)) &&
+         (CacheHdr->FreeOffset <= CacheHdr->RegionSize) &&
+         (CacheHdr->EntryCount <= WARM_BOOT_CACHE_ENTRY_MAX);
+}
+
+/**
+  Find the cache entry for a component.
+
+  @param[in] CacheHdr       The cache header.
+  @param[in] ComponentType  Component type.
+
+  @retval   The cache entry, or NULL if not found.
+
+**/
+STATIC
+WARM_BOOT_CACHE_ENTRY *
+FindWarmBootCacheEntry (
+  IN WARM_BOOT_CACHE_HDR   *CacheHdr,
+  IN UINT32                 ComponentType
+  )
+{
+  UINT32                Index;
+
+  for (Index = 0; Index < CacheHdr->EntryCount; Index++) {
+    if (CacheHdr->Entry[Index].ComponentType == ComponentType) {
+      return &CacheHdr->Entry[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Get the hash store digest of a component.
+
+  @param[in]  ComponentType  Component type.
+  @param[out] HashAlg        Pointer to receive the hash algorithm.
+  @param[out] DigestSize     Pointer to receive the digest size.
+
+  @retval   The hash store digest, or NULL if the component cannot be cached.
+
+**/
+STATIC
+CONST UINT8 *
+GetWarmBootComponentHash (
+  IN  UINT32            ComponentType,
+  OUT UINT8            *HashAlg,
+  OUT UINT32           *DigestSize
+  )
+{
+  CONST UINT8          *Digest;
+  RETURN_STATUS         Status;
+
+  if (ComponentType >= COMP_TYPE_INVALID) {
+    return NULL;
+  }
+
+  Status = GetComponentHash ((UINT8)ComponentType, &Digest, HashAlg);
+  if (EFI_ERROR (Status) || (Digest == NULL)) {
+    return NULL;
+  }
+
+  if (*HashAlg == HASH_TYPE_SHA256) {
+    *DigestSize = SHA256_DIGEST_SIZE;
+  } else if (*HashAlg == HASH_TYPE_SHA384) {
+    *DigestSize = SHA384_DIGEST_SIZE;
+  } else {
+    return NULL;
+  }
+
+  return Digest;
+}
+
+/**
+  Check if images can be reused from the warm boot cache on this boot.
+
+  @retval TRUE    The cache is enabled, the last reset preserved DRAM and the
+                  cache region holds a valid header.
+  @retval FALSE   Images have to be loaded from flash.
+
+**/
+BOOLEAN
+EFIAPI
+IsWarmBootCacheActive (
+  VOID
+  )
+{
+  WARM_BOOT_CACHE_HDR  *CacheHdr;
+
+  CacheHdr = GetWarmBootCacheHdr ();
+  if (CacheHdr == NULL) {
+    return FALSE;
+  }
+
+  if ((GetResetReason () & (ResetWarm | ResetTcoWdt)) == 0) {
+    return FALSE;
+  }
+
+  return IsWarmBootCacheHdrValid (CacheHdr);
+}
+
+/**
+  Load a component image from the warm boot cache.
+
+  The cache region is not protected from the OS, so the cached component is
+  authenticated against the verified hash store on every use before it is
+  decompressed into the image buffer.
+
+  @param[in]      ComponentType  Component type, COMP_TYPE_STAGE_2 or a payload type.
+  @param[in, out] Buffer         On input, the load address or NULL to allocate.
+                                 On output, the image address.
+  @param[out]     Length         Pointer to receive the image length.
+  @param[in]      LoadComponentCallback  Callback function pointer.
+
+  @retval EFI_SUCCESS            The image was loaded from the cache.
+  @retval EFI_NOT_FOUND          The image is not cached.
+  @retval EFI_SECURITY_VIOLATION The cached component failed authentication.
+  @retval EFI_UNSUPPORTED        The cached component is not compressed.
+  @retval EFI_OUT_OF_RESOURCES   Failed to allocate the image buffer.
+
+**/
+EFI_STATUS
+EFIAPI
+LoadWarmBootImage (
+  IN      UINT32                    ComponentType,
+  IN OUT  VOID                    **Buffer,
+  OUT     UINT32                   *Length,
+  IN      LOAD_COMPONENT_CALLBACK   LoadComponentCallback
+  )
+{
+  WARM_BOOT_CACHE_HDR      *CacheHdr;
+  WARM_BOOT_CACHE_ENTRY    *Entry;
+  LOADER_COMPRESSED_HEADER *CompressHdr;
+  COMPONENT_CALLBACK_INFO   CbInfo;
+  CONST UINT8              *StoreHash;
+  UINT8                     HashAlg;
+  UINT32                    DigestSize;
+  UINT8                     Digest[HASH_DIGEST_MAX];
+  UINT32                    DstLen;
+  UINT32                    ScrLen;
+  VOID                     *ScrBuf;
+  VOID                     *Dst;
+  RETURN_STATUS             Status;
+
+  if (!IsWarmBootCacheActive ()) {
+    return EFI_NOT_FOUND;
+  }
+
+  CacheHdr = GetWarmBootCacheHdr ();
+  Entry    = FindWarmBootCacheEntry (CacheHdr, ComponentType);
+  if ((Entry == NULL) || (Entry->Length < sizeof (LOADER_COMPRESSED_HEADER)) ||
+      (Entry->Offset < sizeof (WARM_BOOT_CACHE_HDR)) || (Entry->Offset > CacheHdr->FreeOffset) ||
+      (Entry->Length > CacheHdr->FreeOffset - Entry->Offset)) {
+    return EFI_NOT_FOUND;
+  }
+
+  StoreHash = GetWarmBootComponentHash (ComponentType, &HashAlg, &DigestSize);
+  if (StoreHash == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  // Authenticate the cached component, it also rejects images from an older firmware
+  CompressHdr = (LOADER_COMPRESSED_HEADER *)((UINT8 *)CacheHdr + Entry->Offset);
+  Status = CalculateHash ((UINT8 *)CompressHdr, Entry->Length, HashAlg, Digest);
+  if (EFI_ERROR (Status) || (CompareMem (Digest, StoreHash, DigestSize) != 0)) {
+    DEBUG ((DEBUG_INFO, "Warm boot cached image 0x%X is stale or corrupted\n", ComponentType));
+    Entry->ComponentType = COMP_TYPE_INVALID;
+    return EFI_SECURITY_VIOLATION;
+  }
+
+  if (!IS_COMPRESSED (CompressHdr) || (CompressHdr->Size == 0) ||
+      (CompressHdr->CompressedSize > Entry->Length - sizeof (LOADER_COMPRESSED_HEADER))) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = DecompressGetInfo (CompressHdr->Signature, CompressHdr->Data, CompressHdr->CompressedSize,
+                              &DstLen, &ScrLen);
+  if (EFI_ERROR (Status)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  ScrBuf = AllocateTemporaryMemory (ScrLen);
+  if (ScrBuf == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Dst = *Buffer;
+  if (Dst == NULL) {
+    Dst = AllocatePages (EFI_SIZE_TO_PAGES ((UINTN)CompressHdr->Size));
+    if (Dst == NULL) {
+      FreeTemporaryMemory (ScrBuf);
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  // Measure the digest computed from the cached component
+  if (LoadComponentCallback != NULL) {
+    ZeroMem (&CbInfo, sizeof (CbInfo));
+    CbInfo.ComponentType = ComponentType;
+    CbInfo.CompBuf       = (UINT8 *)CompressHdr;
+    CbInfo.CompLen       = Entry->Length;
+    CbInfo.HashAlg       = HashAlg;
+    CbInfo.HashData      = Digest;
+    LoadComponentCallback (PROGESS_ID_AUTHENTICATE, &CbInfo);
+  }
+
+  Status = Decompress (CompressHdr->Signature, CompressHdr->Data, CompressHdr->CompressedSize,
+                       Dst, ScrBuf);
+  FreeTemporaryMemory (ScrBuf);
+  if (EFI_ERROR (Status) && (*Buffer == NULL)) {
+    FreePages (Dst, EFI_SIZE_TO_PAGES ((UINTN)CompressHdr->Size));
+  }
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (LoadComponentCallback != NULL) {
+    LoadComponentCallback (PROGESS_ID_DECOMPRESS, NULL);
+  }
+
+  *Buffer = Dst;
+  *Length = CompressHdr->Size;
+
+  DEBUG ((DEBUG_INFO, "Reused warm boot cached image 0x%X (0x%X bytes)\n", ComponentType, Entry->Length));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Save a verified component into the warm boot cache.
+
+  It is called from the PROGESS_ID_AUTHENTICATE load callback with the signed
+  component that was just authenticated, before it is decompressed.
+
+  @param[in]  ComponentType  Component type, COMP_TYPE_STAGE_2 or a payload type.
+  @param[in]  Image          Signed component starting with its compressed header.
+  @param[in]  Length         Signed component length.
+
+  @retval EFI_SUCCESS            The component was saved or is already cached.
+  @retval EFI_UNSUPPORTED        The cache is disabled or the component has no
+                                 hash store entry.
+  @retval EFI_OUT_OF_RESOURCES   The component does not fit into the cache.
+
+**/
+EFI_STATUS
+EFIAPI
+SaveWarmBootImage (
+  IN  UINT32          ComponentType,
+  IN  CONST VOID     *Image,
+  IN  UINT32          Length
+  )
+{
+  WARM_BOOT_CACHE_HDR    *CacheHdr;
+  WARM_BOOT_CACHE_ENTRY  *Entry;
+  UINT8                   HashAlg;
+  UINT32                  DigestSize;
+  UINT32                  Offset;
+
+  CacheHdr = GetWarmBootCacheHdr ();
+  if ((CacheHdr == NULL) || (Image == NULL) || (Length == 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (GetWarmBootComponentHash (ComponentType, &HashAlg, &DigestSize) == NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  // Component loaded from the cache itself
+  if (((UINTN)Image >= (UINTN)CacheHdr) && ((UINTN)Image < (UINTN)CacheHdr + PcdGet32 (PcdWarmBootCacheSize))) {
+    return EFI_SUCCESS;
+  }
+
+  if (!IsWarmBootCacheHdrValid (CacheHdr)) {
+    ZeroMem (CacheHdr, sizeof (WARM_BOOT_CACHE_HDR));
+    CacheHdr->Signature  = WARM_BOOT_CACHE_SIGNATURE;
+    CacheHdr->RegionBase = (UINT32)(UINTN)CacheHdr;
+    CacheHdr->RegionSize = PcdGet32 (PcdWarmBootCacheSize);
+    CacheHdr->FreeOffset = ALIGN_UP (sizeof (WARM_BOOT_CACHE_HDR), WARM_BOOT_CACHE_ALIGN);
+  }
+
+  // Replace a stale entry in place if the new component still fits there
+  Entry = FindWarmBootCacheEntry (CacheHdr, ComponentType);
+  if ((Entry != NULL) && (ALIGN_UP (Entry->Length, WARM_BOOT_CACHE_ALIGN) >= Length)) {
+    Offset = Entry->Offset;
+  } else {
+    if (Entry != NULL) {
+      Entry->ComponentType = COMP_TYPE_INVALID;
+    }
+    if (((Entry == NULL) && (CacheHdr->EntryCount >= WARM_BOOT_CACHE_ENTRY_MAX)) ||
+        (Length > CacheHdr->RegionSize - CacheHdr->FreeOffset)) {
+      // Start over, components still needed are saved again on this boot
+      CacheHdr->EntryCount = 0;
+      CacheHdr->FreeOffset = ALIGN_UP (sizeof (WARM_BOOT_CACHE_HDR), WARM_BOOT_CACHE_ALIGN);
+      if (Length > CacheHdr->RegionSize - CacheHdr->FreeOffset) {
+        DEBUG ((DEBUG_INFO, "Warm boot cache too small for image 0x%X (0x%X bytes)\n", ComponentType, Length));
+        return EFI_OUT_OF_RESOURCES;
+      }
+      Entry = NULL;
+    }
+    if (Entry == NULL) {
+      Entry = &CacheHdr->Entry[CacheHdr->EntryCount++];
+    }
+    Offset = CacheHdr->FreeOffset;
+    CacheHdr->FreeOffset += ALIGN_UP (Length, WARM_BOOT_CACHE_ALIGN);
+  }
+
+  // Invalidate the entry while it is updated
+  Entry->ComponentType = COMP_TYPE_INVALID;
+  Entry->Offset        = Offset;
+  Entry->Length        = Length;
+  CopyMem ((UINT8 *)CacheHdr + Offset, Image, Length);
+  Entry->ComponentType = ComponentType;
+
+  return EFI_SUCCESS;
+}
@@ -33,6 +33,9 @@ LoadComponentCallback (
       // Extend the stage hash
       ExtendStageHash (CbInfo);
     }
+    if (CbInfo != NULL) {
+      SaveWarmBootImage (CbInfo->ComponentType, CbInfo->CompBuf, CbInfo->CompLen);
+    }
     AddMeasurePoint (0x20A0);
     break;
   case PROGESS_ID_DECOMPRESS:
@@ -77,11 +80,14 @@ PrepareStage2 (
   }
 
   AddMeasurePoint (0x2080);
-  Status = LoadComponentWithCallback (COMP_TYPE_STAGE_2, FLASH_MAP_SIG_STAGE2,
-                                     &DstAdr, &DstLen, LoadComponentCallback);
+  Status = LoadWarmBootImage (COMP_TYPE_STAGE_2, &DstAdr, &DstLen, LoadComponentCallback);
   if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Loading Stage2 error - %r !", Status));
-    return 0;
+    Status = LoadComponentWithCallback (COMP_TYPE_STAGE_2, FLASH_MAP_SIG_STAGE2,
+                                       &DstAdr, &DstLen, LoadComponentCallback);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Loading Stage2 error - %r !", Status));
+      return 0;
+    }
   }
   AddMeasurePoint (0x20C0);
 
@@ -460,10 +466,13 @@ SecStartup2 (
   LdrGlobal->MemPoolCurrTop    = MemPoolCurrTop;
   LdrGlobal->MemPoolCurrBottom = MemPoolStart;
   LdrGlobal->MemPoolMaxUsed    = 0;
+  LdrGlobal->MemPoolFreeList   = 0;
+  ZeroMem (&LdrGlobal->MemPoolProfile, sizeof (MEM_POOL_PROFILE));
 
   if (FeaturePcdGet (PcdDmaProtectionEnabled)) {
     DmaBuffer = MemPoolStart - (PcdGet32 (PcdLoaderAcpiNvsSize) + PcdGet32 (PcdLoaderAcpiReclaimSize)
-                + PcdGet32 (PcdPayloadReservedMemSize) + PcdGet32 (PcdDmaBufferSize));
+                + PcdGet32 (PcdWarmBootCacheSize) + PcdGet32 (PcdPayloadReservedMemSize)
+                + PcdGet32 (PcdDmaBufferSize));
     DmaBuffer = ALIGN_DOWN (DmaBuffer, PcdGet32 (PcdDmaBufferAlignment));
   } else {
     DmaBuffer = 0;
@@ -680,6 +689,21 @@ ContinueFunc (
            (OldLdrGlobal->MemPoolCurrBottom - OldLdrGlobal->MemPoolStart),
            OldLdrGlobal->MemPoolMaxUsed
            ));
+  if (FeaturePcdGet (PcdMemPoolProfileEnabled)) {
+    DEBUG ((
+             DEBUG_INFO,
+             "MEMPOOL PROFILE: Stage=1 BootMode=0x%02X Region=0x%X Pool=0x%X Perm=0x%X@0x%08X Temp=0x%X@0x%08X Peak=0x%X@0x%08X\n",
+             GetBootMode (),
+             PcdGet32 (PcdStage1DataSize),
+             OldLdrGlobal->MemPoolEnd - OldLdrGlobal->MemPoolStart,
+             OldLdrGlobal->MemPoolProfile.PermMaxUsed,
+             OldLdrGlobal->MemPoolProfile.PermCaller,
+             OldLdrGlobal->MemPoolProfile.TempMaxUsed,
+             OldLdrGlobal->MemPoolProfile.TempCaller,
+             OldLdrGlobal->MemPoolMaxUsed,
+             OldLdrGlobal->MemPoolProfile.MaxUsedCaller
+             ));
+  }
   DEBUG_CODE_END ();
 
   AddMeasurePoint (0x2050);
@@ -43,6 +43,7 @@
 #include <Guid/LoaderPlatformDataGuid.h>
 #include <Library/TopSwapLib.h>
 #include <Library/FirmwareResiliencyLib.h>
+#include <Library/WarmBootCacheLib.h>
 #include <FirmwareUpdateStatus.h>
 #include <VerInfo.h>
 
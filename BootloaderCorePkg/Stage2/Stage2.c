@@ -37,6 +37,9 @@ LoadComponentCallback (
       // Extend the stage hash
       ExtendStageHash (CbInfo);
     }
+    if (CbInfo != NULL) {
+      SaveWarmBootImage (CbInfo->ComponentType, CbInfo->CompBuf, CbInfo->CompLen);
+    }
     AddMeasurePoint (0x3130);
     break;
   case PROGESS_ID_DECOMPRESS:
@@ -49,29 +52,45 @@ LoadComponentCallback (
 
 }
 
-/**
-  Prepare and load payload into proper location for execution.
+typedef enum {
+  EnumPrefetchIdle = 0,
+  EnumPrefetchPrepared,
+  EnumPrefetchRunning,
+  EnumPrefetchDone
+} PAYLOAD_PREFETCH_STATE;
+
+typedef struct {
+  COMPONENT_LOAD_CONTEXT          LoadCtx;
+  UINT32                          ContainerSig;
+  UINT32                          ComponentName;
+  UINT32                          Dst;
+  UINT32                          CpuIndex;
+  UINT64                          StartTsc;
+  UINT64                          EndTsc;
+  EFI_STATUS                      Status;
+  volatile UINT32                 State;
+} PAYLOAD_PREFETCH;
 
-  @param[in]  Stage2Param    Param pointer for Stage2
+STATIC PAYLOAD_PREFETCH  mPayloadPrefetch;
 
-  @retval     The base address of the payload.
-              0 if loading fails.
+/**
+  Get the payload component to load for current boot.
+
+  @param[out] ContainerSig     Pointer to receive container signature or component type.
+  @param[out] ComponentName    Pointer to receive component name.
+  @param[out] Dst              Pointer to receive payload load address, 0 to allocate.
 
 **/
-UINT32
-PreparePayload (
-  IN STAGE2_PARAM   *Stage2Param
+STATIC
+VOID
+GetPayloadComponent (
+  OUT UINT32        *ContainerSig,
+  OUT UINT32        *ComponentName,
+  OUT UINT32        *Dst
   )
 {
-  EFI_STATUS                     Status;
-  UINT32                         Dst;
-  UINT32                         DstLen;
-  VOID                          *DstAdr;
   UINT32                         PayloadId;
-  UINT32                         ContainerSig;
-  UINT32                         ComponentName;
   UINT8                          BootMode;
-  UINT64                         SignatureBuf;
 
   BootMode = GetBootMode();
   //
@@ -83,33 +102,222 @@ PreparePayload (
   // Load payload to PcdPayloadLoadBase.
   PayloadId   = GetPayloadId ();
   if (BootMode == BOOT_ON_FLASH_UPDATE) {
-    ContainerSig  = COMP_TYPE_PAYLOAD_FWU;
-    ComponentName = FLASH_MAP_SIG_FWUPDATE;
+    *ContainerSig  = COMP_TYPE_PAYLOAD_FWU;
+    *ComponentName = FLASH_MAP_SIG_FWUPDATE;
   } else {
     if (PayloadId == 0) {
-      ContainerSig  = COMP_TYPE_PAYLOAD;
-      ComponentName = FLASH_MAP_SIG_PAYLOAD;
+      *ContainerSig  = COMP_TYPE_PAYLOAD;
+      *ComponentName = FLASH_MAP_SIG_PAYLOAD;
     } else {
-      ContainerSig  = FLASH_MAP_SIG_EPAYLOAD;
-      ComponentName = PayloadId;
+      *ContainerSig  = FLASH_MAP_SIG_EPAYLOAD;
+      *ComponentName = PayloadId;
     }
   }
-  SignatureBuf = ComponentName;
-  DEBUG ((DEBUG_INFO, "Loading Payload ID %4a\n", (CHAR8 *)&SignatureBuf));
 
-  Dst = PcdGet32 (PcdPayloadExeBase);
+  *Dst = PcdGet32 (PcdPayloadExeBase);
   if (FixedPcdGetBool (PcdPayloadLoadHigh)) {
-    PayloadId = GetPayloadId();
     if ((PayloadId != LINX_PAYLOAD_ID_SIGNATURE) && (PayloadId != UEFI_PAYLOAD_ID_SIGNATURE)) {
-      Dst = 0;
+      *Dst = 0;
+    }
+  }
+}
+
+/**
+  AP task to copy, verify and decompress the payload in background.
+
+  @param[in] Argument          Pointer to PAYLOAD_PREFETCH.
+
+  @retval    Payload load status.
+
+**/
+STATIC
+UINT64
+EFIAPI
+PayloadPrefetchTask (
+  IN UINT64          Argument
+  )
+{
+  PAYLOAD_PREFETCH  *Prefetch;
+
+  Prefetch = (PAYLOAD_PREFETCH *)(UINTN)Argument;
+  Prefetch->StartTsc = ReadTimeStamp ();
+  Prefetch->Status   = ExecuteComponentLoad (&Prefetch->LoadCtx, NULL);
+  Prefetch->EndTsc   = ReadTimeStamp ();
+  MemoryFence ();
+  Prefetch->State    = EnumPrefetchDone;
+
+  return (UINT64)Prefetch->Status;
+}
+
+/**
+  Start loading the payload on an AP while the BSP continues Stage2 init.
+
+  All memory for the payload load is reserved on the BSP here. Only payloads
+  authenticated by hash are loaded in background, since RSA verification
+  needs temporary memory. PreparePayload () joins on the result.
+
+**/
+STATIC
+VOID
+StartPayloadPrefetch (
+  VOID
+  )
+{
+  PAYLOAD_PREFETCH              *Prefetch;
+  SYS_CPU_TASK                  *SysCpuTask;
+  EFI_STATUS                     Status;
+  UINT32                         Index;
+
+  SysCpuTask = MpGetTask ();
+  if (!FixedPcdGetBool (PcdSmpEnabled) || (SysCpuTask->CpuCount < 2)) {
+    return;
+  }
+
+  Prefetch = &mPayloadPrefetch;
+  GetPayloadComponent (&Prefetch->ContainerSig, &Prefetch->ComponentName, &Prefetch->Dst);
+  if ((Prefetch->ContainerSig < COMP_TYPE_INVALID) && IsWarmBootCacheActive ()) {
+    // Payload will be reused from the warm boot cache
+    return;
+  }
+  Status = PrepareComponentLoad (Prefetch->ContainerSig, Prefetch->ComponentName,
+                                 (VOID *)(UINTN)Prefetch->Dst, 0, &Prefetch->LoadCtx);
+  if (EFI_ERROR (Status)) {
+    // Report the error from the regular load path
+    return;
+  }
+  Prefetch->State = EnumPrefetchPrepared;
+
+  if ((Prefetch->LoadCtx.AuthType != AUTH_TYPE_NONE) && (Prefetch->LoadCtx.AuthType != AUTH_TYPE_SHA2_256) &&
+      (Prefetch->LoadCtx.AuthType != AUTH_TYPE_SHA2_384)) {
+    return;
+  }
+
+  for (Index = 1; Index < SysCpuTask->CpuCount; Index++) {
+    Prefetch->State = EnumPrefetchRunning;
+    if (!EFI_ERROR (MpRunTask (Index, PayloadPrefetchTask, (UINT64)(UINTN)Prefetch))) {
+      Prefetch->CpuIndex = Index;
+      DEBUG ((DEBUG_INFO, "Payload prefetch started on CPU %d\n", Index));
+      return;
+    }
+    Prefetch->State = EnumPrefetchPrepared;
+  }
+}
+
+/**
+  Join on the payload prefetch started by StartPayloadPrefetch ().
+
+  @param[in]  ContainerSig     Container signature or component type to load.
+  @param[in]  ComponentName    Component name to load.
+  @param[in]  Dst              Payload load address, 0 to allocate.
+  @param[out] DstAdr           Pointer to receive the payload base.
+  @param[out] DstLen           Pointer to receive the payload size.
+
+  @retval     EFI_NOT_STARTED  No prefetch matches the payload to load.
+  @retval     Others           Payload load status.
+
+**/
+STATIC
+EFI_STATUS
+JoinPayloadPrefetch (
+  IN  UINT32         ContainerSig,
+  IN  UINT32         ComponentName,
+  IN  UINT32         Dst,
+  OUT VOID         **DstAdr,
+  OUT UINT32        *DstLen
+  )
+{
+  PAYLOAD_PREFETCH              *Prefetch;
+  EFI_STATUS                     Status;
+
+  Prefetch = &mPayloadPrefetch;
+  if (Prefetch->State == EnumPrefetchIdle) {
+    return EFI_NOT_STARTED;
+  }
+
+  while (Prefetch->State == EnumPrefetchRunning) {
+    CpuPause ();
+  }
+
+  // FinishComponentLoad () rolls the temporary memory back to the prefetch
+  // scratch buffer, so no temporary memory may be in use above it.
+  ASSERT (GetLoaderGlobalDataPointer ()->MemPoolCurrBottom ==
+          (UINT32)(UINTN)Prefetch->LoadCtx.AllocBuf + Prefetch->LoadCtx.AllocLen);
+
+  if ((Prefetch->ContainerSig != ContainerSig) || (Prefetch->ComponentName != ComponentName) ||
+      (Prefetch->Dst != Dst)) {
+    // Payload selection changed after the prefetch was started
+    FinishComponentLoad (&Prefetch->LoadCtx, EFI_ABORTED, NULL, NULL);
+    Prefetch->State = EnumPrefetchIdle;
+    return EFI_NOT_STARTED;
+  }
+
+  LoadComponentCallback (PROGESS_ID_LOCATE, NULL);
+  if (Prefetch->State == EnumPrefetchDone) {
+    DEBUG ((DEBUG_INFO, "Payload prefetched on CPU %d in %ld us\n", Prefetch->CpuIndex,
+            TimeStampTickToMicroSecond (Prefetch->EndTsc - Prefetch->StartTsc)));
+    // Replay the load progress on the BSP for performance data and measured boot
+    if (Prefetch->LoadCtx.IsInFlash) {
+      LoadComponentCallback (PROGESS_ID_COPY, NULL);
+    }
+    LoadComponentCallback (PROGESS_ID_AUTHENTICATE,
+                           (Prefetch->LoadCtx.AuthStatus == EFI_SUCCESS) ? &Prefetch->LoadCtx.CbInfo : NULL);
+    if ((Prefetch->LoadCtx.AuthStatus == EFI_SUCCESS) && (Prefetch->LoadCtx.CompBase != NULL)) {
+      LoadComponentCallback (PROGESS_ID_DECOMPRESS, NULL);
     }
+    Status = Prefetch->Status;
+  } else {
+    Status = ExecuteComponentLoad (&Prefetch->LoadCtx, LoadComponentCallback);
   }
 
+  Status = FinishComponentLoad (&Prefetch->LoadCtx, Status, DstAdr, DstLen);
+  Prefetch->State = EnumPrefetchIdle;
+
+  return Status;
+}
+
+/**
+  Prepare and load payload into proper location for execution.
+
+  @param[in]  Stage2Param    Param pointer for Stage2
+
+  @retval     The base address of the payload.
+              0 if loading fails.
+
+**/
+UINT32
+PreparePayload (
+  IN STAGE2_PARAM   *Stage2Param
+  )
+{
+  EFI_STATUS                     Status;
+  UINT32                         Dst;
+  UINT32                         DstLen;
+  VOID                          *DstAdr;
+  UINT32                         PayloadId;
+  UINT32                         ContainerSig;
+  UINT32                         ComponentName;
+  UINT64                         SignatureBuf;
+
+  GetPayloadComponent (&ContainerSig, &ComponentName, &Dst);
+  PayloadId    = GetPayloadId ();
+  SignatureBuf = ComponentName;
+  DEBUG ((DEBUG_INFO, "Loading Payload ID %4a\n", (CHAR8 *)&SignatureBuf));
+
   AddMeasurePoint (0x3100);
   DstLen = 0;
   DstAdr = (VOID *)(UINTN)Dst;
-  Status = LoadComponentWithCallback (ContainerSig, ComponentName,
-                                      &DstAdr, &DstLen, LoadComponentCallback);
+  Status = EFI_NOT_FOUND;
+  if (ContainerSig < COMP_TYPE_INVALID) {
+    Status = LoadWarmBootImage (ContainerSig, &DstAdr, &DstLen, LoadComponentCallback);
+  }
+  if (EFI_ERROR (Status)) {
+    DstAdr = (VOID *)(UINTN)Dst;
+    Status = JoinPayloadPrefetch (ContainerSig, ComponentName, Dst, &DstAdr, &DstLen);
+    if (Status == EFI_NOT_STARTED) {
+      Status = LoadComponentWithCallback (ContainerSig, ComponentName,
+                                          &DstAdr, &DstLen, LoadComponentCallback);
+    }
+  }
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Loading payload error - %r !", Status));
     return 0;
@@ -373,6 +581,250 @@ S3ResumePath (
   FindAcpiWakeVectorAndJump (S3Data->AcpiBase);
 }
 
+typedef enum {
+  Stage2PhaseSmbiosInit,
+  Stage2PhasePrePciEnumeration,
+  Stage2PhasePciEnumeration,
+  Stage2PhasePostPciEnumeration,
+  Stage2PhasePostPciNotify,
+  Stage2PhasePostPciSplash,
+  Stage2PhaseAcpiInit,
+  Stage2PhaseMax
+} STAGE2_PHASE_INDEX;
+
+STATIC BOOLEAN       mSplashPostPci;
+STATIC EFI_STATUS    mPciEnumStatus;
+
+/**
+  Stage2 phase: build SMBIOS tables.
+
+  The table memory is allocated on the BSP before the phase graph runs so that
+  this phase is free of shared allocator state and can run on an AP.
+
+  @param[in] Stage2Param       STAGE2 Param pointer.
+
+  @retval    EFI_UNSUPPORTED   SMBIOS is not enabled.
+  @retval    Others            SMBIOS init status.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+Stage2SmbiosInit (
+  IN STAGE2_PARAM   *Stage2Param
+  )
+{
+  if (!FixedPcdGetBool (PcdSmbiosEnabled)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  return SmbiosInit ();
+}
+
+/**
+  Stage2 phase: board PrePciEnumeration hook.
+
+  @param[in] Stage2Param       STAGE2 Param pointer.
+
+  @retval    EFI_SUCCESS       The hook has been called.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+Stage2PrePciEnumeration (
+  IN STAGE2_PARAM   *Stage2Param
+  )
+{
+  BoardInit (PrePciEnumeration);
+  return EFI_SUCCESS;
+}
+
+/**
+  Stage2 phase: PCI enumeration.
+
+  @param[in] Stage2Param       STAGE2 Param pointer.
+
+  @retval    EFI_UNSUPPORTED   PCI enumeration is not enabled.
+  @retval    Others            PCI enumeration status.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+Stage2PciEnumeration (
+  IN STAGE2_PARAM   *Stage2Param
+  )
+{
+  VOID                           *MemPool;
+
+  if (!FixedPcdGetBool (PcdPciEnumEnabled)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  MemPool = AllocateTemporaryMemory (0);
+  DEBUG ((DEBUG_INIT, "PCI Enum\n"));
+  mPciEnumStatus = PciEnumeration (MemPool);
+  return mPciEnumStatus;
+}
+
+/**
+  Stage2 phase: board PostPciEnumeration hook.
+
+  @param[in] Stage2Param       STAGE2 Param pointer.
+
+  @retval    EFI_UNSUPPORTED   PCI enumeration is not enabled.
+  @retval    EFI_SUCCESS       The hook has been called.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+Stage2PostPciEnumeration (
+  IN STAGE2_PARAM   *Stage2Param
+  )
+{
+  if (!FixedPcdGetBool (PcdPciEnumEnabled)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  UpdateGraphicsHob ();
+  BoardInit (PostPciEnumeration);
+  return EFI_SUCCESS;
+}
+
+/**
+  Stage2 phase: FSP PostPciEnumeration notification.
+
+  @param[in] Stage2Param       STAGE2 Param pointer.
+
+  @retval    EFI_UNSUPPORTED   The notification is not required.
+  @retval    EFI_SUCCESS       The notification has been sent.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+Stage2PostPciNotify (
+  IN STAGE2_PARAM   *Stage2Param
+  )
+{
+  EFI_STATUS                      Status;
+
+  if (!FixedPcdGetBool (PcdPciEnumEnabled)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = EFI_UNSUPPORTED;
+  if (!EFI_ERROR (mPciEnumStatus)) {
+    if (GetBootMode () != BOOT_ON_FLASH_UPDATE) {
+      BoardNotifyPhase (PostPciEnumeration);
+      Status = EFI_SUCCESS;
+    }
+  }
+  ASSERT_EFI_ERROR (mPciEnumStatus);
+
+  return Status;
+}
+
+/**
+  Stage2 phase: display splash if the frame buffer was only available after PCI
+  enumeration.
+
+  @param[in] Stage2Param       STAGE2 Param pointer.
+
+  @retval    EFI_UNSUPPORTED   Splash has already been displayed or is disabled.
+  @retval    Others            Splash display status.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+Stage2PostPciSplash (
+  IN STAGE2_PARAM   *Stage2Param
+  )
+{
+  if (!FixedPcdGetBool (PcdPciEnumEnabled) || !FixedPcdGetBool (PcdSplashEnabled) || !mSplashPostPci) {
+    return EFI_UNSUPPORTED;
+  }
+
+  return DisplaySplash ();
+}
+
+/**
+  Stage2 phase: ACPI initialization.
+
+  @param[in] Stage2Param       STAGE2 Param pointer.
+
+  @retval    EFI_UNSUPPORTED   ACPI is not enabled.
+  @retval    EFI_SUCCESS       ACPI tables are ready.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+Stage2AcpiInit (
+  IN STAGE2_PARAM   *Stage2Param
+  )
+{
+  EFI_STATUS                      Status;
+  UINT32                          AcpiGnvs;
+  UINT32                          AcpiBase;
+  LOADER_GLOBAL_DATA             *LdrGlobal;
+  S3_DATA                        *S3Data;
+
+  if (!ACPI_ENABLED ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  LdrGlobal = (LOADER_GLOBAL_DATA *)GetLoaderGlobalDataPointer();
+  AcpiGnvs = 0;
+  AcpiBase = 0;
+  Status   = (PcdGet32 (PcdLoaderAcpiNvsSize) < GetAcpiGnvsSize ()) ? EFI_OUT_OF_RESOURCES : EFI_SUCCESS;
+  if (!EFI_ERROR (Status)) {
+    AcpiGnvs = LdrGlobal->MemPoolStart - PcdGet32 (PcdLoaderAcpiNvsSize);
+    AcpiBase = AcpiGnvs - PcdGet32 (PcdLoaderAcpiReclaimSize);
+    Status   = PcdSet32S (PcdAcpiGnvsAddress, AcpiGnvs);
+
+    S3Data = (S3_DATA *)LdrGlobal->S3DataPtr;
+    if (GetBootMode () != BOOT_ON_S3_RESUME) {
+      PlatformUpdateAcpiGnvs ((VOID *)(UINTN)AcpiGnvs);
+      S3Data->AcpiGnvs = AcpiGnvs;
+      S3Data->AcpiBase = AcpiBase;
+      DEBUG ((DEBUG_INIT, "ACPI Init\n"));
+      Status = AcpiInit (&AcpiBase);
+      DEBUG ((DEBUG_INFO, "ACPI Ret: %r\n", Status));
+      S3Data->AcpiTop = AcpiBase;
+      if (!EFI_ERROR (Status) && ((S3Data->AcpiTop - S3Data->AcpiBase) >
+           PcdGet32 (PcdLoaderAcpiReclaimSize))) {
+        Status = EFI_OUT_OF_RESOURCES;
+      }
+    } else {
+      Status = (S3Data->AcpiGnvs == AcpiGnvs) ? EFI_SUCCESS : EFI_ABORTED;
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    CpuHaltWithStatus ("ACPI error !", Status);
+  }
+
+  return EFI_SUCCESS;
+}
+
+//
+// Stage2 initialization phases between MP init and payload loading.
+// SMBIOS has no data dependency on PCI enumeration or ACPI and runs on an AP.
+//
+STATIC CONST STAGE2_PHASE  mStage2PhaseTable[Stage2PhaseMax] = {
+  { "SMBIOS",    0x3070, STAGE2_PHASE_FLAG_AP, 0,                                    Stage2SmbiosInit         },
+  { "PrePci",    0x3090, 0,                    0,                                    Stage2PrePciEnumeration  },
+  { "PciEnum",   0x30A0, 0,                    (1 << Stage2PhasePrePciEnumeration),  Stage2PciEnumeration     },
+  { "PostPci",   0x30B0, 0,                    (1 << Stage2PhasePciEnumeration),     Stage2PostPciEnumeration },
+  { "PciNotify", 0x30C0, 0,                    (1 << Stage2PhasePostPciEnumeration), Stage2PostPciNotify      },
+  { "Splash",    0,      0,                    (1 << Stage2PhasePostPciNotify),      Stage2PostPciSplash      },
+  { "ACPI",      0x30D0, 0,                    (1 << Stage2PhasePostPciNotify),      Stage2AcpiInit           },
+};
+
 /**
   Entry point to the C language phase of Stage2.
 
@@ -393,13 +845,9 @@ SecStartup (
   STAGE2_PARAM                   *Stage2Param;
   VOID                           *NvsData;
   UINT32                          MrcDataLen;
-  VOID                           *MemPool;
   UINT32                          Delta;
-  UINT32                          AcpiGnvs;
-  UINT32                          AcpiBase;
   LOADER_GLOBAL_DATA             *LdrGlobal;
   UINT8                           BootMode;
-  S3_DATA                        *S3Data;
   PLATFORM_SERVICE               *PlatformService;
   VOID                           *SmbiosEntry;
   BOOLEAN                         SplashPostPci;
@@ -420,8 +868,8 @@ SecStartup (
   FreeTemporaryMemory (NULL);
 
   if (IS_X64) {
-    // Build full physical space 1:1 mapping page table
-    CreateIdentityMappingPageTables (0);
+    CreateStage2PageTables (LdrGlobal->FspHobList);
+    AddMeasurePoint (0x3008);
   }
 
   // Init all services
@@ -513,78 +961,23 @@ SecStartup (
   ASSERT_EFI_ERROR (Status);
 
   //
-  // Allocate SMBIOS tables' memory, set Base and call Smbios init
+  // Allocate SMBIOS tables' memory and set Base, tables are built in the phase graph
   //
   if (FixedPcdGetBool (PcdSmbiosEnabled)) {
     SmbiosEntry = AllocateZeroPool (PcdGet16(PcdSmbiosTablesSize));
     Status = PcdSet32S (PcdSmbiosTablesBase, (UINT32)(UINTN)SmbiosEntry);
-    Status = SmbiosInit ();
-    if (EFI_ERROR(Status)) {
-      DEBUG ((DEBUG_INFO, "SMBIOS init Status = %r\n", Status));
-    }
   }
 
-  // PCI Enumeration
-  BoardInit (PrePciEnumeration);
-  AddMeasurePoint (0x3090);
-
-  if (FixedPcdGetBool (PcdPciEnumEnabled)) {
-    MemPool = AllocateTemporaryMemory (0);
-    DEBUG ((DEBUG_INIT, "PCI Enum\n"));
-    Status = PciEnumeration (MemPool);
-    AddMeasurePoint (0x30A0);
-    UpdateGraphicsHob ();
-    BoardInit (PostPciEnumeration);
-    AddMeasurePoint (0x30B0);
-
-    if (!EFI_ERROR (Status)) {
-      if (BootMode != BOOT_ON_FLASH_UPDATE) {
-        BoardNotifyPhase (PostPciEnumeration);
-        AddMeasurePoint (0x30C0);
-      }
-    }
-    ASSERT_EFI_ERROR (Status);
-
-    if (FixedPcdGetBool (PcdSplashEnabled)) {
-      if (SplashPostPci) {
-        DisplaySplash ();
-      }
-    }
+  // Load payload in background while the BSP continues
+  if (BootMode != BOOT_ON_S3_RESUME) {
+    StartPayloadPrefetch ();
   }
 
-  // ACPI Initialization
-  if (ACPI_ENABLED ()) {
-    AcpiGnvs = 0;
-    AcpiBase = 0;
-    Status   = (PcdGet32 (PcdLoaderAcpiNvsSize) < GetAcpiGnvsSize ()) ? EFI_OUT_OF_RESOURCES : EFI_SUCCESS;
-    if (!EFI_ERROR (Status)) {
-      AcpiGnvs = LdrGlobal->MemPoolStart - PcdGet32 (PcdLoaderAcpiNvsSize);
-      AcpiBase = AcpiGnvs - PcdGet32 (PcdLoaderAcpiReclaimSize);
-      Status   = PcdSet32S (PcdAcpiGnvsAddress, AcpiGnvs);
-
-      S3Data = (S3_DATA *)LdrGlobal->S3DataPtr;
-      if (BootMode != BOOT_ON_S3_RESUME) {
-        PlatformUpdateAcpiGnvs ((VOID *)(UINTN)AcpiGnvs);
-        S3Data->AcpiGnvs = AcpiGnvs;
-        S3Data->AcpiBase = AcpiBase;
-        DEBUG ((DEBUG_INIT, "ACPI Init\n"));
-        Status = AcpiInit (&AcpiBase);
-        DEBUG ((DEBUG_INFO, "ACPI Ret: %r\n", Status));
-        S3Data->AcpiTop = AcpiBase;
-        if (!EFI_ERROR (Status) && ((S3Data->AcpiTop - S3Data->AcpiBase) >
-             PcdGet32 (PcdLoaderAcpiReclaimSize))) {
-          Status = EFI_OUT_OF_RESOURCES;
-        }
-      } else {
-        Status = (S3Data->AcpiGnvs == AcpiGnvs) ? EFI_SUCCESS : EFI_ABORTED;
-      }
-    }
-
-    AddMeasurePoint (0x30D0);
-    if (EFI_ERROR (Status)) {
-      CpuHaltWithStatus ("ACPI error !", Status);
-    }
-  }
+  // SMBIOS, PCI enumeration and ACPI initialization
+  mSplashPostPci = SplashPostPci;
+  mPciEnumStatus = EFI_SUCCESS;
+  Status = RunStage2Phases (mStage2PhaseTable, ARRAY_SIZE (mStage2PhaseTable), Stage2Param);
+  ASSERT_EFI_ERROR (Status);
 
   PlatformService = (PLATFORM_SERVICE *) GetServiceBySignature (PLATFORM_SERVICE_SIGNATURE);
   if (PlatformService != NULL) {
@@ -11,7 +11,7 @@
 #include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/PcdLib.h>
-#include <Library/HobLib.h>
+#include <Library/BlHobLib.h>
 #include <Library/BootloaderCoreLib.h>
 #include <Library/BootloaderCommonLib.h>
 #include <Library/DecompressLib.h>
@@ -43,6 +43,7 @@
 #include <Library/ContainerLib.h>
 #include <Library/TcoTimerLib.h>
 #include <Library/WatchDogTimerLib.h>
+#include <Library/TimeStampLib.h>
 #include <Guid/BootLoaderServiceGuid.h>
 #include <Guid/BootLoaderVersionGuid.h>
 #include <Guid/LoaderPlatformInfoGuid.h>
@@ -67,6 +68,7 @@
 #include <Library/ElfLib.h>
 #include <Library/SmbiosInitLib.h>
 #include <Library/UniversalPayloadLib.h>
+#include <Library/WarmBootCacheLib.h>
 #include <VerInfo.h>
 #include <Guid/SmramMemoryReserve.h>
 #include <Guid/SmmRegisterInfoGuid.h>
@@ -77,6 +79,44 @@
 
 #define UIMAGE_FIT_MAGIC               (0x56190527)
 
+#define STAGE2_PHASE_MAX               32
+
+// Resource ranges above 4GB mapped up front with lazy page tables
+#define STAGE2_PAGE_MAP_RANGE_MAX      16
+
+//
+// The phase has no side effect on shared loader state (no memory allocation,
+// no HOB building) and can be executed on an AP. AP stacks are only 4KB
+// (AP_STACK_SIZE in MpInitLib) and have no guard page, so the phase including
+// its DEBUG output must not use large local buffers.
+//
+#define STAGE2_PHASE_FLAG_AP           BIT0
+
+/**
+  Stage2 initialization phase function.
+
+  @param[in] Stage2Param       STAGE2 Param pointer.
+
+  @retval    EFI_UNSUPPORTED   The phase is not applicable and was skipped.
+  @retval    Others            The phase was executed.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *STAGE2_PHASE_FUNC) (
+  IN STAGE2_PARAM                *Stage2Param
+  );
+
+typedef struct {
+  CHAR8                          *Name;
+  // Measure point Id recorded when the phase completes, 0 for none
+  UINT16                          PerfId;
+  UINT16                          Flags;
+  // Bit mask of the phase indexes that must complete before this phase
+  UINT32                          DependMask;
+  STAGE2_PHASE_FUNC               Func;
+} STAGE2_PHASE;
+
 /**
   Build some basic HOBs
 
@@ -150,6 +190,18 @@ PrintStackHeapInfo (
   VOID
   );
 
+/**
+  Build the X64 1:1 mapping page tables for Stage2.
+
+  @param[in] FspHobList     FSP HOB list pointer.
+
+**/
+VOID
+EFIAPI
+CreateStage2PageTables (
+  IN VOID                        *FspHobList
+  );
+
 /**
   Initialize services so that payload can consume.
 
@@ -181,4 +233,28 @@ UpdateGraphicsHob (
   VOID
   );
 
+/**
+  Execute a graph of Stage2 initialization phases.
+
+  A phase starts once all phases in its DependMask have completed. Phases
+  flagged with STAGE2_PHASE_FLAG_AP are dispatched to idle APs when MP init
+  has reached the run phase, all other phases run on the BSP in table order.
+  The critical path through the graph is marked in the performance data.
+
+  @param[in] PhaseTable        Phase table.
+  @param[in] PhaseCount        Number of phases in the table.
+  @param[in] Stage2Param       STAGE2 Param pointer.
+
+  @retval    EFI_SUCCESS       All phases have been executed.
+  @retval    EFI_INVALID_PARAMETER  The phase table is invalid.
+  @retval    EFI_ABORTED       The phase dependencies cannot be satisfied.
+
+**/
+EFI_STATUS
+RunStage2Phases (
+  IN CONST STAGE2_PHASE          *PhaseTable,
+  IN UINT32                       PhaseCount,
+  IN STAGE2_PARAM                *Stage2Param
+  );
+
 #endif
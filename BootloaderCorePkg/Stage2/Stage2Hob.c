@@ -106,7 +106,7 @@ SplitMemroyMap (
       //
       // Add bootloader and payload reserved memory map entry
       //
-      for (Loop = 0; (Loop < 4) && (NewIdx < PcdGet32 (PcdMemoryMapEntryNumber)); Loop++) {
+      for (Loop = 0; (Loop < 5) && (NewIdx < PcdGet32 (PcdMemoryMapEntryNumber)); Loop++) {
         Flag   = 0;
         Type   = MEM_MAP_TYPE_RESERVED;
         switch (Loop) {
@@ -125,6 +125,10 @@ SplitMemroyMap (
           Type   = MEM_MAP_TYPE_ACPI_RECLAIM;
           break;
         case 3:
+          // Warm boot image cache
+          Adjust = PcdGet32 (PcdWarmBootCacheSize);
+          break;
+        case 4:
           // Payload reserved memory
           Adjust = PcdGet32 (PcdPayloadReservedMemSize);
           Flag   = MEM_MAP_FLAG_PAYLOAD;
@@ -294,6 +298,9 @@ BuildBaseInfoHob (
 
   LdrGlobal = (LOADER_GLOBAL_DATA *)GetLoaderGlobalDataPointer();
 
+  // FSP HOB list is complete now, index it for the GUID HOB lookups to come
+  BuildGuidHobIndex (LdrGlobal->FspHobList);
+
   // Build Loader FSP info hob
   LoaderFspInfo = BuildGuidHob (&gLoaderFspInfoGuid, sizeof (LOADER_FSP_INFO));
   if (LoaderFspInfo != NULL) {
@@ -0,0 +1,300 @@
+/** @file
+  Stage2 initialization phase graph executor.
+
+  Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Stage2.h"
+
+typedef enum {
+  EnumPhasePending = 0,
+  EnumPhaseRunning,
+  EnumPhaseDone
+} STAGE2_PHASE_STATE;
+
+typedef struct {
+  CONST STAGE2_PHASE             *Phase;
+  STAGE2_PARAM                   *Stage2Param;
+  UINT64                          StartTsc;
+  UINT64                          EndTsc;
+  EFI_STATUS                      Status;
+  UINT32                          CpuIndex;
+  UINT32                          PerfIndex;
+  volatile UINT32                 State;
+} STAGE2_PHASE_RUN;
+
+/**
+  Execute a single phase and record its timing.
+
+  @param[in] Run               Phase run state.
+
+**/
+STATIC
+VOID
+ExecuteStage2Phase (
+  IN STAGE2_PHASE_RUN            *Run
+  )
+{
+  Run->StartTsc = ReadTimeStamp ();
+  Run->Status   = Run->Phase->Func (Run->Stage2Param);
+  Run->EndTsc   = ReadTimeStamp ();
+}
+
+/**
+  AP task entry to execute a phase.
+
+  @param[in] Argument          Pointer to the phase run state.
+
+  @retval    Phase execution status.
+
+**/
+STATIC
+UINT64
+EFIAPI
+Stage2PhaseApTask (
+  IN UINT64                       Argument
+  )
+{
+  STAGE2_PHASE_RUN               *Run;
+
+  Run = (STAGE2_PHASE_RUN *)(UINTN)Argument;
+  ExecuteStage2Phase (Run);
+  MemoryFence ();
+  Run->State = EnumPhaseDone;
+
+  return (UINT64)Run->Status;
+}
+
+/**
+  Try to dispatch a phase to an idle AP.
+
+  @param[in] Run               Phase run state.
+  @param[in] BusyCpuMask       Bit mask of the APs already running a phase.
+
+  @retval    CPU index the phase was dispatched to, or 0 if no AP is idle.
+
+**/
+STATIC
+UINT32
+DispatchStage2PhaseToAp (
+  IN STAGE2_PHASE_RUN            *Run,
+  IN UINT32                       BusyCpuMask
+  )
+{
+  SYS_CPU_TASK                   *SysCpuTask;
+  UINT32                          Index;
+  UINT32                          CpuCount;
+
+  SysCpuTask = MpGetTask ();
+  CpuCount   = MIN (SysCpuTask->CpuCount, 32);
+  for (Index = 1; Index < CpuCount; Index++) {
+    if ((BusyCpuMask & (1 << Index)) != 0) {
+      continue;
+    }
+    Run->State = EnumPhaseRunning;
+    if (!EFI_ERROR (MpRunTask (Index, Stage2PhaseApTask, (UINT64)(UINTN)Run))) {
+      return Index;
+    }
+    Run->State = EnumPhasePending;
+  }
+
+  return 0;
+}
+
+/**
+  Record a completed phase in the performance data.
+
+  @param[in] Run               Phase run state.
+
+**/
+STATIC
+VOID
+RecordStage2Phase (
+  IN STAGE2_PHASE_RUN            *Run
+  )
+{
+  BL_PERF_DATA                   *PerfData;
+
+  Run->PerfIndex = MAX_TS_NUM;
+  if (EFI_ERROR (Run->Status) && (Run->Status != EFI_UNSUPPORTED)) {
+    DEBUG ((DEBUG_INFO, "%a init Status = %r\n", Run->Phase->Name, Run->Status));
+  }
+
+  if ((Run->Status == EFI_UNSUPPORTED) || (Run->Phase->PerfId == 0)) {
+    return;
+  }
+
+  PerfData = GetPerfDataPtr ();
+  if (PerfData->PerfIndex < MAX_TS_NUM) {
+    Run->PerfIndex = PerfData->PerfIndex;
+  }
+  AddMeasurePoint (Run->Phase->PerfId);
+}
+
+/**
+  Find the critical path through the executed phase graph, mark it in the
+  performance data and print it.
+
+  @param[in] RunTable          Phase run state table.
+  @param[in] PhaseCount        Number of phases.
+  @param[in] GraphStartTsc     Timestamp when the graph execution started.
+
+**/
+STATIC
+VOID
+MarkStage2CriticalPath (
+  IN STAGE2_PHASE_RUN            *RunTable,
+  IN UINT32                       PhaseCount,
+  IN UINT64                       GraphStartTsc
+  )
+{
+  BL_PERF_DATA                   *PerfData;
+  STAGE2_PHASE_RUN               *Run;
+  UINT32                          Index;
+  UINT32                          Last;
+  UINT32                          DependMask;
+
+  // The critical path ends with the phase completing last
+  Last = PhaseCount;
+  for (Index = 0; Index < PhaseCount; Index++) {
+    if ((Last == PhaseCount) || (RunTable[Index].EndTsc > RunTable[Last].EndTsc)) {
+      Last = Index;
+    }
+  }
+
+  DEBUG ((DEBUG_INFO, "Stage2 critical path (%ld us):", TimeStampTickToMicroSecond (RunTable[Last].EndTsc - GraphStartTsc)));
+  PerfData = GetPerfDataPtr ();
+  while (Last < PhaseCount) {
+    Run = &RunTable[Last];
+    DEBUG ((DEBUG_INFO, " %a(%ld us)", Run->Phase->Name, TimeStampTickToMicroSecond (Run->EndTsc - Run->StartTsc)));
+    if (Run->PerfIndex < MAX_TS_NUM) {
+      ((UINT16 *)&PerfData->TimeStamp[Run->PerfIndex])[3] |= PERF_ID_CRITICAL_PATH;
+    }
+
+    // Walk back through the dependency that completed last
+    DependMask = Run->Phase->DependMask;
+    Last = PhaseCount;
+    for (Index = 0; Index < PhaseCount; Index++) {
+      if ((DependMask & (1 << Index)) == 0) {
+        continue;
+      }
+      if ((Last == PhaseCount) || (RunTable[Index].EndTsc > RunTable[Last].EndTsc)) {
+        Last = Index;
+      }
+    }
+  }
+  DEBUG ((DEBUG_INFO, "\n"));
+}
+
+/**
+  Execute a graph of Stage2 initialization phases.
+
+  A phase starts once all phases in its DependMask have completed. Phases
+  flagged with STAGE2_PHASE_FLAG_AP are dispatched to idle APs when MP init
+  has reached the run phase, all other phases run on the BSP in table order.
+  The critical path through the graph is marked in the performance data.
+
+  @param[in] PhaseTable        Phase table.
+  @param[in] PhaseCount        Number of phases in the table.
+  @param[in] Stage2Param       STAGE2 Param pointer.
+
+  @retval    EFI_SUCCESS       All phases have been executed.
+  @retval    EFI_INVALID_PARAMETER  The phase table is invalid.
+  @retval    EFI_ABORTED       The phase dependencies cannot be satisfied.
+
+**/
+EFI_STATUS
+RunStage2Phases (
+  IN CONST STAGE2_PHASE          *PhaseTable,
+  IN UINT32                       PhaseCount,
+  IN STAGE2_PARAM                *Stage2Param
+  )
+{
+  STAGE2_PHASE_RUN                RunTable[STAGE2_PHASE_MAX];
+  STAGE2_PHASE_RUN               *Run;
+  UINT32                          Index;
+  UINT32                          AllMask;
+  UINT32                          DoneMask;
+  UINT32                          StartMask;
+  UINT32                          BusyCpuMask;
+  UINT32                          CpuIndex;
+  UINT64                          GraphStartTsc;
+  BOOLEAN                         Progress;
+
+  if ((PhaseTable == NULL) || (PhaseCount == 0) || (PhaseCount > STAGE2_PHASE_MAX)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (RunTable, sizeof (RunTable));
+  for (Index = 0; Index < PhaseCount; Index++) {
+    RunTable[Index].Phase       = &PhaseTable[Index];
+    RunTable[Index].Stage2Param = Stage2Param;
+    RunTable[Index].PerfIndex   = MAX_TS_NUM;
+  }
+
+  AllMask       = (PhaseCount == 32) ? MAX_UINT32 : ((1U << PhaseCount) - 1);
+  DoneMask      = 0;
+  StartMask     = 0;
+  BusyCpuMask   = BIT0;
+  GraphStartTsc = ReadTimeStamp ();
+
+  while (DoneMask != AllMask) {
+    Progress = FALSE;
+
+    // Collect phases completed on APs
+    for (Index = 0; Index < PhaseCount; Index++) {
+      Run = &RunTable[Index];
+      if (((StartMask & ~DoneMask & (1 << Index)) != 0) && (Run->State == EnumPhaseDone)) {
+        RecordStage2Phase (Run);
+        BusyCpuMask &= ~(1 << Run->CpuIndex);
+        DoneMask    |= (1 << Index);
+        Progress     = TRUE;
+      }
+    }
+
+    // Hand out ready AP capable phases to idle APs first
+    for (Index = 0; Index < PhaseCount; Index++) {
+      Run = &RunTable[Index];
+      if (((StartMask & (1 << Index)) != 0) || ((Run->Phase->Flags & STAGE2_PHASE_FLAG_AP) == 0) ||
+          ((Run->Phase->DependMask & ~DoneMask) != 0)) {
+        continue;
+      }
+      CpuIndex = DispatchStage2PhaseToAp (Run, BusyCpuMask);
+      if (CpuIndex != 0) {
+        Run->CpuIndex = CpuIndex;
+        BusyCpuMask  |= (1 << CpuIndex);
+        StartMask    |= (1 << Index);
+        Progress      = TRUE;
+      }
+    }
+
+    // Run the first ready phase left on the BSP
+    for (Index = 0; Index < PhaseCount; Index++) {
+      Run = &RunTable[Index];
+      if (((StartMask & (1 << Index)) != 0) || ((Run->Phase->DependMask & ~DoneMask) != 0)) {
+        continue;
+      }
+      StartMask |= (1 << Index);
+      ExecuteStage2Phase (Run);
+      Run->State = EnumPhaseDone;
+      RecordStage2Phase (Run);
+      DoneMask  |= (1 << Index);
+      Progress   = TRUE;
+      break;
+    }
+
+    if (!Progress) {
+      if ((StartMask & ~DoneMask) == 0) {
+        DEBUG ((DEBUG_ERROR, "Stage2 phase dependency cannot be satisfied (0x%08X)\n", AllMask & ~DoneMask));
+        return EFI_ABORTED;
+      }
+      CpuPause ();
+    }
+  }
+
+  MarkStage2CriticalPath (RunTable, PhaseCount, GraphStartTsc);
+
+  return EFI_SUCCESS;
+}
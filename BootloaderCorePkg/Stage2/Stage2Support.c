@@ -119,6 +119,7 @@ PrintStackHeapInfo (
   LOADER_GLOBAL_DATA             *LdrGlobal;
   EFI_HOB_HANDOFF_INFO_TABLE     *HandOffHob;
   UINT32                          StackBot;
+  CONST HOB_GUID_INDEX_STATS     *HobStats;
 
   LdrGlobal = (LOADER_GLOBAL_DATA *)GetLoaderGlobalDataPointer();
   HandOffHob = (EFI_HOB_HANDOFF_INFO_TABLE *)LdrGlobal->LdrHobList;
@@ -143,8 +144,90 @@ PrintStackHeapInfo (
            LdrGlobal->MemPoolCurrTop - LdrGlobal->MemPoolCurrBottom,
            LdrGlobal->MemPoolMaxUsed
            ));
+
+  HobStats = GetGuidHobIndexStats ();
+  DEBUG ((
+           DEBUG_INFO,
+           "Stage2 GUID HOB lookup: %d indexed, %d walked\n",
+           HobStats->IndexedLookups,
+           HobStats->WalkedLookups
+           ));
+
+  if (FeaturePcdGet (PcdMemPoolProfileEnabled)) {
+    DEBUG ((
+             DEBUG_INFO,
+             "MEMPOOL PROFILE: Stage=2 BootMode=0x%02X Region=0x%X Pool=0x%X Perm=0x%X@0x%08X Temp=0x%X@0x%08X Peak=0x%X@0x%08X\n",
+             GetBootMode (),
+             PcdGet32 (PcdLoaderReservedMemSize),
+             LdrGlobal->MemPoolEnd - LdrGlobal->MemPoolStart,
+             LdrGlobal->MemPoolProfile.PermMaxUsed,
+             LdrGlobal->MemPoolProfile.PermCaller,
+             LdrGlobal->MemPoolProfile.TempMaxUsed,
+             LdrGlobal->MemPoolProfile.TempCaller,
+             LdrGlobal->MemPoolMaxUsed,
+             LdrGlobal->MemPoolProfile.MaxUsedCaller
+             ));
+  }
 }
 
+/**
+  Build the X64 1:1 mapping page tables for Stage2.
+
+  When PcdLazyPageTablePages is not 0, only the low 4GB and the memory and
+  MMIO resources reported by FSP are mapped up front. The rest of the physical
+  address space is mapped on page fault by the CPU exception handler.
+
+  @param[in] FspHobList     FSP HOB list pointer.
+
+**/
+VOID
+EFIAPI
+CreateStage2PageTables (
+  IN VOID                        *FspHobList
+  )
+{
+  EFI_PEI_HOB_POINTERS            Hob;
+  EFI_HOB_RESOURCE_DESCRIPTOR    *Resource;
+  MAP_RANGE                       Ranges[STAGE2_PAGE_MAP_RANGE_MAX];
+  UINT32                          Count;
+  EFI_STATUS                      Status;
+
+  if (PcdGet32 (PcdLazyPageTablePages) != 0) {
+    // Low 4GB is always mapped, collect the resources above it
+    Count   = 0;
+    Hob.Raw = FspHobList;
+    while ((Hob.Raw != NULL) && !END_OF_HOB_LIST (Hob)) {
+      if (Hob.Header->HobType == EFI_HOB_TYPE_RESOURCE_DESCRIPTOR) {
+        Resource = Hob.ResourceDescriptor;
+        if (((Resource->ResourceType == EFI_RESOURCE_SYSTEM_MEMORY) ||
+             (Resource->ResourceType == EFI_RESOURCE_MEMORY_MAPPED_IO) ||
+             (Resource->ResourceType == EFI_RESOURCE_MEMORY_RESERVED)) &&
+            (Resource->ResourceLength != 0) &&
+            (Resource->PhysicalStart + Resource->ResourceLength > SIZE_4GB)) {
+          if (Count < ARRAY_SIZE (Ranges)) {
+            Ranges[Count].Start = (UINTN)Resource->PhysicalStart;
+            Ranges[Count].Limit = (UINTN)(Resource->PhysicalStart + Resource->ResourceLength - 1);
+            Count++;
+          } else {
+            DEBUG ((DEBUG_ERROR, "Too many resources above 4GB, 0x%lx - 0x%lx is not mapped up front\n",
+                    Resource->PhysicalStart, Resource->PhysicalStart + Resource->ResourceLength - 1));
+            ASSERT (FALSE);
+          }
+        }
+      }
+      Hob.Raw = GET_NEXT_HOB (Hob);
+    }
+
+    Status = CreateLazyIdentityMappingPageTables (0, Ranges, Count, PcdGet32 (PcdLazyPageTablePages));
+    if (!EFI_ERROR (Status)) {
+      return;
+    }
+    DEBUG ((DEBUG_WARN, "Lazy page table creation failed - %r\n", Status));
+  }
+
+  // Build full physical space 1:1 mapping page table
+  CreateIdentityMappingPageTables (0);
+}
 
 /**
   Initialize services so that payload can consume.
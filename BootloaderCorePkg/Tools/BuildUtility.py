@@ -20,6 +20,8 @@ import hashlib
 import subprocess
 import datetime
 import zipfile
+import zlib
+import uuid
 import ntpath
 from   CommonUtility import *
 from   IfwiUtility   import FLASH_MAP, FLASH_MAP_DESC, FIT_ENTRY, UCODE_HEADER
@@ -837,6 +839,67 @@ def gen_vbt_file (brd_pkg_name, vbt_dict, vbt_file):
     fp.close()
 
 
+def gen_fb_splash_file (bmp_file, splash_file, rle = False):
+    # Convert a BMP image into the frame buffer native splash format ($FBS):
+    # 32-bit BGRA pixels, lines stored top-down, optionally RLE compressed.
+    bmp = bytearray(get_file_data (bmp_file))
+    if bmp[0:2] != b'BM':
+        raise Exception ("Logo file '%s' is not a BMP image !" % bmp_file)
+    img_off, hdr_size, width, height, planes, bpp, comp = struct.unpack_from('<IIiiHHI', bmp, 10)
+    if comp != 0 or bpp not in [1, 4, 8, 24, 32]:
+        raise Exception ("Unsupported BMP format in '%s' (bpp %d, compression %d) !" % (bmp_file, bpp, comp))
+    top_down = height < 0
+    height   = abs(height)
+    palette  = []
+    if bpp <= 8:
+        pal_off = 14 + hdr_size
+        for idx in range(1 << bpp):
+            b, g, r = bmp[pal_off + idx * 4 : pal_off + idx * 4 + 3]
+            palette.append(b | (g << 8) | (r << 16))
+    line_size = ((width * bpp + 31) >> 3) & ~3
+
+    lines = []
+    for row in range(height):
+        line_off = img_off + line_size * (row if top_down else height - 1 - row)
+        line = bmp[line_off:line_off + line_size]
+        if bpp == 32:
+            pixels = list(struct.unpack_from('<%dI' % width, line))
+        elif bpp == 24:
+            pixels = [line[x * 3] | (line[x * 3 + 1] << 8) | (line[x * 3 + 2] << 16) for x in range(width)]
+        else:
+            ppb = 8 // bpp
+            pixels = [palette[(line[x // ppb] >> ((ppb - 1 - x % ppb) * bpp)) & ((1 << bpp) - 1)] for x in range(width)]
+        lines.append(pixels)
+
+    data = bytearray()
+    for pixels in lines:
+        if not rle:
+            data.extend(struct.pack('<%dI' % width, *pixels))
+            continue
+        idx = 0
+        literal = []
+        while idx < width:
+            run = 1
+            while idx + run < width and pixels[idx + run] == pixels[idx]:
+                run += 1
+            if run >= 3:
+                if literal:
+                    data.extend(struct.pack('<%dI' % (len(literal) + 1), len(literal), *literal))
+                    literal = []
+                data.extend(struct.pack('<II', 0x80000000 | run, pixels[idx]))
+            else:
+                literal.extend(pixels[idx:idx + run])
+            idx += run
+        if literal:
+            data.extend(struct.pack('<%dI' % (len(literal) + 1), len(literal), *literal))
+
+    # FB_SPLASH_HEADER
+    header = struct.pack('<4sHBBIII', b'$FBS', 20, 1 if rle else 0, 0, width, height, len(data))
+    fp = open(splash_file, 'wb')
+    fp.write(header + data)
+    fp.close()
+
+
 def get_verinfo_via_file (ver_dict, file):
     if not os.path.exists(file):
         raise Exception ("Version TXT file '%s' does not exist!" % file)
@@ -1094,6 +1157,37 @@ def copy_images_to_output (fv_dir, zip_file, img_list, rgn_name_list, out_list):
 
     stitch_zip.close()
 
+def gen_acpi_patch_map (stage2_fd, acpi_guid = '7E374E25-8E01-4FEE-87F2-390C23C606CD'):
+    # Locate the GNVS OperationRegion in the DSDT built into Stage2 so that
+    # AcpiInitLib can patch it at boot time without scanning the whole DSDT.
+    # Return (GNVS name offset in DSDT, CRC32 of the DSDT header) or None.
+    # Only the 36-byte header is covered by the CRC, the boot time code
+    # re-validates the AML opcodes at the offset before patching.
+    if not os.path.exists(stage2_fd):
+        raise Exception("file '%s' not found !" % stage2_fd)
+
+    fd = FirmwareDevice(0, stage2_fd)
+    fd.ParseFd ()
+    for fv in fd.FvList:
+        for ffs in fv.FfsList:
+            if bytes(bytearray(ffs.FfsHdr.Name)) != uuid.UUID(acpi_guid).bytes_le:
+                continue
+            for sec in ffs.SecList:
+                aml = sec.SecData[sizeof(sec.SecHdr):]
+                if aml[0:4] != b'DSDT':
+                    continue
+                aml = aml[0:struct.unpack('<I', aml[4:8])[0]]
+                # Same match as the boot time scan: 'GNVS' after AML_EXT_REGION_OP
+                idx = aml.find(b'\x80GNVS')
+                if idx < 1:
+                    return None
+                off = idx + 1
+                if (aml[idx - 1] != 0x5B) or (off + 13 > len(aml)) or (aml[off + 5] != 0x0C) or (aml[off + 10] != 0x0B):
+                    return None
+                return (off, zlib.crc32(bytes(aml[0:36])) & 0xFFFFFFFF)
+    return None
+
+
 def rebase_stage (in_file, out_file, delta):
 
     if not os.path.exists(in_file):
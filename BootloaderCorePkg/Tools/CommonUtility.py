@@ -21,6 +21,7 @@ import string
 from   ctypes import *
 from   functools import reduce
 from   importlib.machinery import SourceFileLoader
+from   concurrent.futures import ThreadPoolExecutor
 from   SingleSign import *
 
 
@@ -383,10 +384,7 @@ def decompress (in_file, out_file, tool_dir = ''):
         run_process (cmdline, False, True)
     os.remove(temp)
 
-def compress (in_file, alg, svn=0, out_path = '', tool_dir = ''):
-    if not os.path.isfile(in_file):
-        raise Exception ("Invalid input file '%s' !" % in_file)
-
+def get_compress_out_file (in_file, out_path = ''):
     basename, ext = os.path.splitext(os.path.basename (in_file))
     if out_path:
         if os.path.isdir (out_path):
@@ -395,6 +393,54 @@ def compress (in_file, alg, svn=0, out_path = '', tool_dir = ''):
             out_file = os.path.join(out_path)
     else:
         out_file = os.path.splitext(in_file)[0] + '.lz'
+    return out_file
+
+_compress_tool_ids = {}
+
+def get_compress_tool_id (compress_tool):
+    # Identify the compression tool by its binary content so that an updated
+    # tool invalidates all cached outputs
+    if compress_tool not in _compress_tool_ids:
+        tool_path = shutil.which (compress_tool)
+        if tool_path:
+            tool_id = hashlib.sha256(get_file_data(tool_path)).hexdigest()
+        else:
+            try:
+                import lz4
+                tool_id = 'lz4-%s' % lz4.VERSION
+            except ImportError:
+                tool_id = ''
+        _compress_tool_ids[compress_tool] = tool_id
+    return _compress_tool_ids[compress_tool]
+
+def get_build_cache_file (name, key_list):
+    # Build outputs are cached under SBL_BUILD_CACHE, keyed on the hash of
+    # everything the output depends on. An empty SBL_BUILD_CACHE disables it.
+    cache_dir = os.environ.get('SBL_BUILD_CACHE', '')
+    if not cache_dir:
+        return ''
+    ho = hashlib.sha256()
+    for key in key_list:
+        ho.update (key if isinstance(key, (bytes, bytearray)) else str(key).encode())
+        ho.update (b'\0')
+    return os.path.join(cache_dir, name, ho.hexdigest())
+
+def save_build_cache_file (cache_file, data):
+    if not cache_file:
+        return
+    cache_dir = os.path.dirname(cache_file)
+    if not os.path.exists(cache_dir):
+        os.makedirs(cache_dir, exist_ok = True)
+    # Write to a private file first, parallel jobs may save the same entry
+    temp = '%s.%d.%d' % (cache_file, os.getpid(), id(data))
+    gen_file_from_object (temp, data)
+    os.replace (temp, cache_file)
+
+def compress (in_file, alg, svn=0, out_path = '', tool_dir = ''):
+    if not os.path.isfile(in_file):
+        raise Exception ("Invalid input file '%s' !" % in_file)
+
+    out_file = get_compress_out_file (in_file, out_path)
 
     if alg == "Lzma":
         sig = "LZMA"
@@ -408,6 +454,14 @@ def compress (in_file, alg, svn=0, out_path = '', tool_dir = ''):
         raise Exception ("Unsupported compression '%s' !" % alg)
 
     in_len = os.path.getsize(in_file)
+    cache_file = ''
+    if in_len > 0 and sig in ["LZMA", "LZ4 "]:
+        compress_tool = os.path.join (tool_dir, "%sCompress" % alg)
+        cache_file = get_build_cache_file ('Compress', [get_file_data(in_file), sig, svn, get_compress_tool_id (compress_tool)])
+        if os.path.isfile (cache_file):
+            shutil.copyfile (cache_file, out_file)
+            return out_file
+
     if in_len > 0:
         compress_tool = "%sCompress" % alg
         if sig == "LZDM":
@@ -452,5 +506,32 @@ def compress (in_file, alg, svn=0, out_path = '', tool_dir = ''):
     data.extend (lz_hdr)
     data.extend (compress_data)
     gen_file_from_object (out_file, data)
+    save_build_cache_file (cache_file, data)
 
     return out_file
+
+def compress_files (job_list, tool_dir = ''):
+    # Compress independent files in parallel. Each job is a tuple of
+    # (in_file, alg, svn, out_path). The compression itself runs in external
+    # tool processes, so threads are enough to keep all host cores busy.
+    # Jobs writing to an output file used by an earlier job are skipped and
+    # have to be compressed by the caller.
+    out_files = set()
+    run_list  = []
+    for job in job_list:
+        out_file = get_compress_out_file (job[0], job[3])
+        if out_file in out_files:
+            continue
+        out_files.add (out_file)
+        run_list.append (job)
+
+    results = {}
+    if len(run_list) == 0:
+        return results
+
+    with ThreadPoolExecutor (max_workers = min(len(run_list), os.cpu_count() or 1)) as executor:
+        futures = [(job, executor.submit (compress, job[0], job[1], job[2], job[3], tool_dir)) for job in run_list]
+        for job, future in futures:
+            results[job] = future.result ()
+
+    return results
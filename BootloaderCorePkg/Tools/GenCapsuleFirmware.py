@@ -13,6 +13,7 @@ import re
 import struct
 import uuid
 import binascii
+import hashlib
 from ctypes import *
 
 sys.dont_write_bytecode = True
@@ -422,6 +423,115 @@ class FirmwareUpdateHeader(Structure):
   ]
 
 
+class DeltaImageHeader(Structure):
+
+  DELTA_IMAGE_SIGNATURE = b'$DLT'
+  DELTA_IMAGE_VERSION   = 1
+
+  _pack_ = 1
+  _fields_ = [
+    ('Signature',          ARRAY(c_char, 4)),
+    ('HeaderSize',         c_uint16),
+    ('Version',            c_uint8),
+    ('HashAlg',            c_uint8),
+    ('BaseSize',           c_uint32),
+    ('TargetSize',         c_uint32),
+    ('CmdCount',           c_uint32),
+    ('Reserved',           c_uint32),
+    ('BaseHash',           ARRAY(c_uint8, 64)),
+    ('TargetHash',         ARRAY(c_uint8, 64))
+  ]
+
+
+class DeltaImageCmd(Structure):
+
+  DELTA_IMAGE_CMD_COPY = 1
+  DELTA_IMAGE_CMD_DATA = 2
+
+  _pack_ = 1
+  _fields_ = [
+    ('Command',            c_uint16),
+    ('Reserved',           c_uint16),
+    ('Length',             c_uint32),
+    ('BaseOffset',         c_uint32)
+  ]
+
+
+def GenDeltaImage(BaseData, TargetData, HashType, BlockSize = 64):
+    #
+    # Build a COPY/DATA command stream that rebuilds TargetData from BaseData.
+    # Base is indexed at BlockSize granularity, and every match found in the
+    # target is extended forward as far as both images agree.
+    #
+    if HashType == 'SHA2_384':
+        HashFunc = hashlib.sha384
+    else:
+        HashType = 'SHA2_256'
+        HashFunc = hashlib.sha256
+
+    BlockIndex = {}
+    for Offset in range(0, len(BaseData) - BlockSize + 1, BlockSize):
+        BlockIndex.setdefault(BaseData[Offset:Offset + BlockSize], Offset)
+
+    Cmds = []
+    def AddCmd(Cmd, Length, BaseOffset, Data = b''):
+        if Cmds and Cmds[-1][0] == Cmd:
+            Last = Cmds[-1]
+            if Cmd == DeltaImageCmd.DELTA_IMAGE_CMD_DATA:
+                Cmds[-1] = (Cmd, Last[1] + Length, 0, Last[3] + Data)
+                return
+            if Last[2] + Last[1] == BaseOffset:
+                Cmds[-1] = (Cmd, Last[1] + Length, Last[2], b'')
+                return
+        Cmds.append((Cmd, Length, BaseOffset, Data))
+
+    Pos = 0
+    Literal = 0
+    while Pos < len(TargetData):
+        Match = BlockIndex.get(TargetData[Pos:Pos + BlockSize])
+        if Match is None:
+            Pos += 1
+            continue
+        if Pos > Literal:
+            AddCmd(DeltaImageCmd.DELTA_IMAGE_CMD_DATA, Pos - Literal, 0, TargetData[Literal:Pos])
+        Length = BlockSize
+        while Pos + Length < len(TargetData) and Match + Length < len(BaseData) and \
+              TargetData[Pos + Length] == BaseData[Match + Length]:
+            Length += 1
+        AddCmd(DeltaImageCmd.DELTA_IMAGE_CMD_COPY, Length, Match)
+        Pos += Length
+        Literal = Pos
+    if len(TargetData) > Literal:
+        AddCmd(DeltaImageCmd.DELTA_IMAGE_CMD_DATA, len(TargetData) - Literal, 0, TargetData[Literal:])
+
+    Header = DeltaImageHeader()
+    Header.Signature  = DeltaImageHeader.DELTA_IMAGE_SIGNATURE
+    Header.HeaderSize = sizeof(DeltaImageHeader)
+    Header.Version    = DeltaImageHeader.DELTA_IMAGE_VERSION
+    Header.HashAlg    = HASH_TYPE_VALUE[HashType]
+    Header.BaseSize   = len(BaseData)
+    Header.TargetSize = len(TargetData)
+    Header.CmdCount   = len(Cmds)
+    Digest = HashFunc(BaseData).digest()
+    Header.BaseHash[0:len(Digest)]   = Digest
+    Digest = HashFunc(TargetData).digest()
+    Header.TargetHash[0:len(Digest)] = Digest
+
+    DeltaData = bytearray(Header)
+    for Cmd, Length, BaseOffset, Data in Cmds:
+        Entry = DeltaImageCmd()
+        Entry.Command    = Cmd
+        Entry.Length     = Length
+        Entry.BaseOffset = BaseOffset
+        DeltaData += bytearray(Entry)
+        if Cmd == DeltaImageCmd.DELTA_IMAGE_CMD_DATA:
+            DeltaData += Data + b'\x00' * get_padding_length(len(Data))
+
+    print('Delta image: base 0x%X, target 0x%X, delta 0x%X bytes (%d commands)' % \
+          (len(BaseData), len(TargetData), len(DeltaData), len(Cmds)))
+    return bytes(DeltaData)
+
+
 def SignImage(RawData, OutFile, HashType, SignScheme, PrivKey, ForceBiosUpdate):
 
     #
@@ -514,6 +624,7 @@ def main():
     parser.add_argument('-s',  '--sign_scheme', dest='SignScheme', type=str, choices=['RSA_PKCS1', 'RSA_PSS'], default='RSA_PSS', help='Signing Scheme types')
     parser.add_argument('-o',  '--output', dest='NewImage', type=str, required=True, help='Output file for signed image')
     parser.add_argument("-v",  "--verbose", dest='Verbose', action="store_true", help= "Turn on verbose output with informational messages printed, including capsule headers and warning messages.")
+    parser.add_argument('-d',  '--delta', nargs=2, action='append', type=str, default=[], help='Generate delta payload against a base image: Component, BaseFileName')
     parser.add_argument("-f",  "--force_bios_update", dest='ForceBiosUpdate', action="store_true", help= "Force update whole BIOS region in a single shot.")
 
     #
@@ -521,11 +632,23 @@ def main():
     #
     args = parser.parse_args()
 
+    DeltaBaseDict = dict((Comp.upper(), BaseFile) for Comp, BaseFile in args.delta)
+    if len(DeltaBaseDict) and args.ForceBiosUpdate:
+        raise Exception ("Delta payload is not supported with '-f' flag !")
+
     FmpCapsuleHeader = FmpCapsuleHeaderClass()
     for PldUuid, PldFile in args.payload:
 
         FmpPayloadHeader = FmpPayloadHeaderClass()
         Buffer = open(PldFile, 'rb').read()
+        if PldUuid.upper() in DeltaBaseDict:
+            if PldUuid.upper() in PredefinedUuidDict or ':' in PldUuid:
+                raise Exception ('Delta payload is not supported for %s' % PldUuid)
+            HashType = args.HashType
+            if HashType == 'AUTO':
+                HashType = adjust_hash_type(args.PrivKey)
+            BaseBuffer = open(DeltaBaseDict[PldUuid.upper()], 'rb').read()
+            Buffer = GenDeltaImage(BaseBuffer, Buffer, HashType)
         Result = Buffer
         FmpPayloadHeader.Payload = Result
         Result = FmpPayloadHeader.Encode()
@@ -15,12 +15,16 @@ import string
 import operator as op
 import ast
 import binascii
+import hashlib
 import fnmatch
 from   datetime    import date
 from   collections import OrderedDict
 
 from CommonUtility import *
 
+# Files read while loading a config YAML, used to validate the build cache
+_dep_files = []
+
 # Generated file copyright header
 __copyright_tmp__ = """/** @file
 
@@ -95,6 +99,7 @@ def read_lines (file):
     fi = open (file, 'r')
     lines = fi.readlines ()
     fi.close ()
+    _dep_files.append (os.path.abspath(file))
     return lines
 
 def expand_file_value (path, value_str):
@@ -106,8 +111,34 @@ def expand_file_value (path, value_str):
             file = file.strip()
             bin_path = os.path.join(path, file)
             result.extend(bytearray(open(bin_path, 'rb').read()))
+            _dep_files.append (os.path.abspath(bin_path))
     return result
 
+def load_cfg_cache (kind, cfg_file):
+    # Look up the cached result of processing cfg_file. The entry is only used
+    # if none of the files read to produce it have changed since.
+    tool_data  = get_file_data (os.path.realpath(__file__))
+    cache_file = get_build_cache_file ('CfgData', [kind, os.path.realpath(cfg_file), tool_data])
+    if not cache_file or not os.path.isfile(cache_file):
+        return cache_file, None
+    try:
+        with open(cache_file, 'rb') as fd:
+            entry = marshal.load(fd)
+    except (EOFError, ValueError, TypeError):
+        return cache_file, None
+    for path, digest in entry['deps']:
+        if not os.path.isfile(path) or hashlib.sha256(get_file_data(path)).hexdigest() != digest:
+            return cache_file, None
+    return cache_file, entry['data']
+
+def save_cfg_cache (cache_file, data):
+    if not cache_file:
+        return
+    deps = []
+    for path in OrderedDict.fromkeys(_dep_files):
+        deps.append ((path, hashlib.sha256(get_file_data(path)).hexdigest()))
+    save_build_cache_file (cache_file, marshal.dumps({'deps' : deps, 'data' : data}))
+
 class ExpressionEval(ast.NodeVisitor):
     operators = {
         ast.Add:    op.add,
@@ -223,6 +254,7 @@ class CFG_YAML():
         self.tmp_tree        = None
         self.var_dict        = None
         self.def_dict        = {}
+        self.tmp_text        = {}
         self.yaml_path       = ''
         self.lines           = []
         self.full_lines      = []
@@ -232,7 +264,7 @@ class CFG_YAML():
 
     @staticmethod
     def count_indent (line):
-        return next((i for i, c in enumerate(line) if not c.isspace()), len(line))
+        return len(line) - len(line.lstrip())
 
     @staticmethod
     def substitue_args (text, arg_dict):
@@ -327,9 +359,10 @@ class CFG_YAML():
         parts = [i.strip() for i in parts]
         num = len(parts)
         arg_dict = dict(zip( ['(%d)' % (i + 1) for i in range(num)], parts))
-        str_data = self.tmp_tree[temp_name]
-        text = DefTemplate(str_data).safe_substitute(self.def_dict)
-        text = CFG_YAML.substitue_args (text, arg_dict)
+        if temp_name not in self.tmp_text:
+            # variables are fixed once templates are parsed, substitute them once per template
+            self.tmp_text[temp_name] = DefTemplate(self.tmp_tree[temp_name]).safe_substitute(self.def_dict)
+        text = CFG_YAML.substitue_args (self.tmp_text[temp_name], arg_dict)
         target  = CFG_YAML.count_indent (prefix) + indent
         current = CFG_YAML.count_indent (text)
         padding = target * ' '
@@ -1475,8 +1508,12 @@ class CGenCfgData:
             self._cfg_tree = CGenCfgData.deep_convert_list (self._cfg_tree)
 
     def generate_yml_file (self, in_file, out_file):
-        cfg_yaml = CFG_YAML()
-        text = cfg_yaml.expand_yaml (in_file)
+        cache_file, text = load_cfg_cache ('GENYML', in_file)
+        if text is None:
+            del _dep_files[:]
+            cfg_yaml = CFG_YAML()
+            text = cfg_yaml.expand_yaml (in_file)
+            save_cfg_cache (cache_file, text)
         yml_fd = open(out_file, "w")
         yml_fd.write (text)
         yml_fd.close ()
@@ -1861,6 +1898,14 @@ class CGenCfgData:
 
 
     def load_yaml (self, cfg_file):
+        # reuse the parsed and expanded result of an earlier run if possible
+        cache_file, data = load_cfg_cache ('YAML', cfg_file)
+        if data is not None:
+            self.__dict__ = data
+            self.prepare_marshal (False)
+            return 0
+
+        del _dep_files[:]
         cfg_yaml = CFG_YAML()
         self.initialize ()
         self._cfg_tree  = cfg_yaml.load_yaml (cfg_file)
@@ -1869,6 +1914,11 @@ class CGenCfgData:
         self.build_cfg_list()
         self.build_var_dict()
         self.update_def_value()
+
+        if cache_file:
+            data = dict(self.__dict__)
+            data['_cfg_tree'] = CGenCfgData.deep_convert_dict (self._cfg_tree)
+            save_cfg_cache (cache_file, data)
         return 0
 
 
@@ -418,6 +418,18 @@ class CONTAINER ():
             print (self.hex_str (component.auth_data, 'auth_data'))
             print (self.hex_str (component.data, 'data') + ' %s' % str(component.data[:4].decode()))
 
+    def get_component_file (self, file):
+        if os.path.isabs(file):
+            in_file = file
+        else:
+            for tst in [self.inp_dir, self.out_dir]:
+                in_file = os.path.join(tst, file)
+                if os.path.isfile(in_file):
+                    break
+        if not os.path.isfile(in_file):
+            raise Exception ("Component file path '%s' is invalid !" % file)
+        return in_file
+
     def create (self, layout):
 
         # for monolithic signing, need to add a reserved _SG_ entry to hold the auth info
@@ -447,6 +459,13 @@ class CONTAINER ():
         self.set_header_auth_info (auth_type, key_path)
         self.set_header_svn_info (svn)
 
+        # compress all component files in parallel up front
+        comp_jobs = []
+        for name, file, compress_alg, auth_type, key_file, alignment, region_size, svn in layout[1:]:
+            if file:
+                comp_jobs.append ((self.get_component_file (file), compress_alg if compress_alg else 'Dummy', svn, self.out_dir))
+        lz_files = compress_files (comp_jobs, self.tool_dir)
+
         name_set = set()
         is_last_entry = False
         for name, file, compress_alg, auth_type, key_file, alignment, region_size, svn in layout[1:]:
@@ -468,15 +487,7 @@ class CONTAINER ():
             component.auth_type = self.get_auth_type_val (auth_type)
             key_file = os.path.join (self.key_dir, key_file)
             if file:
-                if os.path.isabs(file):
-                    in_file = file
-                else:
-                    for tst in [self.inp_dir, self.out_dir]:
-                        in_file = os.path.join(tst, file)
-                        if os.path.isfile(in_file):
-                            break
-                if not os.path.isfile(in_file):
-                    raise Exception ("Component file path '%s' is invalid !" % file)
+                in_file = self.get_component_file (file)
             else:
                 in_file = os.path.join(self.out_dir, component.name.decode() + '.bin')
                 gen_file_with_size (in_file, 0)
@@ -486,7 +497,9 @@ class CONTAINER ():
                     is_last_entry       = True
 
             # compress the component
-            lz_file = compress (in_file, compress_alg, svn, self.out_dir, self.tool_dir)
+            lz_file = lz_files.get ((in_file, compress_alg, svn, self.out_dir))
+            if lz_file is None:
+                lz_file = compress (in_file, compress_alg, svn, self.out_dir, self.tool_dir)
             component.data = bytearray(get_file_data (lz_file))
 
             # calculate the component auth info
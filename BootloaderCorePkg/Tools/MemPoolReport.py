@@ -0,0 +1,147 @@
+## @ MemPoolReport.py
+#  Memory pool sizing report from boot logs.
+#
+#  Parses the 'MEMPOOL PROFILE' lines printed by a loader built with
+#  ENABLE_MEM_POOL_PROFILE = 1 (e.g. captured from QEMU serial output for
+#  normal, S3 and firmware update boots) and recommends the minimal
+#  STAGE1_DATA_SIZE and LOADER_RSVD_MEM_SIZE board settings.
+#
+# Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+##
+
+import os
+import re
+import sys
+import argparse
+
+sys.dont_write_bytecode = True
+
+BOOT_MODE_NAME = {
+    0x00 : 'Normal',
+    0x01 : 'Minimal',
+    0x02 : 'NoConfigChange',
+    0x11 : 'S3',
+    0x12 : 'FWU',
+    0x20 : 'Recovery',
+}
+
+# Board setting sized from each stage memory pool
+STAGE_SETTING = {
+    1 : 'STAGE1_DATA_SIZE',
+    2 : 'LOADER_RSVD_MEM_SIZE',
+}
+
+PROFILE_LINE = re.compile (
+    r'MEMPOOL PROFILE: Stage=(\d+) BootMode=0x([0-9A-Fa-f]+) Region=0x([0-9A-Fa-f]+) '
+    r'Pool=0x([0-9A-Fa-f]+) Perm=0x([0-9A-Fa-f]+)@0x([0-9A-Fa-f]+) '
+    r'Temp=0x([0-9A-Fa-f]+)@0x([0-9A-Fa-f]+) Peak=0x([0-9A-Fa-f]+)@0x([0-9A-Fa-f]+)')
+
+
+def align_up (value, alignment = 0x1000):
+    return (value + alignment - 1) & ~(alignment - 1)
+
+
+def get_boot_mode_name (boot_mode):
+    return BOOT_MODE_NAME.get (boot_mode, '0x%02X' % boot_mode)
+
+
+def parse_logs (log_files):
+    records = []
+    for log_file in log_files:
+        with open (log_file, 'r', errors = 'ignore') as fd:
+            for line in fd:
+                match = PROFILE_LINE.search (line)
+                if not match:
+                    continue
+                val = [int(match.group(1))] + [int(x, 16) for x in match.groups()[1:]]
+                records.append ({
+                    'log'       : os.path.basename (log_file),
+                    'stage'     : val[0],
+                    'boot_mode' : val[1],
+                    'region'    : val[2],
+                    'pool'      : val[3],
+                    'perm'      : (val[4], val[5]),
+                    'temp'      : (val[6], val[7]),
+                    'peak'      : (val[8], val[9]),
+                })
+    return records
+
+
+def get_recommendation (records, margin):
+    result = {}
+    for rec in records:
+        stage = rec['stage']
+        if stage not in STAGE_SETTING:
+            continue
+        # Whatever is in the region outside of the pool is fixed (stack, HOB, page table)
+        fixed = rec['region'] - rec['pool']
+        size  = fixed + align_up (rec['peak'][0] * (100 + margin) // 100)
+        if stage not in result or size > result[stage][0]:
+            result[stage] = (size, rec)
+    return result
+
+
+def print_report (records, result):
+    print ('%-20s %-5s %-14s %-10s %-10s %-11s %-10s %-11s %-10s %s' % (
+           'Log', 'Stage', 'BootMode', 'Pool', 'Perm', 'Caller', 'Temp', 'Caller', 'Peak', 'Caller'))
+    for rec in records:
+        print ('%-20s %-5d %-14s 0x%08X 0x%08X @0x%08X 0x%08X @0x%08X 0x%08X @0x%08X' % (
+               rec['log'][:20], rec['stage'], get_boot_mode_name (rec['boot_mode']), rec['pool'],
+               rec['perm'][0], rec['perm'][1], rec['temp'][0], rec['temp'][1],
+               rec['peak'][0], rec['peak'][1]))
+
+    print ('')
+    for stage in sorted (result):
+        size, rec = result[stage]
+        print ('%-22s = 0x%08X  # current 0x%08X, sized by %s boot in %s' % (
+               STAGE_SETTING[stage], size, rec['region'],
+               get_boot_mode_name (rec['boot_mode']), rec['log']))
+
+
+def patch_board_config (board_config, result):
+    with open (board_config, 'r') as fd:
+        lines = fd.readlines ()
+
+    for stage in sorted (result):
+        setting = STAGE_SETTING[stage]
+        pattern = re.compile (r'^(\s*self\.%s\s*=\s*)(\S+)(.*)$' % setting)
+        found   = False
+        for idx, line in enumerate (lines):
+            match = pattern.match (line)
+            if match:
+                lines[idx] = '%s0x%08X%s\n' % (match.group(1), result[stage][0], match.group(3))
+                found = True
+        if not found:
+            print ("WARNING: '%s' is not set in '%s', please add it manually" % (setting, board_config))
+
+    with open (board_config, 'w') as fd:
+        fd.writelines (lines)
+    print ("Updated '%s'" % board_config)
+
+
+def main ():
+    parser = argparse.ArgumentParser (description = 'Recommend loader memory pool sizes from boot logs')
+    parser.add_argument ('logs', nargs = '+', help = 'Boot log files captured with ENABLE_MEM_POOL_PROFILE enabled')
+    parser.add_argument ('-m', '--margin', dest = 'margin', type = int, default = 10,
+                         help = 'Extra margin in percent added to the peak usage (default 10)')
+    parser.add_argument ('-p', '--patch', dest = 'board_config', type = str, default = '',
+                         help = 'BoardConfig.py file to update with the recommended sizes')
+    args = parser.parse_args ()
+
+    records = parse_logs (args.logs)
+    if len (records) == 0:
+        print ('No memory pool profile found, please build with ENABLE_MEM_POOL_PROFILE = 1')
+        return 1
+
+    result = get_recommendation (records, args.margin)
+    print_report (records, result)
+    if args.board_config:
+        patch_board_config (args.board_config, result)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit (main ())
@@ -75,6 +75,8 @@ def prep_env ():
     os.environ['CONF_PATH'] = os.path.join(os.environ['WORKSPACE'], 'Conf')
     if 'SBL_KEY_DIR' not in os.environ:
         os.environ['SBL_KEY_DIR'] = os.path.join(sblsource, '..', 'SblKeys')
+    if 'SBL_BUILD_CACHE' not in os.environ:
+        os.environ['SBL_BUILD_CACHE'] = os.path.join(os.environ['WORKSPACE'], 'Build', 'BuildCache')
 
     create_conf (os.environ['WORKSPACE'], sblsource)
 
@@ -99,6 +101,9 @@ class BaseBoard(object):
 
 
         self.LOGO_FILE              = 'Platform/CommonBoardPkg/Logo/Logo.bmp'
+        # Splash image format in flash: 'BMP', 'FB' (pre-converted frame buffer
+        # layout) or 'FB_RLE' (pre-converted and RLE compressed)
+        self._LOGO_FORMAT           = 'BMP'
 
         self._RSA_SIGN_TYPE          = 'RSA2048'
         self._SIGN_HASH              = 'SHA2_256'
@@ -177,6 +182,8 @@ class BaseBoard(object):
         self.ENABLE_PAYLOD_MODULE  = 0
         self.ENABLE_FAST_BOOT      = 0
         self.ENABLE_LEGACY_EF_SEG  = 1
+        # Report memory pool high-water marks for BootloaderCorePkg/Tools/MemPoolReport.py
+        self.ENABLE_MEM_POOL_PROFILE = 0
         # 0: Disable  1: Enable  2: Auto (disable for UEFI payload, enable for others)
         self.ENABLE_SMM_REBASE     = 0
 
@@ -188,6 +195,10 @@ class BaseBoard(object):
 
         self.CPU_MAX_LOGICAL_PROCESSOR_NUMBER = 16
         self.CPU_SORT_METHOD       = 0
+        # Spare pages for X64 page tables populated on demand, 0 maps everything up front
+        self.LAZY_PAGE_TABLE_PAGES = 0
+        # Reserved memory keeping Stage2 and payload images across warm resets, 0 disables it
+        self.WARM_BOOT_CACHE_SIZE  = 0
 
         self.ACM_SIZE              = 0
         self.DIAGNOSTICACM_SIZE    = 0
@@ -195,6 +206,7 @@ class BaseBoard(object):
         self.CFGDATA_SIZE          = 0
         self.MRCDATA_SIZE          = 0
         self.VARIABLE_SIZE         = 0
+        self.VARIABLE_STORE_BANKS  = 2
         self.UEFI_VARIABLE_SIZE    = 0
         self.FWUPDATE_SIZE         = 0
 
@@ -726,6 +738,12 @@ class Build(object):
             extra_cmd.append (
                 "<Stage2:__gPcd_BinaryPatch_PcdAcpiTablesAddress>, {7E374E25-8E01-4FEE-87F2-390C23C606CD:0x1C}, @Patch ACPI",
             )
+            acpi_patch_map = gen_acpi_patch_map (os.path.join(self._fv_dir, 'STAGE2.fd'))
+            if acpi_patch_map:
+                extra_cmd.extend ([
+                    "<Stage2:__gPcd_BinaryPatch_PcdAcpiGnvsPatchOffset>, 0x%08X, @Patch ACPI GNVS offset" % acpi_patch_map[0],
+                    "<Stage2:__gPcd_BinaryPatch_PcdAcpiPatchMapHdrCrc>, 0x%08X, @Patch ACPI patch map DSDT header CRC" % acpi_patch_map[1],
+                ])
         if self._board.ENABLE_SPLASH:
             extra_cmd.append (
                 "<Stage2:__gPcd_BinaryPatch_PcdSplashLogoAddress>, {5E2D3BE9-AD72-4D1D-AAD5-6B08AF921590:0x1C}, @Patch Logo",
@@ -990,6 +1008,19 @@ class Build(object):
 
         rgn_name_list = [rgn['name'] for rgn in self._region_list]
 
+        # compress all components in parallel up front, skipping the images
+        # stitched by this function since they do not exist yet
+        out_name_list = [comp_name for comp_name, file_list in self._img_list]
+        comp_jobs = []
+        for comp_name, file_list in self._img_list:
+            for src, algo, val, mode, pos in file_list:
+                if (mode & STITCH_OPS.MODE_FILE_IGNOR) or (src == 'EMPTY') or (src in out_name_list) or not algo:
+                    continue
+                src_path = os.path.join(self._fv_dir, src)
+                if os.path.exists(src_path):
+                    comp_jobs.append ((src_path, algo, 0, ''))
+        lz_files = compress_files (comp_jobs)
+
         for idx, (comp_name, file_list)  in enumerate(self._img_list):
             if (self._board.ENABLE_FWU == 0) and (comp_name == 'Stitch_FWU.bin') :
                 print("No firmware update payload specified, skip firmware update.")
@@ -1011,7 +1042,10 @@ class Build(object):
                     raise Exception ("Component '%s' could not be found !" % src)
 
                 if algo:
-                    compress(src_path, algo)
+                    # a pre-compressed output is only used once, the same file
+                    # might be compressed again with another algorithm later
+                    if lz_files.pop ((src_path, algo, 0, ''), None) is None:
+                        compress(src_path, algo)
                     src_path = bas_path + '.lz'
                 else:
                     if src == 'STAGE2.fd':
@@ -1247,6 +1281,16 @@ class Build(object):
             else:
                 gen_vbt_file (self._board.BOARD_PKG_NAME, self._board._MULTI_VBT_FILE, os.path.join(self._fv_dir, 'Vbt.bin'))
 
+        # create pre-converted splash image
+        if self._board.ENABLE_SPLASH and self._board._LOGO_FORMAT != 'BMP':
+            if self._board._LOGO_FORMAT not in ['FB', 'FB_RLE']:
+                raise Exception ("Unsupported LOGO_FORMAT '%s' !" % self._board._LOGO_FORMAT)
+            logo_file = os.path.join(plt_dir, self._board.LOGO_FILE)
+            if not os.path.exists(logo_file):
+                logo_file = os.path.join(sbl_dir, self._board.LOGO_FILE)
+            self._board.LOGO_FILE = os.path.join(self._fv_dir, 'Logo.bin')
+            gen_fb_splash_file (logo_file, self._board.LOGO_FILE, self._board._LOGO_FORMAT == 'FB_RLE')
+
         # create platform include dsc file
         platform_dsc_path = os.path.join(sbl_dir, 'BootloaderCorePkg', 'Platform.dsc')
         self.create_dsc_inc_file (platform_dsc_path)
@@ -1350,7 +1394,7 @@ class Build(object):
         if self._board.VARIABLE_SIZE:
             varhdr = VariableRegionHeader.from_buffer(bytearray(b'\xFF' * sizeof(VariableRegionHeader)))
             varhdr.Signature = b'VARS'
-            varhdr.Size      = self._board.VARIABLE_SIZE >> 1
+            varhdr.Size      = self._board.VARIABLE_SIZE // self._board.VARIABLE_STORE_BANKS
             varhdr.State     = 0xFE
             varfile = open (os.path.join(self._fv_dir, "VARIABLE.bin"), "wb")
             varfile.write(varhdr)
@@ -0,0 +1,302 @@
+/** @file
+  This file contains the delta capsule image support for firmware update.
+
+  A delta image carries only the differences between a known base image
+  and the new target image. The target image is rebuilt in memory from the
+  component currently on flash before it is handed to the regular update flow.
+
+  Copyright (c) 2022, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Uefi/UefiBaseType.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/BootloaderCommonLib.h>
+#include <Library/PayloadMemoryAllocationLib.h>
+#include <Library/FirmwareUpdateLib.h>
+#include <Library/SecureBootLib.h>
+#include "FirmwareUpdateHelper.h"
+
+/**
+  Check if the capsule payload is a delta image.
+
+  @param[in] ImageHdr       Pointer to fw mgmt capsule Image header
+
+  @retval TRUE              The payload is a delta image.
+  @retval FALSE             The payload is a full component image.
+**/
+BOOLEAN
+IsDeltaFwImage (
+  IN EFI_FW_MGMT_CAP_IMAGE_HEADER  *ImageHdr
+  )
+{
+  DELTA_IMAGE_HEADER        *DeltaHdr;
+
+  if ((ImageHdr == NULL) || (ImageHdr->UpdateImageSize < sizeof (DELTA_IMAGE_HEADER))) {
+    return FALSE;
+  }
+
+  DeltaHdr = (DELTA_IMAGE_HEADER *)((UINTN)ImageHdr + sizeof (EFI_FW_MGMT_CAP_IMAGE_HEADER));
+  return (DeltaHdr->Signature == DELTA_IMAGE_SIGNATURE);
+}
+
+/**
+  Get the digest size for a delta image hash algorithm.
+
+  @param[in] HashAlg        Hash algorithm used by the delta image.
+
+  @retval  Digest size in bytes, or 0 if the algorithm is not supported.
+**/
+STATIC
+UINT32
+GetDeltaHashSize (
+  IN UINT8                         HashAlg
+  )
+{
+  switch (HashAlg) {
+  case HASH_TYPE_SHA256:
+    return SHA256_DIGEST_SIZE;
+  case HASH_TYPE_SHA384:
+    return SHA384_DIGEST_SIZE;
+  default:
+    return 0;
+  }
+}
+
+/**
+  Check if a buffer matches the expected digest.
+
+  @param[in] Data           Data buffer pointer.
+  @param[in] Length         Data buffer size.
+  @param[in] HashAlg        Hash algorithm.
+  @param[in] Digest         Expected digest.
+
+  @retval TRUE              The buffer hash matches the digest.
+  @retval FALSE             Otherwise.
+**/
+STATIC
+BOOLEAN
+IsDeltaHashMatch (
+  IN UINT8                         *Data,
+  IN UINT32                         Length,
+  IN UINT8                          HashAlg,
+  IN UINT8                         *Digest
+  )
+{
+  UINT8                     Hash[HASH_DIGEST_MAX];
+  RETURN_STATUS             Status;
+
+  Status = CalculateHash (Data, Length, HashAlg, Hash);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  return (CompareMem (Hash, Digest, GetDeltaHashSize (HashAlg)) == 0);
+}
+
+/**
+  Apply delta commands on top of the base image.
+
+  @param[in]  DeltaHdr      Pointer to the delta image header.
+  @param[in]  DeltaSize     Size of the delta image in bytes.
+  @param[in]  Base          Pointer to the base image.
+  @param[out] Target        Pointer to the buffer receiving the target image.
+
+  @retval  EFI_SUCCESS      The target image was reconstructed.
+  @retval  EFI_COMPROMISED_DATA  The delta image is malformed.
+**/
+STATIC
+EFI_STATUS
+ApplyDeltaCommands (
+  IN  DELTA_IMAGE_HEADER           *DeltaHdr,
+  IN  UINT32                        DeltaSize,
+  IN  UINT8                        *Base,
+  OUT UINT8                        *Target
+  )
+{
+  DELTA_IMAGE_CMD           *Cmd;
+  UINT32                    Offset;
+  UINT32                    TargetOffset;
+  UINT32                    Index;
+
+  Offset       = DeltaHdr->HeaderSize;
+  TargetOffset = 0;
+  for (Index = 0; Index < DeltaHdr->CmdCount; Index++) {
+    if (Offset + sizeof (DELTA_IMAGE_CMD) > DeltaSize) {
+      return EFI_COMPROMISED_DATA;
+    }
+    Cmd     = (DELTA_IMAGE_CMD *)((UINT8 *)DeltaHdr + Offset);
+    Offset += sizeof (DELTA_IMAGE_CMD);
+
+    if (Cmd->Length > DeltaHdr->TargetSize - TargetOffset) {
+      return EFI_COMPROMISED_DATA;
+    }
+
+    switch (Cmd->Command) {
+    case DELTA_IMAGE_CMD_COPY:
+      if ((Cmd->BaseOffset > DeltaHdr->BaseSize) || (Cmd->Length > DeltaHdr->BaseSize - Cmd->BaseOffset)) {
+        return EFI_COMPROMISED_DATA;
+      }
+      CopyMem (Target + TargetOffset, Base + Cmd->BaseOffset, Cmd->Length);
+      break;
+    case DELTA_IMAGE_CMD_DATA:
+      if (Cmd->Length > DeltaSize - Offset) {
+        return EFI_COMPROMISED_DATA;
+      }
+      CopyMem (Target + TargetOffset, (UINT8 *)DeltaHdr + Offset, Cmd->Length);
+      Offset += ALIGN_UP (Cmd->Length, sizeof (UINT32));
+      break;
+    default:
+      return EFI_COMPROMISED_DATA;
+    }
+    TargetOffset += Cmd->Length;
+  }
+
+  if (TargetOffset != DeltaHdr->TargetSize) {
+    return EFI_COMPROMISED_DATA;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Reconstruct the full component image from a delta image.
+
+  The base image is read from the component in both boot partitions. The
+  copy matching the base hash recorded in the delta image is used as base.
+  If a copy already matches the target hash (e.g. the other partition was
+  updated before a reset), it is used directly.
+
+  The capsule is authenticated as a whole before this is called, and the
+  rebuilt image is checked against the signed target hash.
+
+  @param[in]  ImageHdr      Pointer to fw mgmt capsule Image header with delta payload.
+  @param[out] NewImageHdr   Pointer to a new fw mgmt capsule Image header with full payload.
+
+  @retval  EFI_SUCCESS      The full image was reconstructed.
+  @retval  EFI_UNSUPPORTED  Delta update is not supported for this component.
+  @retval  EFI_NOT_FOUND    No matching base image was found on flash.
+  @retval  other            error occurred during reconstruction.
+**/
+EFI_STATUS
+ReconstructDeltaFwImage (
+  IN  EFI_FW_MGMT_CAP_IMAGE_HEADER   *ImageHdr,
+  OUT EFI_FW_MGMT_CAP_IMAGE_HEADER  **NewImageHdr
+  )
+{
+  EFI_STATUS                    Status;
+  DELTA_IMAGE_HEADER           *DeltaHdr;
+  EFI_FW_MGMT_CAP_IMAGE_HEADER *FullImageHdr;
+  FLASH_MAP                    *FlashMap;
+  UINT8                        *Base;
+  UINT8                        *Target;
+  UINT32                        CompName;
+  UINT32                        CompBase;
+  UINT32                        CompSize;
+  UINT32                        ReadSize;
+  UINT32                        Index;
+  BOOLEAN                       BaseFound;
+
+  DeltaHdr = (DELTA_IMAGE_HEADER *)((UINTN)ImageHdr + sizeof (EFI_FW_MGMT_CAP_IMAGE_HEADER));
+  CompName = (UINT32)ImageHdr->UpdateHardwareInstance;
+
+  if ((DeltaHdr->Version != DELTA_IMAGE_VERSION) || (DeltaHdr->HeaderSize < sizeof (DELTA_IMAGE_HEADER)) ||
+      (DeltaHdr->HeaderSize > ImageHdr->UpdateImageSize) || (GetDeltaHashSize (DeltaHdr->HashAlg) == 0)) {
+    DEBUG ((DEBUG_ERROR, "Invalid delta image header for %4a\n", (CHAR8 *)&CompName));
+    return EFI_COMPROMISED_DATA;
+  }
+
+  //
+  // Delta images are only supported for flash map components. Full BIOS region,
+  // CSME and container sub-components need the full image in the capsule.
+  //
+  if (((UINT32)RShiftU64 (ImageHdr->UpdateHardwareInstance, 32) != 0) ||
+      (CompName == FW_UPDATE_COMP_BIOS_REGION) || (CompName == FW_UPDATE_COMP_CSME_REGION) ||
+      (CompName == FW_UPDATE_COMP_CSME_DRIVER) || (CompName == FW_UPDATE_COMP_CMD_REQUEST)) {
+    DEBUG ((DEBUG_ERROR, "Delta image is not supported for %4a\n", (CHAR8 *)&CompName));
+    return EFI_UNSUPPORTED;
+  }
+
+  FlashMap = GetFlashMapPtr ();
+  if (FlashMap == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  ReadSize = MAX (DeltaHdr->BaseSize, DeltaHdr->TargetSize);
+  Base     = AllocatePool (ReadSize);
+  FullImageHdr = AllocatePool (sizeof (EFI_FW_MGMT_CAP_IMAGE_HEADER) + DeltaHdr->TargetSize);
+  if ((Base == NULL) || (FullImageHdr == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+  Target = (UINT8 *)FullImageHdr + sizeof (EFI_FW_MGMT_CAP_IMAGE_HEADER);
+
+  //
+  // Look for the base image in primary and backup partitions
+  //
+  Status    = EFI_NOT_FOUND;
+  BaseFound = FALSE;
+  for (Index = 0; Index < 2; Index++) {
+    if (EFI_ERROR (GetComponentInfoByPartition (CompName, (BOOLEAN)(Index != 0), &CompBase, &CompSize))) {
+      continue;
+    }
+    if (ReadSize > CompSize) {
+      continue;
+    }
+    Status = BootMediaRead (GetRomImageOffsetInBiosRegion () + FlashMap->RomSize + CompBase, ReadSize, Base);
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
+    if (IsDeltaHashMatch (Base, DeltaHdr->TargetSize, DeltaHdr->HashAlg, DeltaHdr->TargetHash)) {
+      DEBUG ((DEBUG_INFO, "Delta target for %4a already present in partition %d\n", (CHAR8 *)&CompName, Index));
+      CopyMem (Target, Base, DeltaHdr->TargetSize);
+      Status = EFI_SUCCESS;
+      goto Done;
+    }
+    if (IsDeltaHashMatch (Base, DeltaHdr->BaseSize, DeltaHdr->HashAlg, DeltaHdr->BaseHash)) {
+      BaseFound = TRUE;
+      break;
+    }
+  }
+
+  if (!BaseFound) {
+    DEBUG ((DEBUG_ERROR, "No matching delta base image found for %4a\n", (CHAR8 *)&CompName));
+    Status = EFI_NOT_FOUND;
+    goto Exit;
+  }
+
+  Status = ApplyDeltaCommands (DeltaHdr, ImageHdr->UpdateImageSize, Base, Target);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Malformed delta image for %4a\n", (CHAR8 *)&CompName));
+    goto Exit;
+  }
+
+  if (!IsDeltaHashMatch (Target, DeltaHdr->TargetSize, DeltaHdr->HashAlg, DeltaHdr->TargetHash)) {
+    DEBUG ((DEBUG_ERROR, "Delta target hash mismatch for %4a\n", (CHAR8 *)&CompName));
+    Status = EFI_SECURITY_VIOLATION;
+    goto Exit;
+  }
+
+Done:
+  DEBUG ((DEBUG_INFO, "Delta image for %4a: 0x%X bytes -> 0x%X bytes\n", (CHAR8 *)&CompName,
+          ImageHdr->UpdateImageSize, DeltaHdr->TargetSize));
+  CopyMem (FullImageHdr, ImageHdr, sizeof (EFI_FW_MGMT_CAP_IMAGE_HEADER));
+  FullImageHdr->UpdateImageSize      = DeltaHdr->TargetSize;
+  FullImageHdr->UpdateVendorCodeSize = 0;
+  *NewImageHdr = FullImageHdr;
+  FullImageHdr = NULL;
+
+Exit:
+  if (Base != NULL) {
+    FreePool (Base);
+  }
+  if (FullImageHdr != NULL) {
+    FreePool (FullImageHdr);
+  }
+
+  return Status;
+}
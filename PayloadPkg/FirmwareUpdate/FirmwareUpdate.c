@@ -1180,8 +1180,10 @@ ApplyFwImage (
   BOOT_PARTITION          Partition;
   VOID                    *CsmeUpdateInData;
   FIRMWARE_UPDATE_HEADER  *CapHdr;
+  EFI_FW_MGMT_CAP_IMAGE_HEADER  *DeltaImageHdr;
 
   CapHdr = (FIRMWARE_UPDATE_HEADER *)CapImage;
+  DeltaImageHdr = NULL;
 
   Status = EFI_SUCCESS;
   *ResetRequired = FALSE;
@@ -1193,6 +1195,18 @@ ApplyFwImage (
   Signature = (UINT32)ImageHdr->UpdateHardwareInstance;
   DEBUG((DEBUG_INFO, "ApplyFwImage: %04X:%04X\n", Signature, (UINT32)RShiftU64 (Signature, 32)));
 
+  //
+  // Rebuild the full component image in memory if a delta image is provided
+  //
+  if (IsDeltaFwImage (ImageHdr)) {
+    Status = ReconstructDeltaFwImage (ImageHdr, &DeltaImageHdr);
+    if (EFI_ERROR (Status)) {
+      DEBUG((DEBUG_ERROR, "ReconstructDeltaFwImage failed with Status = %r\n", Status));
+      return Status;
+    }
+    ImageHdr = DeltaImageHdr;
+  }
+
   switch (Signature) {
   case FW_UPDATE_COMP_BIOS_REGION:
     if ((CapHdr->CapsuleFlags & CAPSULE_FLAG_FORCE_BIOS_UPDATE) != 0) {
@@ -1241,6 +1255,10 @@ ApplyFwImage (
     Status = UpdateSblComponent (ImageHdr);
   }
 
+  if (DeltaImageHdr != NULL) {
+    FreePool (DeltaImageHdr);
+  }
+
   return Status;
 }
 
@@ -276,6 +276,36 @@ Reboot (
   IN  EFI_RESET_TYPE        ResetType
   );
 
+/**
+  Check if the capsule payload is a delta image.
+
+  @param[in] ImageHdr       Pointer to fw mgmt capsule Image header
+
+  @retval TRUE              The payload is a delta image.
+  @retval FALSE             The payload is a full component image.
+**/
+BOOLEAN
+IsDeltaFwImage (
+  IN EFI_FW_MGMT_CAP_IMAGE_HEADER  *ImageHdr
+  );
+
+/**
+  Reconstruct the full component image from a delta image.
+
+  @param[in]  ImageHdr      Pointer to fw mgmt capsule Image header with delta payload.
+  @param[out] NewImageHdr   Pointer to a new fw mgmt capsule Image header with full payload.
+
+  @retval  EFI_SUCCESS      The full image was reconstructed.
+  @retval  EFI_UNSUPPORTED  Delta update is not supported for this component.
+  @retval  EFI_NOT_FOUND    No matching base image was found on flash.
+  @retval  other            error occurred during reconstruction.
+**/
+EFI_STATUS
+ReconstructDeltaFwImage (
+  IN  EFI_FW_MGMT_CAP_IMAGE_HEADER   *ImageHdr,
+  OUT EFI_FW_MGMT_CAP_IMAGE_HEADER  **NewImageHdr
+  );
+
 /**
   Retrieve the SBL rom image offset within BIOS region.
 
@@ -46,4 +46,15 @@ GetMemoryResourceInfo (
   OUT  UINT64           *EndAddr    OPTIONAL
   );
 
+/**
+  Retrieve the allocation call counts and latencies.
+
+  @return   Pointer to the memory allocation statistics.
+**/
+CONST MEMORY_ALLOCATION_STATS *
+EFIAPI
+GetMemoryAllocationStats (
+  VOID
+  );
+
 #endif
@@ -10,7 +10,7 @@
 #include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/PcdLib.h>
-#include <Library/HobLib.h>
+#include <Library/BlHobLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/PayloadLib.h>
 #include <Library/BootloaderCommonLib.h>
@@ -120,6 +120,9 @@ PayloadInit (
   PcdStatus2 = PcdSet32S (PcdGlobalDataAddress, (UINT32) (UINTN)GlobalDataPtr);
   ASSERT_EFI_ERROR (PcdStatus1 | PcdStatus2);
 
+  // Payload HOB list does not change anymore, index it for GUID HOB lookups
+  BuildGuidHobIndex (HobList);
+
   // Create Debug Log Buffer and init configuration data
   GuidHob = GetNextGuidHob (&gLoaderPlatformDataGuid, (VOID *)(UINTN)PcdGet32 (PcdPayloadHobList));
   if (GuidHob != NULL) {
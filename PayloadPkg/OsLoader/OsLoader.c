@@ -11,6 +11,14 @@
 UINT8    mCurrentBoot;
 VOID    *mEntryStack;
 
+//
+// Initialization result of each boot device tried in the current pass over
+// the boot option list, and the index of the one that is still initialized.
+//
+BOOT_DEVICE_STATE  mBootDeviceState[MAX_BOOT_OPTION_ENTRY];
+UINT8              mBootDeviceCount;
+UINT8              mActiveBootDevice = BOOT_DEVICE_NONE;
+
 /**
   Callback function to add performance measure point during component loading.
 
@@ -483,6 +491,8 @@ PrintStackHeapInfo (
   UINT32           StackTop;
   UINT8            Idx;
   EFI_MEMORY_TYPE  MemoryType;
+  CONST MEMORY_ALLOCATION_STATS  *Stats;
+  CONST HOB_GUID_INDEX_STATS     *HobStats;
 
   StackTop = 0;
   for  (Idx = 0; Idx < 2; Idx++) {
@@ -516,6 +526,36 @@ PrintStackHeapInfo (
              StackTop - StackBot
              ));
   }
+
+  HobStats = GetGuidHobIndexStats ();
+  DEBUG ((
+           DEBUG_INFO,
+           "Payload GUID HOB lookup: %d indexed, %d walked\n",
+           HobStats->IndexedLookups,
+           HobStats->WalkedLookups
+           ));
+
+  Stats = GetMemoryAllocationStats ();
+  DEBUG ((
+           DEBUG_INFO,
+           "Payload pool: %d alloc (%ld/%ld avg/max ticks), %d free (%ld/%ld avg/max ticks)\n",
+           Stats->AllocatePool.Count,
+           DivU64x32 (Stats->AllocatePool.TotalTicks, MAX (Stats->AllocatePool.Count, 1)),
+           Stats->AllocatePool.MaxTicks,
+           Stats->FreePool.Count,
+           DivU64x32 (Stats->FreePool.TotalTicks, MAX (Stats->FreePool.Count, 1)),
+           Stats->FreePool.MaxTicks
+           ));
+  DEBUG ((
+           DEBUG_INFO,
+           "Payload pages: %d alloc (%ld/%ld avg/max ticks), %d free (%ld/%ld avg/max ticks)\n",
+           Stats->AllocatePages.Count,
+           DivU64x32 (Stats->AllocatePages.TotalTicks, MAX (Stats->AllocatePages.Count, 1)),
+           Stats->AllocatePages.MaxTicks,
+           Stats->FreePages.Count,
+           DivU64x32 (Stats->FreePages.TotalTicks, MAX (Stats->FreePages.Count, 1)),
+           Stats->FreePages.MaxTicks
+           ));
 }
 
 /**
@@ -527,8 +567,9 @@ DeinitBootDevices (
   VOID
   )
 {
-  // Deinit boot media
+  // Deinit boot media, it has to be initialized again before the next use
   MediaInitialize (0, DevDeinit);
+  mActiveBootDevice = BOOT_DEVICE_NONE;
 
   if ((PcdGet32 (PcdConsoleInDeviceMask) & ConsoleInUsbKeyboard) != 0) {
     // Deinit USB devices if USB keyboard console is active
@@ -593,6 +634,9 @@ BeforeOSJump (
   DEBUG_LOG_BUFFER_HEADER   *LogBufHdr;
   UINT8                      PlatformDebugEnabled;
 
+  // Erase stale variable banks while the flash is still writable
+  CompactVariableStore (FALSE);
+
   PlatformService = (PLATFORM_SERVICE *) GetServiceBySignature (PLATFORM_SERVICE_SIGNATURE);
   if ((PlatformService != NULL) && (PlatformService->NotifyPhase != NULL)) {
     PlatformService->NotifyPhase (ReadyToBoot);
@@ -786,6 +830,62 @@ InitBootDevice (
   return EFI_SUCCESS;
 }
 
+/**
+  Prepare the boot device used by a boot option.
+
+  A boot device is only initialized once per pass over the boot option list.
+  If it is still initialized from a previous boot option, it is reused as is.
+  If its initialization failed before, the failure is returned right away so
+  that a missing or slow device does not add its timeout to every boot option
+  referring to it.
+
+  @param[in]  OsBootOption      OS boot option to boot
+
+  @retval  EFI_SUCCESS          The boot device is ready
+  @retval  Others               An error during initializing the boot device
+
+**/
+EFI_STATUS
+PrepareBootDevice (
+  IN  OS_BOOT_OPTION          *OsBootOption
+  )
+{
+  BOOT_DEVICE_STATE         *DevState;
+  UINT8                     Index;
+
+  for (Index = 0; Index < mBootDeviceCount; Index++) {
+    DevState = &mBootDeviceState[Index];
+    if ((DevState->DevType == OsBootOption->DevType) && (DevState->DevInstance == OsBootOption->DevInstance)) {
+      if (EFI_ERROR (DevState->InitStatus)) {
+        DEBUG ((DEBUG_INFO, "Skip boot device that failed to initialize - %r\n", DevState->InitStatus));
+        return DevState->InitStatus;
+      }
+      if (mActiveBootDevice == Index) {
+        DEBUG ((DEBUG_INFO, "Reuse initialized boot device\n"));
+        return EFI_SUCCESS;
+      }
+      break;
+    }
+  }
+
+  if (Index == mBootDeviceCount) {
+    if (mBootDeviceCount >= ARRAY_SIZE (mBootDeviceState)) {
+      return InitBootDevice (OsBootOption);
+    }
+    mBootDeviceCount++;
+  }
+
+  DevState = &mBootDeviceState[Index];
+  DevState->DevType     = OsBootOption->DevType;
+  DevState->DevInstance = OsBootOption->DevInstance;
+  DevState->InitStatus  = InitBootDevice (OsBootOption);
+  if (!EFI_ERROR (DevState->InitStatus)) {
+    mActiveBootDevice = Index;
+  }
+
+  return DevState->InitStatus;
+}
+
 /**
   Find a MBR or GPT partition from the given hardware partition number
 
@@ -1104,7 +1204,7 @@ BootOsImage (
   //
   // Initialize Boot Device
   //
-  Status = InitBootDevice (OsBootOption);
+  Status = PrepareBootDevice (OsBootOption);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_INFO, "Failed to Initialize Boot Device - Type %d, Instance %d\n",
       OsBootOption->DevType, OsBootOption->DevInstance));
@@ -1345,7 +1445,9 @@ PayloadMain (
   BOOLEAN                BootShell;
   UINTN                  ShellTimeout;
   UINT8                  CurrIdx;
+  UINT8                  NextIdx;
   UINT8                  BootIdx;
+  BOOLEAN                SameDevice;
 
   mEntryStack = Param;
 
@@ -1388,6 +1490,10 @@ PayloadMain (
     PrintBootOptions (OsBootOptionList);
     DEBUG_CODE_END ();
 
+    // Shell commands might have changed the boot devices, so probe them again
+    mBootDeviceCount  = 0;
+    mActiveBootDevice = BOOT_DEVICE_NONE;
+
     // Load and run Image in order from OsImageList
     BootIdx = 0;
     CurrIdx = GetCurrentBootOption (OsBootOptionList, 0);
@@ -1399,12 +1505,28 @@ PayloadMain (
       CopyMem ((VOID *)&OsBootOption, (VOID *)&OsBootOptionList->OsBootOption[CurrIdx], sizeof (OS_BOOT_OPTION));
       BootOsImage (&OsBootOption);
 
+      // Find next boot option
+      NextIdx = GetNextBootOption (OsBootOptionList, CurrIdx);
+      if (NextIdx >= OsBootOptionList->OsBootOptionCount) {
+        NextIdx = 0;
+      }
+
+      // Keep the boot device initialized if the next boot option uses it too
+      SameDevice = (OsBootOptionList->RestrictedBoot == 0) &&
+                   (BootIdx + 1 < OsBootOptionList->OsBootOptionCount) &&
+                   (mActiveBootDevice != BOOT_DEVICE_NONE) &&
+                   (OsBootOptionList->OsBootOption[NextIdx].DevType == OsBootOption.DevType) &&
+                   (OsBootOptionList->OsBootOption[NextIdx].DevInstance == OsBootOption.DevInstance);
+
       // De-init the current boot devices
       // If USB keyboard console is used, don't DeInit USB yet at this moment.
       // It will be handled just before transfering to OS.
-      if (!((OsBootOption.DevType == OsBootDeviceUsb) &&
-          ((PcdGet32 (PcdConsoleInDeviceMask) & ConsoleInUsbKeyboard) != 0))) {
-        MediaInitialize (0, DevDeinit);
+      if (!SameDevice) {
+        mActiveBootDevice = BOOT_DEVICE_NONE;
+        if (!((OsBootOption.DevType == OsBootDeviceUsb) &&
+            ((PcdGet32 (PcdConsoleInDeviceMask) & ConsoleInUsbKeyboard) != 0))) {
+          MediaInitialize (0, DevDeinit);
+        }
       }
 
       if (OsBootOptionList->RestrictedBoot != 0) {
@@ -1412,10 +1534,7 @@ PayloadMain (
         break;
       } else {
         // Move to next boot option
-        CurrIdx = GetNextBootOption (OsBootOptionList, CurrIdx);
-        if (CurrIdx >= OsBootOptionList->OsBootOptionCount) {
-          CurrIdx = 0;
-        }
+        CurrIdx = NextIdx;
         BootIdx++;
       }
     }
@@ -22,7 +22,7 @@
 #include <Library/MediaAccessLib.h>
 #include <Library/PayloadEntryLib.h>
 #include <Library/LitePeCoffLib.h>
-#include <Library/HobLib.h>
+#include <Library/BlHobLib.h>
 #include <Library/PrintLib.h>
 #include <Library/Crc32Lib.h>
 #include <Library/PcdLib.h>
@@ -149,6 +149,15 @@ typedef struct {
   RESERVED_CMDLINE_DATA   ReservedCmdlineData;
 } LOADED_IMAGE;
 
+#define BOOT_DEVICE_NONE         0xFF
+
+typedef struct {
+  UINT8                   DevType;
+  UINT8                   DevInstance;
+  UINT8                   Reserved[2];
+  EFI_STATUS              InitStatus;
+} BOOT_DEVICE_STATE;
+
 /**
 OS Loader module entry point. Can also be used to get the
 base address of the OS Loader's location in memory.
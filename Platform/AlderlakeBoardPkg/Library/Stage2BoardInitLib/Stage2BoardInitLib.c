@@ -29,6 +29,11 @@ STATIC S3_SAVE_REG mS3SaveReg = {
   { { REG_TYPE_IO, WIDE32, { 0, 0}, (ACPI_BASE_ADDRESS + R_ACPI_IO_SMI_EN), 0x00000000 } }
 };
 
+STATIC EFI_STATUS  mCsmeBootPerfStatus = EFI_NOT_READY;
+STATIC UINT32      *mCsmeBootPerfData;
+STATIC UINT32      mCsmeBootPerfDataLength;
+STATIC UINT32      mCsmeBootPerfDataVersion;
+
 /**
   Create OS config data support HOB.
 
@@ -94,6 +99,29 @@ BuildOsConfigDataHob (
   return EFI_SUCCESS;
 }
 
+/**
+  Get the CSME boot time data and cache it.
+
+  The request posted at PrePayloadLoading is completed on the first call, so no
+  HECI response is left in the circular buffer once the HECI service is handed
+  over or FSP notifications send other HECI messages.
+
+  @retval EFI_SUCCESS           The CSME boot time data is cached.
+  @retval Others                The CSME boot time data could not be obtained.
+**/
+STATIC
+EFI_STATUS
+GetCsmeBootPerfData (
+  VOID
+  )
+{
+  if (mCsmeBootPerfStatus == EFI_NOT_READY) {
+    mCsmeBootPerfStatus = HeciGetEarlyBootPerfData (&mCsmeBootPerfData, &mCsmeBootPerfDataLength, &mCsmeBootPerfDataVersion);
+  }
+
+  return mCsmeBootPerfStatus;
+}
+
 /**
   Create Csme Boot time HOB.
 
@@ -108,15 +136,9 @@ UpdateCsmeBootPerfHob (
   OUT CSME_PERFORMANCE_INFO  *CsmeBootTimeData
   )
 {
-  UINT32      *EarlyBootData;
-  UINT32      EarlyBootDataLength;
-  UINT32      EarlyBootDataVersion;
   UINT32      AllocatedDataLength;
   EFI_STATUS  Status;
 
-  EarlyBootData = NULL;
-  EarlyBootDataLength = 0;
-
   if (CsmeBootTimeData == NULL) {
     return EFI_INVALID_PARAMETER;
   }
@@ -126,7 +148,7 @@ UpdateCsmeBootPerfHob (
   //
   AllocatedDataLength = CsmeBootTimeData->BootDataLength;
 
-  Status = HeciGetEarlyBootPerfData (&EarlyBootData, &EarlyBootDataLength, &EarlyBootDataVersion);
+  Status = GetCsmeBootPerfData ();
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Obtaining CSME Boot performance data failed with status: %r\n", Status));
     return Status;
@@ -134,14 +156,14 @@ UpdateCsmeBootPerfHob (
     DEBUG ((DEBUG_INFO, "Found CSME Boot performance data!\n"));
   }
 
-  if (EarlyBootDataLength > AllocatedDataLength) {
+  if (mCsmeBootPerfDataLength > AllocatedDataLength) {
     return EFI_OUT_OF_RESOURCES;
   }
 
   CsmeBootTimeData->Revision = 1;
-  CsmeBootTimeData->BootDataVersion = EarlyBootDataVersion;
-  CsmeBootTimeData->BootDataLength = EarlyBootDataLength;
-  CopyMem (CsmeBootTimeData->BootPerformanceData, EarlyBootData, EarlyBootDataLength * sizeof (UINT32));
+  CsmeBootTimeData->BootDataVersion = mCsmeBootPerfDataVersion;
+  CsmeBootTimeData->BootDataLength = mCsmeBootPerfDataLength;
+  CopyMem (CsmeBootTimeData->BootPerformanceData, mCsmeBootPerfData, mCsmeBootPerfDataLength * sizeof (UINT32));
 
   return EFI_SUCCESS;
 }
@@ -425,8 +447,25 @@ BoardInit (
 
     //Initialize and setup MeMeasureboot
     MeMeasuredBootInit();
+
+    //
+    // Let CSME prepare its boot time data while the payload is loaded
+    //
+    if ((PcdGet32 (PcdBootPerformanceMask) & BIT2) != 0) {
+      HeciPostEarlyBootPerfDataRequest ();
+    }
+    break;
+  case PostPayloadLoading:
+    HeciPollAsync ();
     break;
   case EndOfStages:
+    //
+    // Complete the CSME boot time data request before the HECI service is
+    // registered and before any FSP notification sends a HECI message
+    //
+    if (((PcdGet32 (PcdBootPerformanceMask) & BIT2) != 0) && (GetBootMode () != BOOT_ON_S3_RESUME)) {
+      GetCsmeBootPerfData ();
+    }
     // Register Heci Service
     HeciRegisterHeciService ();
     ClearSmi ();
@@ -0,0 +1,97 @@
+#!/usr/bin/env python
+## @ mp_init.py
+#
+# Test multi-processor init on QEMU with many CPU threads
+#
+# Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+##
+
+import os
+import sys
+from   test_base import *
+
+def get_check_lines (cpu_count):
+    lines = [
+              "===== Intel Slim Bootloader STAGE2 ======",
+              "MP Init (Run)",
+              "Detected %d CPU threads" % cpu_count,
+              "Jump to payload",
+              "MP Init (Done)",
+              "Linux version",
+            ]
+    return lines
+
+def get_error_lines ():
+    lines = [
+              "MPINIT timeout",
+              "MP task timeout",
+              "MTRR sync on APs failed",
+              "is not ready yet",
+              "PcdCpuMaxLogicalProcessorNumber is too small",
+            ]
+    return lines
+
+def check_no_errors (output):
+    ret = 0
+    for line in get_error_lines ():
+        for out_line in output:
+            if line in out_line:
+                print ("Found '%s' !" % out_line)
+                ret = -1
+                break
+    return ret
+
+def usage():
+    print("usage:\n  python %s bios_image os_image_dir\n" % sys.argv[0])
+    print("  bios_image  :  QEMU Slim Bootloader firmware image.")
+    print("                 This image can be generated through the normal Slim Bootloader build process.")
+    print("  os_image_dir:  Directory containing bootable OS image.")
+    print("                 This image can be generated using GenContainer.py tool.")
+    print("")
+
+
+def main():
+    if sys.version_info.major < 3:
+        print ("This script needs Python3 !")
+        return -1
+
+    if len(sys.argv) != 3:
+        usage()
+        return -2
+
+    bios_img = sys.argv[1]
+    os_dir   = sys.argv[2]
+
+    print("MP init test for Slim BootLoader")
+
+    # download and unzip OS image
+    tmp_dir = os.path.dirname(os_dir) + '/temp'
+    create_dirs ([tmp_dir, os_dir])
+    local_file = tmp_dir + '/QemuLinux.zip'
+    if not os.path.exists(local_file):
+        download_url (
+            'https://github.com/slimbootloader/slimbootloader/files/4463548/QemuLinux.zip',
+            local_file
+        )
+    unzip_file (local_file, os_dir)
+
+    # boot with enough APs that the MP task broadcast and per-CPU
+    # tasks overlap, then boot Linux to go through MP init done
+    ret = 0
+    for cpu_count in [8, 16]:
+        print ('Booting with %d CPU threads' % cpu_count)
+        output = run_qemu(bios_img, os_dir, timeout = 15, smp = cpu_count)
+
+        # check test result
+        if check_result (output, get_check_lines(cpu_count)) or check_no_errors (output):
+            ret = -1
+            break
+
+    print ('\nMP init test %s !\n' % ('PASSED' if ret == 0 else 'FAILED'))
+
+    return ret
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,152 @@
+#!/usr/bin/env python
+## @ multi_disk_boot.py
+#
+# Test OS boot option fallback over several disks on QEMU
+#
+# Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+##
+
+import os
+import sys
+import shutil
+from   test_base import *
+
+#
+# Boot options written into the CFGDATA for this test:
+#   0: NVMe, no controller attached, fails to initialize
+#   1: NVMe again, skipped without initializing it again
+#   2: SATA port 1, empty disk, no boot partition
+#   3: SATA port 0, boots Linux on the already initialized controller
+#
+def get_boot_option_lines ():
+    lines = [
+              'GEN_CFG_DATA.CurrentBoot | 0\n',
+              'BOOT_OPTION_CFG_DATA_0.BootDeviceType_0 | 6\n',
+              'BOOT_OPTION_CFG_DATA_0.HwPart_0 | 0\n',
+              'BOOT_OPTION_CFG_DATA_1.BootDeviceType_1 | 6\n',
+              'BOOT_OPTION_CFG_DATA_1.HwPart_1 | 0\n',
+              'BOOT_OPTION_CFG_DATA_2.BootDeviceType_2 | 0\n',
+              'BOOT_OPTION_CFG_DATA_2.HwPart_2 | 1\n',
+              'BOOT_OPTION_CFG_DATA_3.BootDeviceType_3 | 0\n',
+              'BOOT_OPTION_CFG_DATA_3.HwPart_3 | 0\n',
+            ]
+    return lines
+
+def get_check_lines ():
+    lines = [
+              "===== Intel Slim Bootloader STAGE2 ======",
+              "Jump to payload",
+              "Try Booting with Boot Option 0",
+              "Failed to Initialize Boot Device - Type 6, Instance 0",
+              "Try Booting with Boot Option 1",
+              "Skip boot device that failed to initialize",
+              "Failed to Initialize Boot Device - Type 6, Instance 0",
+              "Try Booting with Boot Option 2",
+              "Getting boot image from SATA",
+              "Try Booting with Boot Option 3",
+              "Reuse initialized boot device",
+              "Starting Kernel ...",
+              "Linux version",
+            ]
+    return lines
+
+def count_lines (output, text):
+    return len ([line for line in output if text in line])
+
+def usage():
+    print("usage:\n  python %s bios_image os_image_dir\n" % sys.argv[0])
+    print("  bios_image  :  QEMU Slim Bootloader firmware image.")
+    print("                 This image can be generated through the normal Slim Bootloader build process.")
+    print("  os_image_dir:  Directory containing bootable OS image.")
+    print("                 This image can be generated using GenContainer.py tool.")
+    print("")
+
+
+def main():
+    if sys.version_info.major < 3:
+        print ("This script needs Python3 !")
+        return -1
+
+    if len(sys.argv) != 3:
+        usage()
+        return -2
+
+    bios_img = sys.argv[1]
+    bios_dir = os.path.dirname (bios_img)
+    os_dir   = sys.argv[2]
+    tmp_dir  = os.path.join(os.path.dirname (os_dir), 'temp')
+    cfg_dir  = os.path.join(tmp_dir, 'multi_disk')
+    sbl_dir  = os.getcwd()
+    key_dir  = get_key_dir (sbl_dir)
+
+    print("Multiple disk boot test for Slim BootLoader")
+    if os.path.exists(cfg_dir):
+        shutil.rmtree (cfg_dir)
+    create_dirs  ([tmp_dir, os_dir, cfg_dir])
+
+    # download and unzip OS image
+    local_file = tmp_dir + '/QemuLinux.zip'
+    if not os.path.exists(local_file):
+        download_url (
+            'https://github.com/slimbootloader/slimbootloader/files/4463548/QemuLinux.zip',
+            local_file
+        )
+    unzip_file (local_file, os_dir)
+
+    # copy files to cfg dir
+    src_files = ['CfgDataStitch.py', 'CfgDataDef.yaml']
+    for file in src_files:
+        shutil.copyfile (os.path.join(bios_dir, file), os.path.join(cfg_dir, file))
+
+    # run cfg stitch tool to generate delta files, then again with the boot options
+    cfg_stitch = os.path.join(bios_dir, src_files[0])
+    cmds = [sys.executable, cfg_stitch, '-i', bios_img,
+            '-k', key_dir + '/ConfigTestKey_Priv_RSA3072.pem',
+            '-t', get_tool_dir (sbl_dir),
+            '-s', sbl_dir + '/BootloaderCorePkg/Tools',
+            '-c', cfg_dir,
+            '-o', cfg_dir + '/SlimBootloader.bin']
+    res = run_command (cmds)
+    if res:
+        return res
+
+    fd   = open (cfg_dir + '/CfgDataExt_Brd1.dlt', 'r')
+    dlt_lines = fd.readlines ()
+    fd.close ()
+    dlt_lines.extend (get_boot_option_lines ())
+    fd   = open (cfg_dir + '/CfgDataExt_Brd1.dlt', 'w')
+    fd.write (''.join(dlt_lines))
+    fd.close ()
+
+    res = run_command (cmds)
+    if res:
+        return res
+
+    # two empty disks on SATA port 1 and 2, no NVMe controller
+    disks = []
+    for idx in range(2):
+        disk = os.path.join(cfg_dir, 'empty%d.img' % idx)
+        gen_file_from_object (disk, b'\x00' * 0x1000000)
+        disks.append (disk)
+
+    # run QEMU boot with timeout
+    bios_img = os.path.join (cfg_dir, 'SlimBootloader.bin')
+    output = run_qemu(bios_img, os_dir, timeout = 15, disks = disks)
+
+    # check test result, each controller is initialized once at most
+    ret = check_result (output, get_check_lines())
+    if ret == 0:
+        for device in ['NVME', 'SATA']:
+            count = count_lines (output, 'Getting boot image from %s' % device)
+            if count > 1:
+                print ("%s initialized %d times !" % (device, count))
+                ret = -1
+
+    print ('\nMultiple disk boot test %s !\n' % ('PASSED' if ret == 0 else 'FAILED'))
+
+    return ret
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -47,7 +47,7 @@ def create_dirs (dirs):
             os.mkdir (dir_name)
 
 
-def run_qemu (bios_img, fwu_path, fwu_mode=False, boot_order='', timeout=0):
+def run_qemu (bios_img, fwu_path, fwu_mode=False, boot_order='', timeout=0, smp=0, disks=[]):
     if os.name == 'nt':
         path = r"C:\Program Files\qemu\qemu-system-x86_64"
     else:
@@ -60,6 +60,14 @@ def run_qemu (bios_img, fwu_path, fwu_mode=False, boot_order='', timeout=0):
         "ide-hd,drive=mydrive", "-boot", "order=d%s" % ('an' if fwu_mode else boot_order),
         "-no-reboot", "-drive", "file=%s,if=pflash,format=raw" % bios_img
     ]
+    if smp:
+        cmd_list.extend (["-smp", "%d" % smp])
+    # extra raw disk images go to the next SATA ports after fwu_path
+    for idx, disk in enumerate (disks):
+        cmd_list.extend ([
+            "-drive", "id=disk%d,if=none,format=raw,file=%s" % (idx, disk),
+            "-device", "ide-hd,drive=disk%d,bus=ide.%d" % (idx, idx + 1)
+        ])
 
     lines = run_process (cmd_list, timeout)
     return lines
@@ -39,6 +39,8 @@ def main():
       ('linux_boot.py'     ,  [tst_img, img_dir]),
       ('uefi_upld_boot.py' ,  [tst_img, tmp_dir]),
       ('cfgdata_update.py' ,  [tst_img, tmp_dir]),
+      ('mp_init.py'        ,  [tst_img, img_dir]),
+      ('multi_disk_boot.py',  [tst_img, img_dir]),
     ]
 
     for test_file, test_args in test_cases:
@@ -113,13 +113,55 @@ GpioDwRegValueFromGpioConfig (
   }
 }
 
+/**
+  Check if the PADCFG registers of a pad already hold the requested configuration.
+
+  @param[in] GpioCom                    GPIO community of the pad
+  @param[in] PadCfgReg                  Offset of the pad PADCFG DW0 register
+  @param[in] PadCfgDwReg                PADCFG register values to be programmed
+  @param[in] PadCfgDwRegMask            PADCFG register masks of the values
+
+  @retval TRUE                          The pad does not need to be programmed
+  @retval FALSE                         At least one PADCFG register differs
+**/
+STATIC
+BOOLEAN
+GpioIsPadCfgUnchanged (
+  IN PCH_SBI_PID               GpioCom,
+  IN UINT32                    PadCfgReg,
+  IN CONST UINT32              *PadCfgDwReg,
+  IN CONST UINT32              *PadCfgDwRegMask
+  )
+{
+  UINT32                 RegNum;
+
+  //
+  // Only DW0 and DW1 are programmed by GpioConfigurePch ()
+  //
+  for (RegNum = 0; RegNum < 2; RegNum++) {
+    if ((MmioRead32 (PCH_PCR_ADDRESS (GpioCom, PadCfgReg + RegNum * 0x4)) & PadCfgDwRegMask[RegNum]) !=
+        (PadCfgDwReg[RegNum] & PadCfgDwRegMask[RegNum])) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
 /**
   This internal procedure will scan GPIO initialization table and unlock
-  all pads present in it
+  the pads present in it which are going to be reprogrammed or need to be
+  left unlocked.
 
-  @param[in] NumberOfItem               Number of GPIO pad records in table
-  @param[in] GpioInitTableAddress       GPIO initialization table
-  @param[in] Index                      Index of GPIO Initialization table record
+  Pads whose PADCFG registers already match the table, typically after a warm
+  reset, keep their PADCFG lock state. Their TX state is still unlocked unless
+  the pad is input only or disabled, so that the output can be driven later.
+
+  @param[in]  NumberOfItem              Number of GPIO pad records in table
+  @param[in]  GpioInitTableAddress      GPIO initialization table
+  @param[in]  Index                     Index of GPIO Initialization table record
+  @param[out] PadsToUpdate              Pads of the group whose PADCFG registers
+                                        need to be programmed, one bit per pad
 
   @retval EFI_SUCCESS                   The function completed successfully
   @retval EFI_INVALID_PARAMETER         Invalid group or pad number
@@ -127,12 +169,20 @@ GpioDwRegValueFromGpioConfig (
 STATIC
 EFI_STATUS
 GpioUnlockPadsForAGroup (
-  IN UINT32                    NumberOfItems,
-  IN GPIO_INIT_CONFIG          *GpioInitTableAddress,
-  IN UINT32                    Index
+  IN  UINT32                   NumberOfItems,
+  IN  GPIO_INIT_CONFIG         *GpioInitTableAddress,
+  IN  UINT32                   Index,
+  OUT UINT32                   *PadsToUpdate
   )
 {
   UINT32                 PadsToUnlock[GPIO_GROUP_DW_NUMBER];
+  UINT32                 PadsToUnlockTx[GPIO_GROUP_DW_NUMBER];
+  UINT32                 PadsOutput[GPIO_GROUP_DW_NUMBER];
+  GPIO_GROUP_DW_DATA     GroupDwData[GPIO_GROUP_DW_NUMBER];
+  UINT32                 PadCfgDwReg[GPIO_PADCFG_DW_REG_NUMBER];
+  UINT32                 PadCfgDwRegMask[GPIO_PADCFG_DW_REG_NUMBER];
+  UINT32                 PadCfgReg;
+  PCH_SBI_PID            GpioCom;
   UINT32                 DwNum;
   UINT32                 PadBitPosition;
   CONST GPIO_GROUP_INFO  *GpioGroupInfo;
@@ -147,8 +197,11 @@ GpioUnlockPadsForAGroup (
   GpioData   = &GpioInitTableAddress[Index];
   Group      = GPIO_GET_GROUP_FROM_PAD (GpioData->GpioPad);
   GroupIndex = (UINT32) GPIO_GET_GROUP_INDEX_FROM_PAD (GpioData->GpioPad);
+  GpioCom    = GpioGroupInfo[GroupIndex].Community;
 
-  ZeroMem (PadsToUnlock, sizeof (PadsToUnlock));
+  ZeroMem (GroupDwData, sizeof (GroupDwData));
+  ZeroMem (PadsOutput, sizeof (PadsOutput));
+  ZeroMem (PadsToUpdate, sizeof (UINT32) * GPIO_GROUP_DW_NUMBER);
   //
   // Loop through pads for one group. If pad belongs to a different group then
   // break and move to register programming.
@@ -178,21 +231,52 @@ GpioUnlockPadsForAGroup (
       return EFI_UNSUPPORTED;
     }
     //
-    // Update pads which need to be unlocked
+    // Only pads with a PADCFG change need to be unlocked for programming
+    //
+    ZeroMem (PadCfgDwReg, sizeof (PadCfgDwReg));
+    ZeroMem (PadCfgDwRegMask, sizeof (PadCfgDwRegMask));
+    GpioPadCfgRegValueFromGpioConfig (
+      GpioData->GpioPad,
+      &GpioData->GpioConfig,
+      PadCfgDwReg,
+      PadCfgDwRegMask
+      );
+    PadCfgReg = S_GPIO_PCR_PADCFG * PadNumber + GpioGroupInfo[GroupIndex].PadCfgOffset;
+    if (!GpioIsPadCfgUnchanged (GpioCom, PadCfgReg, PadCfgDwReg, PadCfgDwRegMask)) {
+      PadsToUpdate[DwNum] |= 0x1 << PadBitPosition;
+    }
+
+    //
+    // PADCFGLOCKTX survives a warm reset, so pads which may drive an output
+    // keep their TX state unlocked even if PADCFG is not reprogrammed
+    //
+    if ((GpioData->GpioConfig.Direction != GpioDirIn) && (GpioData->GpioConfig.Direction != GpioDirNone)) {
+      PadsOutput[DwNum] |= 0x1 << PadBitPosition;
+    }
+
+    //
+    // Pads which are left unlocked after boot still need to be unlocked
     //
-    PadsToUnlock[DwNum] |= 0x1 << PadBitPosition;
+    GpioDwRegValueFromGpioConfig (PadNumber, &GpioData->GpioConfig, GroupDwData);
 
     //Move to next item
     Index++;
   }
 
+  for (DwNum = 0; DwNum < GPIO_GROUP_DW_NUMBER; DwNum++) {
+    PadsToUnlock[DwNum]   = PadsToUpdate[DwNum] | GroupDwData[DwNum].ConfigUnlockMask;
+    PadsToUnlockTx[DwNum] = PadsToUpdate[DwNum] | PadsOutput[DwNum] | GroupDwData[DwNum].OutputUnlockMask;
+  }
+
   for (DwNum = 0; DwNum <= GPIO_GET_DW_NUM (GpioGroupInfo[GroupIndex].PadPerGroup); DwNum++) {
     //
     // Unlock pads
     //
     if (PadsToUnlock[DwNum] != 0) {
       GpioUnlockPadCfgForGroupDw (Group, DwNum, PadsToUnlock[DwNum]);
-      GpioUnlockPadCfgTxForGroupDw (Group, DwNum, PadsToUnlock[DwNum]);
+    }
+    if (PadsToUnlockTx[DwNum] != 0) {
+      GpioUnlockPadCfgTxForGroupDw (Group, DwNum, PadsToUnlockTx[DwNum]);
     }
   }
 
@@ -227,6 +311,12 @@ GpioConfigurePch (
   UINT32                 GroupIndex;
   UINT32                 PadNumber;
   PCH_SBI_PID            GpioCom;
+  UINT32                 PadsToUpdate[GPIO_GROUP_DW_NUMBER];
+  UINT32                 PadsProgrammed;
+  UINT32                 PadsUnchanged;
+
+  PadsProgrammed = 0;
+  PadsUnchanged  = 0;
 
   GpioGroupInfo = GpioGetGroupInfoTable (&GpioGroupInfoLength);
 
@@ -245,9 +335,10 @@ GpioConfigurePch (
     // will get back to default only after G3 or DeepSx transition. On the other hand GpioPads
     // configuration is controlled by a configurable type of reset - PadRstCfg. This means that if
     // PadRstCfg != Powergood GpioPad will have its configuration locked despite it being not the
-    // one desired by BIOS. Before reconfiguring all pads they will get unlocked.
+    // one desired by BIOS. Before reconfiguring pads they will get unlocked. Pads which already
+    // hold the desired configuration are neither unlocked nor reprogrammed.
     //
-    GpioUnlockPadsForAGroup (NumberOfItems, GpioInitTableAddress, Index);
+    GpioUnlockPadsForAGroup (NumberOfItems, GpioInitTableAddress, Index, PadsToUpdate);
 
     ZeroMem (GroupDwData, sizeof (GroupDwData));
     //
@@ -264,6 +355,21 @@ GpioConfigurePch (
 
       PadNumber  = (UINT32) GPIO_GET_PAD_NUMBER (GpioData->GpioPad);
 
+      //
+      // Skip PADCFG programming if the pad already holds the configuration
+      //
+      if ((PadsToUpdate[GPIO_GET_DW_NUM (PadNumber)] & (0x1 << GPIO_GET_PAD_POSITION (PadNumber))) == 0) {
+        GpioDwRegValueFromGpioConfig (
+          PadNumber,
+          &GpioData->GpioConfig,
+          GroupDwData
+          );
+        PadsUnchanged++;
+        Index++;
+        continue;
+      }
+      PadsProgrammed++;
+
       ZeroMem (PadCfgDwReg, sizeof (PadCfgDwReg));
       ZeroMem (PadCfgDwRegMask, sizeof (PadCfgDwRegMask));
       //
@@ -366,6 +472,8 @@ GpioConfigurePch (
     }
   }
 
+  DEBUG ((DEBUG_INFO, "GPIO pads programmed: %d, unchanged: %d\n", PadsProgrammed, PadsUnchanged));
+
   return EFI_SUCCESS;
 }
 
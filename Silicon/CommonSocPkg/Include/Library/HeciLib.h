@@ -15,6 +15,11 @@
 #define HECI_NON_BLOCKING_MSG               0
 #define HECI_BLOCKING_MSG                   1
 
+//
+// Maximum number of asynchronous HECI requests waiting for a response
+//
+#define HECI_ASYNC_QUEUE_DEPTH              4
+
 //
 // Abstract ME Mode Definitions
 //
@@ -181,6 +186,75 @@ HeciSendwAck (
   IN      UINT8        MeAddress
   );
 
+/**
+  Function sends one message through the HECI circular buffer and returns without
+  waiting for the response.
+
+  The response is collected into the Response buffer by HeciPollAsync () or
+  HeciWaitAsync (). Responses are matched to requests in the order the requests
+  were posted on a HECI device. A synchronous HeciSend () on the same device
+  first waits for all pending asynchronous responses of that device.
+
+  @param[in]  HeciDev             The HECI device to be accessed.
+  @param[in]  Message             Pointer to the message data to be sent.
+  @param[in]  Length              Length of the message in bytes.
+  @param[in]  HostAddress         Address of the sending entity.
+  @param[in]  MeAddress           Address of the ME entity that should receive the message.
+  @param[out] Response            Buffer to receive the response. It must stay valid
+                                  until the request is completed by HeciWaitAsync ().
+  @param[in]  ResponseLength      Length of the response buffer in bytes.
+  @param[out] RequestId           Identifier of the posted request.
+
+  @retval EFI_SUCCESS             The message was sent.
+  @retval EFI_INVALID_PARAMETER   Response or RequestId is NULL.
+  @retval EFI_OUT_OF_RESOURCES    Too many requests are waiting for a response.
+  @retval Others                  The message could not be sent, see HeciSend ().
+**/
+EFI_STATUS
+EFIAPI
+HeciSendAsync (
+  IN  HECI_DEVICE  HeciDev,
+  IN  UINT32      *Message,
+  IN  UINT32       Length,
+  IN  UINT8        HostAddress,
+  IN  UINT8        MeAddress,
+  OUT UINT32      *Response,
+  IN  UINT32       ResponseLength,
+  OUT UINT32      *RequestId
+  );
+
+/**
+  Collect the responses of asynchronous HECI requests that are already available
+  without waiting for the ME.
+
+  It is meant to be called at idle points of the boot flow.
+
+  @retval EFI_SUCCESS             No request is waiting for a response anymore.
+  @retval EFI_NOT_READY           Some requests are still waiting for a response.
+**/
+EFI_STATUS
+EFIAPI
+HeciPollAsync (
+  VOID
+  );
+
+/**
+  Wait for the response of an asynchronous HECI request and release the request.
+
+  @param[in]  RequestId           Identifier returned by HeciSendAsync ().
+  @param[out] RecLength           Length of the received response in bytes. Optional.
+
+  @retval EFI_SUCCESS             The response was received into the Response buffer.
+  @retval EFI_INVALID_PARAMETER   RequestId is not a posted request.
+  @retval Others                  The response could not be received, see HeciReceive ().
+**/
+EFI_STATUS
+EFIAPI
+HeciWaitAsync (
+  IN  UINT32       RequestId,
+  OUT UINT32      *RecLength  OPTIONAL
+  );
+
 /**
   Function forces a reinit of the heci interface by following the reset heci interface via Host algorithm
 
@@ -316,4 +390,19 @@ HeciGetEarlyBootPerfData (
   OUT UINT32        *EarlyBootDataVersion
   );
 
+/**
+  Post the CSME boot time data request without waiting for the response.
+
+  A later HeciGetEarlyBootPerfData () call returns the response of this request
+  instead of sending a new one, so the CSME latency overlaps with other boot work.
+
+  @retval EFI_SUCCESS             The request was posted or is already pending.
+  @retval EFI_OUT_OF_RESOURCES    Failed to allocate the response buffer.
+  @retval Others                  The request could not be sent.
+**/
+EFI_STATUS
+HeciPostEarlyBootPerfDataRequest (
+  VOID
+  );
+
 #endif // _HECI_LIB_H_
@@ -26,6 +26,27 @@
 #define HECI_INIT_TIMEOUT         15000000    // 15sec timeout in microseconds
 #define HECI_TIMEOUT_COUNT(t)     (((t) + HECI_WAIT_DELAY - 1) / HECI_WAIT_DELAY)
 
+typedef enum {
+  HeciAsyncFree = 0,
+  HeciAsyncPending,
+  HeciAsyncDone
+} HECI_ASYNC_STATE;
+
+//
+// Asynchronous HECI request waiting for or holding its response
+//
+typedef struct {
+  HECI_ASYNC_STATE   State;
+  HECI_DEVICE        HeciDev;
+  UINT32            *Response;
+  UINT32             Length;
+  UINT32             Sequence;
+  EFI_STATUS         Status;
+} HECI_ASYNC_REQUEST;
+
+STATIC HECI_ASYNC_REQUEST  mHeciAsyncQueue[HECI_ASYNC_QUEUE_DEPTH];
+STATIC UINT32              mHeciAsyncSequence;
+
 /**
   Return number of filled slots in HECI circular buffer.
   Corresponds to HECI HPS (part of) section 4.2.1
@@ -696,6 +717,54 @@ HeciServiceReceive (
   return HeciReceive((HECI_DEVICE)HeciDev, Blocking, MessageBody, Length);
 }
 
+/**
+  Receive the response of the oldest asynchronous request pending on a HECI device.
+
+  @param[in] HeciDev              The HECI device to be accessed.
+  @param[in] Blocking             Used to determine if the read is BLOCKING or NON_BLOCKING.
+
+  @retval EFI_SUCCESS             The oldest pending request got its response or an error.
+  @retval EFI_NOT_FOUND           No request is pending on the device.
+  @retval EFI_NO_RESPONSE         NON_BLOCKING read and the response is not available yet.
+**/
+STATIC
+EFI_STATUS
+HeciReceiveAsync (
+  IN HECI_DEVICE  HeciDev,
+  IN UINT32       Blocking
+  )
+{
+  HECI_ASYNC_REQUEST  *Request;
+  EFI_STATUS           Status;
+  UINT32               Length;
+  UINT32               Index;
+
+  Request = NULL;
+  for (Index = 0; Index < HECI_ASYNC_QUEUE_DEPTH; Index++) {
+    if ((mHeciAsyncQueue[Index].State == HeciAsyncPending) && (mHeciAsyncQueue[Index].HeciDev == HeciDev)) {
+      if ((Request == NULL) || ((INT32)(mHeciAsyncQueue[Index].Sequence - Request->Sequence) < 0)) {
+        Request = &mHeciAsyncQueue[Index];
+      }
+    }
+  }
+
+  if (Request == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  Length = Request->Length;
+  Status = HeciReceive (HeciDev, Blocking, Request->Response, &Length);
+  if ((Status == EFI_NO_RESPONSE) && (Blocking == HECI_NON_BLOCKING_MSG)) {
+    return Status;
+  }
+
+  Request->Status = Status;
+  Request->Length = Length;
+  Request->State  = HeciAsyncDone;
+
+  return EFI_SUCCESS;
+}
+
 /**
   Function sends one message (of any length) through the HECI circular buffer.
 
@@ -710,9 +779,9 @@ HeciServiceReceive (
   @retval EFI_TIMEOUT             HECI is not ready for communication
   @retval EFI_UNSUPPORTED      Current ME mode doesn't support send this message through this HECI
 **/
+STATIC
 EFI_STATUS
-EFIAPI
-HeciSend (
+HeciSendMessage (
   IN HECI_DEVICE  HeciDev,
   IN UINT32      *Message,
   IN UINT32       Length,
@@ -808,6 +877,186 @@ HeciSend (
   return EFI_SUCCESS;
 }
 
+/**
+  Function sends one message (of any length) through the HECI circular buffer.
+
+  Responses of asynchronous requests pending on the device are received first
+  so that they are not mistaken for the response of this message.
+
+  @param[in] HeciDev              The HECI device to be accessed.
+  @param[in] Message              Pointer to the message data to be sent.
+  @param[in] Length               Length of the message in bytes.
+  @param[in] HostAddress          The address of the Host processor.
+  @param[in] MeAddress            Address of the ME subsystem the message is being sent to.
+
+  @retval EFI_SUCCESS             One message packet sent.
+  @retval EFI_DEVICE_ERROR        Failed to initialize HECI
+  @retval EFI_TIMEOUT             HECI is not ready for communication
+  @retval EFI_UNSUPPORTED      Current ME mode doesn't support send this message through this HECI
+**/
+EFI_STATUS
+EFIAPI
+HeciSend (
+  IN HECI_DEVICE  HeciDev,
+  IN UINT32      *Message,
+  IN UINT32       Length,
+  IN UINT8        HostAddress,
+  IN UINT8        MeAddress
+  )
+{
+  while (HeciReceiveAsync (HeciDev, HECI_BLOCKING_MSG) == EFI_SUCCESS) {
+  }
+
+  return HeciSendMessage (HeciDev, Message, Length, HostAddress, MeAddress);
+}
+
+/**
+  Function sends one message through the HECI circular buffer and returns without
+  waiting for the response.
+
+  The response is collected into the Response buffer by HeciPollAsync () or
+  HeciWaitAsync (). Responses are matched to requests in the order the requests
+  were posted on a HECI device. A synchronous HeciSend () on the same device
+  first waits for all pending asynchronous responses of that device.
+
+  @param[in]  HeciDev             The HECI device to be accessed.
+  @param[in]  Message             Pointer to the message data to be sent.
+  @param[in]  Length              Length of the message in bytes.
+  @param[in]  HostAddress         Address of the sending entity.
+  @param[in]  MeAddress           Address of the ME entity that should receive the message.
+  @param[out] Response            Buffer to receive the response. It must stay valid
+                                  until the request is completed by HeciWaitAsync ().
+  @param[in]  ResponseLength      Length of the response buffer in bytes.
+  @param[out] RequestId           Identifier of the posted request.
+
+  @retval EFI_SUCCESS             The message was sent.
+  @retval EFI_INVALID_PARAMETER   Response or RequestId is NULL.
+  @retval EFI_OUT_OF_RESOURCES    Too many requests are waiting for a response.
+  @retval Others                  The message could not be sent, see HeciSend ().
+**/
+EFI_STATUS
+EFIAPI
+HeciSendAsync (
+  IN  HECI_DEVICE  HeciDev,
+  IN  UINT32      *Message,
+  IN  UINT32       Length,
+  IN  UINT8        HostAddress,
+  IN  UINT8        MeAddress,
+  OUT UINT32      *Response,
+  IN  UINT32       ResponseLength,
+  OUT UINT32      *RequestId
+  )
+{
+  EFI_STATUS          Status;
+  UINT32              Index;
+
+  if ((Response == NULL) || (RequestId == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  for (Index = 0; Index < HECI_ASYNC_QUEUE_DEPTH; Index++) {
+    if (mHeciAsyncQueue[Index].State == HeciAsyncFree) {
+      break;
+    }
+  }
+  if (Index == HECI_ASYNC_QUEUE_DEPTH) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = HeciSendMessage (HeciDev, Message, Length, HostAddress, MeAddress);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[HECI%d] HeciSendAsync failed on send, Status: %r\n", HeciDev, Status));
+    return Status;
+  }
+
+  mHeciAsyncQueue[Index].HeciDev  = HeciDev;
+  mHeciAsyncQueue[Index].Response = Response;
+  mHeciAsyncQueue[Index].Length   = ResponseLength;
+  mHeciAsyncQueue[Index].Sequence = mHeciAsyncSequence++;
+  mHeciAsyncQueue[Index].Status   = EFI_NOT_READY;
+  mHeciAsyncQueue[Index].State    = HeciAsyncPending;
+  *RequestId = Index;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Collect the responses of asynchronous HECI requests that are already available
+  without waiting for the ME.
+
+  It is meant to be called at idle points of the boot flow.
+
+  @retval EFI_SUCCESS             No request is waiting for a response anymore.
+  @retval EFI_NOT_READY           Some requests are still waiting for a response.
+**/
+EFI_STATUS
+EFIAPI
+HeciPollAsync (
+  VOID
+  )
+{
+  EFI_STATUS          Status;
+  UINT32              Index;
+
+  Status = EFI_SUCCESS;
+  for (Index = 0; Index < HECI_ASYNC_QUEUE_DEPTH; Index++) {
+    if (mHeciAsyncQueue[Index].State != HeciAsyncPending) {
+      continue;
+    }
+    while (HeciReceiveAsync (mHeciAsyncQueue[Index].HeciDev, HECI_NON_BLOCKING_MSG) == EFI_SUCCESS) {
+    }
+    if (mHeciAsyncQueue[Index].State == HeciAsyncPending) {
+      Status = EFI_NOT_READY;
+    }
+  }
+
+  return Status;
+}
+
+/**
+  Wait for the response of an asynchronous HECI request and release the request.
+
+  @param[in]  RequestId           Identifier returned by HeciSendAsync ().
+  @param[out] RecLength           Length of the received response in bytes. Optional.
+
+  @retval EFI_SUCCESS             The response was received into the Response buffer.
+  @retval EFI_INVALID_PARAMETER   RequestId is not a posted request.
+  @retval Others                  The response could not be received, see HeciReceive ().
+**/
+EFI_STATUS
+EFIAPI
+HeciWaitAsync (
+  IN  UINT32       RequestId,
+  OUT UINT32      *RecLength  OPTIONAL
+  )
+{
+  HECI_ASYNC_REQUEST  *Request;
+  EFI_STATUS           Status;
+
+  if ((RequestId >= HECI_ASYNC_QUEUE_DEPTH) || (mHeciAsyncQueue[RequestId].State == HeciAsyncFree)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Request = &mHeciAsyncQueue[RequestId];
+  while (Request->State == HeciAsyncPending) {
+    //
+    // Older requests on the same device get their responses first
+    //
+    HeciReceiveAsync (Request->HeciDev, HECI_BLOCKING_MSG);
+  }
+
+  if (RecLength != NULL) {
+    *RecLength = Request->Length;
+  }
+  Status = Request->Status;
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[HECI%d] HeciWaitAsync failed on read, Status: %r\n", Request->HeciDev, Status));
+  }
+  Request->State = HeciAsyncFree;
+
+  return Status;
+}
+
 /**
   Heci Service API function wrapper to HeciSend API
 
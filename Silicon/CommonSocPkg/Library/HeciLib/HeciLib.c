@@ -19,6 +19,9 @@
 #include <IndustryStandard/Pci.h>
 #include "HeciRegs.h"
 
+STATIC GET_EARLY_BOOT_PERF_DATA_BUFFER  *mEarlyBootPerfDataBuf;
+STATIC UINT32                            mEarlyBootPerfDataRequestId = MAX_UINT32;
+
 /**
   Return HECI1 Mode
 
@@ -249,7 +252,81 @@ HeciGetEarlyBootPerfData (
     return EFI_INVALID_PARAMETER;
   }
 
-  ReqLength = sizeof (GET_EARLY_BOOT_PERF_DATA_CMD);
+  if (mEarlyBootPerfDataRequestId != MAX_UINT32) {
+    //
+    // Collect the response of the request posted earlier
+    //
+    PerfDataBuf = mEarlyBootPerfDataBuf;
+    Status = HeciWaitAsync (mEarlyBootPerfDataRequestId, &RespLength);
+    mEarlyBootPerfDataRequestId = MAX_UINT32;
+  } else {
+    ReqLength = sizeof (GET_EARLY_BOOT_PERF_DATA_CMD);
+    RespLength = sizeof (GET_EARLY_BOOT_PERF_DATA_RESPONSE) + (EARLY_BOOT_PERF_DATA_LENGTH_VERSION_1 * sizeof(UINT32));
+    PerfDataBuf = (GET_EARLY_BOOT_PERF_DATA_BUFFER*) AllocatePool (RespLength);
+    if (PerfDataBuf == NULL) {
+      DEBUG ((DEBUG_ERROR, "CSME PERF Data: Could not allocate Memory\n"));
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    ZeroMem (PerfDataBuf, RespLength);
+
+    PerfDataBuf->Request.Header.Fields.GroupId = BUP_COMMON_GROUP_ID;
+    PerfDataBuf->Request.Header.Fields.Command = GET_EARLY_BOOT_PERFORMANCE_DATA_CMD;
+
+    Status = HeciSendwAck (
+                     HECI1_DEVICE,
+                     (UINT32 *)PerfDataBuf,
+                     ReqLength,
+                     &RespLength,
+                     BIOS_FIXED_HOST_ADDR,
+                     HECI_MKHI_MESSAGE_ADDR
+                     );
+  }
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Heci Get Csme Perf Data failed with status %r\n", Status));
+    return Status;
+  }
+
+  if ((PerfDataBuf->Response.Header.Fields.GroupId != BUP_COMMON_GROUP_ID) ||
+      (PerfDataBuf->Response.Header.Fields.Command != GET_EARLY_BOOT_PERFORMANCE_DATA_CMD) ||
+      (PerfDataBuf->Response.Header.Fields.IsResponse == 0) ||
+      (PerfDataBuf->Response.Header.Fields.Result != 0)) {
+    DEBUG ((DEBUG_ERROR, "Heci Get Csme Perf Data failed\n"));
+    return EFI_DEVICE_ERROR;
+  }
+
+  *EarlyBootData     = PerfDataBuf->Response.BootPerformanceData;
+  *EarlyBootLength   = PerfDataBuf->Response.BootDataLength;
+  *EarlyBootDataVersion = PerfDataBuf->Response.BootDataVersion;
+
+  DEBUG ((DEBUG_INFO, "Heci Get Csme Perf Data Msg successful.\n"));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Post the CSME boot time data request without waiting for the response.
+
+  A later HeciGetEarlyBootPerfData () call returns the response of this request
+  instead of sending a new one, so the CSME latency overlaps with other boot work.
+
+  @retval EFI_SUCCESS             The request was posted or is already pending.
+  @retval EFI_OUT_OF_RESOURCES    Failed to allocate the response buffer.
+  @retval Others                  The request could not be sent.
+**/
+EFI_STATUS
+HeciPostEarlyBootPerfDataRequest (
+  VOID
+  )
+{
+  EFI_STATUS                        Status;
+  UINT32                            RespLength;
+  GET_EARLY_BOOT_PERF_DATA_BUFFER   *PerfDataBuf;
+
+  if (mEarlyBootPerfDataRequestId != MAX_UINT32) {
+    return EFI_SUCCESS;
+  }
+
   RespLength = sizeof (GET_EARLY_BOOT_PERF_DATA_RESPONSE) + (EARLY_BOOT_PERF_DATA_LENGTH_VERSION_1 * sizeof(UINT32));
   PerfDataBuf = (GET_EARLY_BOOT_PERF_DATA_BUFFER*) AllocatePool (RespLength);
   if (PerfDataBuf == NULL) {
@@ -262,32 +339,23 @@ HeciGetEarlyBootPerfData (
   PerfDataBuf->Request.Header.Fields.GroupId = BUP_COMMON_GROUP_ID;
   PerfDataBuf->Request.Header.Fields.Command = GET_EARLY_BOOT_PERFORMANCE_DATA_CMD;
 
-  Status = HeciSendwAck (
+  Status = HeciSendAsync (
                    HECI1_DEVICE,
                    (UINT32 *)PerfDataBuf,
-                   ReqLength,
-                   &RespLength,
+                   sizeof (GET_EARLY_BOOT_PERF_DATA_CMD),
                    BIOS_FIXED_HOST_ADDR,
-                   HECI_MKHI_MESSAGE_ADDR
+                   HECI_MKHI_MESSAGE_ADDR,
+                   (UINT32 *)PerfDataBuf,
+                   RespLength,
+                   &mEarlyBootPerfDataRequestId
                    );
   if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Heci Get Csme Perf Data failed with status %r\n", Status));
+    DEBUG ((DEBUG_ERROR, "Heci Post Csme Perf Data request failed with status %r\n", Status));
+    mEarlyBootPerfDataRequestId = MAX_UINT32;
     return Status;
   }
 
-  if ((PerfDataBuf->Response.Header.Fields.GroupId != BUP_COMMON_GROUP_ID) ||
-      (PerfDataBuf->Response.Header.Fields.Command != GET_EARLY_BOOT_PERFORMANCE_DATA_CMD) ||
-      (PerfDataBuf->Response.Header.Fields.IsResponse == 0) ||
-      (PerfDataBuf->Response.Header.Fields.Result != 0)) {
-    DEBUG ((DEBUG_ERROR, "Heci Get Csme Perf Data failed\n"));
-    return EFI_DEVICE_ERROR;
-  }
-
-  *EarlyBootData     = PerfDataBuf->Response.BootPerformanceData;
-  *EarlyBootLength   = PerfDataBuf->Response.BootDataLength;
-  *EarlyBootDataVersion = PerfDataBuf->Response.BootDataVersion;
-
-  DEBUG ((DEBUG_INFO, "Heci Get Csme Perf Data Msg successful.\n"));
+  mEarlyBootPerfDataBuf = PerfDataBuf;
 
   return EFI_SUCCESS;
 }